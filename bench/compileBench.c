@@ -0,0 +1,427 @@
+/**
+ * @file compileBench.c
+ * @brief Compile-time throughput harness linked against compiler_lib.
+ *
+ * Runs discovery and the in-process pipeline (lex .. codegen) for every
+ * module of a project at each optimization level, in a forked child per
+ * level so peak RSS is measured separately. Assembling and linking are left
+ * out: they time gcc, not us. Results are written as JSON with one result
+ * object per line, which is also the format --compare reads back.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "../src/modules/build.h"
+#include "../src/lexer/lexer.h"
+#include "../src/codeGeneration/codegen.h"
+#include "../src/IR/optimization.h"
+
+typedef enum {
+    PHASE_DISCOVERY,
+    PHASE_LEX,
+    PHASE_PARSE,
+    PHASE_TYPECHECK,
+    PHASE_EXPORTS,
+    PHASE_IRGEN,
+    PHASE_OPTIMIZE,
+    PHASE_CODEGEN,
+    PHASE_TOTAL,
+    PHASE_COUNT
+} BenchPhase;
+
+static const char *phaseNames[PHASE_COUNT] = {
+    "discovery", "lex", "parse", "typecheck", "exports", "irgen", "optimize", "codegen", "total",
+};
+
+typedef struct LevelResult {
+    int ok;
+    double seconds[PHASE_COUNT];
+    long peakRssKb;
+} LevelResult;
+
+typedef struct BenchConfig {
+    const char *entry;
+    const char *jsonPath;
+    const char *baselinePath;
+    double threshold;
+    int reps;
+    int minLevel;
+    int maxLevel;
+} BenchConfig;
+
+static char *readSource(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char *content = malloc(size + 1);
+    if (content) content[fread(content, 1, size, file)] = '\0';
+    fclose(file);
+    return content;
+}
+
+static void countSource(BuildContext *ctx, long *lines, long *bytes) {
+    *lines = 0;
+    *bytes = 0;
+    for (int i = 0; i < ctx->moduleCount; i++) {
+        char *source = readSource(ctx->modules[i].path);
+        if (!source) continue;
+        for (char *p = source; *p; p++) *lines += *p == '\n';
+        *bytes += (long)strlen(source);
+        free(source);
+    }
+}
+
+static int phaseIndex(const char *name) {
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        if (strcmp(phaseNames[i], name) == 0) return i;
+    }
+    return -1;
+}
+
+/**
+ * @brief Same steps as compileModule in build.c, minus file output and gcc.
+ */
+static int compileInProcess(BuildContext *ctx, Module *mod, int optLevel) {
+    BuildTimer *timer = ctx->timer;
+    char *source = readSource(mod->path);
+    if (!source) return 0;
+
+    int phase = timerBegin(timer, "lex");
+    TokenList *tokens = lex(source, mod->path);
+    timerEnd(timer, phase);
+
+    phase = timerBegin(timer, "parse");
+    ASTContext *ast = tokens ? ASTGenerator(tokens) : NULL;
+    timerEnd(timer, phase);
+    if (!ast || !ast->root) {
+        if (tokens) freeTokens(tokens);
+        free(source);
+        return 0;
+    }
+
+    phase = timerBegin(timer, "typecheck");
+    TypeCheckContext typeCtx = createTypeCheckContext(source, mod->path);
+    ModuleInterface **imports = calloc(mod->importCount + 1, sizeof(ModuleInterface *));
+    int importCount = 0;
+    for (int i = 0; i < mod->importCount; i++) {
+        Module *imported = findModule(ctx, mod->imports[i]);
+        if (imported && imported->interface) {
+            addImportsToSymbolTable(typeCtx->global, imported->interface);
+            imports[importCount++] = imported->interface;
+        }
+    }
+    TypeCheckContext checked = typeCheckAST(ast->root, source, mod->path, typeCtx);
+    timerEnd(timer, phase);
+    if (!checked) {
+        free(imports);
+        freeASTContext(ast);
+        freeTokens(tokens);
+        free(source);
+        return 0;
+    }
+
+    phase = timerBegin(timer, "exports");
+    if (mod->interface) freeModuleInterface(mod->interface);
+    mod->interface = extractExportsWithContext(ast->root, mod->name, typeCtx);
+    timerEnd(timer, phase);
+
+    phase = timerBegin(timer, "irgen");
+    IrContext *ir = generateIr(ast->root, typeCtx);
+    timerEnd(timer, phase);
+
+    if (ir && optLevel > 0) {
+        phase = timerBegin(timer, "optimize");
+        optimizeIR(ir, optLevel, NULL, NULL, NULL);
+        timerEnd(timer, phase);
+    }
+
+    phase = timerBegin(timer, "codegen");
+    char *assembly = ir ? generateAssembly(ir, mod->name, imports, importCount, NULL) : NULL;
+    timerEnd(timer, phase);
+
+    int ok = assembly != NULL;
+    free(assembly);
+    free(imports);
+    if (ir) freeIrContext(ir);
+    freeTypeCheckContext(typeCtx);
+    freeASTContext(ast);
+    freeTokens(tokens);
+    free(source);
+    return ok;
+}
+
+/**
+ * @brief One full compile of the project; adds per-phase seconds into out.
+ */
+static int compileOnce(const char *entry, int optLevel, double out[PHASE_COUNT]) {
+    BuildContext ctx = {0};
+    ctx.timer = createBuildTimer();
+
+    int phase = timerBegin(ctx.timer, "discovery");
+    int ok = findModules(&ctx, entry);
+    timerEnd(ctx.timer, phase);
+
+    int sortedCount = 0;
+    int *sorted = ok ? topoSortModules(&ctx, &sortedCount) : NULL;
+    ok = sorted != NULL;
+    for (int i = 0; ok && i < sortedCount; i++) {
+        ok = compileInProcess(&ctx, &ctx.modules[sorted[i]], optLevel);
+    }
+    free(sorted);
+
+    for (int i = 0; ok && i < ctx.timer->sampleCount; i++) {
+        PhaseSample *s = &ctx.timer->samples[i];
+        int idx = phaseIndex(s->phase);
+        if (idx < 0 || s->depth != 0) continue;
+        out[idx] += s->durationNs / 1e9;
+        out[PHASE_TOTAL] += s->durationNs / 1e9;
+    }
+
+    freeBuildContext(&ctx);
+    return ok;
+}
+
+/**
+ * @brief Best-of-reps time for every phase at one level, run in this process.
+ */
+static LevelResult runLevel(const BenchConfig *cfg, int optLevel) {
+    LevelResult result = {0};
+    for (int rep = 0; rep < cfg->reps; rep++) {
+        double seconds[PHASE_COUNT] = {0};
+        if (!compileOnce(cfg->entry, optLevel, seconds)) return result;
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            if (rep == 0 || seconds[p] < result.seconds[p]) result.seconds[p] = seconds[p];
+        }
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    result.peakRssKb = usage.ru_maxrss;
+    result.ok = 1;
+    return result;
+}
+
+static LevelResult runLevelIsolated(const BenchConfig *cfg, int optLevel) {
+    LevelResult result = {0};
+    int fds[2];
+    if (pipe(fds) != 0) return result;
+
+    fflush(NULL);
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return result;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        // compiler diagnostics go to stdout, keep them out of the JSON
+        if (!freopen("/dev/null", "w", stdout)) _exit(1);
+        LevelResult child = runLevel(cfg, optLevel);
+        ssize_t written = write(fds[1], &child, sizeof(child));
+        _exit(written == (ssize_t)sizeof(child) ? 0 : 1);
+    }
+
+    close(fds[1]);
+    if (read(fds[0], &result, sizeof(result)) != (ssize_t)sizeof(result)) result.ok = 0;
+    close(fds[0]);
+    int status;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) result.ok = 0;
+    return result;
+}
+
+static void writeJson(FILE *out, const BenchConfig *cfg, LevelResult *results, long lines,
+                      long bytes, int modules) {
+    fprintf(out, "{\n  \"benchmark\": \"compile\",\n  \"entry\": \"%s\",\n", cfg->entry);
+    fprintf(out, "  \"modules\": %d,\n  \"lines\": %ld,\n  \"bytes\": %ld,\n  \"reps\": %d,\n",
+            modules, lines, bytes, cfg->reps);
+    fprintf(out, "  \"results\": [\n");
+    int first = 1;
+    for (int lvl = cfg->minLevel; lvl <= cfg->maxLevel; lvl++) {
+        LevelResult *r = &results[lvl];
+        if (!r->ok) continue;
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            if (p == PHASE_OPTIMIZE && lvl == 0) continue;
+            double lps = r->seconds[p] > 0 ? lines / r->seconds[p] : 0;
+            fprintf(out, "%s    {\"opt\":%d,\"phase\":\"%s\",\"sec\":%.6f,\"linesPerSec\":%.0f,"
+                         "\"peakRssKb\":%ld}",
+                    first ? "" : ",\n", lvl, phaseNames[p], r->seconds[p], lps, r->peakRssKb);
+            first = 0;
+        }
+    }
+    fprintf(out, "\n  ]\n}\n");
+}
+
+static void printTable(LevelResult *results, const BenchConfig *cfg, long lines) {
+    fprintf(stderr, "%-10s", "Phase");
+    for (int lvl = cfg->minLevel; lvl <= cfg->maxLevel; lvl++) fprintf(stderr, " %11s-O%d", "", lvl);
+    fprintf(stderr, "\n");
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        fprintf(stderr, "%-10s", phaseNames[p]);
+        for (int lvl = cfg->minLevel; lvl <= cfg->maxLevel; lvl++) {
+            double sec = results[lvl].seconds[p];
+            if (!results[lvl].ok || sec <= 0) {
+                fprintf(stderr, " %14s", "-");
+            } else {
+                fprintf(stderr, " %10.0f l/s", lines / sec);
+            }
+        }
+        fprintf(stderr, "\n");
+    }
+    fprintf(stderr, "%-10s", "peak RSS");
+    for (int lvl = cfg->minLevel; lvl <= cfg->maxLevel; lvl++) {
+        fprintf(stderr, " %11ld KB", results[lvl].peakRssKb);
+    }
+    fprintf(stderr, "\n");
+}
+
+/**
+ * @brief Flags phases slower than the baseline by more than the threshold.
+ * @return number of regressions, or -1 when the baseline cannot be read
+ */
+static int compareBaseline(const BenchConfig *cfg, LevelResult *results, long lines) {
+    FILE *in = fopen(cfg->baselinePath, "r");
+    if (!in) {
+        fprintf(stderr, "Error: Cannot open baseline '%s'\n", cfg->baselinePath);
+        return -1;
+    }
+
+    int regressions = 0;
+    int matched = 0;
+    char line[512];
+    fprintf(stderr, "\nCompared with %s (threshold %.1f%%):\n", cfg->baselinePath, cfg->threshold);
+    while (fgets(line, sizeof(line), in)) {
+        int lvl;
+        char phase[32];
+        double sec, baseLps;
+        long baseRss;
+        const char *obj = strchr(line, '{');
+        if (!obj || sscanf(obj, "{\"opt\":%d,\"phase\":\"%31[^\"]\",\"sec\":%lf,\"linesPerSec\":%lf,"
+                                "\"peakRssKb\":%ld}",
+                           &lvl, phase, &sec, &baseLps, &baseRss) != 5) {
+            continue;
+        }
+        int p = phaseIndex(phase);
+        if (p < 0 || lvl < cfg->minLevel || lvl > cfg->maxLevel || !results[lvl].ok) continue;
+        matched++;
+
+        double cur = results[lvl].seconds[p];
+        double curLps = cur > 0 ? lines / cur : 0;
+        double delta = baseLps > 0 ? 100.0 * (curLps - baseLps) / baseLps : 0;
+        int slow = delta < -cfg->threshold;
+        regressions += slow;
+        fprintf(stderr, "  -O%d %-10s %12.0f -> %12.0f l/s  %+6.1f%%%s\n", lvl, phase, baseLps,
+                curLps, delta, slow ? "  REGRESSION" : "");
+
+        if (p == PHASE_TOTAL && baseRss > 0) {
+            double rssDelta = 100.0 * (results[lvl].peakRssKb - baseRss) / baseRss;
+            int grown = rssDelta > cfg->threshold;
+            regressions += grown;
+            fprintf(stderr, "  -O%d %-10s %9ld KB -> %9ld KB  %+6.1f%%%s\n", lvl, "peak RSS",
+                    baseRss, results[lvl].peakRssKb, rssDelta, grown ? "  REGRESSION" : "");
+        }
+    }
+    fclose(in);
+
+    if (!matched) {
+        fprintf(stderr, "Error: No comparable results in '%s'\n", cfg->baselinePath);
+        return -1;
+    }
+    return regressions;
+}
+
+static void printUsage(const char *programName) {
+    printf("Usage: %s <entry.orn> [options]\n\n", programName);
+    printf("OPTIONS:\n");
+    printf("    --reps <n>           Repetitions per level, best time is kept (default 3)\n");
+    printf("    -O<a>-<b>            Range of levels to measure (default -O0-3)\n");
+    printf("    --json <file>        Write results as JSON (default stdout)\n");
+    printf("    --compare <file>     Compare against a saved JSON baseline\n");
+    printf("    --threshold <pct>    Allowed slowdown before flagging (default 5)\n");
+}
+
+int main(int argc, char *argv[]) {
+    BenchConfig cfg = {NULL, NULL, NULL, 5.0, 3, 0, 3};
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (strcmp(arg, "--help") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        } else if (strncmp(arg, "-O", 2) == 0) {
+            if (sscanf(arg + 2, "%d-%d", &cfg.minLevel, &cfg.maxLevel) != 2) {
+                cfg.maxLevel = cfg.minLevel;
+            }
+            if (cfg.minLevel < 0 || cfg.maxLevel > 3 || cfg.minLevel > cfg.maxLevel) {
+                fprintf(stderr, "Invalid level range: %s\n", arg);
+                return 1;
+            }
+        } else if (arg[0] != '-') {
+            cfg.entry = arg;
+        } else if (i + 1 >= argc) {
+            fprintf(stderr, "Error: %s requires an argument\n", arg);
+            return 1;
+        } else if (strcmp(arg, "--reps") == 0) {
+            cfg.reps = atoi(argv[++i]);
+        } else if (strcmp(arg, "--json") == 0) {
+            cfg.jsonPath = argv[++i];
+        } else if (strcmp(arg, "--compare") == 0) {
+            cfg.baselinePath = argv[++i];
+        } else if (strcmp(arg, "--threshold") == 0) {
+            cfg.threshold = atof(argv[++i]);
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", arg);
+            return 1;
+        }
+    }
+
+    if (!cfg.entry || cfg.reps < 1) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // Children fork from a small parent so their peak RSS starts clean
+    LevelResult results[4] = {{0}};
+    int failed = 0;
+    for (int lvl = cfg.minLevel; lvl <= cfg.maxLevel; lvl++) {
+        results[lvl] = runLevelIsolated(&cfg, lvl);
+        if (!results[lvl].ok) {
+            fprintf(stderr, "Error: Compilation failed at -O%d\n", lvl);
+            failed = 1;
+        }
+    }
+
+    BuildContext ctx = {0};
+    if (!findModules(&ctx, cfg.entry)) {
+        freeBuildContext(&ctx);
+        return 1;
+    }
+    long lines, bytes;
+    countSource(&ctx, &lines, &bytes);
+    int modules = ctx.moduleCount;
+    freeBuildContext(&ctx);
+    fprintf(stderr, "%s: %d module(s), %ld lines, %ld bytes, best of %d\n\n", cfg.entry, modules,
+            lines, bytes, cfg.reps);
+    printTable(results, &cfg, lines);
+
+    FILE *out = cfg.jsonPath ? fopen(cfg.jsonPath, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "Error: Cannot write '%s'\n", cfg.jsonPath);
+        return 1;
+    }
+    writeJson(out, &cfg, results, lines, bytes, modules);
+    if (out != stdout) fclose(out);
+
+    if (cfg.baselinePath) {
+        int regressions = compareBaseline(&cfg, results, lines);
+        if (regressions != 0) return 1;
+    }
+    return failed;
+}
@@ -0,0 +1,231 @@
+/**
+ * @file genProgram.c
+ * @brief Deterministic generator of large Orn projects for compile-time benchmarks.
+ *
+ * Writes main.orn plus mod_0.orn .. mod_<N-1>.orn into the output directory.
+ * Module i only imports modules with a higher index, so the import graph is
+ * always a DAG. The same seed and sizes always produce byte-identical files.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct GenConfig {
+    const char *outDir;
+    uint64_t seed;
+    int modules;
+    int functions;
+    int exprDepth;
+    int structFields;
+    int arrayLen;
+    int importFanout;
+} GenConfig;
+
+static uint64_t rngState;
+
+static uint64_t nextRandom(void) {
+    // xorshift64*, fixed so output does not depend on the libc rand()
+    rngState ^= rngState >> 12;
+    rngState ^= rngState << 25;
+    rngState ^= rngState >> 27;
+    return rngState * 0x2545F4914F6CDD1Dull;
+}
+
+static int randomBelow(int n) {
+    return n > 0 ? (int)(nextRandom() % (uint64_t)n) : 0;
+}
+
+static void writeLeaf(FILE *out) {
+    switch (randomBelow(3)) {
+        case 0: fprintf(out, "a"); break;
+        case 1: fprintf(out, "b"); break;
+        default: fprintf(out, "%d", randomBelow(100) + 1); break;
+    }
+}
+
+/**
+ * @brief Left-deep expression with occasional balanced subtrees, so depth
+ * grows linearly with the parameter instead of doubling the size.
+ */
+static void writeExpr(FILE *out, int depth) {
+    static const char *ops[] = {"+", "-", "*", "&", "|", "^"};
+    if (depth <= 0) {
+        writeLeaf(out);
+        return;
+    }
+    fprintf(out, "(");
+    writeExpr(out, depth - 1);
+    fprintf(out, " %s ", ops[randomBelow(6)]);
+    if (randomBelow(4) == 0) {
+        writeExpr(out, depth / 2);
+    } else {
+        writeLeaf(out);
+    }
+    fprintf(out, ")");
+}
+
+static void writeStruct(FILE *out, int mod, const GenConfig *cfg) {
+    fprintf(out, "struct Rec%d {\n", mod);
+    for (int f = 0; f < cfg->structFields; f++) {
+        fprintf(out, "    f%d: int\n", f);
+    }
+    fprintf(out, "};\n\n");
+
+    // Fills every field then sums them back
+    fprintf(out, "fn m%d_rec(a: int, b: int) -> int {\n", mod);
+    fprintf(out, "    let r: Rec%d;\n", mod);
+    for (int f = 0; f < cfg->structFields; f++) {
+        fprintf(out, "    r.f%d = a + %d;\n", f, f);
+    }
+    fprintf(out, "    let sum: int = b;\n");
+    for (int f = 0; f < cfg->structFields; f++) {
+        fprintf(out, "    sum = sum + r.f%d;\n", f);
+    }
+    fprintf(out, "    return sum;\n};\n\n");
+}
+
+static void writeArrayFn(FILE *out, int mod, const GenConfig *cfg) {
+    fprintf(out, "fn m%d_arr(a: int, b: int) -> int {\n", mod);
+    fprintf(out, "    let xs: int[%d] = [", cfg->arrayLen);
+    for (int i = 0; i < cfg->arrayLen; i++) {
+        fprintf(out, "%s%d", i ? ", " : "", randomBelow(1000));
+    }
+    fprintf(out, "];\n");
+    fprintf(out, "    let i: int = 0;\n    let sum: int = a;\n");
+    fprintf(out, "    while i < %d {\n        sum = sum + xs[i] * b;\n        i++;\n    };\n",
+            cfg->arrayLen);
+    fprintf(out, "    return sum;\n};\n\n");
+}
+
+static void writeFunction(FILE *out, int mod, int fn, const int *imports, int importCount,
+                          const GenConfig *cfg) {
+    fprintf(out, "export fn m%d_f%d(a: int, b: int) -> int {\n", mod, fn);
+    fprintf(out, "    let t: int = ");
+    writeExpr(out, cfg->exprDepth);
+    fprintf(out, ";\n");
+
+    // Call an earlier function of this module or an export of an import
+    if (fn > 0 && randomBelow(2) == 0) {
+        fprintf(out, "    t = t + m%d_f%d(b, t);\n", mod, randomBelow(fn));
+    } else if (importCount > 0) {
+        int dep = imports[randomBelow(importCount)];
+        fprintf(out, "    t = t + m%d_f%d(t, a);\n", dep, randomBelow(cfg->functions));
+    }
+
+    fprintf(out, "    if t > %d {\n        t = t - a;\n    } else {\n        t = t + b;\n    };\n",
+            randomBelow(500));
+    fprintf(out, "    return t;\n};\n\n");
+}
+
+static int writeModule(int mod, const GenConfig *cfg) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/mod_%d.orn", cfg->outDir, mod);
+    FILE *out = fopen(path, "w");
+    if (!out) {
+        fprintf(stderr, "Error: Cannot write '%s'\n", path);
+        return 0;
+    }
+
+    int *imports = malloc((cfg->importFanout + 1) * sizeof(int));
+    int importCount = 0;
+    for (int k = 0; k < cfg->importFanout && imports; k++) {
+        int remaining = cfg->modules - mod - 1;
+        if (remaining <= 0) break;
+        int dep = mod + 1 + randomBelow(remaining);
+        int dup = 0;
+        for (int j = 0; j < importCount; j++) dup |= imports[j] == dep;
+        if (!dup) imports[importCount++] = dep;
+    }
+
+    fprintf(out, "// generated: module %d of %d\n", mod, cfg->modules);
+    for (int j = 0; j < importCount; j++) fprintf(out, "import \"mod_%d\";\n", imports[j]);
+    fprintf(out, "\n");
+
+    if (cfg->structFields > 0) writeStruct(out, mod, cfg);
+    if (cfg->arrayLen > 0) writeArrayFn(out, mod, cfg);
+    for (int fn = 0; fn < cfg->functions; fn++) {
+        writeFunction(out, mod, fn, imports, importCount, cfg);
+    }
+
+    free(imports);
+    fclose(out);
+    return 1;
+}
+
+static int writeMain(const GenConfig *cfg) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/main.orn", cfg->outDir);
+    FILE *out = fopen(path, "w");
+    if (!out) {
+        fprintf(stderr, "Error: Cannot write '%s'\n", path);
+        return 0;
+    }
+
+    fprintf(out, "// generated entry point\n");
+    for (int m = 0; m < cfg->modules; m++) fprintf(out, "import \"mod_%d\";\n", m);
+    fprintf(out, "\nlet total: int = 0;\n");
+    for (int m = 0; m < cfg->modules; m++) {
+        fprintf(out, "total = total + m%d_f%d(%d, %d);\n", m, randomBelow(cfg->functions),
+                randomBelow(50), randomBelow(50));
+    }
+    fprintf(out, "print(total);\nprint(\"\\n\");\n");
+    fclose(out);
+    return 1;
+}
+
+static void printUsage(const char *programName) {
+    printf("Usage: %s -o <dir> [options]\n\n", programName);
+    printf("OPTIONS:\n");
+    printf("    -o <dir>            Output directory (must exist)\n");
+    printf("    --seed <n>          Random seed (default 1)\n");
+    printf("    --modules <n>       Number of modules besides main (default 16)\n");
+    printf("    --functions <n>     Exported functions per module (default 200)\n");
+    printf("    --expr-depth <n>    Depth of each function's expression (default 24)\n");
+    printf("    --struct-fields <n> Fields of each module's struct (default 64)\n");
+    printf("    --array-len <n>     Length of each module's array literal (default 512)\n");
+    printf("    --imports <n>       Max imports per module (default 3)\n");
+}
+
+int main(int argc, char *argv[]) {
+    GenConfig cfg = {NULL, 1, 16, 200, 24, 64, 512, 3};
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (strcmp(arg, "--help") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            fprintf(stderr, "Error: %s requires an argument\n", arg);
+            return 1;
+        }
+        const char *val = argv[++i];
+        if (strcmp(arg, "-o") == 0) cfg.outDir = val;
+        else if (strcmp(arg, "--seed") == 0) cfg.seed = strtoull(val, NULL, 10);
+        else if (strcmp(arg, "--modules") == 0) cfg.modules = atoi(val);
+        else if (strcmp(arg, "--functions") == 0) cfg.functions = atoi(val);
+        else if (strcmp(arg, "--expr-depth") == 0) cfg.exprDepth = atoi(val);
+        else if (strcmp(arg, "--struct-fields") == 0) cfg.structFields = atoi(val);
+        else if (strcmp(arg, "--array-len") == 0) cfg.arrayLen = atoi(val);
+        else if (strcmp(arg, "--imports") == 0) cfg.importFanout = atoi(val);
+        else {
+            fprintf(stderr, "Unknown option: %s\n", arg);
+            return 1;
+        }
+    }
+
+    if (!cfg.outDir || cfg.modules < 1 || cfg.functions < 1) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    rngState = cfg.seed ? cfg.seed : 1;
+    for (int m = 0; m < cfg.modules; m++) {
+        if (!writeModule(m, &cfg)) return 1;
+    }
+    if (!writeMain(&cfg)) return 1;
+
+    printf("Generated %d module(s) in %s\n", cfg.modules + 1, cfg.outDir);
+    return 0;
+}
@@ -0,0 +1,465 @@
+/**
+ * @file runBench.c
+ * @brief Runtime benchmark harness for the programs in bench/runtime.
+ *
+ * Builds every program with orn at each optimization level and its C
+ * reference with the system compiler, runs each binary several times with
+ * a fixed stdin, and reports the median wall time, instructions retired
+ * (when perf counters are available) and binary size. Output of every
+ * build is checked against the C reference, so a miscompile shows up as
+ * WRONG instead of as a suspiciously fast time.
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "../src/modules/perfCounters.h"
+
+#define MAX_REPS 64
+#define VARIANT_REF 4
+#define VARIANT_COUNT 5
+
+typedef struct RuntimeBench {
+    const char *name;
+    const char *description;
+    int size;
+} RuntimeBench;
+
+// size is what the program reads first from stdin
+static const RuntimeBench benches[] = {
+    {"fib", "recursive calls", 32},
+    {"loops", "nested array loops", 400},
+    {"structs", "struct field updates", 2000000},
+    {"math", "int and double math", 100000},
+    {"print", "print-heavy output", 200000},
+    {"parse", "stdin integer parsing", 200000},
+};
+
+#define BENCH_COUNT ((int)(sizeof(benches) / sizeof(benches[0])))
+
+typedef enum {
+    RUN_OK,
+    RUN_SKIPPED,
+    RUN_BUILD_FAILED,
+    RUN_CRASHED,
+    RUN_TIMEOUT,
+    RUN_WRONG,
+} RunStatus;
+
+static const char *statusNames[] = {"ok", "skipped", "BUILD", "CRASH", "TIMEOUT", "WRONG"};
+
+typedef struct RunResult {
+    RunStatus status;
+    double medianSec;
+    uint64_t instructions;
+    long binaryBytes;
+} RunResult;
+
+typedef struct RunConfig {
+    const char *orn;
+    const char *sourceDir;
+    const char *workDir;
+    const char *cc;
+    const char *jsonPath;
+    double scale;
+    int reps;
+    int timeoutSec;
+    int minLevel;
+    int maxLevel;
+    int withRef;
+} RunConfig;
+
+static uint64_t nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static const char *variantName(int variant) {
+    static const char *names[VARIANT_COUNT] = {"-O0", "-O1", "-O2", "-O3", "C -O2"};
+    return names[variant];
+}
+
+/**
+ * @brief Runs argv with stdin/stdout redirected to the given files.
+ * @return wait status, or -1 when the child could not be started
+ */
+static int runCommand(char *const argv[], const char *workDir, const char *inPath,
+                      const char *outPath, int timeoutSec) {
+    fflush(NULL);
+    pid_t pid = fork();
+    if (pid < 0) return -1;
+    if (pid == 0) {
+        // Open before chdir, the paths may be relative to our cwd
+        int in = open(inPath ? inPath : "/dev/null", O_RDONLY);
+        int out = open(outPath ? outPath : "/dev/null", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (in < 0 || out < 0) _exit(127);
+        if (workDir && chdir(workDir) != 0) _exit(127);
+        dup2(in, STDIN_FILENO);
+        dup2(out, STDOUT_FILENO);
+        dup2(out, STDERR_FILENO);
+        close(in);
+        close(out);
+        // SIGALRM survives exec and kills a runaway binary
+        if (timeoutSec > 0) alarm((unsigned)timeoutSec);
+        execvp(argv[0], argv);
+        _exit(127);
+    }
+
+    int status;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) return -1;
+    }
+    return status;
+}
+
+static int commandSucceeded(int status) {
+    return status != -1 && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static int sameFile(const char *a, const char *b) {
+    FILE *fa = fopen(a, "rb");
+    FILE *fb = fopen(b, "rb");
+    int same = fa && fb;
+    while (same) {
+        int ca = fgetc(fa);
+        int cb = fgetc(fb);
+        if (ca != cb) same = 0;
+        if (ca == EOF || cb == EOF) break;
+    }
+    if (fa) fclose(fa);
+    if (fb) fclose(fb);
+    return same;
+}
+
+static int copyFile(const char *from, const char *to) {
+    FILE *in = fopen(from, "rb");
+    if (!in) return 0;
+    FILE *out = fopen(to, "wb");
+    if (!out) {
+        fclose(in);
+        return 0;
+    }
+    char buf[8192];
+    size_t n;
+    int ok = 1;
+    while ((n = fread(buf, 1, sizeof(buf), in)) > 0) {
+        ok &= fwrite(buf, 1, n, out) == n;
+    }
+    fclose(in);
+    ok &= fclose(out) == 0;
+    return ok;
+}
+
+/**
+ * @brief Writes the stdin of one benchmark. parse gets a deterministic list
+ * of integers; every other program just reads its size.
+ */
+static int writeInput(const RuntimeBench *bench, int size, const char *path) {
+    FILE *out = fopen(path, "w");
+    if (!out) return 0;
+    fprintf(out, "%d\n", size);
+    if (strcmp(bench->name, "parse") == 0) {
+        uint64_t state = 0x9E3779B97F4A7C15ull;
+        for (int i = 0; i < size; i++) {
+            state ^= state >> 12;
+            state ^= state << 25;
+            state ^= state >> 27;
+            long v = (long)((state * 0x2545F4914F6CDD1Dull) % 2000001) - 1000000;
+            fprintf(out, "%ld%c", v, i % 10 == 9 ? '\n' : ' ');
+        }
+        fprintf(out, "\n");
+    }
+    return fclose(out) == 0;
+}
+
+static int compareDoubles(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static int compareCounts(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Runs one built binary reps times; the first run's output is kept
+ * for the correctness check against the expected output.
+ */
+static RunResult measureBinary(const RunConfig *cfg, PerfCounters *perf, const char *binary,
+                               const char *inPath, const char *outPath, const char *expectPath) {
+    RunResult result = {RUN_OK, 0, 0, 0};
+    double seconds[MAX_REPS];
+    uint64_t instrs[MAX_REPS];
+
+    struct stat st;
+    if (stat(binary, &st) == 0) result.binaryBytes = (long)st.st_size;
+
+    char *argv[] = {(char *)binary, NULL};
+    for (int rep = 0; rep < cfg->reps; rep++) {
+        uint64_t before[PERF_COUNTER_COUNT], after[PERF_COUNTER_COUNT];
+        readPerfCounters(perf, before);
+        uint64_t start = nowNs();
+        int status = runCommand(argv, NULL, inPath, rep == 0 ? outPath : NULL, cfg->timeoutSec);
+        uint64_t end = nowNs();
+        readPerfCounters(perf, after);
+
+        if (status != -1 && WIFSIGNALED(status)) {
+            result.status = WTERMSIG(status) == SIGALRM ? RUN_TIMEOUT : RUN_CRASHED;
+            return result;
+        }
+        if (!commandSucceeded(status)) {
+            result.status = RUN_CRASHED;
+            return result;
+        }
+        seconds[rep] = (end - start) / 1e9;
+        instrs[rep] = after[PERF_INSTRUCTIONS] - before[PERF_INSTRUCTIONS];
+
+        if (rep == 0 && expectPath && !sameFile(outPath, expectPath)) {
+            result.status = RUN_WRONG;
+            return result;
+        }
+    }
+
+    qsort(seconds, cfg->reps, sizeof(double), compareDoubles);
+    qsort(instrs, cfg->reps, sizeof(uint64_t), compareCounts);
+    result.medianSec = seconds[cfg->reps / 2];
+    result.instructions = instrs[cfg->reps / 2];
+    return result;
+}
+
+static int buildVariant(const RunConfig *cfg, const RuntimeBench *bench, int variant,
+                        const char *binary) {
+    char source[1024], log[1024], level[8];
+    snprintf(log, sizeof(log), "%s/%s_%s.log", cfg->workDir, bench->name,
+             variant == VARIANT_REF ? "c" : variantName(variant) + 1);
+
+    if (variant == VARIANT_REF) {
+        snprintf(source, sizeof(source), "%s/%s.c", cfg->sourceDir, bench->name);
+        char *argv[] = {(char *)cfg->cc, "-O2", "-o", (char *)binary, source, NULL};
+        return commandSucceeded(runCommand(argv, NULL, NULL, log, 0));
+    }
+
+    // Build from inside the work dir, so the binary and any orn.prof land there
+    const char *slash = strrchr(binary, '/');
+    snprintf(source, sizeof(source), "%s.orn", bench->name);
+    snprintf(level, sizeof(level), "-O%d", variant);
+    char *argv[] = {(char *)cfg->orn, level, "-o", (char *)(slash ? slash + 1 : binary), source, NULL};
+    return commandSucceeded(runCommand(argv, cfg->workDir, NULL, log, 0));
+}
+
+static void runBenchmark(const RunConfig *cfg, PerfCounters *perf, const RuntimeBench *bench,
+                         RunResult results[VARIANT_COUNT]) {
+    char inPath[1024], expectPath[1024];
+    int size = (int)(bench->size * cfg->scale);
+    if (size < 1) size = 1;
+
+    snprintf(inPath, sizeof(inPath), "%s/%s.in", cfg->workDir, bench->name);
+    for (int v = 0; v < VARIANT_COUNT; v++) results[v].status = RUN_SKIPPED;
+    if (!writeInput(bench, size, inPath)) {
+        fprintf(stderr, "Error: Cannot write '%s'\n", inPath);
+        return;
+    }
+
+    char from[1024], to[1024];
+    snprintf(from, sizeof(from), "%s/%s.orn", cfg->sourceDir, bench->name);
+    snprintf(to, sizeof(to), "%s/%s.orn", cfg->workDir, bench->name);
+    if (!copyFile(from, to)) {
+        fprintf(stderr, "Error: Cannot copy '%s'\n", from);
+        return;
+    }
+
+    // The C reference defines the expected output, -O0 stands in without it
+    int order[VARIANT_COUNT];
+    int count = 0;
+    if (cfg->withRef) order[count++] = VARIANT_REF;
+    for (int lvl = cfg->minLevel; lvl <= cfg->maxLevel; lvl++) order[count++] = lvl;
+
+    const char *expect = NULL;
+    char outPaths[VARIANT_COUNT][1024];
+    for (int i = 0; i < count; i++) {
+        int v = order[i];
+        char binary[1024];
+        const char *tag = v == VARIANT_REF ? "c" : variantName(v) + 1;
+        snprintf(binary, sizeof(binary), "%s/%s_%s", cfg->workDir, bench->name, tag);
+        snprintf(outPaths[v], sizeof(outPaths[v]), "%s/%s_%s.out", cfg->workDir, bench->name, tag);
+
+        if (!buildVariant(cfg, bench, v, binary)) {
+            results[v].status = RUN_BUILD_FAILED;
+            continue;
+        }
+        results[v] = measureBinary(cfg, perf, binary, inPath, outPaths[v], expect);
+        if (!expect && results[v].status == RUN_OK) {
+            snprintf(expectPath, sizeof(expectPath), "%s", outPaths[v]);
+            expect = expectPath;
+        }
+    }
+}
+
+static void printTable(RunResult results[][VARIANT_COUNT], int haveInstrs) {
+    fprintf(stderr, "%-9s %-7s %-8s %11s %14s %10s %8s\n", "Program", "Build", "Status",
+            "Median ms", "Instructions", "Size", "vs C");
+    for (int b = 0; b < BENCH_COUNT; b++) {
+        RunResult *ref = &results[b][VARIANT_REF];
+        for (int v = 0; v < VARIANT_COUNT; v++) {
+            RunResult *r = &results[b][v];
+            if (r->status == RUN_SKIPPED) continue;
+            fprintf(stderr, "%-9s %-7s %-8s", benches[b].name, variantName(v), statusNames[r->status]);
+            if (r->status != RUN_OK) {
+                fprintf(stderr, " %11s %14s %10s %8s\n", "-", "-", "-", "-");
+                continue;
+            }
+            fprintf(stderr, " %11.2f", r->medianSec * 1e3);
+            if (haveInstrs) {
+                fprintf(stderr, " %14llu", (unsigned long long)r->instructions);
+            } else {
+                fprintf(stderr, " %14s", "-");
+            }
+            fprintf(stderr, " %10ld", r->binaryBytes);
+            if (v != VARIANT_REF && ref->status == RUN_OK && ref->medianSec > 0) {
+                fprintf(stderr, " %7.2fx\n", r->medianSec / ref->medianSec);
+            } else {
+                fprintf(stderr, " %8s\n", "-");
+            }
+        }
+    }
+}
+
+static void writeJson(FILE *out, const RunConfig *cfg, RunResult results[][VARIANT_COUNT],
+                      int haveInstrs) {
+    fprintf(out, "{\n  \"benchmark\": \"runtime\",\n  \"reps\": %d,\n  \"scale\": %g,\n", cfg->reps,
+            cfg->scale);
+    fprintf(out, "  \"results\": [\n");
+    int first = 1;
+    for (int b = 0; b < BENCH_COUNT; b++) {
+        for (int v = 0; v < VARIANT_COUNT; v++) {
+            RunResult *r = &results[b][v];
+            if (r->status == RUN_SKIPPED) continue;
+            fprintf(out, "%s    {\"program\":\"%s\",\"build\":\"%s\",\"status\":\"%s\","
+                         "\"medianSec\":%.6f,\"instructions\":",
+                    first ? "" : ",\n", benches[b].name, variantName(v), statusNames[r->status],
+                    r->medianSec);
+            if (haveInstrs && r->status == RUN_OK) {
+                fprintf(out, "%llu", (unsigned long long)r->instructions);
+            } else {
+                fprintf(out, "null");
+            }
+            fprintf(out, ",\"binaryBytes\":%ld}", r->binaryBytes);
+            first = 0;
+        }
+    }
+    fprintf(out, "\n  ]\n}\n");
+}
+
+static void printUsage(const char *programName) {
+    printf("Usage: %s --orn <compiler> --src <dir> --work <dir> [options]\n\n", programName);
+    printf("OPTIONS:\n");
+    printf("    --orn <file>         orn compiler to benchmark\n");
+    printf("    --src <dir>          Directory with <name>.orn and <name>.c programs\n");
+    printf("    --work <dir>         Scratch directory for builds and output\n");
+    printf("    --reps <n>           Runs per binary, the median is reported (default 5)\n");
+    printf("    -O<a>-<b>            Range of levels to build (default -O0-3)\n");
+    printf("    --scale <f>          Multiply every program's input size (default 1)\n");
+    printf("    --timeout <sec>      Kill a run after this many seconds (default 10)\n");
+    printf("    --cc <compiler>      C compiler for the references (default cc)\n");
+    printf("    --no-ref             Skip the C references, check against -O0 instead\n");
+    printf("    --json <file>        Write results as JSON (default stdout)\n");
+}
+
+int main(int argc, char *argv[]) {
+    RunConfig cfg = {NULL, NULL, NULL, "cc", NULL, 1.0, 5, 10, 0, 3, 1};
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (strcmp(arg, "--help") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        } else if (strcmp(arg, "--no-ref") == 0) {
+            cfg.withRef = 0;
+        } else if (strncmp(arg, "-O", 2) == 0) {
+            if (sscanf(arg + 2, "%d-%d", &cfg.minLevel, &cfg.maxLevel) != 2) {
+                cfg.maxLevel = cfg.minLevel;
+            }
+            if (cfg.minLevel < 0 || cfg.maxLevel > 3 || cfg.minLevel > cfg.maxLevel) {
+                fprintf(stderr, "Invalid level range: %s\n", arg);
+                return 1;
+            }
+        } else if (i + 1 >= argc) {
+            fprintf(stderr, "Error: %s requires an argument\n", arg);
+            return 1;
+        } else if (strcmp(arg, "--orn") == 0) {
+            cfg.orn = argv[++i];
+        } else if (strcmp(arg, "--src") == 0) {
+            cfg.sourceDir = argv[++i];
+        } else if (strcmp(arg, "--work") == 0) {
+            cfg.workDir = argv[++i];
+        } else if (strcmp(arg, "--reps") == 0) {
+            cfg.reps = atoi(argv[++i]);
+        } else if (strcmp(arg, "--scale") == 0) {
+            cfg.scale = atof(argv[++i]);
+        } else if (strcmp(arg, "--timeout") == 0) {
+            cfg.timeoutSec = atoi(argv[++i]);
+        } else if (strcmp(arg, "--cc") == 0) {
+            cfg.cc = argv[++i];
+        } else if (strcmp(arg, "--json") == 0) {
+            cfg.jsonPath = argv[++i];
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", arg);
+            return 1;
+        }
+    }
+
+    if (!cfg.orn || !cfg.sourceDir || !cfg.workDir || cfg.reps < 1 || cfg.reps > MAX_REPS ||
+        cfg.scale <= 0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // orn runs from inside the work dir, so a relative path would break
+    char ornPath[4096];
+    if (!realpath(cfg.orn, ornPath)) {
+        fprintf(stderr, "Error: Cannot find compiler '%s'\n", cfg.orn);
+        return 1;
+    }
+    cfg.orn = ornPath;
+
+    // Counters inherit into the benchmarked children; deltas are taken per run
+    PerfCounters *perf = openPerfCounters();
+    int haveInstrs = perfCounterAvailable(perf, PERF_INSTRUCTIONS);
+
+    RunResult results[BENCH_COUNT][VARIANT_COUNT];
+    int failed = 0;
+    for (int b = 0; b < BENCH_COUNT; b++) {
+        fprintf(stderr, "Running %s (%s)...\n", benches[b].name, benches[b].description);
+        runBenchmark(&cfg, perf, &benches[b], results[b]);
+        for (int v = 0; v < VARIANT_COUNT; v++) {
+            failed |= results[b][v].status != RUN_OK && results[b][v].status != RUN_SKIPPED;
+        }
+    }
+    closePerfCounters(perf);
+
+    fprintf(stderr, "\nMedian of %d run(s), input scale %g\n\n", cfg.reps, cfg.scale);
+    printTable(results, haveInstrs);
+
+    FILE *out = cfg.jsonPath ? fopen(cfg.jsonPath, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "Error: Cannot write '%s'\n", cfg.jsonPath);
+        return 1;
+    }
+    writeJson(out, &cfg, results, haveInstrs);
+    if (out != stdout) fclose(out);
+
+    return failed;
+}
@@ -0,0 +1,14 @@
+/* Reference for fib.orn */
+#include <stdio.h>
+
+static int fib(int n) {
+    if (n < 2) return n;
+    return fib(n - 1) + fib(n - 2);
+}
+
+int main(void) {
+    int n = 0;
+    if (scanf("%d", &n) != 1) n = 0;
+    printf("%d\n", fib(n));
+    return 0;
+}
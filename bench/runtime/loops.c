@@ -0,0 +1,34 @@
+/* Reference for loops.orn */
+#include <stdio.h>
+
+static int matmul(int rounds) {
+    int a[1600], b[1600], c[1600];
+
+    for (int i = 0; i < 1600; i++) {
+        a[i] = i % 17 - 8;
+        b[i] = i % 13 - 6;
+    }
+
+    int checksum = 0;
+    for (int r = 0; r < rounds; r++) {
+        for (int row = 0; row < 40; row++) {
+            for (int col = 0; col < 40; col++) {
+                int sum = 0;
+                for (int k = 0; k < 40; k++) sum += a[row * 40 + k] * b[k * 40 + col];
+                c[row * 40 + col] = sum;
+            }
+        }
+        for (int j = 0; j < 1600; j++) {
+            checksum = (checksum * 31 + c[j]) % 1000003;
+            a[j] = c[j] % 19 - 9;
+        }
+    }
+    return checksum;
+}
+
+int main(void) {
+    int rounds = 0;
+    if (scanf("%d", &rounds) != 1) rounds = 0;
+    printf("%d\n", matmul(rounds));
+    return 0;
+}
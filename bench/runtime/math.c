@@ -0,0 +1,51 @@
+/* Reference for math.orn */
+#include <stdio.h>
+
+static int collatz(int limit) {
+    int longest = 0;
+    for (int n = 1; n < limit; n++) {
+        int v = n, steps = 0;
+        while (v != 1) {
+            v = v % 2 == 0 ? v / 2 : 3 * v + 1;
+            steps++;
+        }
+        if (steps > longest) longest = steps;
+    }
+    return longest;
+}
+
+static int gcdSum(int limit) {
+    int total = 0;
+    for (int i = 1; i < limit; i++) {
+        int a = i % 65521 * 7919 % 65521;
+        int b = i;
+        while (b != 0) {
+            int t = a % b;
+            a = b;
+            b = t;
+        }
+        total = (total + a) % 1000000007;
+    }
+    return total;
+}
+
+static double newtonSqrt(double x) {
+    double guess = x / 2.0;
+    for (int k = 0; k < 20; k++) guess = (guess + x / guess) / 2.0;
+    return guess;
+}
+
+static double floatMath(int limit) {
+    double sum = 0.0;
+    for (int i = 1; i <= limit; i++) sum = sum + 1.0 / i + newtonSqrt(i * 1.0) / limit;
+    return sum;
+}
+
+int main(void) {
+    int scale = 0;
+    if (scanf("%d", &scale) != 1) scale = 0;
+    printf("%d\n", collatz(scale));
+    printf("%d\n", gcdSum(scale * 4));
+    printf("%f\n", floatMath(scale));
+    return 0;
+}
@@ -0,0 +1,18 @@
+/* Reference for parse.orn */
+#include <stdio.h>
+
+int main(void) {
+    int count = 0;
+    if (scanf("%d", &count) != 1) count = 0;
+    int sum = 0, minimum = 2147483647, maximum = -2147483647, hash = 0;
+    for (int i = 0; i < count; i++) {
+        int v = 0;
+        if (scanf("%d", &v) != 1) v = 0;
+        sum = (sum + v) % 1000000007;
+        if (v < minimum) minimum = v;
+        if (v > maximum) maximum = v;
+        hash = (hash * 31 + v) % 1000003;
+    }
+    printf("%d %d %d %d\n", sum, minimum, maximum, hash);
+    return 0;
+}
@@ -0,0 +1,11 @@
+/* Reference for print.orn */
+#include <stdio.h>
+
+int main(void) {
+    int lines = 0;
+    if (scanf("%d", &lines) != 1) lines = 0;
+    for (int i = 0; i < lines; i++) {
+        printf("%d %d %s\n", i, i % 9973 * (i % 9973) % 9973, i % 7 == 0 ? "true" : "false");
+    }
+    return 0;
+}
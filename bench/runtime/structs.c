@@ -0,0 +1,42 @@
+/* Reference for structs.orn */
+#include <stdio.h>
+
+struct Body {
+    int x, y, vx, vy;
+};
+
+static void move(struct Body *p, int *hits) {
+    p->x += p->vx;
+    p->y += p->vy;
+    if (p->x < 0 || p->x > 1000) { p->vx = -p->vx; (*hits)++; }
+    if (p->y < 0 || p->y > 1000) { p->vy = -p->vy; (*hits)++; }
+}
+
+static int simulate(int steps) {
+    struct Body a = {10, 20, 3, -2};
+    struct Body b = {500, 300, -4, 5};
+    struct Body c = {900, 50, 7, 1};
+
+    int hits = 0;
+    for (int s = 0; s < steps; s++) {
+        move(&a, &hits);
+        move(&b, &hits);
+        move(&c, &hits);
+
+        int dx = a.x - b.x;
+        int dy = a.y - b.y;
+        if (dx * dx + dy * dy < 400) {
+            int t = a.vx;
+            a.vx = b.vx;
+            b.vx = t;
+        }
+    }
+    return hits % 1000 * 1000000 + a.x * 1000 + c.y;
+}
+
+int main(void) {
+    int steps = 0;
+    if (scanf("%d", &steps) != 1) steps = 0;
+    printf("%d\n", simulate(steps));
+    return 0;
+}
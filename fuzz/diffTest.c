@@ -0,0 +1,366 @@
+/**
+ * @file diffTest.c
+ * @brief Differential optimizer testing.
+ *
+ * Generates random well-typed programs, builds each one at -O0 as the
+ * reference and again with every variant's flags, runs the binaries and
+ * compares their output. A variant that fails to build, crashes, hangs or
+ * prints something different is reduced line by line (whole blocks first)
+ * to the smallest program that still shows the same failure, and saved
+ * next to the other work files.
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "randomProgram.h"
+
+#define MAX_VARIANTS 32
+#define MAX_FLAGS 32
+
+typedef enum {
+    CASE_OK,
+    CASE_BUILD_FAILED,
+    CASE_CRASHED,
+    CASE_TIMEOUT,
+    CASE_WRONG,
+} CaseStatus;
+
+static const char *statusNames[] = {"ok", "BUILD", "CRASH", "TIMEOUT", "WRONG"};
+
+typedef struct DiffConfig {
+    const char *orn;
+    const char *workDir;
+    const char *variants[MAX_VARIANTS];
+    int variantCount;
+    unsigned long long seed;
+    int count;
+    int timeoutSec;
+    int reduce;
+    RandomProgramConfig gen;
+} DiffConfig;
+
+/**
+ * @brief Runs argv with stdin from /dev/null and stdout/stderr to outPath.
+ * @return wait status, or -1 when the child could not be started
+ */
+static int runCommand(char *const argv[], const char *workDir, const char *outPath, int timeoutSec) {
+    fflush(NULL);
+    pid_t pid = fork();
+    if (pid < 0) return -1;
+    if (pid == 0) {
+        // Open before chdir, the paths may be relative to our cwd
+        int in = open("/dev/null", O_RDONLY);
+        int out = open(outPath ? outPath : "/dev/null", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (in < 0 || out < 0) _exit(127);
+        if (workDir && chdir(workDir) != 0) _exit(127);
+        dup2(in, STDIN_FILENO);
+        dup2(out, STDOUT_FILENO);
+        dup2(out, STDERR_FILENO);
+        close(in);
+        close(out);
+        // SIGALRM survives exec and kills a runaway binary
+        if (timeoutSec > 0) alarm((unsigned)timeoutSec);
+        execvp(argv[0], argv);
+        _exit(127);
+    }
+
+    int status;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) return -1;
+    }
+    return status;
+}
+
+static int commandSucceeded(int status) {
+    return status != -1 && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static int sameFile(const char *a, const char *b) {
+    FILE *fa = fopen(a, "rb");
+    FILE *fb = fopen(b, "rb");
+    int same = fa && fb;
+    while (same) {
+        int ca = fgetc(fa);
+        int cb = fgetc(fb);
+        if (ca != cb) same = 0;
+        if (ca == EOF || cb == EOF) break;
+    }
+    if (fa) fclose(fa);
+    if (fb) fclose(fb);
+    return same;
+}
+
+/**
+ * @brief Builds workDir/<name>.orn with the given flags and runs it,
+ * leaving its output in workDir/<name>.out.
+ */
+static CaseStatus buildAndRun(const DiffConfig *cfg, const char *source, const char *name,
+                              const char *flags) {
+    char flagCopy[512], binary[1024], outPath[1024], logPath[1024];
+    char *argv[MAX_FLAGS + 5];
+    int argc = 0;
+
+    argv[argc++] = (char *)cfg->orn;
+    snprintf(flagCopy, sizeof(flagCopy), "%s", flags ? flags : "");
+    for (char *tok = strtok(flagCopy, " "); tok && argc < MAX_FLAGS; tok = strtok(NULL, " ")) {
+        argv[argc++] = tok;
+    }
+    argv[argc++] = "-o";
+    argv[argc++] = (char *)name;
+    argv[argc++] = (char *)source;
+    argv[argc] = NULL;
+
+    // Build from inside the work dir, so every artifact stays there
+    snprintf(logPath, sizeof(logPath), "%s/%s.log", cfg->workDir, name);
+    if (!commandSucceeded(runCommand(argv, cfg->workDir, logPath, cfg->timeoutSec))) {
+        return CASE_BUILD_FAILED;
+    }
+
+    snprintf(binary, sizeof(binary), "%s/%s", cfg->workDir, name);
+    snprintf(outPath, sizeof(outPath), "%s/%s.out", cfg->workDir, name);
+    char *run[] = {binary, NULL};
+    int status = runCommand(run, NULL, outPath, cfg->timeoutSec);
+    if (status != -1 && WIFSIGNALED(status) && WTERMSIG(status) == SIGALRM) return CASE_TIMEOUT;
+    return commandSucceeded(status) ? CASE_OK : CASE_CRASHED;
+}
+
+/**
+ * @brief Builds the kept lines at -O0 and with the variant's flags.
+ * @return variant status, or the negated reference status when the -O0
+ * build itself fails
+ */
+static int checkCase(const DiffConfig *cfg, const RandomProgram *program, const char *keep,
+                     const char *flags) {
+    char source[1024], refOut[1024], varOut[1024];
+    snprintf(source, sizeof(source), "%s/case.orn", cfg->workDir);
+    if (writeRandomProgram(program, keep, source) < 0) return -CASE_BUILD_FAILED;
+
+    CaseStatus refStatus = buildAndRun(cfg, "case.orn", "case_ref", "-O0");
+    if (refStatus != CASE_OK) return -(int)refStatus;
+    CaseStatus status = buildAndRun(cfg, "case.orn", "case_var", flags);
+    if (status != CASE_OK) return status;
+
+    snprintf(refOut, sizeof(refOut), "%s/case_ref.out", cfg->workDir);
+    snprintf(varOut, sizeof(varOut), "%s/case_var.out", cfg->workDir);
+    return sameFile(refOut, varOut) ? CASE_OK : CASE_WRONG;
+}
+
+/**
+ * @brief Tries to drop the given lines; keeps the removal when the
+ * failure is still reproduced.
+ */
+static int tryRemove(const DiffConfig *cfg, const RandomProgram *program, char *keep,
+                     const int *lines, int count, const char *flags, int expected) {
+    int removed = 0;
+    for (int i = 0; i < count; i++) {
+        if (lines[i] >= 0 && keep[lines[i]]) {
+            keep[lines[i]] = 0;
+            removed++;
+        }
+    }
+    if (!removed) return 0;
+    if (checkCase(cfg, program, keep, flags) == expected) return 1;
+    for (int i = 0; i < count; i++) {
+        if (lines[i] >= 0) keep[lines[i]] = 1;
+    }
+    return 0;
+}
+
+static int tryRemoveRange(const DiffConfig *cfg, const RandomProgram *program, char *keep,
+                          int from, int to, const char *flags, int expected) {
+    int count = to - from + 1;
+    int *lines = malloc(count * sizeof(int));
+    if (!lines) return 0;
+    for (int i = 0; i < count; i++) lines[i] = keep[from + i] ? from + i : -1;
+    int removed = tryRemove(cfg, program, keep, lines, count, flags, expected);
+    free(lines);
+    return removed;
+}
+
+/**
+ * @brief Greedy reduction: whole blocks, else branches, single lines and
+ * block wrappers are dropped back to front until nothing more can go.
+ */
+static void reduceCase(const DiffConfig *cfg, const RandomProgram *program, char *keep,
+                       const char *flags, int expected) {
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int i = program->count - 1; i >= 0; i--) {
+            if (!keep[i]) continue;
+            const ProgramLine *line = &program->lines[i];
+
+            if (line->kind == LINE_PLAIN) {
+                changed |= tryRemove(cfg, program, keep, &i, 1, flags, expected);
+            } else if (line->kind == LINE_OPEN && line->close >= 0) {
+                if (tryRemoveRange(cfg, program, keep, i, line->close, flags, expected)) {
+                    changed = 1;
+                    continue;
+                }
+                if (line->middle >= 0 &&
+                    tryRemoveRange(cfg, program, keep, line->middle, line->close - 1, flags, expected)) {
+                    changed = 1;
+                }
+                int wrapper[] = {i, line->middle, line->close};
+                changed |= tryRemove(cfg, program, keep, wrapper, 3, flags, expected);
+            }
+        }
+    }
+}
+
+static int runSeed(const DiffConfig *cfg, unsigned long long seed) {
+    RandomProgram *program = generateRandomProgram(seed, &cfg->gen);
+    if (!program) {
+        fprintf(stderr, "Error: Out of memory generating seed %llu\n", seed);
+        return 1;
+    }
+
+    char path[1024];
+    int failed = 0;
+    for (int v = 0; v < cfg->variantCount; v++) {
+        int status = checkCase(cfg, program, NULL, cfg->variants[v]);
+        if (status == CASE_OK) continue;
+
+        failed = 1;
+        char *keep = malloc(program->count);
+        if (!keep) break;
+        memset(keep, 1, program->count);
+        if (cfg->reduce) reduceCase(cfg, program, keep, cfg->variants[v], status);
+
+        int lines;
+        if (status < 0) {
+            // The generator promises valid programs, so the -O0 build is at fault
+            snprintf(path, sizeof(path), "%s/ref_%llu.orn", cfg->workDir, seed);
+            lines = writeRandomProgram(program, keep, path);
+            fprintf(stderr, "seed %llu: %s at -O0, %d line(s): %s\n", seed,
+                    statusNames[-status], lines, path);
+            free(keep);
+            break;
+        }
+
+        snprintf(path, sizeof(path), "%s/fail_%llu_%d.orn", cfg->workDir, seed, v);
+        lines = writeRandomProgram(program, keep, path);
+        fprintf(stderr, "seed %llu: %s with '%s', %d line(s): %s\n", seed,
+                statusNames[status], cfg->variants[v], lines, path);
+        free(keep);
+    }
+
+    freeRandomProgram(program);
+    return failed;
+}
+
+static void printUsage(const char *prog) {
+    fprintf(stderr, "Usage: %s --orn <compiler> --work <dir> [options]\n", prog);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  --orn <path>        Compiler under test\n");
+    fprintf(stderr, "  --work <dir>        Scratch directory for builds and output\n");
+    fprintf(stderr, "  --seed <n>          First seed (default: 1)\n");
+    fprintf(stderr, "  --count <n>         Number of programs (default: 100)\n");
+    fprintf(stderr, "  --variant <flags>   Flags compared against -O0, repeatable\n");
+    fprintf(stderr, "                      (default: -O1, -O2, -O3 and -O3 -fno-<pass>\n");
+    fprintf(stderr, "                      for every pass)\n");
+    fprintf(stderr, "  --functions <n>     Functions per program (default: 3)\n");
+    fprintf(stderr, "  --statements <n>    Top-level statements per program (default: 30)\n");
+    fprintf(stderr, "  --depth <n>         Maximum block nesting (default: 3)\n");
+    fprintf(stderr, "  --emit <file>       Write the program for --seed and exit\n");
+    fprintf(stderr, "  --timeout <sec>     Per build/run timeout (default: 10)\n");
+    fprintf(stderr, "  --no-reduce         Save failing programs unreduced\n");
+}
+
+int main(int argc, char *argv[]) {
+    DiffConfig cfg = {0};
+    cfg.seed = 1;
+    cfg.count = 100;
+    cfg.timeoutSec = 10;
+    cfg.reduce = 1;
+    cfg.gen = (RandomProgramConfig){3, 30, 3, 3};
+    const char *emitPath = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (strcmp(arg, "--help") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        } else if (strcmp(arg, "--no-reduce") == 0) {
+            cfg.reduce = 0;
+        } else if (i + 1 >= argc) {
+            fprintf(stderr, "Error: %s requires an argument\n", arg);
+            return 1;
+        } else if (strcmp(arg, "--orn") == 0) {
+            cfg.orn = argv[++i];
+        } else if (strcmp(arg, "--work") == 0) {
+            cfg.workDir = argv[++i];
+        } else if (strcmp(arg, "--seed") == 0) {
+            cfg.seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(arg, "--count") == 0) {
+            cfg.count = atoi(argv[++i]);
+        } else if (strcmp(arg, "--variant") == 0) {
+            if (cfg.variantCount == MAX_VARIANTS) {
+                fprintf(stderr, "Error: Too many variants (max %d)\n", MAX_VARIANTS);
+                return 1;
+            }
+            cfg.variants[cfg.variantCount++] = argv[++i];
+        } else if (strcmp(arg, "--functions") == 0) {
+            cfg.gen.functions = atoi(argv[++i]);
+        } else if (strcmp(arg, "--statements") == 0) {
+            cfg.gen.statements = atoi(argv[++i]);
+        } else if (strcmp(arg, "--depth") == 0) {
+            cfg.gen.maxDepth = atoi(argv[++i]);
+        } else if (strcmp(arg, "--emit") == 0) {
+            emitPath = argv[++i];
+        } else if (strcmp(arg, "--timeout") == 0) {
+            cfg.timeoutSec = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", arg);
+            return 1;
+        }
+    }
+
+    if (emitPath) {
+        RandomProgram *program = generateRandomProgram(cfg.seed, &cfg.gen);
+        int ok = program && writeRandomProgram(program, NULL, emitPath) >= 0;
+        freeRandomProgram(program);
+        if (!ok) fprintf(stderr, "Error: Cannot write '%s'\n", emitPath);
+        return ok ? 0 : 1;
+    }
+
+    if (!cfg.orn || !cfg.workDir || cfg.count < 1 || cfg.gen.functions < 0 ||
+        cfg.gen.statements < 1 || cfg.gen.maxDepth < 0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // orn runs from inside the work dir, so a relative path would break
+    char ornPath[4096];
+    if (!realpath(cfg.orn, ornPath)) {
+        fprintf(stderr, "Error: Cannot find compiler '%s'\n", cfg.orn);
+        return 1;
+    }
+    cfg.orn = ornPath;
+
+    if (cfg.variantCount == 0) {
+        // Every level, plus -O3 with each pass left out so pass interactions get covered
+        static const char *defaults[] = {
+            "-O1", "-O2", "-O3",
+            "-O3 -fno-const-fold", "-O3 -fno-copy-prop", "-O3 -fno-dce", "-O3 -fno-simplify-cfg",
+        };
+        for (size_t v = 0; v < sizeof(defaults) / sizeof(defaults[0]); v++) {
+            cfg.variants[cfg.variantCount++] = defaults[v];
+        }
+    }
+
+    int failures = 0;
+    for (int n = 0; n < cfg.count; n++) {
+        failures += runSeed(&cfg, cfg.seed + (unsigned long long)n);
+    }
+
+    fprintf(stderr, "%d program(s), %d variant(s): %d failing\n", cfg.count, cfg.variantCount, failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,607 @@
+/**
+ * @file randomProgram.c
+ * @brief Seeded generator of random well-typed Orn programs for
+ * differential testing of the optimizer.
+ */
+#include "randomProgram.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_VARS 256
+#define ARRAY_LEN 8
+#define STRUCT_FIELDS 4
+
+typedef enum {
+    VALUE_INT,
+    VALUE_BOOL,
+    VALUE_DOUBLE,
+    VALUE_ARRAY,
+    VALUE_STRUCT,
+} ValueType;
+
+typedef struct GenVar {
+    char name[16];
+    ValueType type;
+    int readonly;
+} GenVar;
+
+typedef struct StrBuf {
+    char *data;
+    size_t len;
+    size_t cap;
+} StrBuf;
+
+typedef struct GenState {
+    uint64_t rng;
+    const RandomProgramConfig *cfg;
+    RandomProgram *program;
+    GenVar vars[MAX_VARS];
+    int varCount;
+    int functionCount;
+    int nextId;
+} GenState;
+
+static uint64_t nextRandom(GenState *gen) {
+    // xorshift64*, same family as bench/genProgram.c
+    gen->rng ^= gen->rng >> 12;
+    gen->rng ^= gen->rng << 25;
+    gen->rng ^= gen->rng >> 27;
+    return gen->rng * 0x2545F4914F6CDD1Dull;
+}
+
+static int randomBelow(GenState *gen, int n) {
+    return n > 0 ? (int)(nextRandom(gen) % (uint64_t)n) : 0;
+}
+
+static void appendf(StrBuf *buf, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int needed = vsnprintf(NULL, 0, fmt, args);
+    va_end(args);
+    if (needed < 0) return;
+
+    if (buf->len + (size_t)needed + 1 > buf->cap) {
+        size_t cap = buf->cap ? buf->cap : 64;
+        while (cap < buf->len + (size_t)needed + 1) cap *= 2;
+        char *grown = realloc(buf->data, cap);
+        if (!grown) return;
+        buf->data = grown;
+        buf->cap = cap;
+    }
+
+    va_start(args, fmt);
+    vsnprintf(buf->data + buf->len, buf->cap - buf->len, fmt, args);
+    va_end(args);
+    buf->len += (size_t)needed;
+}
+
+static int addLine(GenState *gen, StrBuf *text, LineKind kind) {
+    RandomProgram *program = gen->program;
+    if (program->count == program->capacity) {
+        int cap = program->capacity ? program->capacity * 2 : 64;
+        ProgramLine *grown = realloc(program->lines, cap * sizeof(ProgramLine));
+        if (!grown) {
+            free(text->data);
+            return -1;
+        }
+        program->lines = grown;
+        program->capacity = cap;
+    }
+
+    ProgramLine *line = &program->lines[program->count];
+    line->text = text->data ? text->data : calloc(1, 1);
+    line->kind = kind;
+    line->close = -1;
+    line->middle = -1;
+    text->data = NULL;
+    text->len = text->cap = 0;
+    return program->count++;
+}
+
+static void indent(StrBuf *buf, int depth) {
+    appendf(buf, "%*s", depth * 4, "");
+}
+
+static GenVar *pickVar(GenState *gen, ValueType type, int writable) {
+    int matches = 0;
+    for (int i = 0; i < gen->varCount; i++) {
+        matches += gen->vars[i].type == type && (!writable || !gen->vars[i].readonly);
+    }
+    if (!matches) return NULL;
+
+    int pick = randomBelow(gen, matches);
+    for (int i = 0; i < gen->varCount; i++) {
+        if (gen->vars[i].type == type && (!writable || !gen->vars[i].readonly) && pick-- == 0) {
+            return &gen->vars[i];
+        }
+    }
+    return NULL;
+}
+
+static GenVar *declareVar(GenState *gen, const char *prefix, ValueType type, int readonly) {
+    if (gen->varCount == MAX_VARS) return NULL;
+    GenVar *var = &gen->vars[gen->varCount++];
+    snprintf(var->name, sizeof(var->name), "%s%d", prefix, gen->nextId++);
+    var->type = type;
+    var->readonly = readonly;
+    return var;
+}
+
+static void genInt(GenState *gen, StrBuf *out, int depth);
+static void genBool(GenState *gen, StrBuf *out, int depth);
+static void genDouble(GenState *gen, StrBuf *out, int depth);
+
+static void genIntLeaf(GenState *gen, StrBuf *out) {
+    GenVar *var;
+    switch (randomBelow(gen, 5)) {
+        case 0:
+        case 1:
+            if ((var = pickVar(gen, VALUE_INT, 0))) {
+                appendf(out, "%s", var->name);
+                return;
+            }
+            break;
+        case 2:
+            if ((var = pickVar(gen, VALUE_ARRAY, 0))) {
+                appendf(out, "%s[(", var->name);
+                genIntLeaf(gen, out);
+                appendf(out, ") & %d]", ARRAY_LEN - 1);
+                return;
+            }
+            break;
+        case 3:
+            if ((var = pickVar(gen, VALUE_STRUCT, 0))) {
+                appendf(out, "%s.f%d", var->name, randomBelow(gen, STRUCT_FIELDS));
+                return;
+            }
+            break;
+        default:
+            break;
+    }
+    appendf(out, "%d", randomBelow(gen, 61) - 20);
+}
+
+static void genInt(GenState *gen, StrBuf *out, int depth) {
+    static const char *ops[] = {"+", "-", "*", "&", "|", "^"};
+    if (depth <= 0 || randomBelow(gen, 10) < 3) {
+        genIntLeaf(gen, out);
+        return;
+    }
+
+    switch (randomBelow(gen, 9)) {
+        case 0:
+        case 1:
+        case 2:
+            appendf(out, "(");
+            genInt(gen, out, depth - 1);
+            appendf(out, " %s ", ops[randomBelow(gen, 6)]);
+            genInt(gen, out, depth - 1);
+            appendf(out, ")");
+            break;
+        case 3:
+            // divisor is in 1..8 whatever the operand's sign
+            appendf(out, "(");
+            genInt(gen, out, depth - 1);
+            appendf(out, " %s ((", randomBelow(gen, 2) ? "/" : "%");
+            genInt(gen, out, depth - 1);
+            appendf(out, " & 7) + 1))");
+            break;
+        case 4:
+            appendf(out, "(");
+            genInt(gen, out, depth - 1);
+            appendf(out, " %s %d)", randomBelow(gen, 2) ? "<<" : ">>", randomBelow(gen, 5));
+            break;
+        case 5:
+            appendf(out, "-(");
+            genInt(gen, out, depth - 1);
+            appendf(out, ")");
+            break;
+        case 6:
+            if (gen->functionCount > 0) {
+                appendf(out, "f%d(", randomBelow(gen, gen->functionCount));
+                genInt(gen, out, depth - 1);
+                appendf(out, ", ");
+                genInt(gen, out, depth - 1);
+                appendf(out, ")");
+                break;
+            }
+            genIntLeaf(gen, out);
+            break;
+        case 7:
+            appendf(out, "((");
+            genDouble(gen, out, depth - 1);
+            appendf(out, ") as int)");
+            break;
+        default:
+            genIntLeaf(gen, out);
+            break;
+    }
+}
+
+static void genBool(GenState *gen, StrBuf *out, int depth) {
+    static const char *cmps[] = {"<", "<=", ">", ">=", "==", "!="};
+    GenVar *var;
+    int choice = depth <= 0 ? randomBelow(gen, 3) : randomBelow(gen, 7);
+    switch (choice) {
+        case 0:
+            if ((var = pickVar(gen, VALUE_BOOL, 0))) {
+                appendf(out, "%s", var->name);
+                break;
+            }
+            appendf(out, "%s", randomBelow(gen, 2) ? "true" : "false");
+            break;
+        case 1:
+        case 2:
+        case 3:
+            appendf(out, "(");
+            genInt(gen, out, depth - 1);
+            appendf(out, " %s ", cmps[randomBelow(gen, 6)]);
+            genInt(gen, out, depth - 1);
+            appendf(out, ")");
+            break;
+        case 4:
+            appendf(out, "!(");
+            genBool(gen, out, depth - 1);
+            appendf(out, ")");
+            break;
+        case 5:
+            appendf(out, "(");
+            genBool(gen, out, depth - 1);
+            appendf(out, " %s ", randomBelow(gen, 2) ? "&&" : "||");
+            genBool(gen, out, depth - 1);
+            appendf(out, ")");
+            break;
+        default:
+            appendf(out, "(");
+            genDouble(gen, out, depth - 1);
+            appendf(out, " %s ", cmps[randomBelow(gen, 4)]);
+            genDouble(gen, out, depth - 1);
+            appendf(out, ")");
+            break;
+    }
+}
+
+static void genDouble(GenState *gen, StrBuf *out, int depth) {
+    static const char *ops[] = {"+", "-", "*"};
+    GenVar *var;
+    if (depth <= 0 || randomBelow(gen, 10) < 4) {
+        if (randomBelow(gen, 2) && (var = pickVar(gen, VALUE_DOUBLE, 0))) {
+            appendf(out, "%s", var->name);
+        } else if (randomBelow(gen, 3) == 0) {
+            appendf(out, "(");
+            genIntLeaf(gen, out);
+            appendf(out, " as double)");
+        } else {
+            appendf(out, "%d.%d", randomBelow(gen, 10), randomBelow(gen, 4) * 25);
+        }
+        return;
+    }
+    appendf(out, "(");
+    genDouble(gen, out, depth - 1);
+    appendf(out, " %s ", ops[randomBelow(gen, 3)]);
+    genDouble(gen, out, depth - 1);
+    appendf(out, ")");
+}
+
+static void genStatements(GenState *gen, int count, int depth);
+
+static void genDeclaration(GenState *gen, int depth) {
+    StrBuf line = {0};
+    int expr = gen->cfg->exprDepth;
+    indent(&line, depth);
+
+    switch (randomBelow(gen, 6)) {
+        case 0:
+        case 1: {
+            StrBuf init = {0};
+            genInt(gen, &init, expr);
+            GenVar *var = declareVar(gen, "v", VALUE_INT, 0);
+            if (var) appendf(&line, "let %s: int = %s;", var->name, init.data);
+            free(init.data);
+            break;
+        }
+        case 2: {
+            StrBuf init = {0};
+            genBool(gen, &init, expr);
+            GenVar *var = declareVar(gen, "b", VALUE_BOOL, 0);
+            if (var) appendf(&line, "let %s: bool = %s;", var->name, init.data);
+            free(init.data);
+            break;
+        }
+        case 3: {
+            StrBuf init = {0};
+            genDouble(gen, &init, expr);
+            GenVar *var = declareVar(gen, "d", VALUE_DOUBLE, 0);
+            if (var) appendf(&line, "let %s: double = %s;", var->name, init.data);
+            free(init.data);
+            break;
+        }
+        case 4: {
+            GenVar *var = declareVar(gen, "a", VALUE_ARRAY, 0);
+            if (!var) break;
+            appendf(&line, "let %s: int[%d] = [", var->name, ARRAY_LEN);
+            for (int i = 0; i < ARRAY_LEN; i++) {
+                appendf(&line, "%s%d", i ? ", " : "", randomBelow(gen, 41) - 20);
+            }
+            appendf(&line, "];");
+            break;
+        }
+        default: {
+            // fields are set on the same line so no reduction can leave them unset
+            StrBuf fields = {0};
+            for (int f = 0; f < STRUCT_FIELDS; f++) {
+                appendf(&fields, " %%s.f%d = ", f);
+                genInt(gen, &fields, expr - 1);
+                appendf(&fields, ";");
+            }
+            GenVar *var = declareVar(gen, "s", VALUE_STRUCT, 0);
+            if (var) {
+                appendf(&line, "let %s: Rec;", var->name);
+                // fields text carries %s placeholders for the variable name
+                for (char *p = fields.data; p && *p; p++) {
+                    if (p[0] == '%' && p[1] == 's') {
+                        appendf(&line, "%s", var->name);
+                        p++;
+                    } else {
+                        appendf(&line, "%c", *p);
+                    }
+                }
+            }
+            free(fields.data);
+            break;
+        }
+    }
+    addLine(gen, &line, LINE_PLAIN);
+}
+
+static void genAssignment(GenState *gen, int depth) {
+    StrBuf line = {0};
+    int expr = gen->cfg->exprDepth;
+    indent(&line, depth);
+
+    GenVar *var;
+    switch (randomBelow(gen, 7)) {
+        case 0:
+            if ((var = pickVar(gen, VALUE_BOOL, 1))) {
+                appendf(&line, "%s = ", var->name);
+                genBool(gen, &line, expr);
+                appendf(&line, ";");
+                break;
+            }
+            // fallthrough
+        case 1:
+            if ((var = pickVar(gen, VALUE_DOUBLE, 1))) {
+                appendf(&line, "%s = ", var->name);
+                genDouble(gen, &line, expr);
+                appendf(&line, ";");
+                break;
+            }
+            // fallthrough
+        case 2:
+            if ((var = pickVar(gen, VALUE_ARRAY, 1))) {
+                appendf(&line, "%s[(", var->name);
+                genInt(gen, &line, 1);
+                appendf(&line, ") & %d] = ", ARRAY_LEN - 1);
+                genInt(gen, &line, expr);
+                appendf(&line, ";");
+                break;
+            }
+            // fallthrough
+        case 3:
+            if ((var = pickVar(gen, VALUE_STRUCT, 1))) {
+                appendf(&line, "%s.f%d = ", var->name, randomBelow(gen, STRUCT_FIELDS));
+                genInt(gen, &line, expr);
+                appendf(&line, ";");
+                break;
+            }
+            // fallthrough
+        case 4:
+            if ((var = pickVar(gen, VALUE_INT, 1))) {
+                static const char *compound[] = {"+=", "-=", "*=", "^="};
+                appendf(&line, "%s %s ", var->name, compound[randomBelow(gen, 4)]);
+                genInt(gen, &line, expr);
+                appendf(&line, ";");
+                break;
+            }
+            // fallthrough
+        case 5:
+            if ((var = pickVar(gen, VALUE_INT, 1))) {
+                appendf(&line, "%s%s;", var->name, randomBelow(gen, 2) ? "++" : "--");
+                break;
+            }
+            // fallthrough
+        default:
+            if ((var = pickVar(gen, VALUE_INT, 1))) {
+                appendf(&line, "%s = ", var->name);
+                genInt(gen, &line, expr);
+                appendf(&line, ";");
+                break;
+            }
+            free(line.data);
+            genDeclaration(gen, depth);
+            return;
+    }
+    addLine(gen, &line, LINE_PLAIN);
+}
+
+static void genPrint(GenState *gen, int depth) {
+    StrBuf line = {0};
+    indent(&line, depth);
+    appendf(&line, "print(");
+    switch (randomBelow(gen, 4)) {
+        case 0: genBool(gen, &line, 1); break;
+        case 1: genDouble(gen, &line, 1); break;
+        default: genInt(gen, &line, gen->cfg->exprDepth); break;
+    }
+    appendf(&line, "); print(\"%s\");", randomBelow(gen, 3) ? " " : "\\n");
+    addLine(gen, &line, LINE_PLAIN);
+}
+
+static void genIf(GenState *gen, int depth) {
+    StrBuf line = {0};
+    indent(&line, depth);
+    appendf(&line, "if ");
+    genBool(gen, &line, gen->cfg->exprDepth);
+    appendf(&line, " {");
+    int open = addLine(gen, &line, LINE_OPEN);
+    if (open < 0) return;
+
+    int body = 1 + randomBelow(gen, 4);
+    int scope = gen->varCount;
+    genStatements(gen, body, depth + 1);
+    gen->varCount = scope;
+
+    if (randomBelow(gen, 2)) {
+        indent(&line, depth);
+        appendf(&line, "} else {");
+        int middle = addLine(gen, &line, LINE_MIDDLE);
+        if (middle < 0) return;
+        gen->program->lines[open].middle = middle;
+        genStatements(gen, body, depth + 1);
+        gen->varCount = scope;
+    }
+
+    indent(&line, depth);
+    appendf(&line, "};");
+    gen->program->lines[open].close = addLine(gen, &line, LINE_CLOSE);
+}
+
+static void genWhile(GenState *gen, int depth) {
+    // The counter lives outside the block and is only bumped by the closer
+    GenVar *counter = declareVar(gen, "i", VALUE_INT, 1);
+    if (!counter) return;
+    StrBuf line = {0};
+    indent(&line, depth);
+    appendf(&line, "let %s: int = 0;", counter->name);
+    addLine(gen, &line, LINE_PLAIN);
+
+    indent(&line, depth);
+    appendf(&line, "while %s < %d {", counter->name, 1 + randomBelow(gen, 6));
+    int open = addLine(gen, &line, LINE_OPEN);
+    if (open < 0) return;
+
+    int scope = gen->varCount;
+    genStatements(gen, 1 + randomBelow(gen, 4), depth + 1);
+    gen->varCount = scope;
+
+    indent(&line, depth + 1);
+    appendf(&line, "%s++;\n", counter->name);
+    indent(&line, depth);
+    appendf(&line, "};");
+    gen->program->lines[open].close = addLine(gen, &line, LINE_CLOSE);
+}
+
+static void genStatements(GenState *gen, int count, int depth) {
+    for (int i = 0; i < count; i++) {
+        int nested = depth < gen->cfg->maxDepth;
+        switch (randomBelow(gen, nested ? 10 : 7)) {
+            case 0:
+            case 1:
+                genDeclaration(gen, depth);
+                break;
+            case 2:
+            case 3:
+            case 4:
+                genAssignment(gen, depth);
+                break;
+            case 5:
+            case 6:
+                genPrint(gen, depth);
+                break;
+            case 7:
+            case 8:
+                genIf(gen, depth);
+                break;
+            default:
+                genWhile(gen, depth);
+                break;
+        }
+    }
+}
+
+static void genFunction(GenState *gen, int index) {
+    StrBuf line = {0};
+    appendf(&line, "fn f%d(p0: int, p1: int) -> int {", index);
+    int open = addLine(gen, &line, LINE_OPEN);
+    if (open < 0) return;
+
+    // Parameters are read-only so every path keeps them well defined
+    int scope = gen->varCount;
+    GenVar *p0 = &gen->vars[gen->varCount++];
+    GenVar *p1 = &gen->vars[gen->varCount++];
+    snprintf(p0->name, sizeof(p0->name), "p0");
+    snprintf(p1->name, sizeof(p1->name), "p1");
+    p0->type = p1->type = VALUE_INT;
+    p0->readonly = p1->readonly = 1;
+
+    genStatements(gen, 1 + gen->cfg->statements / 4, 1);
+
+    // The return shares the closer, a reducer cannot strip it
+    indent(&line, 1);
+    appendf(&line, "return ");
+    genInt(gen, &line, gen->cfg->exprDepth);
+    appendf(&line, ";\n};");
+    gen->program->lines[open].close = addLine(gen, &line, LINE_CLOSE);
+    gen->varCount = scope;
+    gen->functionCount = index + 1;
+}
+
+RandomProgram *generateRandomProgram(uint64_t seed, const RandomProgramConfig *cfg) {
+    RandomProgram *program = calloc(1, sizeof(RandomProgram));
+    if (!program) return NULL;
+
+    GenState gen = {0};
+    gen.rng = seed ? seed : 1;
+    gen.cfg = cfg;
+    gen.program = program;
+    // Warm up so nearby seeds diverge immediately
+    for (int i = 0; i < 4; i++) nextRandom(&gen);
+
+    StrBuf line = {0};
+    appendf(&line, "// orn_difftest seed %llu\nstruct Rec {\n", (unsigned long long)seed);
+    for (int f = 0; f < STRUCT_FIELDS; f++) appendf(&line, "    f%d: int\n", f);
+    appendf(&line, "};");
+    addLine(&gen, &line, LINE_PLAIN);
+
+    for (int i = 0; i < cfg->functions; i++) genFunction(&gen, i);
+    genStatements(&gen, cfg->statements, 0);
+
+    // Dump every live scalar so a wrong value cannot go unnoticed
+    for (int i = 0; i < gen.varCount; i++) {
+        GenVar *var = &gen.vars[i];
+        if (var->type == VALUE_ARRAY) {
+            for (int k = 0; k < ARRAY_LEN; k++) appendf(&line, "print(%s[%d]); print(\" \"); ", var->name, k);
+        } else if (var->type == VALUE_STRUCT) {
+            for (int k = 0; k < STRUCT_FIELDS; k++) appendf(&line, "print(%s.f%d); print(\" \"); ", var->name, k);
+        } else {
+            appendf(&line, "print(%s); print(\" \"); ", var->name);
+        }
+        appendf(&line, "\n");
+    }
+    appendf(&line, "print(\"\\n\");");
+    addLine(&gen, &line, LINE_PLAIN);
+    return program;
+}
+
+void freeRandomProgram(RandomProgram *program) {
+    if (!program) return;
+    for (int i = 0; i < program->count; i++) free(program->lines[i].text);
+    free(program->lines);
+    free(program);
+}
+
+int writeRandomProgram(const RandomProgram *program, const char *keep, const char *path) {
+    FILE *out = fopen(path, "w");
+    if (!out) return -1;
+    int written = 0;
+    for (int i = 0; i < program->count; i++) {
+        if (keep && !keep[i]) continue;
+        fprintf(out, "%s\n", program->lines[i].text);
+        written++;
+    }
+    fclose(out);
+    return written;
+}
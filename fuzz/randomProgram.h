@@ -0,0 +1,54 @@
+#ifndef RANDOM_PROGRAM_H
+#define RANDOM_PROGRAM_H
+
+#include <stdint.h>
+
+/**
+ * @brief One generated source line. Block openers know their closer so a
+ * reducer can drop a whole block at once; middles ("} else {") and closers
+ * are never removed on their own.
+ */
+typedef enum {
+    LINE_PLAIN,
+    LINE_OPEN,
+    LINE_MIDDLE,
+    LINE_CLOSE,
+} LineKind;
+
+typedef struct ProgramLine {
+    char *text;
+    LineKind kind;
+    int close;
+    int middle;
+} ProgramLine;
+
+typedef struct RandomProgram {
+    ProgramLine *lines;
+    int count;
+    int capacity;
+} RandomProgram;
+
+typedef struct RandomProgramConfig {
+    int functions;
+    int statements;
+    int maxDepth;
+    int exprDepth;
+} RandomProgramConfig;
+
+/**
+ * @brief Generates a well-typed, terminating Orn program from a seed.
+ *
+ * Every variable is initialized where it is declared, divisors are forced
+ * non-zero, array indices are masked in bounds and loops are counted, so
+ * the output only depends on the semantics the optimizer must preserve.
+ */
+RandomProgram *generateRandomProgram(uint64_t seed, const RandomProgramConfig *cfg);
+void freeRandomProgram(RandomProgram *program);
+
+/**
+ * @brief Writes the lines whose keep flag is set (all when keep is NULL)
+ * @return number of lines written
+ */
+int writeRandomProgram(const RandomProgram *program, const char *keep, const char *path);
+
+#endif //RANDOM_PROGRAM_H
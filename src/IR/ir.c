@@ -1,12 +1,16 @@
 #include "./ir.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include "../semantic/symbolTable.h"
 #include "../semantic/typeChecker.h"
+#include "../semantic/builtIns.h"
 #include "./irHelpers.h"
 
+#define IR_CHUNK_SIZE 1024                  // instructions, 64 KiB
+
 IrContext *createIrContext(){
-    IrContext *ctx = malloc(sizeof(IrContext));
+    IrContext *ctx = calloc(1, sizeof(IrContext));
     if(!ctx) return NULL;
 
     ctx->instructions = NULL;
@@ -15,22 +19,158 @@ IrContext *createIrContext(){
     ctx->nextTempNum = 1;
     ctx->nextLabelNum = 1;
     ctx->pendingJumps = NULL;
+    ctx->currentLine = 0;
+    ctx->currentColumn = 0;
+    irIntern(ctx, "", 0);
     return ctx;
 }
 
+static void freeChunks(IrChunk *chunk) {
+    while (chunk) {
+        IrChunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+}
+
 void freeIrContext(IrContext *ctx) {
     if (!ctx) return;
-    
-    IrInstruction *inst = ctx->instructions;
-    while (inst) {
-        IrInstruction *next = inst->next;
-        free(inst);
-        inst = next;
-    }
-    
+
+    freeChunks(ctx->chunks);
+    for (unsigned i = 0; i < ctx->strings.count; i++) free(ctx->strings.strings[i]);
+    free(ctx->strings.strings);
+    free(ctx->strings.lengths);
+    free(ctx->strings.buckets);
+    free(ctx->doubles);
     free(ctx);
 }
 
+static unsigned hashString(const char *str, size_t len) {
+    unsigned h = 2166136261u;
+    for (size_t i = 0; i < len; i++) h = (h ^ (unsigned char)str[i]) * 16777619u;
+    return h;
+}
+
+static int growStringBuckets(IrStringTable *table) {
+    unsigned count = table->bucketCount ? table->bucketCount * 2 : 256;
+    unsigned *buckets = calloc(count, sizeof(unsigned));
+    if (!buckets) return 0;
+    for (unsigned id = 0; id < table->count; id++) {
+        unsigned slot = hashString(table->strings[id], table->lengths[id]) & (count - 1);
+        while (buckets[slot]) slot = (slot + 1) & (count - 1);
+        buckets[slot] = id + 1;
+    }
+    free(table->buckets);
+    table->buckets = buckets;
+    table->bucketCount = count;
+    return 1;
+}
+
+unsigned irIntern(IrContext *ctx, const char *str, size_t len) {
+    IrStringTable *table = &ctx->strings;
+    if ((table->count + 1) * 2 > table->bucketCount && !growStringBuckets(table)) return 0;
+
+    unsigned slot = hashString(str, len) & (table->bucketCount - 1);
+    while (table->buckets[slot]) {
+        unsigned id = table->buckets[slot] - 1;
+        if (table->lengths[id] == len && memcmp(table->strings[id], str, len) == 0) return id;
+        slot = (slot + 1) & (table->bucketCount - 1);
+    }
+
+    if (table->count == table->capacity) {
+        unsigned capacity = table->capacity ? table->capacity * 2 : 128;
+        char **strings = realloc(table->strings, capacity * sizeof(char *));
+        if (!strings) return 0;
+        table->strings = strings;
+        size_t *lengths = realloc(table->lengths, capacity * sizeof(size_t));
+        if (!lengths) return 0;
+        table->lengths = lengths;
+        table->capacity = capacity;
+    }
+    char *copy = malloc(len + 1);
+    if (!copy) return 0;
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+
+    unsigned id = table->count++;
+    table->strings[id] = copy;
+    table->lengths[id] = len;
+    table->buckets[slot] = id + 1;
+    return id;
+}
+
+const char *irString(const IrContext *ctx, unsigned id, size_t *len) {
+    if (id >= ctx->strings.count) id = 0;
+    if (len) *len = ctx->strings.lengths[id];
+    return ctx->strings.strings[id];
+}
+
+double irDouble(const IrContext *ctx, IrOperand op) {
+    if (op.value.constant.index >= ctx->doubleCount) return 0.0;
+    return ctx->doubles[op.value.constant.index];
+}
+
+long long irIntValue(const IrContext *ctx, IrOperand op) {
+    long long wide = 0;
+    switch (op.dataType) {
+        case IR_TYPE_I64:
+        case IR_TYPE_U64:
+            if (op.value.constant.index < ctx->doubleCount) {
+                memcpy(&wide, &ctx->doubles[op.value.constant.index], sizeof(wide));
+            }
+            return wide;
+        case IR_TYPE_U32:
+            return (unsigned)op.value.constant.intVal;
+        default:
+            // narrower types are stored already extended
+            return op.value.constant.intVal;
+    }
+}
+
+int irIsInteger(IrDataType type) {
+    return type == IR_TYPE_INT || (type >= IR_TYPE_I8 && type <= IR_TYPE_U64);
+}
+
+int irIsUnsigned(IrDataType type) {
+    return type >= IR_TYPE_U8 && type <= IR_TYPE_U64;
+}
+
+int irIntBits(IrDataType type) {
+    switch (type) {
+        case IR_TYPE_I8:
+        case IR_TYPE_U8: return 8;
+        case IR_TYPE_I16:
+        case IR_TYPE_U16: return 16;
+        case IR_TYPE_I64:
+        case IR_TYPE_U64: return 64;
+        default: return 32;
+    }
+}
+
+int irIsVector(IrDataType type) {
+    return type >= IR_TYPE_F32X4 && type <= IR_TYPE_I32X8;
+}
+
+IrDataType irLaneType(IrDataType type) {
+    switch (type) {
+        case IR_TYPE_F32X4:
+        case IR_TYPE_F32X8: return IR_TYPE_FLOAT;
+        case IR_TYPE_F64X2:
+        case IR_TYPE_F64X4: return IR_TYPE_DOUBLE;
+        default: return IR_TYPE_INT;
+    }
+}
+
+int irLaneCount(IrDataType type) {
+    switch (type) {
+        case IR_TYPE_F64X2: return 2;
+        case IR_TYPE_F32X4:
+        case IR_TYPE_I32X4:
+        case IR_TYPE_F64X4: return 4;
+        default: return 8;
+    }
+}
+
 IrOperand createTemp(IrContext *ctx, IrDataType type){
     return (IrOperand){
         .type =   OPERAND_TEMP,
@@ -39,12 +179,11 @@ IrOperand createTemp(IrContext *ctx, IrDataType type){
     };
 }
 
-IrOperand createVar(const char *name, size_t len, IrDataType type){
+IrOperand createVar(IrContext *ctx, const char *name, size_t len, IrDataType type){
     return (IrOperand){
         .type = OPERAND_VAR,
         .dataType = type,
-        .value.var.name = name,
-        .value.var.nameLen = len
+        .value.var.id = irIntern(ctx, name, len)
     };
 }
 
@@ -67,9 +206,40 @@ IrOperand createFloatConst(float val){
     return op;
 }
 
-IrOperand createDoubleConst(double val){
-    IrOperand op = createConst(IR_TYPE_DOUBLE);
-    op.value.constant.doubleVal = val;
+/**
+ * @brief Appends 8 bytes to the constant table, copied bit for bit.
+ */
+static IrOperand createTableConst(IrContext *ctx, IrDataType type, const void *bits){
+    IrOperand op = createConst(type);
+    if (ctx->doubleCount == ctx->doubleCapacity) {
+        unsigned capacity = ctx->doubleCapacity ? ctx->doubleCapacity * 2 : 32;
+        double *doubles = realloc(ctx->doubles, capacity * sizeof(double));
+        if (!doubles) return op;
+        ctx->doubles = doubles;
+        ctx->doubleCapacity = capacity;
+    }
+    op.value.constant.index = ctx->doubleCount;
+    memcpy(&ctx->doubles[ctx->doubleCount++], bits, sizeof(double));
+    return op;
+}
+
+IrOperand createDoubleConst(IrContext *ctx, double val){
+    return createTableConst(ctx, IR_TYPE_DOUBLE, &val);
+}
+
+IrOperand createSizedIntConst(IrContext *ctx, IrDataType type, long long val){
+    switch (type) {
+        case IR_TYPE_I8: val = (signed char)val; break;
+        case IR_TYPE_I16: val = (short)val; break;
+        case IR_TYPE_U8: val = (unsigned char)val; break;
+        case IR_TYPE_U16: val = (unsigned short)val; break;
+        case IR_TYPE_I64:
+        case IR_TYPE_U64:
+            return createTableConst(ctx, type, &val);
+        default: break;
+    }
+    IrOperand op = createConst(type);
+    op.value.constant.intVal = (int)(unsigned)val;
     return op;
 }
 
@@ -79,10 +249,9 @@ IrOperand createBoolConst(int val){
     return op;
 }
 
-IrOperand createStringConst(const char* val, size_t len){
+IrOperand createStringConst(IrContext *ctx, const char* val, size_t len){
     IrOperand op = createConst(IR_TYPE_STRING);
-    op.value.constant.str.stringVal = val;
-    op.value.constant.str.len = len;
+    op.value.constant.index = irIntern(ctx, val, len);
     return op;
 }
 
@@ -94,11 +263,10 @@ IrOperand createLabel(int label){
     };
 }
 
-IrOperand createFn(const char *start, size_t len){
+IrOperand createFn(IrContext *ctx, const char *start, size_t len){
     return (IrOperand) {
         .type = OPERAND_FUNCTION,
-        .value.fn.name = start,
-        .value.fn.nameLen = len
+        .value.fn.id = irIntern(ctx, start, len)
     };
 }
 
@@ -117,7 +285,34 @@ IrOperand createNullConst() {
     return op;
 }
 
+static IrChunk *createChunk(int capacity) {
+    IrChunk *chunk = malloc(sizeof(IrChunk) + (size_t)capacity * sizeof(IrInstruction));
+    if (!chunk) return NULL;
+    chunk->next = NULL;
+    chunk->used = 0;
+    chunk->capacity = capacity;
+    return chunk;
+}
+
+IrInstruction *allocInstruction(IrContext *ctx) {
+    IrChunk *chunk = ctx->chunks;
+    if (!chunk || chunk->used == chunk->capacity) {
+        // Fixed size: at most one partly used chunk per context
+        IrChunk *fresh = createChunk(IR_CHUNK_SIZE);
+        if (!fresh) return NULL;
+        fresh->next = chunk;
+        ctx->chunks = chunk = fresh;
+    }
+    IrInstruction *inst = &chunk->instructions[chunk->used++];
+    memset(inst, 0, sizeof(IrInstruction));
+    inst->profileCount = -1;
+    return inst;
+}
+
 void appendInstruction(IrContext *ctx, IrInstruction *inst){
+    inst->line = ctx->currentLine;
+    inst->column = ctx->currentColumn;
+    inst->profileCount = -1;
     if(!ctx->instructions){
         ctx->instructions = inst;
         ctx->lastInstruction = inst;
@@ -129,16 +324,82 @@ void appendInstruction(IrContext *ctx, IrInstruction *inst){
     ctx->instructionCount++;
 }
 
+void insertInstructionBefore(IrContext *ctx, IrInstruction *pos, IrInstruction *inst) {
+    inst->prev = pos->prev;
+    inst->next = pos;
+    if (pos->prev) {
+        pos->prev->next = inst;
+    } else {
+        ctx->instructions = inst;
+    }
+    pos->prev = inst;
+    ctx->instructionCount++;
+}
+
+IrInstruction *removeInstruction(IrContext *ctx, IrInstruction *inst) {
+    IrInstruction *next = inst->next;
+
+    if (inst->prev) {
+        inst->prev->next = next;
+    } else {
+        ctx->instructions = next;
+    }
+
+    if (next) {
+        next->prev = inst->prev;
+    } else {
+        ctx->lastInstruction = inst->prev;
+    }
+
+    // The slot stays allocated: callers may still hold the pointer
+    inst->op = IR_NOP;
+    ctx->instructionCount--;
+    ctx->deadCount++;
+    return next;
+}
+
+void compactIr(IrContext *ctx) {
+    // Exact fit: later inserts open a regular chunk
+    IrChunk *chunk = createChunk(ctx->instructionCount > 0 ? ctx->instructionCount : 1);
+    if (!chunk) return;
+
+    IrInstruction *prev = NULL;
+    for (IrInstruction *inst = ctx->instructions; inst; inst = inst->next) {
+        IrInstruction *copy = &chunk->instructions[chunk->used++];
+        *copy = *inst;
+        copy->prev = prev;
+        copy->next = NULL;
+        if (prev) prev->next = copy;
+        prev = copy;
+    }
+
+    freeChunks(ctx->chunks);
+    ctx->chunks = chunk;
+    ctx->instructions = chunk->used ? &chunk->instructions[0] : NULL;
+    ctx->lastInstruction = prev;
+    ctx->deadCount = 0;
+}
+
+size_t irMemoryUsage(const IrContext *ctx) {
+    size_t bytes = sizeof(IrContext);
+    for (const IrChunk *chunk = ctx->chunks; chunk; chunk = chunk->next) {
+        bytes += sizeof(IrChunk) + (size_t)chunk->capacity * sizeof(IrInstruction);
+    }
+    bytes += ctx->strings.capacity * (sizeof(char *) + sizeof(size_t));
+    bytes += ctx->strings.bucketCount * sizeof(unsigned);
+    for (unsigned i = 0; i < ctx->strings.count; i++) bytes += ctx->strings.lengths[i] + 1;
+    bytes += ctx->doubleCapacity * sizeof(double);
+    return bytes;
+}
+
 IrInstruction *emitBinary(IrContext *ctx, IrOpCode op, IrOperand res, IrOperand ar1, IrOperand ar2){
-    IrInstruction *inst = malloc(sizeof(IrInstruction));
+    IrInstruction *inst = allocInstruction(ctx);
     if(!inst) return NULL;
 
     inst->op = op;
     inst->result = res;
     inst->ar1 = ar1;
     inst->ar2 = ar2;
-    inst->next = NULL;
-    inst->prev = NULL;
 
     appendInstruction(ctx, inst);
     return inst;
@@ -192,11 +453,7 @@ IrInstruction *emitPointerStore(IrContext *ctx, IrOperand base, IrOperand off, I
 
 IrInstruction *emitCall(IrContext *ctx, IrOperand res, const char *fnName, 
                         size_t nameLen, int params) {
-    IrOperand func = (IrOperand) {
-        .type = OPERAND_FUNCTION,
-        .value.fn.name = fnName,
-        .value.fn.nameLen = nameLen
-    };  
+    IrOperand func = createFn(ctx, fnName, nameLen);
     
     IrOperand paramCount = createIntConst(params);
     
@@ -204,42 +461,36 @@ IrInstruction *emitCall(IrContext *ctx, IrOperand res, const char *fnName,
 }
 
 IrInstruction *emitMemberStore(IrContext *ctx, IrOperand structVar, int offset, IrOperand val){
-    IrInstruction *inst = malloc(sizeof(struct IrInstruction));
+    IrInstruction *inst = allocInstruction(ctx);
     if(!inst) return NULL;
     inst->op = IR_MEMBER_STORE;
     inst->result = structVar;
     inst->ar1 = createIntConst(offset);
     inst->ar2 = val;
-    inst->next = NULL;
-    inst->prev = NULL;
 
     appendInstruction(ctx, inst);
     return inst;
 }
 
 IrInstruction *emitMemberLoad(IrContext *ctx, IrOperand dest, IrOperand structVar, int offset){
-    IrInstruction *inst = malloc(sizeof(struct IrInstruction));
+    IrInstruction *inst = allocInstruction(ctx);
     if(!inst) return NULL;
     inst->op = IR_MEMBER_LOAD;
     inst->result = dest;
     inst->ar1 = structVar;
     inst->ar2 = createIntConst(offset);
-    inst->next = NULL;
-    inst->prev = NULL;
 
     appendInstruction(ctx, inst);
     return inst;
 }
 
-IrInstruction *emitAllocStruct(IrContext *ctx, IrOperand dest, int size){
-    IrInstruction *inst = malloc(sizeof(struct IrInstruction));
+IrInstruction *emitAllocStruct(IrContext *ctx, IrOperand dest, int size, int alignment){
+    IrInstruction *inst = allocInstruction(ctx);
     if(!inst) return NULL;
     inst->op = IR_ALLOC_STRUCT;
     inst->result = dest;
     inst->ar1 = createIntConst(size);
-    inst->ar2 = createNone();
-    inst->next = NULL;
-    inst->prev = NULL;
+    inst->ar2 = createIntConst(alignment);
 
     appendInstruction(ctx, inst);
     return inst;
@@ -256,6 +507,19 @@ IrDataType symbolTypeToIrType(DataType type) {
         case TYPE_POINTER: return IR_TYPE_POINTER;
         case TYPE_STRUCT: return IR_TYPE_POINTER;
         case TYPE_NULL: return IR_TYPE_POINTER;
+        case TYPE_I8: return IR_TYPE_I8;
+        case TYPE_I16: return IR_TYPE_I16;
+        case TYPE_I64: return IR_TYPE_I64;
+        case TYPE_U8: return IR_TYPE_U8;
+        case TYPE_U16: return IR_TYPE_U16;
+        case TYPE_U32: return IR_TYPE_U32;
+        case TYPE_U64: return IR_TYPE_U64;
+        case TYPE_F32X4: return IR_TYPE_F32X4;
+        case TYPE_F64X2: return IR_TYPE_F64X2;
+        case TYPE_I32X4: return IR_TYPE_I32X4;
+        case TYPE_F32X8: return IR_TYPE_F32X8;
+        case TYPE_F64X4: return IR_TYPE_F64X4;
+        case TYPE_I32X8: return IR_TYPE_I32X8;
         default: return IR_TYPE_INT;
     }
 }
@@ -280,6 +544,21 @@ IrDataType nodeTypeToIrType(NodeTypes nodeType) {
         case REF_VOID:
             return IR_TYPE_VOID;
 
+        case REF_I8:
+        case REF_I16:
+        case REF_I64:
+        case REF_U8:
+        case REF_U16:
+        case REF_U32:
+        case REF_U64:
+        case REF_F32X4:
+        case REF_F64X2:
+        case REF_I32X4:
+        case REF_F32X8:
+        case REF_F64X4:
+        case REF_I32X8:
+            return symbolTypeToIrType(getDataTypeFromNode(nodeType));
+
         case REF_CUSTOM:
         case STRUCT_VARIABLE_DEFINITION:
             return IR_TYPE_POINTER;
@@ -365,6 +644,52 @@ IrOpCode astOpToIrOp(NodeTypes nodeType) {
     }
 }
 
+/**
+ * @brief Common operand type of a mixed int/float/double arithmetic or compare.
+ * Integers follow C: narrower than int becomes int, then the wider type wins
+ * and unsigned wins a tie (promoteIntegerTypes on the semantic side).
+ */
+static IrDataType promoteNumericType(IrDataType left, IrDataType right) {
+    if (left == IR_TYPE_DOUBLE || right == IR_TYPE_DOUBLE) return IR_TYPE_DOUBLE;
+    if (left == IR_TYPE_FLOAT || right == IR_TYPE_FLOAT) return IR_TYPE_FLOAT;
+    if (!irIsInteger(left) || !irIsInteger(right)) return left;
+
+    if (irIntBits(left) < 32) left = IR_TYPE_INT;
+    if (irIntBits(right) < 32) right = IR_TYPE_INT;
+    if (irIntBits(left) != irIntBits(right)) return irIntBits(left) > irIntBits(right) ? left : right;
+    return irIsUnsigned(right) ? right : left;
+}
+
+/**
+ * @brief Converts an operand to the type an operation or store expects, so
+ * codegen only sees matching operand types: integers to floating point or to
+ * another integer width. Constants are converted in place.
+ */
+static IrOperand promoteOperand(IrContext *ctx, IrOperand op, IrDataType target) {
+    if (op.dataType == target) return op;
+    int toFloat = target == IR_TYPE_FLOAT || target == IR_TYPE_DOUBLE;
+    if (!toFloat && !(irIsInteger(target) && irIsInteger(op.dataType))) return op;
+
+    if (op.type == OPERAND_CONSTANT) {
+        if (irIsInteger(op.dataType)) {
+            long long value = irIntValue(ctx, op);
+            if (!toFloat) return createSizedIntConst(ctx, target, value);
+            double real = op.dataType == IR_TYPE_U64 ? (double)(unsigned long long)value : (double)value;
+            return target == IR_TYPE_FLOAT ? createFloatConst((float)real) : createDoubleConst(ctx, real);
+        }
+        if (op.dataType == IR_TYPE_FLOAT && target == IR_TYPE_DOUBLE) {
+            return createDoubleConst(ctx, (double)op.value.constant.floatVal);
+        }
+        if (op.dataType == IR_TYPE_DOUBLE && target == IR_TYPE_FLOAT) {
+            return createFloatConst((float)irDouble(ctx, op));
+        }
+    }
+
+    IrOperand res = createTemp(ctx, target);
+    emitUnary(ctx, IR_CAST, res, op);
+    return res;
+}
+
 static MemberAccessInfo resolveMemberAccessChain(ASTNode node, TypeCheckContext typeCtx) {
     MemberAccessInfo info = { NULL, 0, 0, NULL, TYPE_UNKNOWN };
     
@@ -413,6 +738,56 @@ static MemberAccessInfo resolveMemberAccessChain(ASTNode node, TypeCheckContext
     return info;
 }
 
+/**
+ * @brief Lowers a vector intrinsic call in place. Loads and stores name their
+ * array or pointer through a pointer var, the same way subscripts do.
+ */
+static IrOperand generateVectorIntrinsicIr(IrContext *ctx, ASTNode node, const VectorIntrinsic *intrinsic,
+                                           TypeCheckContext typeCtx) {
+    ASTNode arg = node->children->children;
+    IrDataType vectorType = symbolTypeToIrType(intrinsic->vectorType);
+
+    switch (intrinsic->kind) {
+    case VEC_INTRINSIC_LOAD: {
+        IrOperand base = createVar(ctx, arg->start, arg->length, IR_TYPE_POINTER);
+        IrOperand index = generateExpressionIr(ctx, arg->brothers, typeCtx);
+        IrOperand res = createTemp(ctx, vectorType);
+        emitBinary(ctx, IR_VEC_LOAD, res, base, index);
+        return res;
+    }
+    case VEC_INTRINSIC_STORE: {
+        IrOperand base = createVar(ctx, arg->start, arg->length, IR_TYPE_POINTER);
+        IrOperand index = generateExpressionIr(ctx, arg->brothers, typeCtx);
+        IrOperand value = generateExpressionIr(ctx, arg->brothers->brothers, typeCtx);
+        emitBinary(ctx, IR_VEC_STORE, base, index, value);
+        return createNone();
+    }
+    case VEC_INTRINSIC_SPLAT: {
+        IrOperand scalar = promoteOperand(ctx, generateExpressionIr(ctx, arg, typeCtx), irLaneType(vectorType));
+        IrOperand res = createTemp(ctx, vectorType);
+        emitUnary(ctx, IR_VEC_SPLAT, res, scalar);
+        return res;
+    }
+    case VEC_INTRINSIC_SHUFFLE: {
+        IrOperand vector = generateExpressionIr(ctx, arg, typeCtx);
+        int selector = 0;
+        int lane = 0;
+        for (ASTNode source = arg->brothers; source; source = source->brothers) {
+            selector |= parseInt(source->start, source->length) << (3 * lane++);
+        }
+        IrOperand res = createTemp(ctx, vector.dataType);
+        emitBinary(ctx, IR_VEC_SHUFFLE, res, vector, createIntConst(selector));
+        return res;
+    }
+    default: {
+        IrOperand vector = generateExpressionIr(ctx, arg, typeCtx);
+        IrOperand res = createTemp(ctx, irLaneType(vector.dataType));
+        emitBinary(ctx, IR_VEC_REDUCE, res, vector, createIntConst(intrinsic->kind - VEC_INTRINSIC_REDUCE_ADD));
+        return res;
+    }
+    }
+}
+
 /**
  * @brief Generated Ir instructtions for a function
  * @details ar1 is the function name, ar2 is 1 if exported, 0 otherwise and ar3 it is used to indicate if the function returns a data container (struct)
@@ -433,7 +808,7 @@ static void generateFunctionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
         typeCtx->current = fnSymbol->functionScope;
     }
     
-    IrOperand funcName = createFn(node->start, node->length);
+    IrOperand funcName = createFn(ctx, node->start, node->length);
     IrOperand exportFlag = createIntConst(isExported);
     int returnsDataContainerFlag = fnSymbol->type == TYPE_STRUCT;
     IrOperand returnsDataContainer = createIntConst(returnsDataContainerFlag);
@@ -444,7 +819,7 @@ static void generateFunctionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
         FunctionParameter param = fnSymbol->parameters;
         int paramIndex = returnsDataContainerFlag ? 1 : 0; // Adjust for hidden struct return param
         if(returnsDataContainerFlag){
-            IrOperand hiddenPtr = createVar("__hidden_ptr", 13, IR_TYPE_POINTER);
+            IrOperand hiddenPtr = createVar(ctx, "__hidden_ptr", 13, IR_TYPE_POINTER);
             emitBinary(ctx, IR_LOAD_PARAM, hiddenPtr, createNone(), createIntConst(0));
         }
         while (param) {
@@ -452,7 +827,7 @@ static void generateFunctionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
             if (param->isPointer) {
                 irType = IR_TYPE_POINTER;
             }
-            IrOperand paramVar = createVar(param->nameStart, param->nameLength, irType);
+            IrOperand paramVar = createVar(ctx, param->nameStart, param->nameLength, irType);
             IrOperand indexOp = createIntConst(paramIndex);
 
             emitBinary(ctx, IR_LOAD_PARAM, paramVar, createNone(), indexOp);
@@ -481,19 +856,23 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
         }
         switch (node->children->nodeType) {
         case REF_INT:
-            return createIntConst(parseInt(node->start, node->length));
+            switch (intLiteralRank(node->start, node->length)) {
+                case 0: return createIntConst(parseInt(node->start, node->length));
+                case 1: return createSizedIntConst(ctx, IR_TYPE_I64, parseLong(node->start, node->length));
+                default: return createSizedIntConst(ctx, IR_TYPE_U64, parseLong(node->start, node->length));
+            }
 
         case REF_FLOAT:
             return createFloatConst(parseFloat(node->start, node->length));
 
         case REF_DOUBLE:
-            return createDoubleConst(parseFloat(node->start, node->length));
+            return createDoubleConst(ctx, parseFloat(node->start, node->length));
 
         case REF_BOOL:
             return createBoolConst(matchLit(node->start, node->length, "true") ? 1 : 0);
 
         case REF_STRING:
-            return createStringConst(node->start, node->length);
+            return createStringConst(ctx, node->start, node->length);
         default:
             return createNone();
         }
@@ -513,7 +892,7 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
             type = symbolTypeToIrType(sym->type);
         }
         
-        return createVar(node->start, node->length, type);
+        return createVar(ctx, node->start, node->length, type);
     }
 
     case ADD_OP:
@@ -544,6 +923,38 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
         IrDataType resultType = symbolTypeToIrType(getOperationResultType(
             getDataTypeFromNode(left->nodeType), getDataTypeFromNode(right->nodeType), node->nodeType));
 
+        // Operand types are already resolved, so use them for numeric promotion
+        switch (node->nodeType) {
+        case ADD_OP: case SUB_OP: case MUL_OP: case DIV_OP: case MOD_OP:
+            resultType = promoteNumericType(leftOp.dataType, rightOp.dataType);
+            leftOp = promoteOperand(ctx, leftOp, resultType);
+            rightOp = promoteOperand(ctx, rightOp, resultType);
+            break;
+        case BITWISE_AND: case BITWISE_OR: case BITWISE_XOR:
+            resultType = promoteNumericType(leftOp.dataType, rightOp.dataType);
+            leftOp = promoteOperand(ctx, leftOp, resultType);
+            rightOp = promoteOperand(ctx, rightOp, resultType);
+            break;
+        case BITWISE_LSHIFT: case BITWISE_RSHIFT:
+            // The shifted value decides the type, the count just follows it
+            resultType = promoteNumericType(leftOp.dataType, leftOp.dataType);
+            leftOp = promoteOperand(ctx, leftOp, resultType);
+            rightOp = promoteOperand(ctx, rightOp, resultType);
+            break;
+        case EQUAL_OP: case NOT_EQUAL_OP: case LESS_THAN_OP:
+        case LESS_EQUAL_OP: case GREATER_THAN_OP: case GREATER_EQUAL_OP: {
+            IrDataType operandType = promoteNumericType(leftOp.dataType, rightOp.dataType);
+            leftOp = promoteOperand(ctx, leftOp, operandType);
+            rightOp = promoteOperand(ctx, rightOp, operandType);
+            resultType = IR_TYPE_BOOL;
+            break;
+        }
+        case LOGIC_AND: case LOGIC_OR:
+            resultType = IR_TYPE_BOOL;
+            break;
+        default: break;
+        }
+
         IrOperand res = createTemp(ctx, resultType);
         IrOpCode op = astOpToIrOp(node->nodeType);
         emitBinary(ctx, op, res, leftOp, rightOp);
@@ -554,6 +965,9 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
     case LOGIC_NOT: {
         ASTNode operand = node->children;
         IrOperand operandOp = generateExpressionIr(ctx, operand, typeCtx);
+        if (node->nodeType == UNARY_MINUS_OP) {
+            operandOp = promoteOperand(ctx, operandOp, promoteNumericType(operandOp.dataType, operandOp.dataType));
+        }
         IrOperand res = createTemp(ctx, operandOp.dataType);
 
         IrOpCode irOp = astOpToIrOp(node->nodeType);
@@ -568,7 +982,7 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
         }
         
         IrOperand temp = createTemp(ctx, symbolTypeToIrType(info.fieldType));
-        IrOperand structVar = createVar(info.baseName, info.baseNameLen, IR_TYPE_POINTER);
+        IrOperand structVar = createVar(ctx, info.baseName, info.baseNameLen, IR_TYPE_POINTER);
         emitMemberLoad(ctx, temp, structVar, info.totalOffset);
         
         return temp;
@@ -583,7 +997,7 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
         if (!targetSym) return createNone();
 
         IrDataType targetType = symbolTypeToIrType(targetSym->type);
-        IrOperand targetVar = createVar(target->start, target->length, targetType);
+        IrOperand targetVar = createVar(ctx, target->start, target->length, targetType);
 
         // Create temp to hold the address
         IrOperand result = createTemp(ctx, IR_TYPE_POINTER);
@@ -608,7 +1022,11 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
             ptrSym = lookupSymbol(typeCtx->current, ptrNode->start, ptrNode->length);
         }
 
-        IrDataType derefType = ptrSym ? symbolTypeToIrType(ptrSym->type) : IR_TYPE_INT;
+        IrDataType derefType = IR_TYPE_INT;
+        if (ptrSym) {
+            derefType = ptrSym->isPointer && ptrSym->pointerLvl == 1 ? symbolTypeToIrType(ptrSym->baseType)
+                                                                     : IR_TYPE_POINTER;
+        }
 
         // Create temp to hold dereferenced value
         IrOperand result = createTemp(ctx, derefType);
@@ -627,9 +1045,9 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
         if (var.dataType == IR_TYPE_FLOAT) {
             one = createFloatConst(1.0f);
         } else if (var.dataType == IR_TYPE_DOUBLE) {
-            one = createDoubleConst(1.0);
+            one = createDoubleConst(ctx, 1.0);
         } else {
-            one = createIntConst(1);
+            one = createSizedIntConst(ctx, var.dataType, 1);
         }
         
         IrOperand temp = createTemp(ctx, var.dataType);
@@ -652,9 +1070,9 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
         if (var.dataType == IR_TYPE_FLOAT) {
             one = createFloatConst(1.0f);
         } else if (var.dataType == IR_TYPE_DOUBLE) {
-            one = createDoubleConst(1.0);
+            one = createDoubleConst(ctx, 1.0);
         } else {
-            one = createIntConst(1);
+            one = createSizedIntConst(ctx, var.dataType, 1);
         }
         
         IrOperand newValue = createTemp(ctx, var.dataType);
@@ -668,21 +1086,42 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
     }
 
     case FUNCTION_CALL: {
+        const VectorIntrinsic *intrinsic = findVectorIntrinsic(node->start, node->length);
+        if (intrinsic) return generateVectorIntrinsicIr(ctx, node, intrinsic, typeCtx);
+
         Symbol funcSymbol = lookupSymbol(typeCtx->current, node->start, node->length);
         int paramCount = 0;
-        if(funcSymbol && funcSymbol->returnedVar->type == TYPE_STRUCT){
+        if(funcSymbol && funcSymbol->type == TYPE_STRUCT){
             ++paramCount;
         }
         ASTNode argList = node->children;
         if (argList && argList->nodeType == ARGUMENT_LIST) {
-            ASTNode arg = argList->children;
-            while (arg) {
-                IrOperand argOp = generateExpressionIr(ctx, arg, typeCtx);
+            int argCount = 0;
+            for (ASTNode arg = argList->children; arg; arg = arg->brothers) argCount++;
+
+            // Evaluate every argument before the first PARAM: PARAM loads the
+            // argument register directly, so a nested call or a division in a
+            // later argument would clobber the earlier ones.
+            IrOperand *args = malloc((argCount ? argCount : 1) * sizeof(IrOperand));
+            if (!args) return createNone();
+            // User functions take their parameters' exact types, builtins dispatch on the argument
+            FunctionParameter param = funcSymbol && !isBuiltinFunction(node->start, node->length)
+                ? funcSymbol->parameters : NULL;
+            int i = 0;
+            for (ASTNode arg = argList->children; arg; arg = arg->brothers) {
+                args[i] = generateExpressionIr(ctx, arg, typeCtx);
+                if (param) {
+                    if (!param->isPointer) args[i] = promoteOperand(ctx, args[i], symbolTypeToIrType(param->type));
+                    param = param->next;
+                }
+                i++;
+            }
+            for (i = 0; i < argCount; i++) {
                 IrOperand none = createNone();
-                emitBinary(ctx, IR_PARAM, none, argOp, none);
+                emitBinary(ctx, IR_PARAM, none, args[i], none);
                 paramCount++;
-                arg = arg->brothers;
             }
+            free(args);
         }
 
         IrDataType retType = funcSymbol && funcSymbol->type != TYPE_STRUCT ? symbolTypeToIrType(funcSymbol->type) : IR_TYPE_VOID;
@@ -713,11 +1152,35 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
         if (left->nodeType == ARRAY_ACCESS) {
             leftOp = generateExpressionIr(ctx, left->children, typeCtx);
             ASTNode target = left->children->brothers;
+            Symbol arraySym = lookupSymbol(typeCtx->current, left->children->start, left->children->length);
+            if (irIsVector(leftOp.dataType) && arraySym && !arraySym->isArray) {
+                // v[i] = x writes one lane in place, v[i] op= x goes through the lane's value
+                IrOperand laneOp = generateExpressionIr(ctx, target, typeCtx);
+                IrDataType laneType = irLaneType(leftOp.dataType);
+                rightOp = promoteOperand(ctx, rightOp, laneType);
+                if (node->nodeType != ASSIGNMENT) {
+                    IrOperand lane = createTemp(ctx, laneType);
+                    emitBinary(ctx, IR_LANE_LOAD, lane, leftOp, laneOp);
+                    IrOperand combined = createTemp(ctx, laneType);
+                    emitBinary(ctx, astOpToIrOp(node->nodeType), combined, lane, rightOp);
+                    rightOp = combined;
+                }
+                emitBinary(ctx, IR_LANE_STORE, leftOp, laneOp, rightOp);
+                return leftOp;
+            }
+            if (arraySym && !arraySym->isPointer) {
+                rightOp = promoteOperand(ctx, rightOp, symbolTypeToIrType(arraySym->type));
+            }
             emitPointerStore(ctx, leftOp, generateExpressionIr(ctx, target, typeCtx), rightOp);
         } else if (left->nodeType == POINTER) {
             // Handle *ptr = value
             ASTNode ptrNode = left->children;
             IrOperand ptrOp = generateExpressionIr(ctx, ptrNode, typeCtx);
+            Symbol ptrSym = ptrNode->nodeType == VARIABLE
+                ? lookupSymbol(typeCtx->current, ptrNode->start, ptrNode->length) : NULL;
+            if (ptrSym && ptrSym->isPointer && ptrSym->pointerLvl == 1) {
+                rightOp = promoteOperand(ctx, rightOp, symbolTypeToIrType(ptrSym->baseType));
+            }
 
             emitStore(ctx, ptrOp, rightOp);
 
@@ -729,7 +1192,7 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
                 return createNone();
             }
             
-            IrOperand structVar = createVar(info.baseName, info.baseNameLen, IR_TYPE_POINTER);
+            IrOperand structVar = createVar(ctx, info.baseName, info.baseNameLen, IR_TYPE_POINTER);
             
             if (node->nodeType != ASSIGNMENT) {
                 // Compound assignment
@@ -737,10 +1200,11 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
                 emitMemberLoad(ctx, temp1, structVar, info.totalOffset);
                 IrOperand t2 = createTemp(ctx, temp1.dataType);
                 IrOpCode op = astOpToIrOp(node->nodeType);
-                emitBinary(ctx, op, t2, temp1, rightOp);
+                emitBinary(ctx, op, t2, temp1, promoteOperand(ctx, rightOp, temp1.dataType));
                 emitMemberStore(ctx, structVar, info.totalOffset, t2);
             } else {
-                emitMemberStore(ctx, structVar, info.totalOffset, rightOp);
+                IrDataType fieldType = symbolTypeToIrType(info.fieldType);
+                emitMemberStore(ctx, structVar, info.totalOffset, promoteOperand(ctx, rightOp, fieldType));
             }
         }else {
             leftOp = generateExpressionIr(ctx, left, typeCtx);
@@ -750,13 +1214,13 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
 
                 IrOpCode op = astOpToIrOp(node->nodeType);
 
-                emitBinary(ctx, op, temp, leftOp, rightOp);
+                emitBinary(ctx, op, temp, leftOp, promoteOperand(ctx, rightOp, resultType));
                 emitCopy(ctx, leftOp, temp);
 
                 return leftOp;
             }
 
-            emitCopy(ctx, leftOp, rightOp);
+            emitCopy(ctx, leftOp, promoteOperand(ctx, rightOp, leftOp.dataType));
         }
 
         return leftOp;
@@ -781,8 +1245,14 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
 
         Symbol arraySym = lookupSymbol(typeCtx->current, arrNode->start, arrNode->length);
         IrDataType elemType = symbolTypeToIrType(arraySym->type);
+        if (irIsVector(elemType) && !arraySym->isArray && !arraySym->isPointer) {
+            IrOperand vector = createVar(ctx, arrNode->start, arrNode->length, elemType);
+            IrOperand lane = createTemp(ctx, irLaneType(elemType));
+            emitBinary(ctx, IR_LANE_LOAD, lane, vector, indexOp);
+            return lane;
+        }
 
-        IrOperand arrayBase = createVar(arrNode->start, arrNode->length, IR_TYPE_POINTER);
+        IrOperand arrayBase = createVar(ctx, arrNode->start, arrNode->length, IR_TYPE_POINTER);
 
         IrOperand result = createTemp(ctx, elemType);
         emitPointerLoad(ctx, result, arrayBase, indexOp);
@@ -794,7 +1264,22 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
 }
 
 
+static void generateStatementNodeIr(IrContext *ctx, ASTNode node, TypeCheckContext typeCtx);
+
 void generateStatementIr(IrContext *ctx, ASTNode node, TypeCheckContext typeCtx){
+    // Instructions take the position of the innermost statement that produced them
+    int oldLine = ctx->currentLine;
+    int oldColumn = ctx->currentColumn;
+    if (node->line) {
+        ctx->currentLine = node->line;
+        ctx->currentColumn = node->column;
+    }
+    generateStatementNodeIr(ctx, node, typeCtx);
+    ctx->currentLine = oldLine;
+    ctx->currentColumn = oldColumn;
+}
+
+static void generateStatementNodeIr(IrContext *ctx, ASTNode node, TypeCheckContext typeCtx){
     switch(node->nodeType){
         case PROGRAM: {
             ASTNode child = node->children;
@@ -832,13 +1317,13 @@ void generateStatementIr(IrContext *ctx, ASTNode node, TypeCheckContext typeCtx)
                 ASTNode varDef = node->children;
                 Symbol sym = lookupSymbol(typeCtx->current, varDef->start, varDef->length);
                 if(sym->type == TYPE_STRUCT){
-                    IrOperand var = createVar(varDef->start, varDef->length, IR_TYPE_POINTER);
+                    IrOperand var = createVar(ctx, varDef->start, varDef->length, IR_TYPE_POINTER);
                     int totalSize = sym->structType->size;
                     if(typeCtx->currentFunction && typeCtx->currentFunction->returnedVar == sym){
-                        emitCopy(ctx, var, createVar("__hidden_ptr", 13, IR_TYPE_POINTER));
+                        emitCopy(ctx, var, createVar(ctx, "__hidden_ptr", 13, IR_TYPE_POINTER));
                     }else{
-                        emitAllocStruct(ctx, var, totalSize);
-                        if(varDef->children->brothers->children->nodeType == FUNCTION_CALL){
+                        emitAllocStruct(ctx, var, totalSize, (int)sym->structType->alignment);
+                        if(varDef->children->brothers && varDef->children->brothers->children->nodeType == FUNCTION_CALL){
                             IrOperand temp = createTemp(ctx, IR_TYPE_POINTER);
                             emitUnary(ctx, IR_ADDROF, temp, var);
                             emitBinary(ctx, IR_PARAM, createNone(), temp, createNone());
@@ -876,8 +1361,8 @@ void generateStatementIr(IrContext *ctx, ASTNode node, TypeCheckContext typeCtx)
                     type = nodeTypeToIrType(typeRefChild ? typeRefChild->nodeType : REF_INT);
                 }
 
-                IrOperand var = createVar(node->start, node->length, type);
-                emitCopy(ctx, var, val);
+                IrOperand var = createVar(ctx, node->start, node->length, type);
+                emitCopy(ctx, var, promoteOperand(ctx, val, type));
             }
             break;
         }
@@ -886,7 +1371,7 @@ void generateStatementIr(IrContext *ctx, ASTNode node, TypeCheckContext typeCtx)
                 ASTNode typeref = node->children;
                 IrDataType type = nodeTypeToIrType(typeref->children->nodeType);
                 ASTNode staticSizeNode = typeref->brothers;
-                IrOperand arr = createVar(node->start, node->length, type);
+                IrOperand arr = createVar(ctx, node->start, node->length, type);
                 ASTNode valNode = staticSizeNode->brothers;
                 int staticSize;
                 if(staticSizeNode->nodeType == LITERAL){
@@ -901,7 +1386,7 @@ void generateStatementIr(IrContext *ctx, ASTNode node, TypeCheckContext typeCtx)
                     if (valNode->children->nodeType == ARRAY_LIT) {
                         ASTNode arrLitVal = valNode->children->children;
                         for (int i = 0; i < staticSize; ++i) {
-                            IrOperand val = generateExpressionIr(ctx, arrLitVal, typeCtx);
+                            IrOperand val = promoteOperand(ctx, generateExpressionIr(ctx, arrLitVal, typeCtx), type);
                             IrOperand off = createIntConst(i);
                             emitPointerStore(ctx, arr, off, val);
                             arrLitVal = arrLitVal->brothers;
@@ -941,7 +1426,6 @@ void generateStatementIr(IrContext *ctx, ASTNode node, TypeCheckContext typeCtx)
         }
 
         case LOOP_STATEMENT: {
-            printf("Generating IR for loop statement\n");
             ASTNode cond = node->children;
             ASTNode body = cond->brothers;
 
@@ -962,7 +1446,7 @@ void generateStatementIr(IrContext *ctx, ASTNode node, TypeCheckContext typeCtx)
         case RETURN_STATEMENT: {
             if (node->children && typeCtx->currentFunction->type != TYPE_STRUCT) {
                 IrOperand retVal = generateExpressionIr(ctx, node->children, typeCtx);
-                emitReturn(ctx, retVal);
+                emitReturn(ctx, promoteOperand(ctx, retVal, symbolTypeToIrType(typeCtx->currentFunction->type)));
             } else {
                 IrOperand none = createNone();
                 emitReturn(ctx, none);
@@ -1035,6 +1519,10 @@ static const char *opCodeToString(IrOpCode op) {
         case IR_FUNC_BEGIN: return "FUNC_BEGIN";
         case IR_FUNC_END: return "FUNC_END";
         case IR_CAST: return "CAST";
+        case IR_PROFILE_FUNC: return "PROF_FUNC";
+        case IR_PROFILE_COUNT: return "PROF_COUNT";
+        case IR_COLD_BEGIN: return "COLD_BEGIN";
+        case IR_COLD_END: return "COLD_END";
         case IR_POINTER_LOAD: return "PTRLD";
         case IR_POINTER_STORE: return "PTRST";
         case IR_REQ_MEM: return "REQMEM";
@@ -1044,67 +1532,83 @@ static const char *opCodeToString(IrOpCode op) {
         case IR_MEMBER_LOAD: return "MEM_LOAD";
         case IR_MEMBER_STORE: return "MEM_STORE";
         case IR_ALLOC_STRUCT: return "ALLOC_STRUCT";
+        case IR_VEC_SPLAT: return "VSPLAT";
+        case IR_VEC_LOAD: return "VLOAD";
+        case IR_VEC_STORE: return "VSTORE";
+        case IR_VEC_SHUFFLE: return "VSHUF";
+        case IR_VEC_REDUCE: return "VREDUCE";
+        case IR_LANE_LOAD: return "LANE_LD";
+        case IR_LANE_STORE: return "LANE_ST";
         default: return "UNKNOWN";
     }
 }
 
-static void printOperand(IrOperand op) {
+static int formatOperand(const IrContext *ctx, IrOperand op, char *buf, size_t size) {
+    size_t len;
     switch (op.type) {
         case OPERAND_TEMP:
-            printf("t%d", op.value.temp.tempNum);
-            break;
+            return snprintf(buf, size, "t%d", op.value.temp.tempNum);
         case OPERAND_VAR:
-            printf("%.*s", (int)op.value.var.nameLen, op.value.var.name);
-            break;
+            return snprintf(buf, size, "%s", irString(ctx, op.value.var.id, NULL));
         case OPERAND_CONSTANT:
             if (op.dataType == IR_TYPE_POINTER) {
                 if (op.value.constant.intVal == 0) {
-                    printf("null");
-                } else {
-                    printf("0x%lx", (unsigned long)op.value.constant.intVal);
+                    return snprintf(buf, size, "null");
                 }
-            } else if (op.dataType == IR_TYPE_INT || op.dataType == IR_TYPE_BOOL) {
-                printf("%d", op.value.constant.intVal);
+                return snprintf(buf, size, "0x%lx", (unsigned long)op.value.constant.intVal);
+            } else if (op.dataType == IR_TYPE_U64) {
+                return snprintf(buf, size, "%llu", (unsigned long long)irIntValue(ctx, op));
+            } else if (irIsInteger(op.dataType) || op.dataType == IR_TYPE_BOOL) {
+                return snprintf(buf, size, "%lld", irIntValue(ctx, op));
             } else if (op.dataType == IR_TYPE_STRING) {
-                printf("%.*s", (int)op.value.constant.str.len, op.value.constant.str.stringVal);
+                const char *str = irString(ctx, op.value.constant.index, &len);
+                return snprintf(buf, size, "%.*s", (int)len, str);
             } else if (op.dataType == IR_TYPE_FLOAT) {
-                printf("%g", op.value.constant.floatVal);
-            } else {
-                printf("%f", op.value.constant.doubleVal);
+                return snprintf(buf, size, "%g", op.value.constant.floatVal);
             }
-            break;
+            return snprintf(buf, size, "%f", irDouble(ctx, op));
         case OPERAND_LABEL:
-            printf("L%d", op.value.label.labelNum);
-            break;
+            return snprintf(buf, size, "L%d", op.value.label.labelNum);
         case OPERAND_FUNCTION:
-            printf("%.*s", (int)op.value.fn.nameLen, op.value.fn.name);
-            break;
+            return snprintf(buf, size, "%s", irString(ctx, op.value.fn.id, NULL));
         case OPERAND_NONE:
-            printf("-");
-            break;
+            return snprintf(buf, size, "-");
     }
+    return 0;
 }
 
-void printInstruction(IrInstruction *inst) {
-    if (!inst) return;
-
-    printf("%-12s ", opCodeToString(inst->op));
+int formatInstruction(const IrContext *ctx, const IrInstruction *inst, char *buf, size_t size) {
+    if (!inst || !size) return 0;
+    size_t len = 0;
+    #define FORMAT_PART(call) do { \
+        int n = (call); \
+        if (n > 0) len += (size_t)n; \
+        if (len >= size) return (int)len; \
+    } while (0)
 
+    FORMAT_PART(snprintf(buf, size, "%-12s ", opCodeToString(inst->op)));
     if (inst->result.type != OPERAND_NONE) {
-        printOperand(inst->result);
+        FORMAT_PART(formatOperand(ctx, inst->result, buf + len, size - len));
     }
-
     if (inst->ar1.type != OPERAND_NONE) {
-        if(inst->result.type!=OPERAND_NONE){
-            printf(", ");
+        if (inst->result.type != OPERAND_NONE) {
+            FORMAT_PART(snprintf(buf + len, size - len, ", "));
         }
-        printOperand(inst->ar1);
+        FORMAT_PART(formatOperand(ctx, inst->ar1, buf + len, size - len));
     }
-
     if (inst->ar2.type != OPERAND_NONE) {
-        printf(", ");
-        printOperand(inst->ar2);
+        FORMAT_PART(snprintf(buf + len, size - len, ", "));
+        FORMAT_PART(formatOperand(ctx, inst->ar2, buf + len, size - len));
     }
+    #undef FORMAT_PART
+    return (int)len;
+}
+
+void printInstruction(const IrContext *ctx, IrInstruction *inst) {
+    if (!inst) return;
+    char buf[512];
+    formatInstruction(ctx, inst, buf, sizeof(buf));
+    printf("%s", buf);
 }
 
 void printIR(IrContext *ctx) {
@@ -1118,7 +1622,10 @@ void printIR(IrContext *ctx) {
 
     while (inst) {
         printf("%4d: ", count++);
-        printInstruction(inst);
+        printInstruction(ctx, inst);
+        if (inst->profileCount >= 0) {
+            printf("    ; count %lld", inst->profileCount);
+        }
         printf("\n");
         inst = inst->next;
     }
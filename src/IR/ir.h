@@ -1,3 +1,6 @@
+#ifndef IR_H
+#define IR_H
+
 #include <stddef.h>
 #include <stdint.h>
 #include "../semantic/typeChecker.h"
@@ -57,7 +60,21 @@ typedef enum {
     IR_FUNC_BEGIN,
     IR_FUNC_END,
 
-    IR_CAST
+    IR_CAST,
+
+    IR_PROFILE_FUNC,                        // result = function, ar1 = CFG checksum, ar2 = block count
+    IR_PROFILE_COUNT,                       // result = function, ar1 = block index
+
+    IR_COLD_BEGIN,                          // code up to COLD_END goes to .text.unlikely
+    IR_COLD_END,
+
+    IR_VEC_SPLAT,                           // result = ar1 in every lane
+    IR_VEC_LOAD,                            // result = lanes of array/pointer var ar1 from index ar2
+    IR_VEC_STORE,                           // lanes of ar2 to array/pointer var result from index ar1
+    IR_VEC_SHUFFLE,                         // result lane i = ar1 lane (ar2 >> 3 * i) & 7
+    IR_VEC_REDUCE,                          // result = ar1 lanes folded by ar2: 0 add, 1 min, 2 max
+    IR_LANE_LOAD,                           // result = vector var ar1 lane ar2
+    IR_LANE_STORE                           // vector var result lane ar1 = ar2
 } IrOpCode;
 
 typedef struct {
@@ -84,42 +101,49 @@ typedef enum {
     IR_TYPE_BOOL,
     IR_TYPE_STRING,
     IR_TYPE_VOID,
-    IR_TYPE_POINTER
+    IR_TYPE_POINTER,
+    IR_TYPE_I8,
+    IR_TYPE_I16,
+    IR_TYPE_I64,
+    IR_TYPE_U8,
+    IR_TYPE_U16,
+    IR_TYPE_U32,
+    IR_TYPE_U64,
+    IR_TYPE_F32X4,
+    IR_TYPE_F64X2,
+    IR_TYPE_I32X4,
+    IR_TYPE_F32X8,
+    IR_TYPE_F64X4,
+    IR_TYPE_I32X8
 } IrDataType;
 
+/**
+ * @brief 8-byte operand. Names and string constants are interned in the
+ * context's string table, doubles and 64-bit integers live in its 8-byte
+ * constant table; read them back with irString / irDouble / irIntValue.
+ */
 typedef struct IrOperand {
-    OperandType type;
-    IrDataType dataType;
+    uint8_t type;                           // OperandType
+    uint8_t dataType;                       // IrDataType
     union {
         struct{
             int tempNum;
         } temp;
         struct {
-            const char *name;
-            size_t nameLen;
+            unsigned id;                    // interned name
         } var;
         struct {
             union {
                 int intVal;
                 float floatVal;
-                double doubleVal;
-                struct {
-                    const char *stringVal;
-                    size_t len;
-                } str;
+                unsigned index;             // IR_TYPE_DOUBLE/I64/U64: doubles[index], IR_TYPE_STRING: string id
             };
         } constant;
-        struct {
-            char* start;
-            size_t len;
-            int off;
-        } mem;
         struct {
             int labelNum;
         } label;
         struct {
-            const char *name;
-            size_t nameLen;
+            unsigned id;                    // interned name
         } fn;
     } value;
 } IrOperand;
@@ -129,14 +153,45 @@ typedef struct IrInstruction{
     IrOperand result;
     IrOperand ar1;
     IrOperand ar2;
+    int line;                               // originating source line, 0 if unknown
+    int column;
+    long long profileCount;                 // block executions from -fprofile-use, -1 if unknown
     struct IrInstruction *next;
     struct IrInstruction *prev;
 } IrInstruction;
 
+/**
+ * @brief Instructions are carved from chunks instead of malloc'd one by one.
+ * Removed instructions stay in place as tombstones until compactIr copies
+ * the live list into one array, in list order.
+ */
+typedef struct IrChunk {
+    struct IrChunk *next;
+    int used;
+    int capacity;
+    IrInstruction instructions[];
+} IrChunk;
+
+typedef struct IrStringTable {
+    char **strings;                         // NUL terminated copies, id 0 is ""
+    size_t *lengths;
+    unsigned count;
+    unsigned capacity;
+    unsigned *buckets;                      // open addressing, id + 1, 0 = empty
+    unsigned bucketCount;
+} IrStringTable;
+
 typedef struct IrContext {
     IrInstruction *instructions;
     IrInstruction *lastInstruction;         
     int instructionCount;
+
+    IrChunk *chunks;                        // newest first
+    int deadCount;                          // tombstones since the last compaction
+    IrStringTable strings;
+    double *doubles;
+    unsigned doubleCount;
+    unsigned doubleCapacity;
     
     int nextTempNum;                        
     int nextLabelNum;                      
@@ -146,24 +201,69 @@ typedef struct IrContext {
         int targetLabel;                    
         struct JumpPatch *next;
     } *pendingJumps;
-    
+
+    int currentLine;                        // position stamped on appended instructions
+    int currentColumn;
 } IrContext;
 
 IrContext *createIrContext();
 void freeIrContext(IrContext *ctx);
 
+/**
+ * @brief Returns the id of a copy of [str, str + len), one per distinct string.
+ */
+unsigned irIntern(IrContext *ctx, const char *str, size_t len);
+const char *irString(const IrContext *ctx, unsigned id, size_t *len);
+double irDouble(const IrContext *ctx, IrOperand op);
+/**
+ * @brief Value of an integer, bool or pointer constant, sign or zero
+ * extended from its type's width.
+ */
+long long irIntValue(const IrContext *ctx, IrOperand op);
+int irIsInteger(IrDataType type);
+int irIsUnsigned(IrDataType type);
+int irIntBits(IrDataType type);
+int irIsVector(IrDataType type);
+/**
+ * @brief Lane type of a vector: float, double or int.
+ */
+IrDataType irLaneType(IrDataType type);
+int irLaneCount(IrDataType type);
+
 IrOperand createTemp(IrContext *ctx, IrDataType type);
-IrOperand createVar(const char *name, size_t len, IrDataType type);
+IrOperand createVar(IrContext *ctx, const char *name, size_t len, IrDataType type);
 IrOperand createConst(IrDataType type);
 IrOperand createIntConst(int val);
 IrOperand createFloatConst(float val);
-IrOperand createDoubleConst(double val);
+IrOperand createDoubleConst(IrContext *ctx, double val);
+/**
+ * @brief Integer constant of any integer type, truncated to its width.
+ */
+IrOperand createSizedIntConst(IrContext *ctx, IrDataType type, long long val);
 IrOperand createBoolConst(int val);
-IrOperand createStringConst(const char* val, size_t len);
+IrOperand createStringConst(IrContext *ctx, const char* val, size_t len);
 IrOperand createLabel(int label);
 IrOperand createNone();
+IrOperand createFn(IrContext *ctx, const char *start, size_t len);
 
+/**
+ * @brief Returns a zeroed, unlinked instruction from the context's chunks.
+ */
+IrInstruction *allocInstruction(IrContext *ctx);
 void appendInstruction(IrContext *ctx, IrInstruction *inst);
+void insertInstructionBefore(IrContext *ctx, IrInstruction *pos, IrInstruction *inst);
+/**
+ * @brief Unlinks an instruction, leaving a tombstone in its chunk.
+ * @return The instruction that followed the removed one.
+ */
+IrInstruction *removeInstruction(IrContext *ctx, IrInstruction *inst);
+/**
+ * @brief Copies the live instructions into a single array in list order, so
+ * every function is one contiguous run, and frees the old chunks.
+ * Invalidates all IrInstruction pointers held outside the list.
+ */
+void compactIr(IrContext *ctx);
+size_t irMemoryUsage(const IrContext *ctx);
 IrInstruction *emitBinary(IrContext *ctx, IrOpCode op, IrOperand res, IrOperand ar1, IrOperand ar2);
 IrInstruction *emitUnary(IrContext *ctx, IrOpCode op, IrOperand res, IrOperand ar1);
 IrInstruction *emitCopy(IrContext *ctx, IrOperand res, IrOperand ar1);
@@ -181,5 +281,12 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
 void generateStatementIr(IrContext *ctx, ASTNode node, TypeCheckContext typeCtx);
 IrContext *generateIr(ASTNode ast, TypeCheckContext typeCtx);
 
-void printInstruction(IrInstruction *inst);
-void printIR(IrContext *ctx);
\ No newline at end of file
+void printInstruction(const IrContext *ctx, IrInstruction *inst);
+/**
+ * @brief Formats an instruction the way printInstruction prints it.
+ * @return Number of characters that would have been written (snprintf semantics).
+ */
+int formatInstruction(const IrContext *ctx, const IrInstruction *inst, char *buf, size_t size);
+void printIR(IrContext *ctx);
+
+#endif //IR_H
@@ -0,0 +1,297 @@
+#include "./irFile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char irMagic[6] = {'O', 'R', 'N', 'I', 'R', 0};
+
+static void putU8(FILE *out, unsigned value) {
+    fputc((int)(value & 0xff), out);
+}
+
+static void putU32(FILE *out, uint32_t value) {
+    for (int i = 0; i < 4; i++) putU8(out, value >> (8 * i));
+}
+
+static void putU64(FILE *out, uint64_t value) {
+    for (int i = 0; i < 8; i++) putU8(out, (unsigned)(value >> (8 * i)));
+}
+
+static void putString(FILE *out, const char *str, size_t len) {
+    putU32(out, (uint32_t)len);
+    fwrite(str, 1, len, out);
+}
+
+static void putOperand(FILE *out, IrOperand op) {
+    putU8(out, op.type);
+    putU8(out, op.dataType);
+    uint32_t value;
+    memcpy(&value, &op.value, sizeof(value));
+    putU32(out, value);
+}
+
+int writeIrFile(const char *path, const IrFileInfo *info, const IrContext *ctx) {
+    FILE *out = fopen(path, "wb");
+    if (!out) {
+        fprintf(stderr, "Error: Cannot write IR file '%s'\n", path);
+        return 0;
+    }
+
+    fwrite(irMagic, 1, sizeof(irMagic), out);
+    putU32(out, IR_FILE_VERSION);
+    putU32(out, info->flags);
+    putString(out, info->moduleName, strlen(info->moduleName));
+    putString(out, info->sourcePath ? info->sourcePath : "", info->sourcePath ? strlen(info->sourcePath) : 0);
+    putU32(out, (uint32_t)info->importCount);
+    for (int i = 0; i < info->importCount; i++) {
+        putString(out, info->imports[i], strlen(info->imports[i]));
+    }
+
+    putU32(out, (uint32_t)ctx->nextTempNum);
+    putU32(out, (uint32_t)ctx->nextLabelNum);
+
+    // Id 0 is the empty string every context starts with
+    putU32(out, ctx->strings.count - 1);
+    for (unsigned id = 1; id < ctx->strings.count; id++) {
+        putString(out, ctx->strings.strings[id], ctx->strings.lengths[id]);
+    }
+    putU32(out, ctx->doubleCount);
+    for (unsigned i = 0; i < ctx->doubleCount; i++) {
+        uint64_t bits;
+        memcpy(&bits, &ctx->doubles[i], sizeof(bits));
+        putU64(out, bits);
+    }
+
+    putU32(out, (uint32_t)ctx->instructionCount);
+    for (const IrInstruction *inst = ctx->instructions; inst; inst = inst->next) {
+        putU8(out, inst->op);
+        putOperand(out, inst->result);
+        putOperand(out, inst->ar1);
+        putOperand(out, inst->ar2);
+        putU32(out, (uint32_t)inst->line);
+        putU32(out, (uint32_t)inst->column);
+        putU64(out, (uint64_t)inst->profileCount);
+    }
+
+    int ok = !ferror(out);
+    if (fclose(out) != 0) ok = 0;
+    if (!ok) fprintf(stderr, "Error: Cannot write IR file '%s'\n", path);
+    return ok;
+}
+
+typedef struct IrReader {
+    const unsigned char *data;
+    size_t size;
+    size_t pos;
+    int failed;
+} IrReader;
+
+static const unsigned char *take(IrReader *in, size_t len) {
+    if (in->failed || in->size - in->pos < len) {
+        in->failed = 1;
+        return NULL;
+    }
+    const unsigned char *at = in->data + in->pos;
+    in->pos += len;
+    return at;
+}
+
+static unsigned getU8(IrReader *in) {
+    const unsigned char *at = take(in, 1);
+    return at ? at[0] : 0;
+}
+
+static uint32_t getU32(IrReader *in) {
+    const unsigned char *at = take(in, 4);
+    if (!at) return 0;
+    return (uint32_t)at[0] | (uint32_t)at[1] << 8 | (uint32_t)at[2] << 16 | (uint32_t)at[3] << 24;
+}
+
+static uint64_t getU64(IrReader *in) {
+    uint64_t low = getU32(in);
+    return low | (uint64_t)getU32(in) << 32;
+}
+
+/**
+ * @brief Returns a malloc'd NUL terminated copy, NULL when truncated.
+ */
+static char *getString(IrReader *in, size_t *outLen) {
+    uint32_t len = getU32(in);
+    const unsigned char *at = take(in, len);
+    if (!at) return NULL;
+    char *str = malloc((size_t)len + 1);
+    if (!str) {
+        in->failed = 1;
+        return NULL;
+    }
+    memcpy(str, at, len);
+    str[len] = '\0';
+    if (outLen) *outLen = len;
+    return str;
+}
+
+static int validOperand(const IrContext *ctx, IrOperand op) {
+    if (op.dataType > IR_TYPE_I32X8) return 0;
+    switch (op.type) {
+        case OPERAND_NONE:
+            return 1;
+        case OPERAND_TEMP:
+            return op.value.temp.tempNum > 0 && op.value.temp.tempNum < ctx->nextTempNum;
+        case OPERAND_VAR:
+            return op.value.var.id < ctx->strings.count;
+        case OPERAND_FUNCTION:
+            return op.value.fn.id < ctx->strings.count;
+        case OPERAND_LABEL:
+            return op.value.label.labelNum > 0 && op.value.label.labelNum < ctx->nextLabelNum;
+        case OPERAND_CONSTANT:
+            if (op.dataType == IR_TYPE_STRING) return op.value.constant.index < ctx->strings.count;
+            if (op.dataType == IR_TYPE_DOUBLE || op.dataType == IR_TYPE_I64 || op.dataType == IR_TYPE_U64) {
+                return op.value.constant.index < ctx->doubleCount;
+            }
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static IrOperand getOperand(IrReader *in) {
+    IrOperand op = createNone();
+    op.type = (uint8_t)getU8(in);
+    op.dataType = (uint8_t)getU8(in);
+    uint32_t value = getU32(in);
+    memcpy(&op.value, &value, sizeof(value));
+    return op;
+}
+
+static int readHeader(IrReader *in, IrFileInfo *info, const char *path) {
+    const unsigned char *magic = take(in, sizeof(irMagic));
+    if (!magic || memcmp(magic, irMagic, sizeof(irMagic)) != 0) {
+        fprintf(stderr, "Error: '%s' is not an Orn IR file\n", path);
+        return 0;
+    }
+    uint32_t version = getU32(in);
+    if (version != IR_FILE_VERSION) {
+        fprintf(stderr, "Error: '%s' is IR version %u, this compiler reads version %d\n",
+                path, (unsigned)version, IR_FILE_VERSION);
+        return 0;
+    }
+    info->flags = getU32(in);
+    info->moduleName = getString(in, NULL);
+    info->sourcePath = getString(in, NULL);
+
+    uint32_t imports = getU32(in);
+    if (!in->failed && imports <= in->size - in->pos) {
+        info->imports = calloc(imports ? imports : 1, sizeof(char *));
+        for (uint32_t i = 0; info->imports && i < imports && !in->failed; i++) {
+            info->imports[info->importCount++] = getString(in, NULL);
+        }
+    }
+    if (in->failed || !info->imports || !info->moduleName || !info->sourcePath) {
+        fprintf(stderr, "Error: IR file '%s' is truncated or corrupt\n", path);
+        return 0;
+    }
+    return 1;
+}
+
+static int readBody(IrReader *in, IrContext *ctx) {
+    ctx->nextTempNum = (int)getU32(in);
+    ctx->nextLabelNum = (int)getU32(in);
+    if (ctx->nextTempNum < 1 || ctx->nextLabelNum < 1) return 0;
+
+    uint32_t strings = getU32(in);
+    for (uint32_t i = 0; i < strings && !in->failed; i++) {
+        size_t len;
+        char *str = getString(in, &len);
+        if (!str) return 0;
+        // Written without duplicates, so interning hands back the same ids
+        unsigned id = irIntern(ctx, str, len);
+        free(str);
+        if (id != i + 1) return 0;
+    }
+
+    uint32_t doubles = getU32(in);
+    for (uint32_t i = 0; i < doubles && !in->failed; i++) {
+        uint64_t bits = getU64(in);
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        createDoubleConst(ctx, value);
+        if (ctx->doubleCount != i + 1) return 0;
+    }
+
+    uint32_t count = getU32(in);
+    int inFunction = 0;
+    for (uint32_t i = 0; i < count && !in->failed; i++) {
+        IrInstruction *inst = allocInstruction(ctx);
+        if (!inst) return 0;
+        unsigned op = getU8(in);
+        if (op > IR_LANE_STORE) return 0;
+        inst->op = (IrOpCode)op;
+        inst->result = getOperand(in);
+        inst->ar1 = getOperand(in);
+        inst->ar2 = getOperand(in);
+        if (in->failed || !validOperand(ctx, inst->result) || !validOperand(ctx, inst->ar1) ||
+            !validOperand(ctx, inst->ar2)) {
+            return 0;
+        }
+
+        // Codegen relies on functions being properly bracketed
+        if (inst->op == IR_FUNC_BEGIN) {
+            if (inFunction || inst->result.type != OPERAND_FUNCTION) return 0;
+            inFunction = 1;
+        } else if (inst->op == IR_FUNC_END) {
+            if (!inFunction) return 0;
+            inFunction = 0;
+        }
+
+        ctx->currentLine = (int)getU32(in);
+        ctx->currentColumn = (int)getU32(in);
+        appendInstruction(ctx, inst);
+        inst->profileCount = (long long)getU64(in);
+    }
+    ctx->currentLine = 0;
+    ctx->currentColumn = 0;
+    return !in->failed && !inFunction && in->pos == in->size;
+}
+
+IrContext *readIrFile(const char *path, IrFileInfo *info) {
+    memset(info, 0, sizeof(IrFileInfo));
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot open IR file '%s'\n", path);
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    unsigned char *data = size > 0 ? malloc((size_t)size) : NULL;
+    if (!data || fread(data, 1, (size_t)size, file) != (size_t)size) {
+        fprintf(stderr, "Error: Cannot read IR file '%s'\n", path);
+        free(data);
+        fclose(file);
+        return NULL;
+    }
+    fclose(file);
+
+    IrReader in = {data, (size_t)size, 0, 0};
+    IrContext *ctx = NULL;
+    if (readHeader(&in, info, path)) {
+        ctx = createIrContext();
+        if (ctx && !readBody(&in, ctx)) {
+            fprintf(stderr, "Error: IR file '%s' is truncated or corrupt\n", path);
+            freeIrContext(ctx);
+            ctx = NULL;
+        }
+    }
+    free(data);
+    if (!ctx) freeIrFileInfo(info);
+    return ctx;
+}
+
+void freeIrFileInfo(IrFileInfo *info) {
+    if (!info) return;
+    free(info->moduleName);
+    free(info->sourcePath);
+    for (int i = 0; i < info->importCount; i++) free(info->imports[i]);
+    free(info->imports);
+    memset(info, 0, sizeof(IrFileInfo));
+}
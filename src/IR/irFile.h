@@ -0,0 +1,37 @@
+#ifndef IRFILE_H
+#define IRFILE_H
+
+#include "ir.h"
+
+#define IR_FILE_VERSION 1
+
+#define IR_FILE_ENTRY   1u              // the module holding the program's top-level code
+#define IR_FILE_LAYOUT  2u              // IR went through the -O2 code layout, align when emitting
+
+/**
+ * @brief What codegen needs besides the IR: the module's name, its source
+ * (for -g and listings) and the imported functions calls are bound to.
+ */
+typedef struct IrFileInfo {
+    char *moduleName;
+    char *sourcePath;                   // absolute, may no longer exist when read back
+    unsigned flags;
+    char **imports;                     // "module.function"
+    int importCount;
+} IrFileInfo;
+
+/**
+ * @brief Writes a versioned binary .oir file: header, string and constant
+ * tables, then the instructions in list order. Integers are little endian.
+ * @return 1 on success, 0 after reporting the error
+ */
+int writeIrFile(const char *path, const IrFileInfo *info, const IrContext *ctx);
+
+/**
+ * @brief Reads a file written by writeIrFile, validating every operand.
+ * @return The IR (with info filled in), NULL after reporting the error
+ */
+IrContext *readIrFile(const char *path, IrFileInfo *info);
+void freeIrFileInfo(IrFileInfo *info);
+
+#endif //IRFILE_H
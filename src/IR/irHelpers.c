@@ -19,6 +19,38 @@ int parseInt(const char *start, size_t len){
     return sign * res;
 }
 
+/**
+ * @brief Parses a decimal integer into 64 bits, wrapping like the generated code.
+ */
+long long parseLong(const char *start, size_t len){
+    unsigned long long res = 0;
+    size_t i = start[0] == '-' ? 1 : 0;
+
+    while(i < len && isdigit(start[i])){
+        res = res * 10 + (unsigned long long)(start[i] - '0');
+        i++;
+    }
+
+    return (long long)(start[0] == '-' ? 0 - res : res);
+}
+
+/**
+ * @brief Narrowest type an integer literal fits: 0 int, 1 i64, 2 u64.
+ */
+int intLiteralRank(const char *start, size_t len){
+    int negative = start[0] == '-';
+    unsigned long long magnitude = 0;
+    for (size_t i = negative ? 1 : 0; i < len && isdigit(start[i]); i++) {
+        unsigned digit = (unsigned)(start[i] - '0');
+        if (magnitude > (~0ULL - digit) / 10) return negative ? 1 : 2;
+        magnitude = magnitude * 10 + digit;
+    }
+
+    if (negative) return magnitude <= 0x80000000ULL ? 0 : 1;
+    if (magnitude <= 0x7fffffffULL) return 0;
+    return magnitude <= 0x7fffffffffffffffULL ? 1 : 2;
+}
+
 double parseFloat(const char *start, size_t len){
     double res = 0.0;
     double sign = 1.0;
@@ -4,6 +4,8 @@
 #include <stddef.h>
 
 int parseInt(const char *start, size_t len);
+long long parseLong(const char *start, size_t len);
+int intLiteralRank(const char *start, size_t len);
 double parseFloat(const char *start, size_t len);
 
 int matchLit(const char *start, size_t len, const char *lit);
@@ -0,0 +1,345 @@
+#include "./layout.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct FunctionChunk {
+    IrInstruction *begin;
+    IrInstruction *end;
+    long long heat;                         // entry count from the profile, -1 if unknown
+} FunctionChunk;
+
+typedef struct CallEdge {
+    int caller;                             // 0 is the top-level code, i + 1 is chunk i
+    int callee;
+    long long weight;
+} CallEdge;
+
+static int compareEdgePair(const void *a, const void *b) {
+    const CallEdge *x = a, *y = b;
+    if (x->caller != y->caller) return x->caller - y->caller;
+    return x->callee - y->callee;
+}
+
+static int compareEdgeWeight(const void *a, const void *b) {
+    const CallEdge *x = a, *y = b;
+    if (x->weight != y->weight) return x->weight < y->weight ? 1 : -1;
+    return compareEdgePair(a, b);
+}
+
+static int findChunk(FunctionChunk *chunks, int count, IrOperand fn) {
+    for (int i = 0; i < count; i++) {
+        if (chunks[i].begin->result.value.fn.id == fn.value.fn.id) return i;
+    }
+    return -1;
+}
+
+static void detachRange(IrContext *ctx, IrInstruction *first, IrInstruction *last) {
+    if (first->prev) {
+        first->prev->next = last->next;
+    } else {
+        ctx->instructions = last->next;
+    }
+    if (last->next) {
+        last->next->prev = first->prev;
+    } else {
+        ctx->lastInstruction = first->prev;
+    }
+    first->prev = NULL;
+    last->next = NULL;
+}
+
+static void appendRange(IrContext *ctx, IrInstruction *first, IrInstruction *last) {
+    first->prev = ctx->lastInstruction;
+    if (ctx->lastInstruction) {
+        ctx->lastInstruction->next = first;
+    } else {
+        ctx->instructions = first;
+    }
+    ctx->lastInstruction = last;
+}
+
+/**
+ * @brief Collects the call graph (summed per caller/callee pair).
+ * @return Number of distinct edges, -1 on allocation failure
+ */
+static int collectCallEdges(IrContext *ctx, FunctionChunk *chunks, int chunkCount, CallEdge **outEdges) {
+    int capacity = 64, count = 0;
+    CallEdge *edges = malloc(capacity * sizeof(CallEdge));
+    if (!edges) return -1;
+
+    int node = 0;
+    long long blockWeight = 1;
+    for (IrInstruction *inst = ctx->instructions; inst; inst = inst->next) {
+        if (inst->profileCount >= 0) blockWeight = inst->profileCount;
+        if (inst->op == IR_FUNC_BEGIN) {
+            node = findChunk(chunks, chunkCount, inst->result) + 1;
+            blockWeight = inst->profileCount >= 0 ? inst->profileCount : 1;
+            continue;
+        }
+        if (inst->op == IR_FUNC_END) {
+            node = 0;
+            blockWeight = 1;
+            continue;
+        }
+        if (inst->op != IR_CALL) continue;
+
+        int callee = findChunk(chunks, chunkCount, inst->ar1);
+        if (callee < 0 || callee + 1 == node) continue;
+        if (count == capacity) {
+            CallEdge *grown = realloc(edges, capacity * 2 * sizeof(CallEdge));
+            if (!grown) {
+                free(edges);
+                return -1;
+            }
+            edges = grown;
+            capacity *= 2;
+        }
+        edges[count++] = (CallEdge){node, callee + 1, blockWeight};
+    }
+
+    qsort(edges, count, sizeof(CallEdge), compareEdgePair);
+    int merged = 0;
+    for (int i = 0; i < count; i++) {
+        if (merged > 0 && compareEdgePair(&edges[merged - 1], &edges[i]) == 0) {
+            edges[merged - 1].weight += edges[i].weight;
+        } else {
+            edges[merged++] = edges[i];
+        }
+    }
+    qsort(edges, merged, sizeof(CallEdge), compareEdgeWeight);
+    *outEdges = edges;
+    return merged;
+}
+
+/**
+ * @brief Greedy Pettis-Hansen: walk call edges from the heaviest and
+ * concatenate the caller's cluster with the callee's. The cluster holding
+ * the top-level code stays first since main is emitted before functions.
+ */
+int orderFunctions(IrContext *ctx) {
+    int chunkCount = 0, capacity = 16;
+    FunctionChunk *chunks = malloc(capacity * sizeof(FunctionChunk));
+    if (!chunks) return 0;
+
+    for (IrInstruction *inst = ctx->instructions; inst; inst = inst->next) {
+        if (inst->op != IR_FUNC_BEGIN) continue;
+        IrInstruction *end = inst;
+        while (end && end->op != IR_FUNC_END) end = end->next;
+        if (!end) break;
+        if (chunkCount == capacity) {
+            FunctionChunk *grown = realloc(chunks, capacity * 2 * sizeof(FunctionChunk));
+            if (!grown) break;
+            chunks = grown;
+            capacity *= 2;
+        }
+        chunks[chunkCount++] = (FunctionChunk){inst, end, inst->profileCount};
+        inst = end;
+    }
+    if (chunkCount == 0) {
+        free(chunks);
+        return 0;
+    }
+
+    CallEdge *edges = NULL;
+    int edgeCount = collectCallEdges(ctx, chunks, chunkCount, &edges);
+    int nodes = chunkCount + 1;
+    int *head = malloc(nodes * sizeof(int));        // cluster of each node
+    int *next = malloc(nodes * sizeof(int));        // following node in its cluster
+    int *tail = malloc(nodes * sizeof(int));        // last node, valid for cluster heads
+    int *order = malloc(nodes * sizeof(int));
+    if (edgeCount < 0 || !head || !next || !tail || !order) {
+        free(edges);
+        free(head);
+        free(next);
+        free(tail);
+        free(order);
+        free(chunks);
+        return 0;
+    }
+
+    for (int i = 0; i < nodes; i++) {
+        head[i] = i;
+        next[i] = -1;
+        tail[i] = i;
+    }
+    for (int e = 0; e < edgeCount; e++) {
+        if (edges[e].weight <= 0) break;
+        int first = head[edges[e].caller], second = head[edges[e].callee];
+        if (first == second) continue;
+        if (second == 0) {
+            int swap = first;
+            first = second;
+            second = swap;
+        }
+        next[tail[first]] = second;
+        tail[first] = tail[second];
+        for (int n = second; n >= 0; n = next[n]) head[n] = first;
+    }
+
+    // Top-level cluster first, then the other clusters hottest first
+    int ordered = 0;
+    for (int n = next[0]; n >= 0; n = next[n]) order[ordered++] = n;
+    for (;;) {
+        int best = -1;
+        long long bestHeat = -2;
+        for (int c = 1; c < nodes; c++) {
+            if (head[c] != c || tail[c] < 0) continue;
+            long long heat = -1;
+            for (int n = c; n >= 0; n = next[n]) {
+                if (chunks[n - 1].heat > heat) heat = chunks[n - 1].heat;
+            }
+            if (heat > bestHeat) {
+                best = c;
+                bestHeat = heat;
+            }
+        }
+        if (best < 0) break;
+        for (int n = best; n >= 0; n = next[n]) order[ordered++] = n;
+        tail[best] = -1;
+    }
+
+    for (int i = 0; i < chunkCount; i++) detachRange(ctx, chunks[i].begin, chunks[i].end);
+    for (int i = 0; i < ordered; i++) appendRange(ctx, chunks[order[i] - 1].begin, chunks[order[i] - 1].end);
+
+    free(edges);
+    free(head);
+    free(next);
+    free(tail);
+    free(order);
+    free(chunks);
+    return ordered;
+}
+
+static IrInstruction *createLayoutInst(IrContext *ctx, IrOpCode op, IrOperand result, IrOperand ar1, const IrInstruction *at) {
+    IrInstruction *inst = allocInstruction(ctx);
+    if (!inst) return NULL;
+    inst->op = op;
+    inst->result = result;
+    inst->ar1 = ar1;
+    inst->ar2 = createNone();
+    inst->line = at->line;
+    inst->column = at->column;
+    return inst;
+}
+
+static int endsWithJump(const IrInstruction *inst) {
+    return inst->op == IR_GOTO || inst->op == IR_RETURN || inst->op == IR_RETURN_VOID;
+}
+
+static int isLeader(const IrInstruction *inst, const IrInstruction *start) {
+    if (inst == start || inst->op == IR_LABEL) return 1;
+    IrOpCode prev = inst->prev->op;
+    return prev == IR_GOTO || prev == IR_IF_FALSE || prev == IR_IF_TRUE ||
+           prev == IR_RETURN || prev == IR_RETURN_VOID;
+}
+
+/**
+ * @brief Returns the label number at inst, inserting a fresh LABEL before
+ * it when the block has none.
+ */
+static int blockLabel(IrContext *ctx, IrInstruction **inst) {
+    if ((*inst)->op == IR_LABEL) return (*inst)->result.value.label.labelNum;
+    int label = ctx->nextLabelNum++;
+    IrInstruction *labelInst = createLayoutInst(ctx, IR_LABEL, createLabel(label), createNone(), *inst);
+    if (!labelInst) return -1;
+    insertInstructionBefore(ctx, *inst, labelInst);
+    *inst = labelInst;
+    return label;
+}
+
+static int insertGoto(IrContext *ctx, IrInstruction *before, int label, const IrInstruction *at) {
+    IrInstruction *jump = createLayoutInst(ctx, IR_GOTO, createNone(), createLabel(label), at);
+    if (!jump) return 0;
+    insertInstructionBefore(ctx, before, jump);
+    return 1;
+}
+
+/**
+ * @brief Moves the blocks [first, stop) out of line. Entry by fall-through
+ * and exit by fall-through both become explicit jumps.
+ */
+static int splitRange(IrContext *ctx, IrInstruction *first, IrInstruction *stop, IrInstruction *regionEnd) {
+    IrInstruction *last = stop ? stop->prev : ctx->lastInstruction;
+    if (!endsWithJump(last) && stop == regionEnd) return 0;
+
+    IrInstruction *branch = first->prev;
+    if (branch->op == IR_IF_FALSE && stop && stop->op == IR_LABEL &&
+        branch->ar2.value.label.labelNum == stop->result.value.label.labelNum) {
+        // if (!c) goto after; cold...; after:  becomes  if (c) goto cold
+        int label = blockLabel(ctx, &first);
+        if (label < 0) return 0;
+        branch->op = IR_IF_TRUE;
+        branch->ar2 = createLabel(label);
+    } else if (!endsWithJump(branch)) {
+        int label = blockLabel(ctx, &first);
+        if (label < 0 || !insertGoto(ctx, first, label, first)) return 0;
+    }
+    if (!endsWithJump(last)) {
+        int label = blockLabel(ctx, &stop);
+        if (label < 0 || !insertGoto(ctx, stop, label, last)) return 0;
+    }
+
+    IrInstruction *begin = createLayoutInst(ctx, IR_COLD_BEGIN, createNone(), createNone(), first);
+    IrInstruction *end = createLayoutInst(ctx, IR_COLD_END, createNone(), createNone(), first);
+    if (!begin || !end) return 0;
+    insertInstructionBefore(ctx, first, begin);
+    if (stop) {
+        insertInstructionBefore(ctx, stop, end);
+    } else {
+        end->prev = ctx->lastInstruction;
+        ctx->lastInstruction->next = end;
+        ctx->lastInstruction = end;
+        ctx->instructionCount++;
+    }
+    return 1;
+}
+
+static int isExitCall(IrContext *ctx, const IrInstruction *inst) {
+    return inst->op == IR_CALL && inst->ar1.type == OPERAND_FUNCTION &&
+           strcmp(irString(ctx, inst->ar1.value.fn.id, NULL), "exit") == 0;
+}
+
+static int splitRegion(IrContext *ctx, IrInstruction *start, IrInstruction *regionEnd, long long entry) {
+    int split = 0;
+    IrInstruction *coldFirst = NULL;
+    IrInstruction *inst = start;
+    while (inst != regionEnd) {
+        // One block: [inst, blockEnd)
+        IrInstruction *blockEnd = inst->next;
+        while (blockEnd != regionEnd && !isLeader(blockEnd, start)) blockEnd = blockEnd->next;
+
+        int cold = 0;
+        if (inst != start) {
+            cold = entry > 0 && inst->profileCount == 0;
+            for (IrInstruction *i = inst; i != blockEnd && !cold; i = i->next) cold = isExitCall(ctx, i);
+        }
+        if (cold && !coldFirst) coldFirst = inst;
+        if (!cold && coldFirst) {
+            split += splitRange(ctx, coldFirst, inst, regionEnd);
+            coldFirst = NULL;
+        }
+        inst = blockEnd;
+    }
+    if (coldFirst) split += splitRange(ctx, coldFirst, regionEnd, regionEnd);
+    return split;
+}
+
+int splitColdCode(IrContext *ctx) {
+    int split = 0;
+    IrInstruction *inst = ctx->instructions;
+    while (inst) {
+        if (inst->op == IR_FUNC_BEGIN) {
+            IrInstruction *end = inst->next;
+            while (end && end->op != IR_FUNC_END) end = end->next;
+            if (!end) break;
+            if (inst->next != end) split += splitRegion(ctx, inst->next, end, inst->profileCount);
+            inst = end->next;
+        } else {
+            IrInstruction *end = inst->next;
+            while (end && end->op != IR_FUNC_BEGIN) end = end->next;
+            split += splitRegion(ctx, inst, end, inst->profileCount);
+            inst = end;
+        }
+    }
+    return split;
+}
@@ -0,0 +1,23 @@
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include "ir.h"
+
+/**
+ * @brief Moves every function body after the top-level code, ordered by
+ * call-graph affinity: callers and their hottest callees end up adjacent.
+ * Call sites are weighted by their block's profile count when one is known.
+ * @return Number of functions laid out
+ */
+int orderFunctions(IrContext *ctx);
+
+/**
+ * @brief Brackets cold blocks with COLD_BEGIN/COLD_END so codegen moves them
+ * to .text.unlikely. A block is cold when it calls exit or when the profile
+ * never reached it although its function ran. Run after orderFunctions and
+ * after the optimizer, which does not know about the markers.
+ * @return Number of cold ranges split out
+ */
+int splitColdCode(IrContext *ctx);
+
+#endif //LAYOUT_H
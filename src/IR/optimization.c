@@ -1,97 +1,155 @@
 #include "./ir.h"
+#include <stdio.h>
 #include <stdlib.h>
-#include "./irHelpers.h"
+#include <string.h>
+#include "./optimization.h"
 
 int binaryConstant(IrInstruction *inst){
     return inst->ar1.type == OPERAND_CONSTANT && inst->ar2.type == OPERAND_CONSTANT;
 }
 
-int constantFolding(IrContext *ctx){
-    int changed = 0;
-    IrInstruction *inst = ctx->instructions;
-    while(inst){
-        if(binaryConstant(inst)){
-            switch(inst->op){
-                case IR_ADD: {
-                    inst->op = IR_COPY;
-                    switch(inst->result.dataType){
-                        case IR_TYPE_INT: inst->ar1 = createIntConst(inst->ar1.value.constant.intVal + inst->ar2.value.constant.intVal); break;
-                        case IR_TYPE_FLOAT: inst->ar1 = createFloatConst(inst->ar1.value.constant.floatVal + inst->ar2.value.constant.floatVal); break;
-                        case IR_TYPE_DOUBLE: inst->ar1 = createDoubleConst(inst->ar1.value.constant.doubleVal + inst->ar2.value.constant.doubleVal); break;
-                        default: break;
-                    }
-                    break;
-                }
-                case IR_SUB: {
-                    inst->op = IR_COPY;
-                    switch(inst->result.dataType){
-                        case IR_TYPE_INT: inst->ar1 = createIntConst(inst->ar1.value.constant.intVal - inst->ar2.value.constant.intVal); break;
-                        case IR_TYPE_FLOAT: inst->ar1 = createFloatConst(inst->ar1.value.constant.floatVal - inst->ar2.value.constant.floatVal); break;
-                        case IR_TYPE_DOUBLE: inst->ar1 = createDoubleConst(inst->ar1.value.constant.doubleVal - inst->ar2.value.constant.doubleVal); break;
-                        default: break;
-                    }
-                    break;
-                }
-                case IR_MUL: {
-                    inst->op = IR_COPY;
-                    switch(inst->result.dataType){
-                        case IR_TYPE_INT: inst->ar1 = createIntConst(inst->ar1.value.constant.intVal * inst->ar2.value.constant.intVal); break;
-                        case IR_TYPE_FLOAT: inst->ar1 = createFloatConst(inst->ar1.value.constant.floatVal * inst->ar2.value.constant.floatVal); break;
-                        case IR_TYPE_DOUBLE: inst->ar1 = createDoubleConst(inst->ar1.value.constant.doubleVal * inst->ar2.value.constant.doubleVal); break;
-                        default: break;
-                    }
-                    break;
-                }
-                case IR_DIV: {
-                    inst->op = IR_COPY;
-                    switch(inst->result.dataType){
-                        case IR_TYPE_INT: inst->ar1 = createIntConst(inst->ar1.value.constant.intVal / inst->ar2.value.constant.intVal); break;
-                        case IR_TYPE_FLOAT: inst->ar1 = createFloatConst(inst->ar1.value.constant.floatVal / inst->ar2.value.constant.floatVal); break;
-                        case IR_TYPE_DOUBLE: inst->ar1 = createDoubleConst(inst->ar1.value.constant.doubleVal / inst->ar2.value.constant.doubleVal); break;
-                        default: break;
-                    }
-                    break;
-                }
-                case IR_BIT_AND: {
-                    inst->op = IR_COPY;
-                    inst->ar1 = createIntConst(inst->ar1.value.constant.intVal & inst->ar2.value.constant.intVal);
-                    break;
-                }
-                case IR_BIT_OR: {
-                    inst->op = IR_COPY;
-                    inst->ar1 = createIntConst(inst->ar1.value.constant.intVal | inst->ar2.value.constant.intVal);
-                    break;
-                }
-                case IR_BIT_XOR: {
-                    inst->op = IR_COPY;
-                    inst->ar1 = createIntConst(inst->ar1.value.constant.intVal ^ inst->ar2.value.constant.intVal);
-                    break;
-                }
-                case IR_SHL: {
-                    inst->op = IR_COPY;
-                    inst->ar1 = createIntConst(inst->ar1.value.constant.intVal << inst->ar2.value.constant.intVal);
-                    break;
-                }
-                case IR_SHR: {
-                    inst->op = IR_COPY;
-                    inst->ar1 = createIntConst(inst->ar1.value.constant.intVal >> inst->ar2.value.constant.intVal);
-                    break;
-                }
-                default: break;
+static int isComparison(IrOpCode op) {
+    return op == IR_EQ || op == IR_NE || op == IR_LT || op == IR_LE || op == IR_GT || op == IR_GE;
+}
+
+static int compareResult(IrOpCode op, double a, double b) {
+    switch (op) {
+        case IR_EQ: return a == b;
+        case IR_NE: return a != b;
+        case IR_LT: return a < b;
+        case IR_LE: return a <= b;
+        case IR_GT: return a > b;
+        default: return a >= b;
+    }
+}
+
+static int compareInteger(IrOpCode op, long long a, long long b, int isUnsigned) {
+    if (isUnsigned) {
+        unsigned long long ua = (unsigned long long)a, ub = (unsigned long long)b;
+        return op == IR_EQ ? ua == ub : op == IR_NE ? ua != ub : op == IR_LT ? ua < ub
+             : op == IR_LE ? ua <= ub : op == IR_GT ? ua > ub : ua >= ub;
+    }
+    return op == IR_EQ ? a == b : op == IR_NE ? a != b : op == IR_LT ? a < b
+         : op == IR_LE ? a <= b : op == IR_GT ? a > b : a >= b;
+}
+
+/**
+ * @brief Folds an integer operation on operands already extended from their
+ * type, with the wrapping semantics of the generated code; the caller
+ * truncates the result back to the type. Division by zero and MIN / -1 on
+ * 32 and 64-bit types trap at runtime, so they are left alone.
+ * @return 0 when the operation cannot be folded
+ */
+static int foldInteger(IrOpCode op, IrDataType type, long long a, long long b, long long *out) {
+    unsigned long long ua = (unsigned long long)a, ub = (unsigned long long)b;
+    int bits = irIntBits(type);
+    // narrow types are computed in 32-bit registers, so shift counts wrap at 32
+    unsigned count = (unsigned)(ub & (bits == 64 ? 63 : 31));
+    switch (op) {
+        case IR_ADD: *out = (long long)(ua + ub); return 1;
+        case IR_SUB: *out = (long long)(ua - ub); return 1;
+        case IR_MUL: *out = (long long)(ua * ub); return 1;
+        case IR_DIV:
+        case IR_MOD:
+            if (b == 0) return 0;
+            if (irIsUnsigned(type)) {
+                *out = (long long)(op == IR_DIV ? ua / ub : ua % ub);
+                return 1;
             }
-            inst->ar2 = createNone();
-            changed = 1;
+            if (b == -1 && ((bits == 64 && a == (long long)(1ULL << 63)) || (bits == 32 && a == -2147483648LL))) {
+                return 0;
+            }
+            *out = op == IR_DIV ? a / b : a % b;
+            return 1;
+        case IR_BIT_AND: *out = a & b; return 1;
+        case IR_BIT_OR: *out = a | b; return 1;
+        case IR_BIT_XOR: *out = a ^ b; return 1;
+        // shr is logical for unsigned types and arithmetic for signed ones
+        case IR_SHL: *out = (long long)(ua << count); return 1;
+        case IR_SHR: *out = irIsUnsigned(type) ? (long long)(ua >> count) : a >> count; return 1;
+        default: return 0;
+    }
+}
+
+static int foldDouble(IrOpCode op, double a, double b, double *out) {
+    switch (op) {
+        case IR_ADD: *out = a + b; return 1;
+        case IR_SUB: *out = a - b; return 1;
+        case IR_MUL: *out = a * b; return 1;
+        case IR_DIV: *out = a / b; return 1;
+        default: return 0;
+    }
+}
+
+static int foldBinary(IrContext *ctx, IrInstruction *inst) {
+    IrOperand a = inst->ar1, b = inst->ar2;
+    if (a.dataType != b.dataType) return 0;
+
+    IrOperand folded;
+    switch (a.dataType) {
+        case IR_TYPE_BOOL: {
+            if (isComparison(inst->op)) {
+                folded = createBoolConst(compareResult(inst->op, a.value.constant.intVal,
+                                                       b.value.constant.intVal));
+            } else if (inst->op == IR_AND || inst->op == IR_OR) {
+                int l = a.value.constant.intVal != 0, r = b.value.constant.intVal != 0;
+                folded = createBoolConst(inst->op == IR_AND ? l && r : l || r);
+            } else {
+                return 0;
+            }
+            break;
+        }
+        case IR_TYPE_FLOAT:
+        case IR_TYPE_DOUBLE: {
+            int isFloat = a.dataType == IR_TYPE_FLOAT;
+            double l = isFloat ? a.value.constant.floatVal : irDouble(ctx, a);
+            double r = isFloat ? b.value.constant.floatVal : irDouble(ctx, b);
+            double value;
+            if (isComparison(inst->op)) {
+                folded = createBoolConst(compareResult(inst->op, l, r));
+            } else if (!foldDouble(inst->op, l, r, &value)) {
+                return 0;
+            } else if (isFloat) {
+                // exact in double, so one rounding gives the float result
+                folded = createFloatConst((float)value);
+            } else {
+                folded = createDoubleConst(ctx, value);
+            }
+            break;
+        }
+        default: {
+            if (!irIsInteger(a.dataType)) return 0;
+            long long l = irIntValue(ctx, a), r = irIntValue(ctx, b), value;
+            if (isComparison(inst->op)) {
+                folded = createBoolConst(compareInteger(inst->op, l, r, irIsUnsigned(a.dataType)));
+            } else if (foldInteger(inst->op, a.dataType, l, r, &value)) {
+                folded = createSizedIntConst(ctx, a.dataType, value);
+            } else {
+                return 0;
+            }
+            break;
         }
-        inst = inst->next;
     }
-    return changed;
+
+    inst->op = IR_COPY;
+    inst->ar1 = folded;
+    inst->ar2 = createNone();
+    return 1;
+}
+
+int constantFolding(IrContext *ctx){
+    int folded = 0;
+    for (IrInstruction *inst = ctx->instructions; inst; inst = inst->next) {
+        if (binaryConstant(inst) && inst->op != IR_CALL) folded += foldBinary(ctx, inst);
+    }
+    return folded;
 }
 
 int operandsEqual(IrOperand a, IrOperand b) {
     if (a.type != b.type) return 0;
     switch (a.type) {
         case OPERAND_TEMP: return a.value.temp.tempNum == b.value.temp.tempNum;
-        case OPERAND_VAR: return bufferEqual(a.value.var.name, a.value.var.nameLen, b.value.var.name, b.value.var.nameLen);
+        case OPERAND_VAR: return a.value.var.id == b.value.var.id;
         case OPERAND_LABEL: return a.value.label.labelNum == b.value.label.labelNum;
         default:
             return 0;
@@ -102,115 +160,549 @@ int isReplaceable(IrOperand op){
     return op.type == OPERAND_VAR || op.type == OPERAND_TEMP;
 }
 
+/**
+ * @brief Stores write through their result operand, so for them it is a read.
+ */
+static int readsResult(IrOpCode op) {
+    return op == IR_MEMBER_STORE || op == IR_POINTER_STORE || op == IR_VEC_STORE || op == IR_LANE_STORE;
+}
+
+/**
+ * @brief Variables that live in memory: address taken, arrays, structs and
+ * vectors written a lane at a time.
+ * Their value can change behind a plain copy, so neither copy propagation
+ * nor dead code elimination may reason about them.
+ */
+static IrOperand memoryOperand(IrInstruction *inst) {
+    switch (inst->op) {
+        case IR_ADDROF:
+        case IR_POINTER_LOAD:
+        case IR_MEMBER_LOAD:
+        case IR_VEC_LOAD:
+            return inst->ar1;
+        case IR_POINTER_STORE:
+        case IR_MEMBER_STORE:
+        case IR_VEC_STORE:
+        case IR_LANE_STORE:
+        case IR_ALLOC_STRUCT:
+        case IR_REQ_MEM:
+            return inst->result;
+        default:
+            return createNone();
+    }
+}
+
+static int isPure(IrOpCode op) {
+    switch (op) {
+        case IR_ADD: case IR_SUB: case IR_MUL: case IR_DIV: case IR_MOD: case IR_NEG:
+        case IR_BIT_AND: case IR_BIT_OR: case IR_BIT_XOR: case IR_BIT_NOT: case IR_SHL: case IR_SHR:
+        case IR_AND: case IR_OR: case IR_NOT:
+        case IR_EQ: case IR_NE: case IR_LT: case IR_LE: case IR_GT: case IR_GE:
+        case IR_COPY: case IR_CAST: case IR_MEMBER_LOAD: case IR_POINTER_LOAD: case IR_DEREF:
+        case IR_ADDROF:
+        case IR_VEC_SPLAT: case IR_VEC_LOAD: case IR_VEC_SHUFFLE: case IR_VEC_REDUCE: case IR_LANE_LOAD:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief Set of operands keyed by the function they appear in. Top-level
+ * statements are one region even when function definitions split them.
+ */
+typedef struct OperandSet {
+    IrOperand *ops;
+    int *regions;
+    int capacity;
+    int count;
+} OperandSet;
+
+static unsigned hashOperand(IrOperand op, int region) {
+    unsigned h = 2166136261u ^ (unsigned)region;
+    if (op.type == OPERAND_TEMP) return (h ^ (unsigned)op.value.temp.tempNum) * 16777619u;
+    return (h ^ ~op.value.var.id) * 16777619u;
+}
+
+static int findOperand(OperandSet *set, IrOperand op, int region, int insert) {
+    if (!isReplaceable(op) || !set->capacity) return 0;
+    unsigned mask = (unsigned)set->capacity - 1;
+    for (unsigned i = hashOperand(op, region) & mask;; i = (i + 1) & mask) {
+        if (set->ops[i].type == OPERAND_NONE) {
+            if (insert && set->count * 2 < set->capacity) {
+                set->ops[i] = op;
+                set->regions[i] = region;
+                set->count++;
+            }
+            return 0;
+        }
+        if (set->regions[i] == region && operandsEqual(set->ops[i], op)) return 1;
+    }
+}
+
+static int initOperandSet(OperandSet *set, int instructions) {
+    // Up to 3 operands per instruction, kept at most half full
+    set->capacity = 16;
+    while (set->capacity < instructions * 6) set->capacity *= 2;
+    set->ops = malloc(set->capacity * sizeof(IrOperand));
+    set->regions = malloc(set->capacity * sizeof(int));
+    set->count = 0;
+    if (!set->ops || !set->regions) {
+        free(set->ops);
+        free(set->regions);
+        return 0;
+    }
+    for (int i = 0; i < set->capacity; i++) set->ops[i] = createNone();
+    return 1;
+}
+
+static void freeOperandSet(OperandSet *set) {
+    free(set->ops);
+    free(set->regions);
+}
+
+static int nextRegion(IrInstruction *inst, int region, int *functions) {
+    if (inst->op == IR_FUNC_BEGIN) return ++*functions;
+    if (inst->prev && inst->prev->op == IR_FUNC_END) return 0;
+    return region;
+}
+
+static int collectMemoryOperands(IrContext *ctx, OperandSet *memory) {
+    if (!initOperandSet(memory, ctx->instructionCount)) return 0;
+    int region = 0, functions = 0;
+    for (IrInstruction *inst = ctx->instructions; inst; inst = inst->next) {
+        region = nextRegion(inst, region, &functions);
+        findOperand(memory, memoryOperand(inst), region, 1);
+    }
+    return 1;
+}
+
+/**
+ * @brief Forwards the source of COPY d, s into later reads of d. Only the
+ * rest of the basic block is scanned: a label may be reached from a loop
+ * back-edge or another branch where d holds something else.
+ */
 int copyProp(IrContext *ctx){
+    OperandSet memory;
+    if (!collectMemoryOperands(ctx, &memory)) return 0;
+
+    int propagated = 0;
+    int region = 0, functions = 0;
+    for (IrInstruction *inst = ctx->instructions; inst; inst = inst->next) {
+        region = nextRegion(inst, region, &functions);
+        if (inst->op != IR_COPY || !isReplaceable(inst->result)) continue;
+        if (inst->ar1.type != OPERAND_CONSTANT && !isReplaceable(inst->ar1)) continue;
+        if (inst->ar1.dataType != inst->result.dataType) continue;
+        if (findOperand(&memory, inst->result, region, 0) || findOperand(&memory, inst->ar1, region, 0)) {
+            continue;
+        }
+
+        for (IrInstruction *scan = inst->next; scan; scan = scan->next) {
+            if (scan->op == IR_LABEL || scan->op == IR_FUNC_BEGIN || scan->op == IR_FUNC_END) break;
+
+            if (isReplaceable(scan->ar1) && operandsEqual(scan->ar1, inst->result)) {
+                scan->ar1 = inst->ar1;
+                propagated++;
+            }
+            if (isReplaceable(scan->ar2) && operandsEqual(scan->ar2, inst->result)) {
+                scan->ar2 = inst->ar1;
+                propagated++;
+            }
+            // Stop once either side of the copy is overwritten
+            if (!readsResult(scan->op) && (operandsEqual(scan->result, inst->result) ||
+                                           operandsEqual(scan->result, inst->ar1))) {
+                break;
+            }
+        }
+    }
+
+    freeOperandSet(&memory);
+    return propagated;
+}
+
+/**
+ * @brief Removes side-effect free instructions whose result is never read
+ * anywhere in the same function. Reads before the definition count too,
+ * since a loop back-edge can carry the value there. One sweep; removing an
+ * instruction can make its operands dead, so the pass manager reruns it.
+ */
+int deadCodeElimination(IrContext *ctx) {
+    OperandSet used, memory;
+    if (!collectMemoryOperands(ctx, &memory)) return 0;
+    if (!initOperandSet(&used, ctx->instructionCount)) {
+        freeOperandSet(&memory);
+        return 0;
+    }
+
+    int region = 0, functions = 0;
+    for (IrInstruction *inst = ctx->instructions; inst; inst = inst->next) {
+        region = nextRegion(inst, region, &functions);
+        findOperand(&used, inst->ar1, region, 1);
+        findOperand(&used, inst->ar2, region, 1);
+        if (readsResult(inst->op)) findOperand(&used, inst->result, region, 1);
+    }
+
+    int removed = 0;
+    region = 0;
+    functions = 0;
+    IrInstruction *inst = ctx->instructions;
+    while (inst) {
+        region = nextRegion(inst, region, &functions);
+        if (isPure(inst->op) && isReplaceable(inst->result) &&
+            !findOperand(&used, inst->result, region, 0) &&
+            !findOperand(&memory, inst->result, region, 0)) {
+            inst = removeInstruction(ctx, inst);
+            removed++;
+            continue;
+        }
+        inst = inst->next;
+    }
+
+    freeOperandSet(&used);
+    freeOperandSet(&memory);
+    return removed;
+}
+
+static int isBranch(IrInstruction *inst) {
+    return inst->op == IR_GOTO || inst->op == IR_IF_FALSE;
+}
+
+static IrOperand *branchTarget(IrInstruction *inst) {
+    return inst->op == IR_GOTO ? &inst->ar1 : &inst->ar2;
+}
+
+static int endsBlock(IrInstruction *inst) {
+    return inst->op == IR_GOTO || inst->op == IR_RETURN || inst->op == IR_RETURN_VOID;
+}
+
+static int isConstantTrue(IrContext *ctx, IrOperand op) {
+    switch (op.dataType) {
+        case IR_TYPE_FLOAT: return op.value.constant.floatVal != 0.0f;
+        case IR_TYPE_DOUBLE: return irDouble(ctx, op) != 0.0;
+        default: return irIntValue(ctx, op) != 0;
+    }
+}
+
+/**
+ * @brief Skips over consecutive labels, returning the first real instruction.
+ */
+static IrInstruction *skipLabels(IrInstruction *inst) {
+    while (inst && inst->op == IR_LABEL) inst = inst->next;
+    return inst;
+}
+
+/**
+ * @brief Rewrites IF_FALSE on a constant condition into a GOTO or drops it.
+ */
+static int foldConstantBranches(IrContext *ctx) {
+    int changed = 0;
+    IrInstruction *inst = ctx->instructions;
+    while (inst) {
+        if (inst->op == IR_IF_FALSE && inst->ar1.type == OPERAND_CONSTANT) {
+            changed++;
+            if (isConstantTrue(ctx, inst->ar1)) {
+                inst = removeInstruction(ctx, inst);
+                continue;
+            }
+            inst->op = IR_GOTO;
+            inst->ar1 = inst->ar2;
+            inst->ar2 = createNone();
+        }
+        inst = inst->next;
+    }
+    return changed;
+}
+
+/**
+ * @brief Retargets branches whose destination block is only a GOTO.
+ *
+ * Labels are numbered densely from 1, so a flat table indexed by label
+ * number resolves every target in O(1).
+ */
+static int threadJumps(IrContext *ctx) {
+    int labelCount = ctx->nextLabelNum;
+    IrInstruction **labels = calloc(labelCount, sizeof(IrInstruction *));
+    if (!labels) return 0;
+
+    for (IrInstruction *inst = ctx->instructions; inst; inst = inst->next) {
+        if (inst->op == IR_LABEL) {
+            int num = inst->result.value.label.labelNum;
+            if (num > 0 && num < labelCount) labels[num] = inst;
+        }
+    }
+
+    int changed = 0;
+    for (IrInstruction *inst = ctx->instructions; inst; inst = inst->next) {
+        if (!isBranch(inst)) continue;
+
+        IrOperand *target = branchTarget(inst);
+        int num = target->value.label.labelNum;
+        // bounded so a cycle of empty blocks cannot spin forever
+        for (int hops = 0; hops < labelCount; hops++) {
+            if (num <= 0 || num >= labelCount || !labels[num]) break;
+            IrInstruction *dest = skipLabels(labels[num]);
+            if (!dest || dest->op != IR_GOTO) break;
+            int next = dest->ar1.value.label.labelNum;
+            if (next == num) break;
+            num = next;
+        }
+
+        if (num != target->value.label.labelNum) {
+            target->value.label.labelNum = num;
+            changed++;
+        }
+    }
+
+    free(labels);
+    return changed;
+}
+
+/**
+ * @brief Deletes instructions after a GOTO or RETURN until the next label.
+ */
+static int removeUnreachable(IrContext *ctx) {
+    int changed = 0;
+    IrInstruction *inst = ctx->instructions;
+    while (inst) {
+        if (endsBlock(inst)) {
+            IrInstruction *dead = inst->next;
+            while (dead && dead->op != IR_LABEL && dead->op != IR_FUNC_END &&
+                   dead->op != IR_FUNC_BEGIN) {
+                dead = removeInstruction(ctx, dead);
+                changed++;
+            }
+        }
+        inst = inst->next;
+    }
+    return changed;
+}
+
+/**
+ * @brief Drops branches that land on the label right after them.
+ */
+static int removeJumpsToNext(IrContext *ctx) {
     int changed = 0;
     IrInstruction *inst = ctx->instructions;
-    while (inst){
-        if((inst->op == IR_COPY || inst->op == IR_CAST) && isReplaceable(inst->result) && ((inst->ar1.type == OPERAND_CONSTANT) || isReplaceable(inst->ar1))){
+    while (inst) {
+        if (isBranch(inst)) {
+            int num = branchTarget(inst)->value.label.labelNum;
             IrInstruction *scan = inst->next;
-            while (scan && !(scan->op == IR_FUNC_BEGIN || scan->op == IR_FUNC_END)) {
-                if (isReplaceable(scan->ar1) && operandsEqual(scan->ar1, inst->result)) {
-                    scan->ar1 = inst->ar1;
-                    changed = 1;
-                }
-                if (isReplaceable(scan->ar2) && operandsEqual(scan->ar2, inst->result)) {
-                    scan->ar2 = inst->ar1;
-                    changed = 1;
-                }
-                if (isReplaceable(scan->result) && operandsEqual(scan->result, inst->result)) {
-                    break;
-                }
-                
+            while (scan && scan->op == IR_LABEL && scan->result.value.label.labelNum != num) {
                 scan = scan->next;
             }
+            if (scan && scan->op == IR_LABEL) {
+                inst = removeInstruction(ctx, inst);
+                changed++;
+                continue;
+            }
         }
         inst = inst->next;
     }
     return changed;
 }
 
-int deadCodeElimination(IrContext *ctx) {
-    int changed;
+/**
+ * @brief Removes labels no branch refers to, merging the blocks around them.
+ */
+static int removeUnusedLabels(IrContext *ctx) {
+    int labelCount = ctx->nextLabelNum;
+    char *used = calloc(labelCount, 1);
+    if (!used) return 0;
 
-    do {
-        changed = 0;
-        IrInstruction *inst = ctx->instructions;
-
-        while (inst) {
-            if ((inst->result.type == OPERAND_TEMP || inst->result.type == OPERAND_VAR) &&
-                inst->op != IR_CALL && inst->op != IR_PARAM && 
-                inst->op != IR_RETURN && inst->op != IR_RETURN_VOID) {
-
-                int isUsed = 0;
-                IrInstruction *scan = inst->next;
-
-                while (scan && !(scan->op == IR_FUNC_BEGIN || scan->op == IR_FUNC_END)) {
-                    if (operandsEqual(scan->ar1, inst->result)) {
-                        isUsed = 1;
-                        break;
-                    }
-
-                    if (operandsEqual(scan->ar2, inst->result)) {
-                        isUsed = 1;
-                        break;
-                    }
-
-                    if (operandsEqual(scan->result, inst->result)) {
-                        break;
-                    }
-                    scan = scan->next;
-                }
-
-                if (!isUsed) {
-                    IrInstruction *toDelete = inst;
-                    inst = inst->next;
-
-                    if (toDelete->prev) {
-                        toDelete->prev->next = toDelete->next;
-                    } else {
-                        ctx->instructions = toDelete->next;
-                    }
-
-                    if (toDelete->next) {
-                        toDelete->next->prev = toDelete->prev;
-                    } else {
-                        ctx->lastInstruction = toDelete->prev;
-                    }
-
-                    free(toDelete);
-                    ctx->instructionCount--;
-                    changed = 1;
-                    continue;
-                }
-            }
-
-            inst = inst->next;
-        }
-    } while (changed);
+    for (IrInstruction *inst = ctx->instructions; inst; inst = inst->next) {
+        if (!isBranch(inst)) continue;
+        int num = branchTarget(inst)->value.label.labelNum;
+        if (num > 0 && num < labelCount) used[num] = 1;
+    }
+
+    int changed = 0;
+    IrInstruction *inst = ctx->instructions;
+    while (inst) {
+        if (inst->op == IR_LABEL) {
+            int num = inst->result.value.label.labelNum;
+            if (num > 0 && num < labelCount && !used[num]) {
+                inst = removeInstruction(ctx, inst);
+                changed++;
+                continue;
+            }
+        }
+        inst = inst->next;
+    }
+
+    free(used);
+    return changed;
+}
+
+/**
+ * @brief CFG cleanup: constant branch folding, jump threading, unreachable
+ * code removal and block merging. One sweep of each; the pass manager
+ * reruns it until nothing changes.
+ */
+int simplifyCFG(IrContext *ctx) {
+    int changed = 0;
+    changed += foldConstantBranches(ctx);
+    changed += threadJumps(ctx);
+    changed += removeUnreachable(ctx);
+    changed += removeJumpsToNext(ctx);
+    changed += removeUnusedLabels(ctx);
     return changed;
 }
 
-void optimizeIR(IrContext *ctx, int optLevel) {
-    if (optLevel == 0) return;
-    
-    int maxPasses;
-    switch (optLevel) {
-        case 1: maxPasses = 3; break;
-        case 2: maxPasses = 5; break;
-        case 3: maxPasses = 10; break;
-        default: maxPasses = 0; break;
+enum {
+    PASS_CONST_FOLD,
+    PASS_COPY_PROP,
+    PASS_DCE,
+    PASS_SIMPLIFY_CFG,
+    PASS_COUNT,
+};
+
+static const OptPass passRegistry[PASS_COUNT] = {
+    [PASS_CONST_FOLD] = {"const-fold", "fold operations on constant operands", constantFolding, 0},
+    [PASS_COPY_PROP] = {"copy-prop", "forward copies into later reads in the same block", copyProp, 0},
+    [PASS_DCE] = {"dce", "remove side-effect free instructions whose result is unused", deadCodeElimination, 1},
+    [PASS_SIMPLIFY_CFG] = {"simplify-cfg", "fold constant branches, thread jumps, drop dead blocks", simplifyCFG, 1},
+};
+
+typedef struct OptPipeline {
+    int iterations;
+    int length;
+    int passes[OPT_MAX_PIPELINE];
+} OptPipeline;
+
+// Indexed by -O level; the pipeline repeats until it changes nothing or runs out of iterations
+static const OptPipeline levelPipelines[] = {
+    {0, 0, {0}},
+    {3, 4, {PASS_CONST_FOLD, PASS_COPY_PROP, PASS_CONST_FOLD, PASS_DCE}},
+    {5, 6, {PASS_CONST_FOLD, PASS_SIMPLIFY_CFG, PASS_COPY_PROP, PASS_CONST_FOLD, PASS_DCE, PASS_SIMPLIFY_CFG}},
+    {10, 6, {PASS_CONST_FOLD, PASS_SIMPLIFY_CFG, PASS_COPY_PROP, PASS_CONST_FOLD, PASS_DCE, PASS_SIMPLIFY_CFG}},
+};
+
+int optPassCount(void) {
+    return PASS_COUNT;
+}
+
+const OptPass *getOptPass(int index) {
+    return index >= 0 && index < PASS_COUNT ? &passRegistry[index] : NULL;
+}
+
+int findOptPass(const char *name, size_t len) {
+    for (int i = 0; i < PASS_COUNT; i++) {
+        if (strlen(passRegistry[i].name) == len && memcmp(passRegistry[i].name, name, len) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int parseOptPassList(const char *list, int *out, int max) {
+    int count = 0;
+    const char *p = list;
+    while (*p) {
+        const char *end = strchr(p, ',');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        if (len == 3 && memcmp(p, "all", 3) == 0) {
+            for (int i = 0; i < PASS_COUNT && count < max; i++) out[count++] = i;
+        } else if (len > 0) {
+            int index = findOptPass(p, len);
+            if (index < 0) {
+                fprintf(stderr, "Error: Unknown optimization pass '%.*s' (see --list-passes)\n", (int)len, p);
+                return -1;
+            }
+            if (count == max) {
+                fprintf(stderr, "Error: Too many passes (max %d)\n", max);
+                return -1;
+            }
+            out[count++] = index;
+        }
+        if (!end) break;
+        p = end + 1;
+    }
+    return count;
+}
+
+void printOptPasses(FILE *out) {
+    for (int i = 0; i < PASS_COUNT; i++) {
+        fprintf(out, "    %-14s %s\n", passRegistry[i].name, passRegistry[i].description);
     }
-    
-    for (int pass = 0; pass < maxPasses; pass++) {
+    for (int level = 1; level <= 3; level++) {
+        const OptPipeline *pipeline = &levelPipelines[level];
+        fprintf(out, "  -O%d (up to %d iterations):", level, pipeline->iterations);
+        for (int i = 0; i < pipeline->length; i++) {
+            fprintf(out, " %s", passRegistry[pipeline->passes[i]].name);
+        }
+        fprintf(out, "\n");
+    }
+}
+
+/**
+ * @brief Runs one pass, timing it when a build timer is attached. Passes
+ * marked fixedPoint are rerun until they report no change.
+ * @return total number of changes
+ */
+static int runPass(IrContext *ctx, int index, BuildTimer *timer, OptStats *stats) {
+    const OptPass *pass = &passRegistry[index];
+    int total = 0;
+    int changes;
+
+    do {
+        int sample = timerBegin(timer, pass->name);
+        changes = pass->run(ctx);
+        timerEnd(timer, sample);
+        total += changes;
+        if (stats) {
+            stats->runs[index]++;
+            stats->changes[index] += changes;
+        }
+    } while (pass->fixedPoint && changes > 0);
+
+    return total;
+}
+
+void optimizeIR(IrContext *ctx, int optLevel, const OptOptions *opts, OptStats *stats, BuildTimer *timer) {
+    if (optLevel < 0) optLevel = 0;
+    if (optLevel > 3) optLevel = 3;
+
+    OptPipeline pipeline = levelPipelines[optLevel];
+    if (opts && opts->pipelineLength > 0) {
+        // -fpass replaces the passes but keeps the level's iteration budget
+        pipeline.length = opts->pipelineLength;
+        memcpy(pipeline.passes, opts->pipeline, opts->pipelineLength * sizeof(int));
+        if (pipeline.iterations == 0) pipeline.iterations = 1;
+    }
+
+    if (stats) stats->instructionsBefore += ctx->instructionCount;
+
+    for (int iteration = 1; iteration <= pipeline.iterations; iteration++) {
         int changed = 0;
-        
-        changed |= constantFolding(ctx);
-        changed |= copyProp(ctx);
-        changed |= constantFolding(ctx);
-        changed |= deadCodeElimination(ctx);
 
-        if (!changed) {
-            break;
+        for (int i = 0; i < pipeline.length; i++) {
+            int index = pipeline.passes[i];
+            if (opts && (opts->disabled & (1u << index))) continue;
+
+            changed += runPass(ctx, index, timer, stats);
+
+            if (opts && (opts->printAfter & (1u << index))) {
+                printf("\n--- IR after %s (iteration %d) ---\n", passRegistry[index].name, iteration);
+                printIR(ctx);
+            }
         }
+
+        if (stats) stats->iterations++;
+        // Tombstones left by removals: repack once they are a quarter of the IR
+        if (ctx->deadCount * 4 > ctx->instructionCount) compactIr(ctx);
+        if (!changed) break;
     }
-}
\ No newline at end of file
+
+    if (stats) stats->instructionsAfter += ctx->instructionCount;
+}
+
+void printOptStats(FILE *out, const OptStats *stats) {
+    fprintf(out, "\n=== OPTIMIZER STATS ===\n");
+    fprintf(out, "%-14s %8s %10s\n", "pass", "runs", "changes");
+    for (int i = 0; i < PASS_COUNT; i++) {
+        if (!stats->runs[i]) continue;
+        fprintf(out, "%-14s %8d %10d\n", passRegistry[i].name, stats->runs[i], stats->changes[i]);
+    }
+    fprintf(out, "Pipeline iterations: %d\n", stats->iterations);
+    fprintf(out, "IR instructions: %d -> %d\n", stats->instructionsBefore, stats->instructionsAfter);
+}
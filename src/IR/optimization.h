@@ -1,4 +1,79 @@
-void constantFolding(IrContext *ctx);
-void copyProp(IrContext *ctx);
-void deadCodeElimination(IrContext *ctx);
-void optimizeIR(IrContext *ctx, int optLvl);
\ No newline at end of file
+#ifndef OPTIMIZATION_H
+#define OPTIMIZATION_H
+
+#include <stdio.h>
+
+#include "ir.h"
+#include "../modules/timing.h"
+
+#define OPT_MAX_PIPELINE 32
+
+/**
+ * @brief An optimizer pass. Returns how many changes it made (constants
+ * folded, operands propagated, instructions removed or rewritten).
+ */
+typedef int (*OptPassFn)(IrContext *ctx);
+
+typedef struct OptPass {
+    const char *name;
+    const char *description;
+    OptPassFn run;
+    int fixedPoint;     // rerun on its own until it reports no change
+} OptPass;
+
+/**
+ * @brief Pass selection from the command line. Passes are registry indices.
+ */
+typedef struct OptOptions {
+    unsigned disabled;                  // -fno-<pass>, one bit per pass
+    int pipeline[OPT_MAX_PIPELINE];     // -fpass=<list>, replaces the level's pipeline
+    int pipelineLength;
+    unsigned printAfter;                // --print-after=<list>, one bit per pass
+} OptOptions;
+
+/**
+ * @brief Accumulated over every optimizeIR call of a build.
+ */
+typedef struct OptStats {
+    int runs[OPT_MAX_PIPELINE];
+    int changes[OPT_MAX_PIPELINE];
+    int iterations;
+    int instructionsBefore;
+    int instructionsAfter;
+} OptStats;
+
+int constantFolding(IrContext *ctx);
+int copyProp(IrContext *ctx);
+int deadCodeElimination(IrContext *ctx);
+int simplifyCFG(IrContext *ctx);
+
+int optPassCount(void);
+const OptPass *getOptPass(int index);
+
+/**
+ * @brief Looks a pass up by name
+ * @return registry index, or -1 when there is no such pass
+ */
+int findOptPass(const char *name, size_t len);
+
+/**
+ * @brief Parses a comma separated pass list ("all" expands to every pass)
+ * @return number of passes written to out, or -1 after reporting an error
+ */
+int parseOptPassList(const char *list, int *out, int max);
+
+/**
+ * @brief Lists registered passes and the per-level pipelines
+ */
+void printOptPasses(FILE *out);
+
+/**
+ * @brief Runs the pipeline for optLevel (or opts->pipeline) until it
+ * reaches a fixed point or the level's iteration budget. opts, stats and
+ * timer may be NULL.
+ */
+void optimizeIR(IrContext *ctx, int optLevel, const OptOptions *opts, OptStats *stats, BuildTimer *timer);
+
+void printOptStats(FILE *out, const OptStats *stats);
+
+#endif //OPTIMIZATION_H
@@ -0,0 +1,379 @@
+#include "./profile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Instructions of one function in order, FUNC_END excluded. Top-level
+ * statements form the "main" region even when function definitions split them.
+ */
+typedef struct ProfileRegion {
+    const char *name;
+    size_t nameLen;
+    IrInstruction **insts;
+    int count;
+    int capacity;
+} ProfileRegion;
+
+static int pushRegionInst(ProfileRegion *region, IrInstruction *inst) {
+    if (region->count == region->capacity) {
+        int capacity = region->capacity ? region->capacity * 2 : 64;
+        IrInstruction **grown = realloc(region->insts, capacity * sizeof(IrInstruction *));
+        if (!grown) return 0;
+        region->insts = grown;
+        region->capacity = capacity;
+    }
+    region->insts[region->count++] = inst;
+    return 1;
+}
+
+static void freeRegions(ProfileRegion *regions, int count) {
+    for (int i = 0; i < count; i++) free(regions[i].insts);
+    free(regions);
+}
+
+static ProfileRegion *collectRegions(IrContext *ctx, int *outCount) {
+    int capacity = 8, count = 1;
+    ProfileRegion *regions = calloc(capacity, sizeof(ProfileRegion));
+    if (!regions) return NULL;
+    regions[0].name = "main";
+    regions[0].nameLen = 4;
+
+    int current = 0;
+    for (IrInstruction *inst = ctx->instructions; inst; inst = inst->next) {
+        if (inst->op == IR_FUNC_BEGIN) {
+            if (count == capacity) {
+                ProfileRegion *grown = realloc(regions, capacity * 2 * sizeof(ProfileRegion));
+                if (!grown) break;
+                memset(grown + capacity, 0, capacity * sizeof(ProfileRegion));
+                regions = grown;
+                capacity *= 2;
+            }
+            current = count++;
+            regions[current].name = irString(ctx, inst->result.value.fn.id, &regions[current].nameLen);
+        } else if (inst->op == IR_FUNC_END) {
+            current = 0;
+            continue;
+        }
+        if (!pushRegionInst(&regions[current], inst)) {
+            freeRegions(regions, count);
+            return NULL;
+        }
+    }
+    *outCount = count;
+    return regions;
+}
+
+static int isLeader(const ProfileRegion *region, int i) {
+    if (i == 0 || region->insts[i]->op == IR_LABEL) return 1;
+    IrOpCode prev = region->insts[i - 1]->op;
+    return prev == IR_GOTO || prev == IR_IF_FALSE || prev == IR_IF_TRUE ||
+           prev == IR_RETURN || prev == IR_RETURN_VOID;
+}
+
+static int countBlocks(const ProfileRegion *region) {
+    int blocks = 0;
+    for (int i = 0; i < region->count; i++) blocks += isLeader(region, i);
+    return blocks;
+}
+
+/**
+ * @brief FNV-1a over the opcode sequence. Temporaries, labels and source
+ * positions are left out so that edits elsewhere in the module keep it stable.
+ */
+static unsigned regionChecksum(const ProfileRegion *region, int blocks) {
+    unsigned h = 2166136261u;
+    for (int i = 0; i < region->count; i++) {
+        h = (h ^ (unsigned)region->insts[i]->op) * 16777619u;
+    }
+    return (h ^ (unsigned)blocks) * 16777619u;
+}
+
+static IrInstruction *createProfileInst(IrContext *ctx, IrOpCode op, IrOperand fn, IrOperand ar1,
+                                        IrOperand ar2, const IrInstruction *at) {
+    IrInstruction *inst = allocInstruction(ctx);
+    if (!inst) return NULL;
+    inst->op = op;
+    inst->result = fn;
+    inst->ar1 = ar1;
+    inst->ar2 = ar2;
+    inst->line = at->line;
+    inst->column = at->column;
+    return inst;
+}
+
+static void insertAfter(IrContext *ctx, IrInstruction *pos, IrInstruction *inst) {
+    inst->prev = pos;
+    inst->next = pos->next;
+    if (pos->next) {
+        pos->next->prev = inst;
+    } else {
+        ctx->lastInstruction = inst;
+    }
+    pos->next = inst;
+    ctx->instructionCount++;
+}
+
+int instrumentProfile(IrContext *ctx) {
+    int regionCount;
+    ProfileRegion *regions = collectRegions(ctx, &regionCount);
+    if (!regions) return 0;
+
+    int counters = 0;
+    for (int r = 0; r < regionCount; r++) {
+        ProfileRegion *region = &regions[r];
+        if (region->count == 0) continue;
+
+        int blocks = countBlocks(region);
+        unsigned checksum = regionChecksum(region, blocks);
+        IrOperand fn = createFn(ctx, region->name, region->nameLen);
+        int block = 0;
+
+        for (int i = 0; i < region->count; i++) {
+            if (!isLeader(region, i)) continue;
+            IrInstruction *leader = region->insts[i];
+            IrInstruction *counter = createProfileInst(ctx, IR_PROFILE_COUNT, fn, createIntConst(block++),
+                                                       createNone(), leader);
+            if (!counter) break;
+            // Counters go inside the block, after its label or the prologue
+            if (leader->op == IR_LABEL || leader->op == IR_FUNC_BEGIN) {
+                insertAfter(ctx, leader, counter);
+            } else {
+                insertInstructionBefore(ctx, leader, counter);
+            }
+            if (i == 0) {
+                IrInstruction *info = createProfileInst(ctx, IR_PROFILE_FUNC, fn, createIntConst((int)checksum),
+                                                        createIntConst(blocks), leader);
+                if (info) insertInstructionBefore(ctx, counter, info);
+            }
+            counters++;
+        }
+    }
+
+    freeRegions(regions, regionCount);
+    return counters;
+}
+
+static const ProfileFunction *findProfileFunction(const ProfileData *data, const char *moduleName,
+                                                  const char *name, size_t nameLen) {
+    size_t moduleLen = strlen(moduleName);
+    for (int i = 0; i < data->count; i++) {
+        const char *key = data->functions[i].name;
+        if (strlen(key) == moduleLen + 1 + nameLen && memcmp(key, moduleName, moduleLen) == 0 &&
+            key[moduleLen] == '.' && memcmp(key + moduleLen + 1, name, nameLen) == 0) {
+            return &data->functions[i];
+        }
+    }
+    return NULL;
+}
+
+int applyProfile(IrContext *ctx, const char *moduleName, const ProfileData *data) {
+    if (!data) return 0;
+    int regionCount;
+    ProfileRegion *regions = collectRegions(ctx, &regionCount);
+    if (!regions) return 0;
+
+    int matched = 0;
+    for (int r = 0; r < regionCount; r++) {
+        ProfileRegion *region = &regions[r];
+        if (region->count == 0) continue;
+
+        const ProfileFunction *counts = findProfileFunction(data, moduleName, region->name, region->nameLen);
+        if (!counts) continue;
+
+        int blocks = countBlocks(region);
+        if (counts->blockCount != blocks || counts->checksum != regionChecksum(region, blocks)) {
+            fprintf(stderr, "Warning: Profile for '%s' does not match the current source, ignored\n",
+                    counts->name);
+            continue;
+        }
+
+        int block = 0;
+        for (int i = 0; i < region->count; i++) {
+            if (isLeader(region, i)) region->insts[i]->profileCount = counts->counts[block++];
+        }
+        matched++;
+    }
+
+    freeRegions(regions, regionCount);
+    return matched;
+}
+
+static IrInstruction *findLabel(IrInstruction *from, int label) {
+    for (IrInstruction *inst = from; inst; inst = inst->next) {
+        if (inst->op == IR_LABEL && inst->result.value.label.labelNum == label) return inst;
+    }
+    return NULL;
+}
+
+static int labelUses(IrContext *ctx, int label) {
+    int uses = 0;
+    for (IrInstruction *inst = ctx->instructions; inst; inst = inst->next) {
+        if (inst->op == IR_GOTO && inst->ar1.value.label.labelNum == label) uses++;
+        if ((inst->op == IR_IF_FALSE || inst->op == IR_IF_TRUE) && inst->ar2.value.label.labelNum == label) uses++;
+    }
+    return uses;
+}
+
+static int readsTemp(IrOperand op, int temp) {
+    return op.type == OPERAND_TEMP && op.value.temp.tempNum == temp;
+}
+
+/**
+ * @brief Negates the condition of a branch. Integer comparisons that feed
+ * only this branch are flipped in place; anything else (including float
+ * compares, where NaN breaks the symmetry) gets an explicit NOT.
+ */
+static int invertCondition(IrContext *ctx, IrInstruction *branch) {
+    IrOperand cond = branch->ar1;
+    if (cond.type != OPERAND_TEMP && cond.type != OPERAND_VAR) return 0;
+
+    IrInstruction *def = branch->prev;
+    if (cond.type == OPERAND_TEMP && def && readsTemp(def->result, cond.value.temp.tempNum) &&
+        def->ar1.dataType != IR_TYPE_FLOAT && def->ar1.dataType != IR_TYPE_DOUBLE) {
+        IrOpCode flipped;
+        switch (def->op) {
+            case IR_EQ: flipped = IR_NE; break;
+            case IR_NE: flipped = IR_EQ; break;
+            case IR_LT: flipped = IR_GE; break;
+            case IR_GE: flipped = IR_LT; break;
+            case IR_GT: flipped = IR_LE; break;
+            case IR_LE: flipped = IR_GT; break;
+            default: flipped = IR_NOP; break;
+        }
+        int shared = 0;
+        for (IrInstruction *inst = branch->next; inst && !shared; inst = inst->next) {
+            shared = readsTemp(inst->ar1, cond.value.temp.tempNum) || readsTemp(inst->ar2, cond.value.temp.tempNum) ||
+                     readsTemp(inst->result, cond.value.temp.tempNum);
+        }
+        if (flipped != IR_NOP && !shared) {
+            def->op = flipped;
+            return 1;
+        }
+    }
+
+    IrOperand negated = createTemp(ctx, IR_TYPE_BOOL);
+    IrInstruction *negate = createProfileInst(ctx, IR_NOT, negated, cond, createNone(), branch);
+    if (!negate) return 0;
+    insertInstructionBefore(ctx, branch, negate);
+    branch->ar1 = negated;
+    return 1;
+}
+
+int layoutProfiledBranches(IrContext *ctx) {
+    int swapped = 0;
+    for (IrInstruction *branch = ctx->instructions; branch; branch = branch->next) {
+        if (branch->op != IR_IF_FALSE) continue;
+
+        // IF_FALSE c, Lelse; <then>; GOTO Lend; LABEL Lelse; <else>; LABEL Lend
+        int elseLabel = branch->ar2.value.label.labelNum;
+        IrInstruction *thenFirst = branch->next;
+        IrInstruction *elseLab = findLabel(branch, elseLabel);
+        if (!elseLab || thenFirst == elseLab || elseLab->prev->op != IR_GOTO) continue;
+        IrInstruction *thenGoto = elseLab->prev;
+        IrInstruction *endLab = findLabel(elseLab, thenGoto->ar1.value.label.labelNum);
+        if (!endLab) continue;
+
+        long long thenCount = thenFirst->profileCount;
+        long long elseCount = elseLab->profileCount;
+        if (thenCount < 0 || elseCount <= thenCount) continue;
+        if (labelUses(ctx, elseLabel) != 1 || !invertCondition(ctx, branch)) continue;
+
+        // -> IF_FALSE !c, Lelse; <else>; GOTO Lend; LABEL Lelse; <then>; LABEL Lend
+        IrInstruction *thenLast = thenGoto->prev;
+        IrInstruction *elseFirst = elseLab->next;
+        IrInstruction *elseLast = endLab->prev;
+        int hasThen = thenLast != branch;
+        int hasElse = elseFirst != endLab;
+
+        IrInstruction *cursor = branch;
+        if (hasElse) {
+            cursor->next = elseFirst;
+            elseFirst->prev = cursor;
+            cursor = elseLast;
+        }
+        cursor->next = thenGoto;
+        thenGoto->prev = cursor;
+        thenGoto->next = elseLab;
+        elseLab->prev = thenGoto;
+        cursor = elseLab;
+        if (hasThen) {
+            cursor->next = thenFirst;
+            thenFirst->prev = cursor;
+            cursor = thenLast;
+        }
+        cursor->next = endLab;
+        endLab->prev = cursor;
+
+        elseLab->profileCount = thenCount;
+        if (hasElse) elseFirst->profileCount = elseCount;
+        swapped++;
+    }
+    return swapped;
+}
+
+ProfileData *readProfileData(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "Error: Cannot open profile '%s'\n", path);
+        return NULL;
+    }
+    ProfileData *data = calloc(1, sizeof(ProfileData));
+    if (!data) {
+        fclose(f);
+        return NULL;
+    }
+
+    char name[512];
+    int c;
+    while ((c = fgetc(f)) != EOF) {
+        if (c == '#') {
+            while ((c = fgetc(f)) != EOF && c != '\n');
+            continue;
+        }
+        if (c == '\n' || c == ' ' || c == '\t' || c == '\r') continue;
+        ungetc(c, f);
+
+        unsigned checksum;
+        int blocks;
+        if (fscanf(f, "%511s %u %d", name, &checksum, &blocks) != 3 || blocks < 0) {
+            fprintf(stderr, "Error: Malformed profile '%s'\n", path);
+            freeProfileData(data);
+            fclose(f);
+            return NULL;
+        }
+        if (data->count == data->capacity) {
+            int capacity = data->capacity ? data->capacity * 2 : 16;
+            ProfileFunction *grown = realloc(data->functions, capacity * sizeof(ProfileFunction));
+            if (!grown) break;
+            data->functions = grown;
+            data->capacity = capacity;
+        }
+        ProfileFunction *fn = &data->functions[data->count++];
+        fn->name = strdup(name);
+        fn->checksum = checksum;
+        fn->blockCount = blocks;
+        fn->counts = calloc(blocks ? blocks : 1, sizeof(long long));
+        for (int i = 0; i < blocks; i++) {
+            if (fscanf(f, "%lld", &fn->counts[i]) != 1) {
+                fprintf(stderr, "Error: Malformed profile '%s'\n", path);
+                freeProfileData(data);
+                fclose(f);
+                return NULL;
+            }
+        }
+    }
+
+    fclose(f);
+    return data;
+}
+
+void freeProfileData(ProfileData *data) {
+    if (!data) return;
+    for (int i = 0; i < data->count; i++) {
+        free(data->functions[i].name);
+        free(data->functions[i].counts);
+    }
+    free(data->functions);
+    free(data);
+}
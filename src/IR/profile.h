@@ -0,0 +1,51 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "ir.h"
+
+/**
+ * @brief Block counts of one function read from a profile file. Functions
+ * are keyed by "module.function" and carry a checksum of their CFG, so a
+ * profile keeps applying to functions that were not edited.
+ */
+typedef struct ProfileFunction {
+    char *name;
+    unsigned checksum;
+    int blockCount;
+    long long *counts;
+} ProfileFunction;
+
+typedef struct ProfileData {
+    ProfileFunction *functions;
+    int count;
+    int capacity;
+} ProfileData;
+
+/**
+ * @brief Reads a profile written by a -fprofile-generate binary.
+ * @return NULL (after reporting the error) when the file cannot be used
+ */
+ProfileData *readProfileData(const char *path);
+void freeProfileData(ProfileData *data);
+
+/**
+ * @brief Inserts a block counter at the start of every basic block of the
+ * unoptimized IR, plus one PROFILE_FUNC describing each function.
+ * @return Number of counters inserted
+ */
+int instrumentProfile(IrContext *ctx);
+
+/**
+ * @brief Attaches the counts of matching functions to their block leaders
+ * (profileCount). Must run on the same unoptimized IR as instrumentProfile.
+ * @return Number of functions that received counts
+ */
+int applyProfile(IrContext *ctx, const char *moduleName, const ProfileData *data);
+
+/**
+ * @brief Swaps if/else arms so the hotter arm is the fall-through path.
+ * @return Number of branches reordered
+ */
+int layoutProfiledBranches(IrContext *ctx);
+
+#endif //PROFILE_H
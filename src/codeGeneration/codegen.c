@@ -27,6 +27,8 @@ void freeCodeGenContext(CodeGenContext *ctx) {
     
     sbFree(&ctx->data);
     sbFree(&ctx->text);
+    free(ctx->lineStarts);
+    free(ctx->loopHeaders);
 
     StringEntry *se = ctx->stringPool;
     while (se) {
@@ -68,6 +70,84 @@ void freeCodeGenContext(CodeGenContext *ctx) {
     free(ctx);
 }
 
+/**
+ * @brief Interned name of a variable or function operand.
+ */
+static const char *operandName(CodeGenContext *ctx, const IrOperand *op, size_t *len) {
+    return irString(ctx->ir, op->type == OPERAND_FUNCTION ? op->value.fn.id : op->value.var.id, len);
+}
+
+static VarLoc *findVarOp(CodeGenContext *ctx, const IrOperand *op) {
+    size_t len;
+    const char *name = operandName(ctx, op, &len);
+    return findVar(ctx, name, len);
+}
+
+static int varOffset(CodeGenContext *ctx, const IrOperand *op) {
+    size_t len;
+    const char *name = operandName(ctx, op, &len);
+    return getVarOffset(ctx, name, len);
+}
+
+static void addLocalVarOp(CodeGenContext *ctx, const IrOperand *op, IrDataType type) {
+    size_t len;
+    const char *name = operandName(ctx, op, &len);
+    addLocalVar(ctx, name, len, type);
+}
+
+/**
+ * @brief Sign or zero extending load of an i8/i16/u8/u16 into a 32-bit register.
+ * @return NULL for types loaded at their own width
+ */
+static const char *extendingLoad(IrDataType type) {
+    switch (type) {
+        case IR_TYPE_I8: return "movsbl";
+        case IR_TYPE_U8: return "movzbl";
+        case IR_TYPE_I16: return "movswl";
+        case IR_TYPE_U16: return "movzwl";
+        default: return NULL;
+    }
+}
+
+static int wantAvx2(CodeGenContext *ctx) {
+    return ctx->options && ctx->options->avx2;
+}
+
+static int isWideVector(IrDataType type) {
+    return irIsVector(type) && getTypeSize(type) == 32;
+}
+
+/**
+ * @brief Vector register num: %xmmN for 128-bit vectors, %ymmN for 256-bit ones.
+ */
+static const char *vectorReg(IrDataType type, int num) {
+    static const char *xmm[] = {"%xmm0", "%xmm1", "%xmm2"};
+    static const char *ymm[] = {"%ymm0", "%ymm1", "%ymm2"};
+    return isWideVector(type) ? ymm[num] : xmm[num];
+}
+
+/**
+ * @brief Whole-vector move. Unaligned forms, frame slots and arrays are not
+ * kept at the vector's alignment.
+ */
+static const char *vectorMove(IrDataType type) {
+    int wide = isWideVector(type);
+    switch (irLaneType(type)) {
+        case IR_TYPE_FLOAT: return wide ? "vmovups" : "movups";
+        case IR_TYPE_DOUBLE: return wide ? "vmovupd" : "movupd";
+        default: return wide ? "vmovdqu" : "movdqu";
+    }
+}
+
+/**
+ * @brief Ends an instruction that used %ymm registers. Values go back to
+ * the frame between instructions, so clearing the upper halves right away
+ * keeps the SSE code, calls and returns around it free of transition stalls.
+ */
+static void endVectorOp(CodeGenContext *ctx, IrDataType type) {
+    if (isWideVector(type)) emitInstruction(ctx, "vzeroupper");
+}
+
 void loadOp(CodeGenContext *ctx, IrOperand *op, const char *reg){
     switch(op->type){
         case OPERAND_CONSTANT:
@@ -78,7 +158,9 @@ void loadOp(CodeGenContext *ctx, IrOperand *op, const char *reg){
             }
             switch(op->dataType){
                 case IR_TYPE_STRING: {
-                    int label = addStringLit(ctx, op->value.constant.str.stringVal, op->value.constant.str.len);
+                    size_t len;
+                    const char *str = irString(ctx->ir, op->value.constant.index, &len);
+                    int label = addStringLit(ctx, str, len);
                     emitInstruction(ctx, "leaq .LC%d(%%rip), %s", label, getIntReg(reg, IR_TYPE_STRING));
                     break;
                 }
@@ -88,27 +170,37 @@ void loadOp(CodeGenContext *ctx, IrOperand *op, const char *reg){
                     if(op->dataType == IR_TYPE_FLOAT){
                         label = addFloatLit(ctx, op->value.constant.floatVal);
                     }else{
-                        label = addDoubleLit(ctx, op->value.constant.doubleVal);
+                        label = addDoubleLit(ctx, irDouble(ctx->ir, *op));
                     }
                     
                     emitInstruction(ctx, "mov%s .LC%d(%%rip), %s", getSSESuffix(op->dataType), label, reg);
                     break;
                 }
+                case IR_TYPE_I64:
+                case IR_TYPE_U64: {
+                    long long value = irIntValue(ctx->ir, *op);
+                    int fitsImm32 = value >= -2147483648LL && value <= 2147483647LL;
+                    emitInstruction(ctx, "%s $%lld, %s", fitsImm32 ? "movq" : "movabsq", value,
+                                    getIntReg(reg, op->dataType));
+                    break;
+                }
                 // ints and bools
                 default: 
                     emitInstruction(ctx, "mov%s $%d, %s",
-                                getIntSuffix(op->dataType),
+                                getIntSuffix(getRegisterType(op->dataType)),
                                 op->value.constant.intVal,
-                                getIntReg(reg, op->dataType));
+                                getIntReg(reg, getRegisterType(op->dataType)));
                     break;
             }
             break;
         case OPERAND_VAR:
         case OPERAND_TEMP: 
             int off = op->type == OPERAND_VAR 
-                ? getVarOffset(ctx, op->value.var.name, op->value.var.nameLen) 
+                ? varOffset(ctx, op) 
                 : getTempOffset(ctx, op->value.temp.tempNum, op->dataType);
+            if (ctx->statFn) ctx->statFn->stackLoads++;
             
+
             switch(op->dataType){
             case IR_TYPE_POINTER:
                 emitInstruction(ctx, "movq %d(%%rbp), %s", off, getIntReg(reg, IR_TYPE_STRING));
@@ -117,7 +209,20 @@ void loadOp(CodeGenContext *ctx, IrOperand *op, const char *reg){
             case IR_TYPE_DOUBLE:
                 emitInstruction(ctx, "mov%s %d(%%rbp), %s", getSSESuffix(op->dataType), off, reg);
                 break;
+            case IR_TYPE_F32X4:
+            case IR_TYPE_F64X2:
+            case IR_TYPE_I32X4:
+            case IR_TYPE_F32X8:
+            case IR_TYPE_F64X4:
+            case IR_TYPE_I32X8:
+                emitInstruction(ctx, "%s %d(%%rbp), %s", vectorMove(op->dataType), off, reg);
+                break;
             default:
+                if (extendingLoad(op->dataType)) {
+                    emitInstruction(ctx, "%s %d(%%rbp), %s", extendingLoad(op->dataType), off,
+                                    getIntReg(reg, IR_TYPE_INT));
+                    break;
+                }
                 emitInstruction(ctx, "mov%s %d(%%rbp), %s", getIntSuffix(op->dataType), off,
                                 getIntReg(reg, op->dataType));
                 break;
@@ -132,14 +237,17 @@ void storeOp(CodeGenContext *ctx, const char *reg, IrOperand *op){
     if(op->type != OPERAND_VAR && op->type != OPERAND_TEMP) return;
     int off;
     if (op->type == OPERAND_VAR) {
-        addLocalVar(ctx, op->value.var.name, op->value.var.nameLen, op->dataType);
-        off = getVarOffset(ctx, op->value.var.name, op->value.var.nameLen);
+        addLocalVarOp(ctx, op, op->dataType);
+        off = varOffset(ctx, op);
     } else {
         off = getTempOffset(ctx, op->value.temp.tempNum, op->dataType);
     }
+    if (ctx->statFn) ctx->statFn->stackStores++;
     
     if (isFloatingPoint(op->dataType)) {
         emitInstruction(ctx, "mov%s %s, %d(%%rbp)", getSSESuffix(op->dataType), reg, off);
+    } else if (irIsVector(op->dataType)) {
+        emitInstruction(ctx, "%s %s, %d(%%rbp)", vectorMove(op->dataType), reg, off);
     } else {
         emitInstruction(ctx, "mov%s %s, %d(%%rbp)", getIntSuffix(op->dataType), getIntReg(reg, op->dataType), off);
     }
@@ -152,7 +260,7 @@ void genPointerLoad(CodeGenContext *ctx, IrInstruction *inst) {
 
     if (base->type != OPERAND_VAR) return;
 
-    VarLoc *baseVar = findVar(ctx, base->value.var.name, base->value.var.nameLen);
+    VarLoc *baseVar = findVarOp(ctx, base);
     if (!baseVar) return;
 
     IrDataType elemType = result->dataType;
@@ -179,7 +287,7 @@ void genPointerStore(CodeGenContext *ctx, IrInstruction *inst) {
 
     if (base->type != OPERAND_VAR) return;
 
-    VarLoc *baseVar = findVar(ctx, base->value.var.name, base->value.var.nameLen);
+    VarLoc *baseVar = findVarOp(ctx, base);
     if (!baseVar) return;
 
     IrDataType elemType = value->dataType;
@@ -202,8 +310,88 @@ void genPointerStore(CodeGenContext *ctx, IrInstruction *inst) {
     }
 }
 
-void genBitwiseOp(CodeGenContext *ctx, IrInstruction *inst){
+/**
+ * @brief dst = dst op src, in the VEX three operand form for 256-bit vectors.
+ */
+static void emitPackedOp(CodeGenContext *ctx, IrDataType type, const char *op, const char *src, const char *dst) {
+    if (isWideVector(type)) {
+        emitInstruction(ctx, "v%s %s, %s, %s", op, src, dst, dst);
+    } else {
+        emitInstruction(ctx, "%s %s, %s", op, src, dst);
+    }
+}
+
+/**
+ * @brief %xmm0 = %xmm0 * %xmm1 on i32x4 without SSE4.1's pmulld: pmuludq
+ * multiplies the even lanes, the odd ones are shifted down and multiplied
+ * the same way, and the low halves of the products are interleaved back.
+ */
+static void emitMulI32x4Sse2(CodeGenContext *ctx) {
+    emitInstruction(ctx, "movdqa %%xmm0, %%xmm2");
+    emitInstruction(ctx, "pmuludq %%xmm1, %%xmm0");
+    emitInstruction(ctx, "psrlq $32, %%xmm2");
+    emitInstruction(ctx, "psrlq $32, %%xmm1");
+    emitInstruction(ctx, "pmuludq %%xmm1, %%xmm2");
+    emitInstruction(ctx, "pshufd $0x08, %%xmm0, %%xmm0");
+    emitInstruction(ctx, "pshufd $0x08, %%xmm2, %%xmm2");
+    emitInstruction(ctx, "punpckldq %%xmm2, %%xmm0");
+}
+
+/**
+ * @brief %xmm0 = min or max of %xmm0 and %xmm1 on i32x4 without SSE4.1's
+ * pminsd/pmaxsd: a pcmpgtd mask picks %xmm1 where it wins.
+ */
+static void emitMinMaxI32x4Sse2(CodeGenContext *ctx, int isMax) {
+    emitInstruction(ctx, "movdqa %s, %%xmm2", isMax ? "%xmm1" : "%xmm0");
+    emitInstruction(ctx, "pcmpgtd %s, %%xmm2", isMax ? "%xmm0" : "%xmm1");
+    emitInstruction(ctx, "pand %%xmm2, %%xmm1");
+    emitInstruction(ctx, "pandn %%xmm0, %%xmm2");
+    emitInstruction(ctx, "por %%xmm2, %%xmm1");
+    emitInstruction(ctx, "movdqa %%xmm1, %%xmm0");
+}
+
+/**
+ * @brief Element-wise + - * / & | ^ on two vectors of the same type.
+ */
+static void genVectorArith(CodeGenContext *ctx, IrInstruction *inst) {
     IrDataType type = inst->result.dataType;
+    int isInt = irLaneType(type) == IR_TYPE_INT;
+    const char *acc = vectorReg(type, 0);
+    const char *src = vectorReg(type, 1);
+
+    loadOp(ctx, &inst->ar1, acc);
+    loadOp(ctx, &inst->ar2, src);
+
+    const char *op;
+    switch (inst->op) {
+        case IR_ADD: op = isInt ? "paddd" : "add"; break;
+        case IR_SUB: op = isInt ? "psubd" : "sub"; break;
+        case IR_MUL: op = isInt ? "pmulld" : "mul"; break;
+        case IR_DIV: op = "div"; break;
+        case IR_BIT_AND: op = "pand"; break;
+        case IR_BIT_OR: op = "por"; break;
+        case IR_BIT_XOR: op = "pxor"; break;
+        default: return;
+    }
+
+    if (isInt && inst->op == IR_MUL && !wantAvx2(ctx)) {
+        emitMulI32x4Sse2(ctx);
+    } else {
+        char name[16];
+        snprintf(name, sizeof(name), "%s%s", op, isInt ? "" : irLaneType(type) == IR_TYPE_FLOAT ? "ps" : "pd");
+        emitPackedOp(ctx, type, name, src, acc);
+    }
+
+    storeOp(ctx, acc, &inst->result);
+    endVectorOp(ctx, type);
+}
+
+void genBitwiseOp(CodeGenContext *ctx, IrInstruction *inst){
+    if (irIsVector(inst->result.dataType)) {
+        genVectorArith(ctx, inst);
+        return;
+    }
+    IrDataType type = getRegisterType(inst->result.dataType);
     
     loadOp(ctx, &inst->ar1, "a");
     loadOp(ctx, &inst->ar2, "c");
@@ -226,7 +414,7 @@ void genBitwiseOp(CodeGenContext *ctx, IrInstruction *inst){
             emitInstruction(ctx, "shl%s %%cl, %s", suffix, regA);
             break;
         case IR_SHR:
-            emitInstruction(ctx, "shr%s %%cl, %s", suffix, regA);
+            emitInstruction(ctx, "%s%s %%cl, %s", irIsUnsigned(type) ? "shr" : "sar", suffix, regA);
             break;
         default:
             break;
@@ -237,7 +425,9 @@ void genBitwiseOp(CodeGenContext *ctx, IrInstruction *inst){
 
 void genBinaryOp(CodeGenContext *ctx, IrInstruction *inst){
     IrDataType type = inst->result.dataType;
-    if(isFloatingPoint(type)){
+    if (irIsVector(type)) {
+        genVectorArith(ctx, inst);
+    } else if(isFloatingPoint(type)){
         loadOp(ctx, &inst->ar1, "%xmm0");
         loadOp(ctx, &inst->ar2, "%xmm1");
         const char *suffix = getSSESuffix(type);
@@ -251,12 +441,16 @@ void genBinaryOp(CodeGenContext *ctx, IrInstruction *inst){
 
         storeOp(ctx, "%xmm0", &inst->result);
     }else {
+        type = getRegisterType(type);
         loadOp(ctx, &inst->ar1, "a");
         loadOp(ctx, &inst->ar2, "c");
         
         const char *suffix = getIntSuffix(type);
         const char *regA = getIntReg("a", type);
         const char *regC = getIntReg("c", type);
+        // unsigned types divide rdx:rax zero extended, signed ones sign extended
+        const char *extend = irIsUnsigned(type) ? "xorl %edx, %edx" : irIntBits(type) == 64 ? "cqto" : "cltd";
+        const char *divide = irIsUnsigned(type) ? "div" : "idiv";
         
         switch (inst->op) {
             case IR_ADD:
@@ -269,12 +463,12 @@ void genBinaryOp(CodeGenContext *ctx, IrInstruction *inst){
                 emitInstruction(ctx, "imul%s %s, %s", suffix, regC, regA);
                 break;
             case IR_DIV:
-                emitInstruction(ctx, "cltd");
-                emitInstruction(ctx, "idiv%s %s", suffix, regC);
+                emitInstruction(ctx, "%s", extend);
+                emitInstruction(ctx, "%s%s %s", divide, suffix, regC);
                 break;
             case IR_MOD:
-                emitInstruction(ctx, "cltd");
-                emitInstruction(ctx, "idiv%s %s", suffix, regC);
+                emitInstruction(ctx, "%s", extend);
+                emitInstruction(ctx, "%s%s %s", divide, suffix, regC);
                 emitInstruction(ctx, "mov%s %s, %s", suffix, getIntReg("d", type), regA);
                 break;
             default:
@@ -306,6 +500,7 @@ void genUnaryOp(CodeGenContext *ctx, IrInstruction *inst) {
         storeOp(ctx, "%xmm0", &inst->result);
     }
     else {
+        type = getRegisterType(type);
         loadOp(ctx, &inst->ar1, "a");
         
         const char *suffix = getIntSuffix(type);
@@ -331,19 +526,20 @@ void genReqMem(CodeGenContext *ctx, IrInstruction *inst) {
         return;
     }
 
-    addLocalVar(ctx, inst->result.value.var.name, inst->result.value.var.nameLen,
-                inst->result.dataType);
+    addLocalVarOp(ctx, &inst->result, inst->result.dataType);
 
     int arraySize = inst->ar1.value.constant.intVal;
-    markVarAsAddresable(ctx, inst->result.value.var.name, inst->result.value.var.nameLen, arraySize);
+    size_t nameLen;
+    const char *name = operandName(ctx, &inst->result, &nameLen);
+    markVarAsAddresable(ctx, name, nameLen, arraySize);
 }
 
 void genLoadParam(CodeGenContext *ctx, IrInstruction *inst) {
     IrDataType type = inst->result.dataType;
     int paramIndex = inst->ar2.value.constant.intVal;
     
-    addLocalVar(ctx, inst->result.value.var.name, inst->result.value.var.nameLen, type);
-    int off = getVarOffset(ctx, inst->result.value.var.name, inst->result.value.var.nameLen);
+    addLocalVarOp(ctx, &inst->result, type);
+    int off = varOffset(ctx, &inst->result);
     
     if (isFloatingPoint(type)) {
         if (paramIndex < 8) {
@@ -365,7 +561,7 @@ void genDeref(CodeGenContext *ctx, IrInstruction *inst) {
     
     // Load the pointer (always 64-bit) into rax
     if (inst->ar1.type == OPERAND_VAR) {
-        int off = getVarOffset(ctx, inst->ar1.value.var.name, inst->ar1.value.var.nameLen);
+        int off = varOffset(ctx, &inst->ar1);
         emitInstruction(ctx, "movq %d(%%rbp), %%rax", off);
     } else if (inst->ar1.type == OPERAND_TEMP) {
         int off = getTempOffset(ctx, inst->ar1.value.temp.tempNum, IR_TYPE_POINTER);
@@ -387,7 +583,7 @@ void genStore(CodeGenContext *ctx, IrInstruction *inst) {
     
     // Load the pointer (always 64-bit) into rax
     if (inst->ar1.type == OPERAND_VAR) {
-        int off = getVarOffset(ctx, inst->ar1.value.var.name, inst->ar1.value.var.nameLen);
+        int off = varOffset(ctx, &inst->ar1);
         emitInstruction(ctx, "movq %d(%%rbp), %%rax", off);
     } else if (inst->ar1.type == OPERAND_TEMP) {
         int off = getTempOffset(ctx, inst->ar1.value.temp.tempNum, IR_TYPE_POINTER);
@@ -406,23 +602,31 @@ void genStore(CodeGenContext *ctx, IrInstruction *inst) {
 
 void genAddrof(CodeGenContext *ctx, IrInstruction *inst) {
     if (inst->ar1.type == OPERAND_VAR) {
-        VarLoc *var = findVar(ctx, inst->ar1.value.var.name, inst->ar1.value.var.nameLen);
+        VarLoc *var = findVarOp(ctx, &inst->ar1);
         if (!var) {
-            addLocalVar(ctx, inst->ar1.value.var.name, inst->ar1.value.var.nameLen, inst->ar1.dataType);
+            addLocalVarOp(ctx, &inst->ar1, inst->ar1.dataType);
         }
-        int off = getVarOffset(ctx, inst->ar1.value.var.name, inst->ar1.value.var.nameLen);
+        int off = varOffset(ctx, &inst->ar1);
         
-        emitInstruction(ctx, "leaq %d(%%rbp), %%rax", off);
+        if (var && var->holdsAddress) {
+            emitInstruction(ctx, "movq %d(%%rbp), %%rax", off);
+        } else {
+            emitInstruction(ctx, "leaq %d(%%rbp), %%rax", off);
+        }
         storeOp(ctx, "a", &inst->result);
     }
 }
 
 void genCopy(CodeGenContext *ctx, IrInstruction *inst) {
     IrDataType type = inst->result.dataType;
-    
+
     if (isFloatingPoint(type)) {
         loadOp(ctx, &inst->ar1, "%xmm0");
         storeOp(ctx, "%xmm0", &inst->result);
+    } else if (irIsVector(type)) {
+        loadOp(ctx, &inst->ar1, vectorReg(type, 0));
+        storeOp(ctx, vectorReg(type, 0), &inst->result);
+        endVectorOp(ctx, type);
     } else {
         loadOp(ctx, &inst->ar1, "a");
         storeOp(ctx, "a", &inst->result);
@@ -437,6 +641,7 @@ void genGoto(CodeGenContext *ctx, IrInstruction *inst) {
 void genIfFalse(CodeGenContext *ctx, IrInstruction *inst) {
     IrDataType type = inst->ar1.dataType;
     int label = inst->ar2.value.label.labelNum;
+    const char *jump = inst->op == IR_IF_TRUE ? "jne" : "je";
     
     if (isFloatingPoint(type)) {
         loadOp(ctx, &inst->ar1, "%xmm0");
@@ -446,14 +651,15 @@ void genIfFalse(CodeGenContext *ctx, IrInstruction *inst) {
         } else {
             emitInstruction(ctx, "ucomisd %%xmm1, %%xmm0");
         }
-        emitInstruction(ctx, "je .L%d", label);
+        emitInstruction(ctx, "%s .L%d", jump, label);
     } else {
+        type = getRegisterType(type);
         loadOp(ctx, &inst->ar1, "a");
         emitInstruction(ctx, "test%s %s, %s", 
                        getIntSuffix(type),
                        getIntReg("a", type),
                        getIntReg("a", type));
-        emitInstruction(ctx, "je .L%d", label);
+        emitInstruction(ctx, "%s .L%d", jump, label);
     }
 }
 
@@ -499,13 +705,18 @@ void genAllocStruct(CodeGenContext *ctx, IrInstruction *inst) {
         return;
     }
     
-    const char *name = inst->result.value.var.name;
-    size_t nameLen = inst->result.value.var.nameLen;
+    size_t nameLen;
+    const char *name = operandName(ctx, &inst->result, &nameLen);
     int32_t structSize = inst->ar1.value.constant.intVal;
+    int32_t alignment = inst->ar2.type == OPERAND_CONSTANT ? inst->ar2.value.constant.intVal : 8;
     
-    addLocalVar(ctx, name, nameLen, IR_TYPE_POINTER);
-    
-    markVarAsAddresable(ctx, name, nameLen, structSize);
+    int storage = addStructVar(ctx, name, nameLen, structSize, alignment);
+    VarLoc *var = findVar(ctx, name, nameLen);
+    if (var && var->holdsAddress) {
+        emitInstruction(ctx, "leaq %d(%%rbp), %%rax", storage + alignment - 16);
+        emitInstruction(ctx, "andq $%d, %%rax", -alignment);
+        emitInstruction(ctx, "movq %%rax, %d(%%rbp)", var->stackOffset);
+    }
 }
 
 void genMemberLoad(CodeGenContext *ctx, IrInstruction *inst) {
@@ -521,7 +732,7 @@ void genMemberLoad(CodeGenContext *ctx, IrInstruction *inst) {
     IrDataType type = dest->dataType;
     
     // Find the variable to check if it's an array/direct struct
-    VarLoc *v = findVar(ctx, structVar->value.var.name, structVar->value.var.nameLen);
+    VarLoc *v = findVarOp(ctx, structVar);
     if (!v) return;
 
     if (v->isAddresable) {
@@ -559,7 +770,7 @@ void genMemberStore(CodeGenContext *ctx, IrInstruction *inst){
     }
 
     // Find variable to check type
-    VarLoc *v = findVar(ctx, structVar->value.var.name, structVar->value.var.nameLen);
+    VarLoc *v = findVarOp(ctx, structVar);
     if (!v) return;
 
     if (v->isAddresable) {
@@ -577,9 +788,25 @@ void genMemberStore(CodeGenContext *ctx, IrInstruction *inst){
     }
 }
 
+/**
+ * @brief Runtime symbol behind a heap builtin (runtime/alloc.s)
+ * @return NULL when fnName is not one
+ */
+static const char *heapBuiltin(const char *fnName, size_t fnLen) {
+    static const char *const builtins[][2] = {
+        {"alloc", "alloc_mem"},          {"free", "free_mem"},
+        {"arenaCreate", "arena_create"}, {"arenaAlloc", "arena_alloc"},
+        {"arenaReset", "arena_reset"},   {"arenaDestroy", "arena_destroy"},
+    };
+    for (size_t i = 0; i < sizeof(builtins) / sizeof(builtins[0]); i++) {
+        if (strlen(builtins[i][0]) == fnLen && memcmp(fnName, builtins[i][0], fnLen) == 0) return builtins[i][1];
+    }
+    return NULL;
+}
+
 void genCall(CodeGenContext *ctx, IrInstruction *inst) {
-    const char *fnName = inst->ar1.value.fn.name;
-    size_t fnLen = inst->ar1.value.fn.nameLen;
+    size_t fnLen;
+    const char *fnName = operandName(ctx, &inst->ar1, &fnLen);
     
     // Handle built-in print
     if (fnLen == 5 && memcmp(fnName, "print", 5) == 0) {
@@ -593,6 +820,17 @@ void genCall(CodeGenContext *ctx, IrInstruction *inst) {
             case IR_TYPE_INT:
                 emitInstruction(ctx, "call print_int");
                 break;
+            case IR_TYPE_U32:
+                // zero extended, so the signed 64-bit printer is exact
+                emitInstruction(ctx, "movl %%edi, %%edi");
+                emitInstruction(ctx, "call print_long");
+                break;
+            case IR_TYPE_I64:
+                emitInstruction(ctx, "call print_long");
+                break;
+            case IR_TYPE_U64:
+                emitInstruction(ctx, "call print_ulong");
+                break;
             case IR_TYPE_FLOAT:
                 emitInstruction(ctx, "call print_float");
                 break;
@@ -611,6 +849,10 @@ void genCall(CodeGenContext *ctx, IrInstruction *inst) {
         }
     }else if(fnLen == 6 && memcmp(fnName, "readln", 6) == 0){
         emitInstruction(ctx, "call read_str");
+    } else if (fnLen == 4 && memcmp(fnName, "exit", 4) == 0) {
+        emitInstruction(ctx, "call exit_program");
+    } else if (heapBuiltin(fnName, fnLen)) {
+        emitInstruction(ctx, "call %s", heapBuiltin(fnName, fnLen));
     } else {
         // Check if this is an imported function
         int found = 0;
@@ -646,20 +888,118 @@ void genCall(CodeGenContext *ctx, IrInstruction *inst) {
     }
 }
 
+static int wantDebugInfo(CodeGenContext *ctx) {
+    return ctx->options && ctx->options->debugInfo;
+}
+
+/**
+ * @brief Frame setup shared by every function. With debug info the CFA is
+ * tracked through the push and then pinned to %rbp for the whole body.
+ */
+static void emitPrologue(CodeGenContext *ctx) {
+    int cfi = wantDebugInfo(ctx);
+    if (cfi) sbAppend(&ctx->text, "    .cfi_startproc\n");
+    emitInstruction(ctx, "pushq %%rbp");
+    if (cfi) {
+        sbAppend(&ctx->text, "    .cfi_def_cfa_offset 16\n");
+        sbAppend(&ctx->text, "    .cfi_offset %rbp, -16\n");
+    }
+    emitInstruction(ctx, "movq %%rsp, %%rbp");
+    if (cfi) sbAppend(&ctx->text, "    .cfi_def_cfa_register %rbp\n");
+}
+
+static void emitEpilogue(CodeGenContext *ctx) {
+    int cfi = wantDebugInfo(ctx);
+    emitInstruction(ctx, "movq %%rbp, %%rsp");
+    emitInstruction(ctx, "popq %%rbp");
+    if (cfi) sbAppend(&ctx->text, "    .cfi_def_cfa %rsp, 8\n");
+    emitInstruction(ctx, "ret");
+    if (cfi) sbAppend(&ctx->text, "    .cfi_endproc\n");
+}
+
+static int wantLayout(CodeGenContext *ctx) {
+    return ctx->options && ctx->options->layout;
+}
+
+static int wantFunctionSections(CodeGenContext *ctx) {
+    return ctx->options && ctx->options->functionSections;
+}
+
+static int wantProfile(CodeGenContext *ctx) {
+    return ctx->options && ctx->options->profile;
+}
+
+/**
+ * @brief Defines the function's profile record in section orn_prof, where
+ * the runtime finds it through __start_orn_prof/__stop_orn_prof. Layout
+ * must match runtime/profile.s: name, calls, inclusive, self, active, printed.
+ */
+static void emitProfileRecord(CodeGenContext *ctx, const char *name, size_t nameLen) {
+    sbAppendf(&ctx->data, ".Lprof_name_%.*s:\n    .asciz \"%s.%.*s\"\n", (int)nameLen, name,
+              ctx->moduleName ? ctx->moduleName : "main", (int)nameLen, name);
+    sbAppend(&ctx->data, "    .pushsection orn_prof, \"aw\"\n    .align 8\n");
+    sbAppendf(&ctx->data, ".Lprof_%.*s:\n    .quad .Lprof_name_%.*s, 0, 0, 0, 0, 0\n", (int)nameLen, name,
+              (int)nameLen, name);
+    sbAppend(&ctx->data, "    .popsection\n");
+}
+
+static void emitProfileHook(CodeGenContext *ctx, const char *hook, const char *name, size_t nameLen) {
+    emitInstruction(ctx, "leaq .Lprof_%.*s(%%rip), %%r11", (int)nameLen, name);
+    emitInstruction(ctx, "call __orn_prof_%s", hook);
+}
+
+/**
+ * @brief -fprofile-generate counter block in section orn_pgo, walked by the
+ * runtime at exit: name, CFG checksum, block count, then the counters.
+ */
+static void genProfileFunc(CodeGenContext *ctx, IrInstruction *inst) {
+    size_t len;
+    const char *name = operandName(ctx, &inst->result, &len);
+    int nameLen = (int)len;
+    int blocks = inst->ar2.value.constant.intVal;
+
+    sbAppendf(&ctx->data, ".Lpgo_name_%.*s:\n    .asciz \"%s.%.*s\"\n", nameLen, name,
+              ctx->moduleName ? ctx->moduleName : "main", nameLen, name);
+    // Pulls the counter writer out of libornrt.a; exit_program calls it
+    sbAppend(&ctx->data, "    .globl __orn_pgo_report\n");
+    sbAppend(&ctx->data, "    .pushsection orn_pgo, \"aw\"\n    .align 8\n");
+    sbAppendf(&ctx->data, "    .quad .Lpgo_name_%.*s, %u, %d\n", nameLen, name,
+              (unsigned)inst->ar1.value.constant.intVal, blocks);
+    sbAppendf(&ctx->data, ".Lpgo_%.*s:\n    .zero %d\n", nameLen, name, blocks * 8);
+    sbAppend(&ctx->data, "    .popsection\n");
+}
+
+static void genProfileCount(CodeGenContext *ctx, IrInstruction *inst) {
+    emitInstruction(ctx, "incq .Lpgo_%s+%d(%%rip)", operandName(ctx, &inst->result, NULL),
+                    inst->ar1.value.constant.intVal * 8);
+}
+
 void genFuncBegin(CodeGenContext *ctx, IrInstruction *inst) {
     FuncInfo *func = calloc(1, sizeof(struct FuncInfo));
-    func->name = inst->result.value.fn.name;
-    func->nameLen = inst->result.value.fn.nameLen;
+    func->name = operandName(ctx, &inst->result, &func->nameLen);
     func->stackSize = 0;
 
     ctx->currentFn = func;
     ctx->inFn = 1;
+    ctx->statFn = beginFunctionStats(ctx->stats, ctx->moduleName, func->name, func->nameLen);
 
     int isExported = (inst->ar1.type == OPERAND_CONSTANT && inst->ar1.value.constant.intVal == 1);
 
     // Special case: main must always be global for the linker
     int isMain = (func->nameLen == 4 && memcmp(func->name, "main", 4) == 0);
 
+    // A profile that never entered the function: keep it out of the hot text
+    func->cold = wantLayout(ctx) && inst->profileCount == 0;
+    func->ownSection = func->cold || wantFunctionSections(ctx);
+    if (func->ownSection) {
+        sbAppendf(&ctx->text, "\n    .pushsection .text%s", func->cold ? ".unlikely" : "");
+        if (wantFunctionSections(ctx)) sbAppendf(&ctx->text, ".%.*s", (int)func->nameLen, func->name);
+        sbAppend(&ctx->text, ", \"ax\", @progbits");
+    }
+    if (wantLayout(ctx)) {
+        sbAppend(&ctx->text, "\n    .p2align 4");
+    }
+
     if (isMain) {
         // main: always global, never mangled
         sbAppendf(&ctx->text, "\n    .globl main\n");
@@ -678,9 +1018,23 @@ void genFuncBegin(CodeGenContext *ctx, IrInstruction *inst) {
         sbAppendf(&ctx->text, "\n%.*s:\n", (int)func->nameLen, func->name);
     }
 
-    emitInstruction(ctx, "pushq %%rbp");
-    emitInstruction(ctx, "movq %%rsp, %%rbp");
-    emitInstruction(ctx, "subq $256, %%rsp");
+    emitPrologue(ctx);
+    emitInstruction(ctx, "subq $.Lframe_%.*s, %%rsp", (int)func->nameLen, func->name);
+    if (wantProfile(ctx)) {
+        emitProfileRecord(ctx, func->name, func->nameLen);
+        emitProfileHook(ctx, "enter", func->name, func->nameLen);
+    }
+}
+
+/**
+ * @brief Defines the frame size symbol used by the prologue, once every
+ * local and temporary of the function has a stack slot. Keeps %rsp
+ * 16-byte aligned at calls.
+ */
+static void emitFrameSize(CodeGenContext *ctx, const char *name, size_t nameLen, int size) {
+    size = (size + 15) & ~15;
+    sbAppendf(&ctx->text, "    .set .Lframe_%.*s, %d\n", (int)nameLen, name, size);
+    if (ctx->statFn) ctx->statFn->frameBytes = size;
 }
 
 void genFuncEnd(CodeGenContext *ctx, IrInstruction *inst) {
@@ -689,17 +1043,77 @@ void genFuncEnd(CodeGenContext *ctx, IrInstruction *inst) {
     sbAppendf(&ctx->text, ".Lret_%.*s:\n", 
               (int)ctx->currentFn->nameLen, ctx->currentFn->name);
     
-    emitInstruction(ctx, "movq %%rbp, %%rsp");
-    emitInstruction(ctx, "popq %%rbp");
-    emitInstruction(ctx, "ret");
+    if (wantProfile(ctx)) {
+        emitProfileHook(ctx, "exit", ctx->currentFn->name, ctx->currentFn->nameLen);
+    }
+    emitEpilogue(ctx);
     
     if (ctx->currentFn) {
+        emitFrameSize(ctx, ctx->currentFn->name, ctx->currentFn->nameLen, ctx->currentFn->stackSize);
+        if (ctx->currentFn->ownSection) sbAppend(&ctx->text, "    .popsection\n");
         freeVarList(ctx->currentFn->locs);
         freeTempList(ctx->currentFn->temps);
         free(ctx->currentFn);
         ctx->currentFn = NULL;
     }
     ctx->inFn = 0;
+    ctx->statFn = NULL;
+}
+
+/**
+ * @brief Integer to integer: narrowing just stores the low bytes, widening
+ * to 64 bits sign extends signed sources (u32 is already zero extended).
+ */
+static void genIntCast(CodeGenContext *ctx, IrInstruction *inst) {
+    IrDataType srcType = inst->ar1.dataType;
+    loadOp(ctx, &inst->ar1, "a");
+    if (srcType == IR_TYPE_BOOL) {
+        emitInstruction(ctx, "movzbl %%al, %%eax");
+    } else if (irIntBits(inst->result.dataType) == 64 && irIntBits(srcType) < 64 &&
+               !irIsUnsigned(getRegisterType(srcType))) {
+        emitInstruction(ctx, "movslq %%eax, %%rax");
+    }
+    storeOp(ctx, "a", &inst->result);
+}
+
+/**
+ * @brief 64-bit unsigned to float/double: values with the top bit set are
+ * halved (keeping the low bit for rounding), converted and doubled.
+ */
+static void genU64ToFloat(CodeGenContext *ctx, IrDataType dstType) {
+    const char *suffix = getSSESuffix(dstType);
+    int label = ctx->nextLab++;
+    emitInstruction(ctx, "testq %%rax, %%rax");
+    emitInstruction(ctx, "js .Lcvt%d", label);
+    emitInstruction(ctx, "cvtsi2%sq %%rax, %%xmm0", suffix);
+    emitInstruction(ctx, "jmp .Lcvt%d_done", label);
+    sbAppendf(&ctx->text, ".Lcvt%d:\n", label);
+    emitInstruction(ctx, "movq %%rax, %%rcx");
+    emitInstruction(ctx, "shrq %%rcx");
+    emitInstruction(ctx, "andl $1, %%eax");
+    emitInstruction(ctx, "orq %%rax, %%rcx");
+    emitInstruction(ctx, "cvtsi2%sq %%rcx, %%xmm0", suffix);
+    emitInstruction(ctx, "add%s %%xmm0, %%xmm0", suffix);
+    sbAppendf(&ctx->text, ".Lcvt%d_done:\n", label);
+}
+
+/**
+ * @brief Float/double to u64: values from 2^63 up are rebased below it,
+ * converted signed and get the top bit back.
+ */
+static void genFloatToU64(CodeGenContext *ctx, IrDataType srcType) {
+    int label = ctx->nextLab++;
+    if (srcType == IR_TYPE_FLOAT) emitInstruction(ctx, "cvtss2sd %%xmm0, %%xmm0");
+    emitInstruction(ctx, "movsd .LC%d(%%rip), %%xmm1", addDoubleLit(ctx, 9223372036854775808.0));
+    emitInstruction(ctx, "ucomisd %%xmm1, %%xmm0");
+    emitInstruction(ctx, "jae .Lcvt%d", label);
+    emitInstruction(ctx, "cvttsd2siq %%xmm0, %%rax");
+    emitInstruction(ctx, "jmp .Lcvt%d_done", label);
+    sbAppendf(&ctx->text, ".Lcvt%d:\n", label);
+    emitInstruction(ctx, "subsd %%xmm1, %%xmm0");
+    emitInstruction(ctx, "cvttsd2siq %%xmm0, %%rax");
+    emitInstruction(ctx, "btcq $63, %%rax");
+    sbAppendf(&ctx->text, ".Lcvt%d_done:\n", label);
 }
 
 void genCast(CodeGenContext *ctx, IrInstruction *inst) {
@@ -710,6 +1124,37 @@ void genCast(CodeGenContext *ctx, IrInstruction *inst) {
         genCopy(ctx, inst);
         return;
     }
+
+    if ((irIsInteger(srcType) || srcType == IR_TYPE_BOOL) && irIsInteger(dstType)) {
+        genIntCast(ctx, inst);
+        return;
+    }
+
+    // Sized integers to and from floating point; u32 and the 64-bit types go through rax
+    if (irIsInteger(srcType) && srcType != IR_TYPE_INT && isFloatingPoint(dstType)) {
+        loadOp(ctx, &inst->ar1, "a");
+        if (srcType == IR_TYPE_U64) {
+            genU64ToFloat(ctx, dstType);
+        } else if (irIntBits(srcType) == 64 || srcType == IR_TYPE_U32) {
+            emitInstruction(ctx, "cvtsi2%sq %%rax, %%xmm0", getSSESuffix(dstType));
+        } else {
+            emitInstruction(ctx, "cvtsi2%s %%eax, %%xmm0", getSSESuffix(dstType));
+        }
+        storeOp(ctx, "%xmm0", &inst->result);
+        return;
+    }
+    if (isFloatingPoint(srcType) && irIsInteger(dstType) && dstType != IR_TYPE_INT) {
+        loadOp(ctx, &inst->ar1, "%xmm0");
+        if (dstType == IR_TYPE_U64) {
+            genFloatToU64(ctx, srcType);
+        } else if (irIntBits(dstType) == 64 || dstType == IR_TYPE_U32) {
+            emitInstruction(ctx, "cvtt%s2siq %%xmm0, %%rax", getSSESuffix(srcType));
+        } else {
+            emitInstruction(ctx, "cvtt%s2si %%xmm0, %%eax", getSSESuffix(srcType));
+        }
+        storeOp(ctx, "a", &inst->result);
+        return;
+    }
     
     // Int to Float
     if (srcType == IR_TYPE_INT && dstType == IR_TYPE_FLOAT) {
@@ -754,7 +1199,7 @@ void genCast(CodeGenContext *ctx, IrInstruction *inst) {
 }
 
 void genComparison(CodeGenContext *ctx, IrInstruction *inst) {
-    IrDataType type = inst->ar1.dataType;
+    IrDataType type = getRegisterType(inst->ar1.dataType);
 
     if (type == IR_TYPE_POINTER || inst->ar2.dataType == IR_TYPE_POINTER) {
         loadOp(ctx, &inst->ar1, "a");
@@ -778,14 +1223,16 @@ void genComparison(CodeGenContext *ctx, IrInstruction *inst) {
                        getIntReg("a", type));
     }
     
+    // ucomis and unsigned compares set CF, use the below/above conditions
+    int unsignedFlags = isFloatingPoint(type) || irIsUnsigned(type);
     const char *setInst;
     switch (inst->op) {
         case IR_EQ: setInst = "sete"; break;
         case IR_NE: setInst = "setne"; break;
-        case IR_LT: setInst = isFloatingPoint(type) ? "setb" : "setl"; break;
-        case IR_LE: setInst = isFloatingPoint(type) ? "setbe" : "setle"; break;
-        case IR_GT: setInst = isFloatingPoint(type) ? "seta" : "setg"; break;
-        case IR_GE: setInst = isFloatingPoint(type) ? "setae" : "setge"; break;
+        case IR_LT: setInst = unsignedFlags ? "setb" : "setl"; break;
+        case IR_LE: setInst = unsignedFlags ? "setbe" : "setle"; break;
+        case IR_GT: setInst = unsignedFlags ? "seta" : "setg"; break;
+        case IR_GE: setInst = unsignedFlags ? "setae" : "setge"; break;
         default: setInst = "sete"; break;
     }
     
@@ -808,10 +1255,219 @@ void genLogical(CodeGenContext *ctx, IrInstruction *inst) {
         default:
             break;
     }
-    
+
     storeOp(ctx, "a", &inst->result);
 }
 
+/**
+ * @brief Loads an integer index into %rcx, sign extending 32-bit signed ones.
+ */
+static void loadIndex(CodeGenContext *ctx, IrOperand *index) {
+    IrDataType type = getRegisterType(index->dataType);
+    loadOp(ctx, index, "c");
+    if (irIntBits(type) == 32 && !irIsUnsigned(type)) {
+        emitInstruction(ctx, "movslq %%ecx, %%rcx");
+    }
+}
+
+/**
+ * @brief Loads the address of an array's first element, or a pointer's value, into %rax.
+ */
+static int loadVectorBase(CodeGenContext *ctx, IrOperand *base) {
+    VarLoc *var = base->type == OPERAND_VAR ? findVarOp(ctx, base) : NULL;
+    if (!var) return 0;
+    emitInstruction(ctx, "%s %d(%%rbp), %%rax", var->isAddresable ? "leaq" : "movq", var->stackOffset);
+    return 1;
+}
+
+static void genVectorLoad(CodeGenContext *ctx, IrInstruction *inst) {
+    IrDataType type = inst->result.dataType;
+
+    loadIndex(ctx, &inst->ar2);
+    if (!loadVectorBase(ctx, &inst->ar1)) return;
+    emitInstruction(ctx, "%s (%%rax,%%rcx,%d), %s", vectorMove(type), getTypeSize(irLaneType(type)),
+                    vectorReg(type, 0));
+    storeOp(ctx, vectorReg(type, 0), &inst->result);
+    endVectorOp(ctx, type);
+}
+
+static void genVectorStore(CodeGenContext *ctx, IrInstruction *inst) {
+    IrDataType type = inst->ar2.dataType;
+
+    loadOp(ctx, &inst->ar2, vectorReg(type, 0));
+    loadIndex(ctx, &inst->ar1);
+    if (loadVectorBase(ctx, &inst->result)) {
+        emitInstruction(ctx, "%s %s, (%%rax,%%rcx,%d)", vectorMove(type), vectorReg(type, 0),
+                        getTypeSize(irLaneType(type)));
+    }
+    endVectorOp(ctx, type);
+}
+
+static void genVectorSplat(CodeGenContext *ctx, IrInstruction *inst) {
+    IrDataType type = inst->result.dataType;
+    int wide = isWideVector(type);
+
+    switch (irLaneType(type)) {
+        case IR_TYPE_FLOAT:
+            loadOp(ctx, &inst->ar1, "%xmm0");
+            emitInstruction(ctx, wide ? "vbroadcastss %%xmm0, %%ymm0" : "shufps $0, %%xmm0, %%xmm0");
+            break;
+        case IR_TYPE_DOUBLE:
+            loadOp(ctx, &inst->ar1, "%xmm0");
+            emitInstruction(ctx, wide ? "vbroadcastsd %%xmm0, %%ymm0" : "unpcklpd %%xmm0, %%xmm0");
+            break;
+        default:
+            loadOp(ctx, &inst->ar1, "a");
+            emitInstruction(ctx, "movd %%eax, %%xmm0");
+            emitInstruction(ctx, wide ? "vpbroadcastd %%xmm0, %%ymm0" : "pshufd $0, %%xmm0, %%xmm0");
+            break;
+    }
+    storeOp(ctx, vectorReg(type, 0), &inst->result);
+    endVectorOp(ctx, type);
+}
+
+/**
+ * @brief Lane permutation, ar2 holds the source lane of each result lane in
+ * 3 bits. Immediate shuffles up to 4 lanes, 8-lane ones index through a
+ * constant vector since vpermd/vpermps only take a register selector.
+ */
+static void genVectorShuffle(CodeGenContext *ctx, IrInstruction *inst) {
+    IrDataType type = inst->result.dataType;
+    int lanes = irLaneCount(type);
+    int selector = inst->ar2.value.constant.intVal;
+
+    loadOp(ctx, &inst->ar1, vectorReg(type, 0));
+    if (lanes == 8) {
+        int label = ctx->nextLab++;
+        if (ctx->statFn) ctx->statFn->constants++;
+        sbAppend(&ctx->data, "    .p2align 5\n");
+        emitDataLabel(ctx, label);
+        sbAppend(&ctx->data, "    .long ");
+        for (int i = 0; i < lanes; i++) {
+            sbAppendf(&ctx->data, "%d%s", (selector >> (3 * i)) & 7, i + 1 < lanes ? ", " : "\n");
+        }
+        emitInstruction(ctx, "vmovdqu .LC%d(%%rip), %%ymm1", label);
+        emitInstruction(ctx, "%s %%ymm0, %%ymm1, %%ymm0", irLaneType(type) == IR_TYPE_INT ? "vpermd" : "vpermps");
+    } else {
+        int bits = lanes == 2 ? 1 : 2;
+        int imm = 0;
+        for (int i = 0; i < lanes; i++) imm |= ((selector >> (3 * i)) & 7) << (bits * i);
+        switch (type) {
+            case IR_TYPE_F32X4: emitInstruction(ctx, "shufps $%d, %%xmm0, %%xmm0", imm); break;
+            case IR_TYPE_F64X2: emitInstruction(ctx, "shufpd $%d, %%xmm0, %%xmm0", imm); break;
+            case IR_TYPE_F64X4: emitInstruction(ctx, "vpermpd $%d, %%ymm0, %%ymm0", imm); break;
+            default: emitInstruction(ctx, "pshufd $%d, %%xmm0, %%xmm0", imm); break;
+        }
+    }
+    storeOp(ctx, vectorReg(type, 0), &inst->result);
+    endVectorOp(ctx, type);
+}
+
+/**
+ * @brief %xmm0 = %xmm0 op %xmm1 for a reduction: 0 add, 1 min, 2 max.
+ */
+static void emitReduceStep(CodeGenContext *ctx, IrDataType type, int kind) {
+    static const char *const intOps[] = {"paddd", "pminsd", "pmaxsd"};
+    static const char *const fpOps[] = {"add", "min", "max"};
+
+    if (irLaneType(type) == IR_TYPE_INT) {
+        if (kind != 0 && !wantAvx2(ctx)) {
+            emitMinMaxI32x4Sse2(ctx, kind == 2);
+            return;
+        }
+        emitPackedOp(ctx, type, intOps[kind], "%xmm1", "%xmm0");
+        return;
+    }
+    char name[16];
+    snprintf(name, sizeof(name), "%s%s", fpOps[kind], irLaneType(type) == IR_TYPE_FLOAT ? "ps" : "pd");
+    emitPackedOp(ctx, type, name, "%xmm1", "%xmm0");
+}
+
+/**
+ * @brief Horizontal add/min/max: a 256-bit vector first folds its upper half
+ * onto the lower one, then the halves of what is left are folded until lane
+ * 0 holds the result.
+ */
+static void genVectorReduce(CodeGenContext *ctx, IrInstruction *inst) {
+    IrDataType type = inst->ar1.dataType;
+    int kind = inst->ar2.value.constant.intVal;
+
+    loadOp(ctx, &inst->ar1, vectorReg(type, 0));
+    if (isWideVector(type)) {
+        emitInstruction(ctx, "vextractf128 $1, %%ymm0, %%xmm1");
+        emitReduceStep(ctx, type, kind);
+        emitInstruction(ctx, "vzeroupper");
+        type = type == IR_TYPE_F32X8 ? IR_TYPE_F32X4 : type == IR_TYPE_F64X4 ? IR_TYPE_F64X2 : IR_TYPE_I32X4;
+    }
+    emitInstruction(ctx, "pshufd $0x4e, %%xmm0, %%xmm1");
+    emitReduceStep(ctx, type, kind);
+    if (irLaneCount(type) == 4) {
+        emitInstruction(ctx, "pshufd $0xb1, %%xmm0, %%xmm1");
+        emitReduceStep(ctx, type, kind);
+    }
+
+    if (irLaneType(type) == IR_TYPE_INT) {
+        emitInstruction(ctx, "movd %%xmm0, %%eax");
+        storeOp(ctx, "a", &inst->result);
+    } else {
+        storeOp(ctx, "%xmm0", &inst->result);
+    }
+}
+
+/**
+ * @brief Frame address of one lane of a vector variable or temp. Indices are
+ * masked to the lane count, variable ones go through %rcx.
+ */
+static void laneAddress(CodeGenContext *ctx, IrOperand *vector, IrOperand *index, char *buf, size_t size) {
+    IrDataType type = vector->dataType;
+    int laneSize = getTypeSize(irLaneType(type));
+    int mask = irLaneCount(type) - 1;
+    int off;
+    if (vector->type == OPERAND_VAR) {
+        addLocalVarOp(ctx, vector, type);
+        off = varOffset(ctx, vector);
+    } else {
+        off = getTempOffset(ctx, vector->value.temp.tempNum, type);
+    }
+
+    if (index->type == OPERAND_CONSTANT) {
+        snprintf(buf, size, "%d(%%rbp)", off + (int)(irIntValue(ctx->ir, *index) & mask) * laneSize);
+    } else {
+        loadOp(ctx, index, "c");
+        emitInstruction(ctx, "andl $%d, %%ecx", mask);
+        snprintf(buf, size, "%d(%%rbp,%%rcx,%d)", off, laneSize);
+    }
+}
+
+static void genLaneLoad(CodeGenContext *ctx, IrInstruction *inst) {
+    IrDataType lane = irLaneType(inst->ar1.dataType);
+    char addr[48];
+
+    laneAddress(ctx, &inst->ar1, &inst->ar2, addr, sizeof(addr));
+    if (ctx->statFn) ctx->statFn->stackLoads++;
+    if (lane == IR_TYPE_INT) {
+        emitInstruction(ctx, "movl %s, %%eax", addr);
+        storeOp(ctx, "a", &inst->result);
+    } else {
+        emitInstruction(ctx, "mov%s %s, %%xmm0", getSSESuffix(lane), addr);
+        storeOp(ctx, "%xmm0", &inst->result);
+    }
+}
+
+static void genLaneStore(CodeGenContext *ctx, IrInstruction *inst) {
+    IrDataType lane = irLaneType(inst->result.dataType);
+    char addr[48];
+
+    loadOp(ctx, &inst->ar2, lane == IR_TYPE_INT ? "d" : "%xmm0");
+    laneAddress(ctx, &inst->result, &inst->ar1, addr, sizeof(addr));
+    if (ctx->statFn) ctx->statFn->stackStores++;
+    if (lane == IR_TYPE_INT) {
+        emitInstruction(ctx, "movl %%edx, %s", addr);
+    } else {
+        emitInstruction(ctx, "mov%s %%xmm0, %s", getSSESuffix(lane), addr);
+    }
+}
+
 void generateInstruction(CodeGenContext *ctx, IrInstruction *inst, int *paramCount) {
     switch (inst->op) {
         case IR_ADD:
@@ -875,8 +1531,22 @@ void generateInstruction(CodeGenContext *ctx, IrInstruction *inst, int *paramCou
         case IR_ADDROF:
             genAddrof(ctx, inst);
             break;
-        case IR_LABEL:
-            emitLabelNum(ctx, inst->result.value.label.labelNum);
+        case IR_LABEL: {
+            int label = inst->result.value.label.labelNum;
+            if (ctx->loopHeaders && label < ctx->labelCount && ctx->loopHeaders[label]) {
+                // pad only when it costs at most 10 bytes, like gcc's loop alignment
+                sbAppend(&ctx->text, "    .p2align 4,,10\n");
+            }
+            emitLabelNum(ctx, label);
+            break;
+        }
+
+        case IR_COLD_BEGIN:
+            sbAppend(&ctx->text, "    .pushsection .text.unlikely, \"ax\", @progbits\n");
+            break;
+
+        case IR_COLD_END:
+            sbAppend(&ctx->text, "    .popsection\n");
             break;
             
         case IR_GOTO:
@@ -884,6 +1554,7 @@ void generateInstruction(CodeGenContext *ctx, IrInstruction *inst, int *paramCou
             break;
             
         case IR_IF_FALSE:
+        case IR_IF_TRUE:
             genIfFalse(ctx, inst);
             break;
             
@@ -923,6 +1594,42 @@ void generateInstruction(CodeGenContext *ctx, IrInstruction *inst, int *paramCou
         case IR_MEMBER_STORE:
             genMemberStore(ctx, inst);
             break;    
+
+        case IR_PROFILE_FUNC:
+            genProfileFunc(ctx, inst);
+            break;
+
+        case IR_PROFILE_COUNT:
+            genProfileCount(ctx, inst);
+            break;
+
+        case IR_VEC_SPLAT:
+            genVectorSplat(ctx, inst);
+            break;
+
+        case IR_VEC_LOAD:
+            genVectorLoad(ctx, inst);
+            break;
+
+        case IR_VEC_STORE:
+            genVectorStore(ctx, inst);
+            break;
+
+        case IR_VEC_SHUFFLE:
+            genVectorShuffle(ctx, inst);
+            break;
+
+        case IR_VEC_REDUCE:
+            genVectorReduce(ctx, inst);
+            break;
+
+        case IR_LANE_LOAD:
+            genLaneLoad(ctx, inst);
+            break;
+
+        case IR_LANE_STORE:
+            genLaneStore(ctx, inst);
+            break;
         default:
             emitComment(ctx, "Unknown instruction");
             break;
@@ -930,30 +1637,123 @@ void generateInstruction(CodeGenContext *ctx, IrInstruction *inst, int *paramCou
 }
 
 static void generateMainWrapper(CodeGenContext *ctx) {
+    if (wantLayout(ctx)) sbAppend(&ctx->text, "\n    .p2align 4");
     sbAppend(&ctx->text, "\n    .globl main\n");
     sbAppend(&ctx->text, "    .type main, @function\n");
     sbAppend(&ctx->text, "main:\n");
-    emitInstruction(ctx, "pushq %%rbp");
-    emitInstruction(ctx, "movq %%rsp, %%rbp");
+    emitPrologue(ctx);
 }
 
 static void generateMainEpilogue(CodeGenContext *ctx) {
+    if (wantProfile(ctx)) {
+        emitProfileHook(ctx, "exit", "main", 4);
+    }
     emitInstruction(ctx, "movl $0, %%eax");
-    emitInstruction(ctx, "movq %%rbp, %%rsp");
-    emitInstruction(ctx, "popq %%rbp");
-    emitInstruction(ctx, "ret");
+    emitEpilogue(ctx);
+    emitFrameSize(ctx, "main", 4, -ctx->globalStackOff);
+}
+
+static void markLoopHeaders(CodeGenContext *ctx, IrContext *ir) {
+    ctx->labelCount = ir->nextLabelNum + 1;
+    ctx->loopHeaders = calloc(ctx->labelCount, 1);
+    unsigned char *seen = calloc(ctx->labelCount, 1);
+    if (!ctx->loopHeaders || !seen) {
+        free(seen);
+        return;
+    }
+    for (IrInstruction *inst = ir->instructions; inst; inst = inst->next) {
+        int target = -1;
+        if (inst->op == IR_LABEL) {
+            target = inst->result.value.label.labelNum;
+            if (target >= 0 && target < ctx->labelCount) seen[target] = 1;
+            continue;
+        }
+        if (inst->op == IR_GOTO) target = inst->ar1.value.label.labelNum;
+        if (inst->op == IR_IF_FALSE || inst->op == IR_IF_TRUE) target = inst->ar2.value.label.labelNum;
+        if (target >= 0 && target < ctx->labelCount && seen[target]) ctx->loopHeaders[target] = 1;
+    }
+    free(seen);
+}
+
+static void indexSourceLines(CodeGenContext *ctx, const char *source) {
+    int capacity = 256;
+    ctx->lineStarts = malloc(capacity * sizeof(const char *));
+    if (!ctx->lineStarts) return;
+    ctx->lineStarts[ctx->lineCount++] = source;
+    for (const char *p = source; *p; p++) {
+        if (*p != '\n') continue;
+        if (ctx->lineCount == capacity) {
+            capacity *= 2;
+            const char **grown = realloc(ctx->lineStarts, capacity * sizeof(const char *));
+            if (!grown) return;
+            ctx->lineStarts = grown;
+        }
+        ctx->lineStarts[ctx->lineCount++] = p + 1;
+    }
+}
+
+static void emitFileDirective(StringBuffer *sb, const char *fileNum, const char *path) {
+    sbAppendf(sb, "    .file %s\"", fileNum ? fileNum : "");
+    for (const char *c = path; *c; c++) {
+        if (*c == '"' || *c == '\\') sbAppend(sb, "\\");
+        sbAppendf(sb, "%c", *c);
+    }
+    sbAppend(sb, "\"\n");
+}
+
+/**
+ * @brief Marks where the code for inst starts: a .loc directive with debug
+ * info, and with annotations the source line (when it changed) and the IR
+ * instruction as comments.
+ */
+static void emitSourceMarkers(CodeGenContext *ctx, IrInstruction *inst, int *lastLine) {
+    const CodegenOptions *opts = ctx->options;
+    if (inst->line > 0 && inst->line != *lastLine) {
+        if (opts->annotate && inst->line <= ctx->lineCount) {
+            const char *line = ctx->lineStarts[inst->line - 1];
+            while (*line == ' ' || *line == '\t') line++;
+            int len = 0;
+            while (line[len] && line[len] != '\n' && line[len] != '\r') len++;
+            sbAppendf(&ctx->text, "\n    # %s:%d: %.*s\n", opts->sourceName, inst->line, len, line);
+        }
+        if (opts->debugInfo && opts->sourceName) {
+            sbAppendf(&ctx->text, "    .loc 1 %d %d\n", inst->line, inst->column);
+        }
+        *lastLine = inst->line;
+    }
+    if (!opts->annotate) return;
+
+    char ir[256];
+    formatInstruction(ctx->ir, inst, ir, sizeof(ir));
+    for (char *c = ir; *c; c++) {
+        if (*c == '\n' || *c == '\r') *c = ' ';
+    }
+    sbAppendf(&ctx->text, "    #   %s\n", ir);
 }
 
-char *generateAssembly(IrContext *ir, const char *moduleName, ModuleInterface **imports, int importCount) {
+char *generateAssembly(IrContext *ir, const char *moduleName, ModuleInterface **imports, int importCount,
+                       const CodegenOptions *opts) {
     if (!ir) return NULL;
     
     CodeGenContext *ctx = createCodeGenContext();
     if (!ctx) return NULL;
 
+    CodegenStats *stats = opts ? opts->stats : NULL;
+    int annotate = opts && opts->annotate && opts->source;
+    int markSource = annotate || (opts && opts->debugInfo && opts->sourceName);
+    ctx->ir = ir;
     ctx->imports = imports;
     ctx->importCount = importCount;
     ctx->moduleName = moduleName;
+    ctx->stats = stats;
+    ctx->options = opts;
+    if (annotate) indexSourceLines(ctx, opts->source);
+    if (opts && opts->layout) markLoopHeaders(ctx, ir);
     
+    if (opts && opts->debugInfo && opts->sourceName) {
+        emitFileDirective(&ctx->data, NULL, opts->sourceName);
+        emitFileDirective(&ctx->data, "1 ", opts->sourceName);
+    }
     sbAppend(&ctx->data, "    .section .rodata\n");
     sbAppend(&ctx->text, "    .text\n");
     
@@ -962,6 +1762,9 @@ char *generateAssembly(IrContext *ir, const char *moduleName, ModuleInterface **
     int paramCount = 0;
     int inUserFunction = 0;
     int mainStarted = 0;
+    FunctionStats *mainStats = NULL;
+    int mainLine = 0;
+    int funcLine = 0;
     
     StringBuffer mainText = ctx->text;
     
@@ -970,28 +1773,41 @@ char *generateAssembly(IrContext *ir, const char *moduleName, ModuleInterface **
         if (inst->op == IR_FUNC_BEGIN) {
             inUserFunction = 1;
             ctx->text = funcText;
+            funcLine = 0;
+            if (markSource) emitSourceMarkers(ctx, inst, &funcLine);
             generateInstruction(ctx, inst, &paramCount);
             funcText = ctx->text;
         } 
         else if (inst->op == IR_FUNC_END) {
             ctx->text = funcText;
+            if (markSource) emitSourceMarkers(ctx, inst, &funcLine);
             generateInstruction(ctx, inst, &paramCount);
             funcText = ctx->text;
             inUserFunction = 0;
         }
         else if (inUserFunction) {
             ctx->text = funcText;
+            if (markSource) emitSourceMarkers(ctx, inst, &funcLine);
             generateInstruction(ctx, inst, &paramCount);
             funcText = ctx->text;
         }
         else {
             ctx->text = mainText;
             
+            if (!mainStarted) {
+                mainStats = beginFunctionStats(stats, moduleName, "main", 4);
+            }
+            ctx->statFn = mainStats;
             if (!mainStarted) {
                 generateMainWrapper(ctx);
-                emitInstruction(ctx, "subq $256, %%rsp");
+                emitInstruction(ctx, "subq $.Lframe_main, %%rsp");
+                if (wantProfile(ctx)) {
+                    emitProfileRecord(ctx, "main", 4);
+                    emitProfileHook(ctx, "enter", "main", 4);
+                }
                 mainStarted = 1;
             }
+            if (markSource) emitSourceMarkers(ctx, inst, &mainLine);
             generateInstruction(ctx, inst, &paramCount);
             mainText = ctx->text;
         }
@@ -1001,6 +1817,7 @@ char *generateAssembly(IrContext *ir, const char *moduleName, ModuleInterface **
     
     ctx->text = mainText;
     if (mainStarted) {
+        ctx->statFn = mainStats;
         generateMainEpilogue(ctx);
         mainText = ctx->text;
     }
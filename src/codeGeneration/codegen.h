@@ -9,6 +9,7 @@
 #include "./dataPool.h"
 #include "../IR/ir.h"
 #include "./variableHandling.h"
+#include "./codegenStats.h"
 #include "../modules/interface.h"
 
 typedef struct FuncInfo {
@@ -16,10 +17,24 @@ typedef struct FuncInfo {
     size_t nameLen;
     int stackSize;
     int paramCount;
+    int cold;
+    int ownSection;             // emitted between .pushsection and .popsection
     VarLoc *locs;
     TempLoc *temps;
 } FuncInfo;
 
+typedef struct CodegenOptions {
+    CodegenStats *stats;        // per-function statistics, NULL to skip
+    const char *source;         // module source, required for annotated listings
+    const char *sourceName;
+    int annotate;               // interleave source lines and IR as comments
+    int debugInfo;              // emit .file/.loc line tables and CFI unwind directives
+    int profile;                // call the runtime's rdtsc entry/exit hooks in every function
+    int layout;                 // align entries and loop headers, never-run functions to .text.unlikely
+    int functionSections;       // each function in .text.<name>, for the linker's --gc-sections
+    int avx2;                   // AVX2 target: 256-bit vectors, pmulld/pminsd on 128-bit ones
+} CodegenOptions;
+
 typedef struct CodeGenContext {
     StringBuffer data;
     StringBuffer text;
@@ -29,6 +44,7 @@ typedef struct CodeGenContext {
     FloatEntry *floatPool;
     int nextLab;
 
+    const IrContext *ir;                // names and constants of the module being emitted
     VarLoc *globalVars;
     TempLoc *globalTemps;
     int globalStackOff;
@@ -42,6 +58,15 @@ typedef struct CodeGenContext {
     const char *moduleName;
     ModuleInterface **imports;
     int importCount;
+
+    CodegenStats *stats;
+    FunctionStats *statFn;
+
+    const CodegenOptions *options;
+    const char **lineStarts;
+    int lineCount;
+    unsigned char *loopHeaders;     // by label number, targets of backward branches
+    int labelCount;
 } CodeGenContext;
 
 CodeGenContext *createCodeGenContext(void);
@@ -67,7 +92,11 @@ void genLogical(CodeGenContext *ctx, IrInstruction *inst);
 void genCast(CodeGenContext *ctx, IrInstruction *inst);
 void generateInstruction(CodeGenContext *ctx, IrInstruction *inst, int *paramCount);
 
-char *generateAssembly(IrContext *ir, const char *moduleName, ModuleInterface **imports, int importCount);
+/**
+ * @brief Generates x86-64 assembly for a module. opts may be NULL.
+ */
+char *generateAssembly(IrContext *ir, const char *moduleName, ModuleInterface **imports, int importCount,
+                       const CodegenOptions *opts);
 int writeAssemblyToFile(const char *assembly, const char *filename);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,169 @@
+#include "./codegenStats.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+CodegenStats *createCodegenStats(void) {
+    return calloc(1, sizeof(CodegenStats));
+}
+
+void freeCodegenStats(CodegenStats *stats) {
+    if (!stats) return;
+    for (int i = 0; i < stats->count; i++) {
+        free(stats->functions[i]->module);
+        free(stats->functions[i]->name);
+        free(stats->functions[i]);
+    }
+    free(stats->functions);
+    free(stats);
+}
+
+FunctionStats *beginFunctionStats(CodegenStats *stats, const char *module, const char *name, size_t nameLen) {
+    if (!stats) return NULL;
+    if (stats->count == stats->capacity) {
+        int capacity = stats->capacity ? stats->capacity * 2 : 16;
+        FunctionStats **grown = realloc(stats->functions, capacity * sizeof(FunctionStats *));
+        if (!grown) return NULL;
+        stats->functions = grown;
+        stats->capacity = capacity;
+    }
+
+    FunctionStats *fn = calloc(1, sizeof(FunctionStats));
+    if (!fn) return NULL;
+    fn->module = strdup(module ? module : "main");
+    fn->name = strndup(name, nameLen);
+    stats->functions[stats->count++] = fn;
+    return fn;
+}
+
+static int startsWith(const char *text, const char *prefix) {
+    return strncmp(text, prefix, strlen(prefix)) == 0;
+}
+
+static InsnClass classify(const char *mnemonic, size_t len) {
+    if (len == 0) return INSN_OTHER;
+    if (startsWith(mnemonic, "call")) return INSN_CALL;
+    if (mnemonic[0] == 'j') return INSN_BRANCH;
+    if (startsWith(mnemonic, "mov") || startsWith(mnemonic, "lea")) return INSN_MOVE;
+    if (startsWith(mnemonic, "cmp") || startsWith(mnemonic, "test") || startsWith(mnemonic, "ucomis") ||
+        startsWith(mnemonic, "comis") || startsWith(mnemonic, "set")) {
+        return INSN_COMPARE;
+    }
+    if (startsWith(mnemonic, "push") || startsWith(mnemonic, "pop")) return INSN_STACK;
+    if (startsWith(mnemonic, "cvt")) return INSN_SSE;
+    // packed integer (paddd, pshufd) and VEX encoded (vaddps, vpermd) vector code
+    if (mnemonic[0] == 'p' || mnemonic[0] == 'v') return INSN_SSE;
+
+    // addsd, mulss, xorpd, andps...
+    if (len > 2) {
+        const char *tail = mnemonic + len - 2;
+        if (!strncmp(tail, "sd", 2) || !strncmp(tail, "ss", 2) || !strncmp(tail, "pd", 2) ||
+            !strncmp(tail, "ps", 2)) {
+            return INSN_SSE;
+        }
+    }
+
+    static const char *arith[] = {"add", "sub", "imul", "mul", "idiv", "div", "neg", "not", "and",
+                                  "or", "xor", "shl", "shr", "sar", "sal", "inc", "dec", "cltd", "cqto"};
+    for (size_t i = 0; i < sizeof(arith) / sizeof(arith[0]); i++) {
+        if (startsWith(mnemonic, arith[i])) return INSN_ARITH;
+    }
+    return INSN_OTHER;
+}
+
+void countInstruction(FunctionStats *fn, const char *text) {
+    if (!fn) return;
+    while (*text == ' ') text++;
+    size_t len = strcspn(text, " \n");
+
+    InsnClass cls = classify(text, len);
+    fn->classes[cls]++;
+    fn->instructions++;
+    if (cls == INSN_CALL) fn->calls++;
+}
+
+int functionCost(const FunctionStats *fn) {
+    return fn->instructions + fn->stackLoads + fn->stackStores;
+}
+
+static int compareCost(const void *a, const void *b) {
+    const FunctionStats *fa = *(FunctionStats *const *)a;
+    const FunctionStats *fb = *(FunctionStats *const *)b;
+    int diff = functionCost(fb) - functionCost(fa);
+    return diff ? diff : strcmp(fa->name, fb->name);
+}
+
+static void printRow(FILE *out, const char *name, const FunctionStats *fn) {
+    fprintf(out, "%-20.20s %6d %6d %6d %6d %5d %6d %5d %5d %5d %5d %5d %5d %5d %7d\n", name,
+            fn->frameBytes, fn->instructions, fn->stackLoads, fn->stackStores, fn->calls, fn->constants,
+            fn->classes[INSN_MOVE], fn->classes[INSN_ARITH], fn->classes[INSN_COMPARE],
+            fn->classes[INSN_BRANCH], fn->classes[INSN_SSE], fn->classes[INSN_STACK],
+            fn->classes[INSN_OTHER], functionCost(fn));
+}
+
+static void addInto(FunctionStats *total, const FunctionStats *fn) {
+    total->frameBytes += fn->frameBytes;
+    total->instructions += fn->instructions;
+    total->stackLoads += fn->stackLoads;
+    total->stackStores += fn->stackStores;
+    total->calls += fn->calls;
+    total->constants += fn->constants;
+    for (int c = 0; c < INSN_CLASS_COUNT; c++) total->classes[c] += fn->classes[c];
+}
+
+void printCodegenStats(CodegenStats *stats, FILE *out) {
+    if (!stats) return;
+
+    // Modules in order of first appearance, each with its own table
+    const char **modules = malloc((stats->count + 1) * sizeof(char *));
+    FunctionStats *totals = calloc(stats->count + 1, sizeof(FunctionStats));
+    FunctionStats **rows = malloc((stats->count + 1) * sizeof(FunctionStats *));
+    if (!modules || !totals || !rows) {
+        free(modules);
+        free(totals);
+        free(rows);
+        return;
+    }
+
+    int moduleCount = 0;
+    for (int i = 0; i < stats->count; i++) {
+        int known = 0;
+        for (int m = 0; m < moduleCount && !known; m++) known = !strcmp(modules[m], stats->functions[i]->module);
+        if (!known) modules[moduleCount++] = stats->functions[i]->module;
+    }
+
+    fprintf(out, "\n=== CODEGEN STATS ===\n");
+    for (int m = 0; m < moduleCount; m++) {
+        int rowCount = 0;
+        for (int i = 0; i < stats->count; i++) {
+            if (!strcmp(stats->functions[i]->module, modules[m])) rows[rowCount++] = stats->functions[i];
+        }
+        qsort(rows, rowCount, sizeof(FunctionStats *), compareCost);
+
+        fprintf(out, "\nModule: %s\n", modules[m]);
+        fprintf(out, "%-20s %6s %6s %6s %6s %5s %6s %5s %5s %5s %5s %5s %5s %5s %7s\n", "function", "frame",
+                "insns", "loads", "stores", "calls", "consts", "move", "arith", "cmp", "jump", "sse", "stack",
+                "other", "cost");
+        totals[m].name = (char *)modules[m];
+        for (int r = 0; r < rowCount; r++) {
+            printRow(out, rows[r]->name, rows[r]);
+            addInto(&totals[m], rows[r]);
+        }
+        printRow(out, "total", &totals[m]);
+    }
+
+    if (moduleCount > 1) {
+        for (int m = 0; m < moduleCount; m++) rows[m] = &totals[m];
+        qsort(rows, moduleCount, sizeof(FunctionStats *), compareCost);
+        fprintf(out, "\nModules by cost:\n");
+        for (int m = 0; m < moduleCount; m++) {
+            fprintf(out, "  %-20s %6d insns %6d stack ops %7d cost\n", rows[m]->name, rows[m]->instructions,
+                    rows[m]->stackLoads + rows[m]->stackStores, functionCost(rows[m]));
+        }
+    }
+    fprintf(out, "\ncost = instructions + stack loads + stack stores\n");
+
+    free(rows);
+    free(totals);
+    free(modules);
+}
@@ -0,0 +1,66 @@
+#ifndef CODEGEN_STATS_H
+#define CODEGEN_STATS_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+typedef enum InsnClass {
+    INSN_MOVE,      // mov*, lea*
+    INSN_ARITH,     // integer add/sub/mul/div, bitwise, shifts
+    INSN_COMPARE,   // cmp, test, ucomis*, set*
+    INSN_BRANCH,    // j*
+    INSN_CALL,
+    INSN_SSE,       // float arithmetic, conversions and vector instructions
+    INSN_STACK,     // push/pop
+    INSN_OTHER,
+    INSN_CLASS_COUNT,
+} InsnClass;
+
+/**
+ * @brief What codegen emitted for one function. Top-level statements are
+ * reported as "main".
+ */
+typedef struct FunctionStats {
+    char *module;
+    char *name;
+    int frameBytes;
+    int stackLoads;
+    int stackStores;
+    int calls;
+    int instructions;
+    int constants;
+    int classes[INSN_CLASS_COUNT];
+} FunctionStats;
+
+typedef struct CodegenStats {
+    FunctionStats **functions;
+    int count;
+    int capacity;
+} CodegenStats;
+
+CodegenStats *createCodegenStats(void);
+void freeCodegenStats(CodegenStats *stats);
+
+/**
+ * @brief Starts a new function record; NULL when stats are off
+ */
+FunctionStats *beginFunctionStats(CodegenStats *stats, const char *module, const char *name, size_t nameLen);
+
+/**
+ * @brief Classifies one emitted instruction by its mnemonic
+ */
+void countInstruction(FunctionStats *fn, const char *text);
+
+/**
+ * @brief Cost used for sorting: emitted instructions plus stack memory
+ * traffic, so spill-heavy code ranks above equally long register code.
+ */
+int functionCost(const FunctionStats *fn);
+
+/**
+ * @brief Per-function tables for each module, most expensive first, then
+ * a summary of modules by cost
+ */
+void printCodegenStats(CodegenStats *stats, FILE *out);
+
+#endif //CODEGEN_STATS_H
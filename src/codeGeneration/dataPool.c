@@ -31,6 +31,7 @@ int addStringLit(CodeGenContext *ctx, const char *str, size_t len){
     entry->next = ctx->stringPool;
     ctx->stringPool = entry;
 
+    if (ctx->statFn) ctx->statFn->constants++;
     emitDataLabel(ctx, entry->labelNum);
     sbAppendf(&ctx->data, "    .string \"");
     for (size_t i = 0; i < len; i++) {
@@ -72,6 +73,7 @@ int addDoubleLit(CodeGenContext *ctx, double d){
     newEntry->next = ctx->doublePool;
     ctx->doublePool = newEntry;
 
+    if (ctx->statFn) ctx->statFn->constants++;
     emitDataLabel(ctx, newEntry->label);
     sbAppendf(&ctx->data, "    .double %.17g\n", d);
     return newEntry->label;
@@ -92,6 +94,7 @@ int addFloatLit(CodeGenContext *ctx, float f){
     newEntry->next = ctx->floatPool;
     ctx->floatPool = newEntry;
 
+    if (ctx->statFn) ctx->statFn->constants++;
     emitDataLabel(ctx, newEntry->label);
     sbAppendf(&ctx->data, "    .float %.9g\n", f);
     return newEntry->label;
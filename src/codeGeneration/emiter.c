@@ -16,6 +16,7 @@ void emitLabelNum(CodeGenContext *ctx, int labelNum){
 
 void emitInstruction(CodeGenContext *ctx, const char *fmt, ...){
     sbAppend(&ctx->text, "    ");
+    size_t start = ctx->text.len;
     va_list args;
     va_start(args, fmt);
     va_list argsCopy;
@@ -31,6 +32,7 @@ void emitInstruction(CodeGenContext *ctx, const char *fmt, ...){
 
     va_end(args);
     sbAppend(&ctx->text, "\n");
+    if (ctx->statFn) countInstruction(ctx->statFn, ctx->text.data + start);
 }
 
 void emitComment(CodeGenContext *ctx, const char *comment) {
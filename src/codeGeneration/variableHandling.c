@@ -9,60 +9,73 @@ int isFloatingPoint(IrDataType type){
 int getTypeSize(IrDataType type){
     switch(type){
         case IR_TYPE_BOOL:   return 1;
-        case IR_TYPE_INT:    return 4;
+        case IR_TYPE_I8:
+        case IR_TYPE_U8:     return 1;
+        case IR_TYPE_I16:
+        case IR_TYPE_U16:    return 2;
+        case IR_TYPE_INT:
+        case IR_TYPE_U32:    return 4;
         case IR_TYPE_FLOAT:  return 4;
         case IR_TYPE_DOUBLE: return 8;
         case IR_TYPE_STRING: return 8; // strings are pointers also
         case IR_TYPE_POINTER: return 8;
+        case IR_TYPE_F32X4:
+        case IR_TYPE_F64X2:
+        case IR_TYPE_I32X4:  return 16;
+        case IR_TYPE_F32X8:
+        case IR_TYPE_F64X4:
+        case IR_TYPE_I32X8:  return 32;
         default: return 8;
     }
 }
 
+IrDataType getRegisterType(IrDataType type) {
+    switch (type) {
+        case IR_TYPE_I8:
+        case IR_TYPE_I16: return IR_TYPE_INT;
+        case IR_TYPE_U8:
+        case IR_TYPE_U16: return IR_TYPE_U32;
+        default:          return type;
+    }
+}
+
 const char *getParamIntReg(int index, IrDataType type) {
-    static const char *regs32[] = {"%edi", "%esi", "%edx", "%ecx", "%r8d", "%r9d"};
-    static const char *regs64[] = {"%rdi", "%rsi", "%rdx", "%rcx", "%r8", "%r9"};
+    static const char *bases[] = {"di", "si", "d", "c", "8", "9"};
     
     if (index < 0 || index >= 6) return NULL;
     
-    return (type == IR_TYPE_INT) ? regs32[index] : regs64[index];
+    return getIntReg(bases[index], type);
 }
 
-const char *getIntSuffix(IrDataType type){
+// 0: byte, 1: word, 2: long, 3: quad
+static int intWidth(IrDataType type) {
     switch (type) {
-        case IR_TYPE_BOOL:  return "b";
-        case IR_TYPE_INT:   return "l";
-        default:            return "q";
+        case IR_TYPE_BOOL:
+        case IR_TYPE_I8:
+        case IR_TYPE_U8:  return 0;
+        case IR_TYPE_I16:
+        case IR_TYPE_U16: return 1;
+        case IR_TYPE_INT:
+        case IR_TYPE_U32: return 2;
+        default:          return 3;
     }
 }
 
+const char *getIntSuffix(IrDataType type){
+    static const char *suffixes[] = {"b", "w", "l", "q"};
+    return suffixes[intWidth(type)];
+}
+
 const char *getIntReg(const char *base, IrDataType type) {
-    switch (type) {
-        case IR_TYPE_BOOL:
-            if (strcmp(base, "a") == 0)  return "%al";
-            if (strcmp(base, "b") == 0)  return "%bl";
-            if (strcmp(base, "c") == 0)  return "%cl";
-            if (strcmp(base, "d") == 0)  return "%dl";
-            if (strcmp(base, "di") == 0) return "%dil";
-            if (strcmp(base, "si") == 0) return "%sil";
-            break;
-            
-        case IR_TYPE_INT:
-            if (strcmp(base, "a") == 0)  return "%eax";
-            if (strcmp(base, "b") == 0)  return "%ebx";
-            if (strcmp(base, "c") == 0)  return "%ecx";
-            if (strcmp(base, "d") == 0)  return "%edx";
-            if (strcmp(base, "di") == 0) return "%edi";
-            if (strcmp(base, "si") == 0) return "%esi";
-            break;
-            
-        default:
-            if (strcmp(base, "a") == 0)  return "%rax";
-            if (strcmp(base, "b") == 0)  return "%rbx";
-            if (strcmp(base, "c") == 0)  return "%rcx";
-            if (strcmp(base, "d") == 0)  return "%rdx";
-            if (strcmp(base, "di") == 0) return "%rdi";
-            if (strcmp(base, "si") == 0) return "%rsi";
-            break;
+    static const char *bases[] = {"a", "b", "c", "d", "di", "si", "8", "9"};
+    static const char *regs[][4] = {
+        {"%al", "%ax", "%eax", "%rax"},     {"%bl", "%bx", "%ebx", "%rbx"},
+        {"%cl", "%cx", "%ecx", "%rcx"},     {"%dl", "%dx", "%edx", "%rdx"},
+        {"%dil", "%di", "%edi", "%rdi"},    {"%sil", "%si", "%esi", "%rsi"},
+        {"%r8b", "%r8w", "%r8d", "%r8"},    {"%r9b", "%r9w", "%r9d", "%r9"},
+    };
+    for (size_t i = 0; i < sizeof(bases) / sizeof(bases[0]); i++) {
+        if (strcmp(base, bases[i]) == 0) return regs[i][intWidth(type)];
     }
     return "%rax"; 
 }
@@ -100,6 +113,7 @@ void addGlobalVar(CodeGenContext *ctx, const char *name, size_t len, IrDataType
     var->type = type;
     var->next = ctx->globalVars;
     var->isAddresable = 0;
+    var->holdsAddress = 0;
     var->arraySize = 0;
     ctx->globalVars = var;
 }
@@ -123,9 +137,8 @@ void addLocalVar(CodeGenContext *ctx, const char *name, size_t len, IrDataType t
     
     int size = getTypeSize(type);
     ctx->currentFn->stackSize += size;
-    int misalignment = (-ctx->globalStackOff) % size;
-    if (misalignment != 0) {
-        ctx->globalStackOff -= (size - misalignment);
+    if (ctx->currentFn->stackSize % size != 0) {
+        ctx->currentFn->stackSize += size - (ctx->currentFn->stackSize % size);
     }
     
     var->name = name;
@@ -134,6 +147,7 @@ void addLocalVar(CodeGenContext *ctx, const char *name, size_t len, IrDataType t
     var->type = type;
     var->next = ctx->currentFn->locs;
     var->isAddresable = 0;
+    var->holdsAddress = 0;
     var->arraySize = 0;
     ctx->currentFn->locs = var;
 }
@@ -181,6 +195,51 @@ void markVarAsAddresable(CodeGenContext *ctx, const char *name, size_t len, int
     }
 }
 
+/**
+ * @brief Grows the current frame (main's for globals) by `bytes` aligned to
+ * `alignment` below %rbp, and returns the offset of the first byte
+ */
+static int reserveFrameBytes(CodeGenContext *ctx, int bytes, int alignment) {
+    int used = ctx->currentFn ? ctx->currentFn->stackSize : -ctx->globalStackOff;
+    used = (used + bytes + alignment - 1) & ~(alignment - 1);
+    if (ctx->currentFn) {
+        ctx->currentFn->stackSize = used;
+    } else {
+        ctx->globalStackOff = -used;
+    }
+    return -used;
+}
+
+int addStructVar(CodeGenContext *ctx, const char *name, size_t len, int size, int alignment) {
+    VarLoc **list = ctx->currentFn ? &ctx->currentFn->locs : &ctx->globalVars;
+    VarLoc *var = *list;
+    while (var && !(var->nameLen == len && memcmp(var->name, name, len) == 0)) {
+        var = var->next;
+    }
+    if (!var) {
+        var = malloc(sizeof(struct VarLoc));
+        if (!var) return 0;
+        var->name = name;
+        var->nameLen = len;
+        var->type = IR_TYPE_POINTER;
+        var->next = *list;
+        *list = var;
+    }
+    var->arraySize = size;
+
+    // %rbp is 16 byte aligned, stricter alignment needs slack and a runtime round down
+    if (alignment <= 16) {
+        var->stackOffset = reserveFrameBytes(ctx, size, alignment);
+        var->isAddresable = 1;
+        var->holdsAddress = 0;
+        return var->stackOffset;
+    }
+    int storage = reserveFrameBytes(ctx, size + alignment - 16, 16);
+    var->stackOffset = reserveFrameBytes(ctx, 8, 8);
+    var->isAddresable = 0;
+    var->holdsAddress = 1;
+    return storage;
+}
 
 //just a wrap
 int getVarOffset(CodeGenContext *ctx, const char *name, size_t len) {
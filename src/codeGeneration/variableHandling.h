@@ -12,6 +12,7 @@ typedef struct VarLoc {
     IrDataType type;
     struct VarLoc *next;
     int isAddresable;
+    int holdsAddress;   // over-aligned struct: the slot keeps the struct's address
     int arraySize;
 } VarLoc;
 
@@ -34,10 +35,21 @@ const char *getSSESuffix(IrDataType type);
 const char *getSSEReg(int num);
 int getTypeSize(IrDataType type);
 const char *getIntSuffix(IrDataType type);
+/**
+ * @brief Type integer arithmetic on a value runs at: i8/i16 and u8/u16 are
+ * loaded extended into 32-bit registers and computed there.
+ */
+IrDataType getRegisterType(IrDataType type);
 int isFloatingPoint(IrDataType type);
 void freeVarList(VarLoc *list);
 void freeTempList(TempLoc *list);
 const char *getParamIntReg(int index, IrDataType type);
 void markVarAsAddresable(CodeGenContext *ctx, const char *name, size_t len, int arraySize);
+/**
+ * @brief Places a struct variable in the frame at the given alignment
+ * @return Offset from %rbp of the struct's storage; when the alignment is above
+ * the frame's 16 bytes the variable holdsAddress and the caller aligns into it
+ */
+int addStructVar(CodeGenContext *ctx, const char *name, size_t len, int size, int alignment);
 
 #endif // VARIABLE_HANDLING_H
\ No newline at end of file
@@ -4,7 +4,8 @@
  *
  * Provides error reporting, counting, and summary functionality with
  * support for different severity levels (WARNING, ERROR, FATAL).
- * Maintains global error state and provides formatted error output.
+ * Counts live in a per-thread ErrorState so that concurrent compilations
+ * (see modules/compiler.h) never share them.
  */
 
 #include "errorHandling.h"
@@ -13,12 +14,24 @@
 #include <stdlib.h>
 #include <string.h>
 
-/** @internal Global counter for non-fatal errors */
-static int errorCount = 0;
-/** @internal Global counter for warning messages */
-static int warningCount = 0;
-/** @internal Global counter for fatal errors */
-static int fatalCount = 0;
+/** @internal State used while no compilation installed its own */
+static _Thread_local ErrorState defaultState;
+/** @internal State of the compilation running on this thread */
+static _Thread_local ErrorState *currentState = NULL;
+
+static ErrorState *state(void) {
+	return currentState ? currentState : &defaultState;
+}
+
+ErrorState *getErrorState(void) {
+	return state();
+}
+
+ErrorState *setErrorState(ErrorState *errors) {
+	ErrorState *previous = currentState;
+	currentState = errors;
+	return previous;
+}
 
 void repError(ErrorCode code, const char *extraContext) {
 	reportError(code, NULL, extraContext);
@@ -53,6 +66,7 @@ void printSourceSnippet (ErrorContext * context) {
 
 void reportError(ErrorCode code, ErrorContext *context, const char *extraContext) {
     const ErrorInfo *info = getErrorInfo(code);
+    ErrorState *errors = state();
     // def vals
     const char *levelColor = RED;
     const char *levelText = "error";
@@ -60,22 +74,28 @@ void reportError(ErrorCode code, ErrorContext *context, const char *extraContext
     // Determine colors and text based on error level
     switch (info->level) {
         case WARNING:
-            warningCount++;
+            errors->warningCount++;
             levelColor = YELLOW;
             levelText = "warning";
             break;
         case ERROR:
-            errorCount++;
+            errors->errorCount++;
             levelColor = RED;
             levelText = "error";
             break;
         case FATAL:
-            fatalCount++;
+            errors->fatalCount++;
             levelColor = RED ;
             levelText = "error";
             break;
     }
 
+    // Embedders collect the diagnostic instead; fatal errors then fail the compilation, not the process
+    if (errors->handler) {
+        errors->handler(errors->userData, code, info->level, context, extraContext);
+        return;
+    }
+
     const char *RESET_COLOR = RESET ;
     const char *BLUE_COLOR = BLUE;
 
@@ -115,11 +135,14 @@ void reportError(ErrorCode code, ErrorContext *context, const char *extraContext
     if (info->level == FATAL) {
         printf("%serror:%s could not compile due to fatal error\n",
                levelColor, RESET_COLOR);
-        exit(code);
+        if (!errors->recoverFatal) exit(code);
     }
 }
 
 void printErrorSummary(void) {
+	int warningCount = state()->warningCount;
+	int errorCount = state()->errorCount;
+	int fatalCount = state()->fatalCount;
 	int totalIssues = warningCount + errorCount + fatalCount;
 
 	if (totalIssues == 0) {
@@ -153,9 +176,28 @@ void printErrorSummary(void) {
 }
 
 int hasErrors(void) {
-	return (errorCount > 0 || fatalCount > 0);
+	return (state()->errorCount > 0 || state()->fatalCount > 0);
 }
 
 int hasFatalErrors(void) {
-	return (fatalCount > 0);
+	return (state()->fatalCount > 0);
+}
+
+int getErrorCount(void) {
+	return state()->errorCount;
+}
+
+int getWarningCount(void) {
+	return state()->warningCount;
+}
+
+int getFatalCount(void) {
+	return state()->fatalCount;
+}
+
+void resetErrorCount(void) {
+	ErrorState *errors = state();
+	errors->errorCount = 0;
+	errors->warningCount = 0;
+	errors->fatalCount = 0;
 }
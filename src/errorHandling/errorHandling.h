@@ -129,6 +129,7 @@ typedef enum {
 	ERROR_EXPECTED_IMPORT = 3054,
 	ERROR_EXPECTED_EXPORT = 3055,
 	ERROR_PARSER_STUCK = 3056,
+	ERROR_INVALID_STRUCT_ATTRIBUTE = 3057,
 
 	// 4000s: Logic/Control flow errors
 	ERROR_INVALID_ASSIGNMENT_TARGET = 4001,
@@ -160,6 +161,7 @@ typedef enum {
 	ERROR_CALLING_NON_FUNCTION = 5012,
 	ERROR_FUNCTION_NO_OVERLOAD_MATCH = 5013,
 	ERROR_NO_ENTRY_POINT = 5014,
+	ERROR_CIRCULAR_IMPORT = 5015,
 
 	// 6000s: System/Internal errors
 	ERROR_MEMORY_ALLOCATION_FAILED = 6001,
@@ -204,6 +206,25 @@ typedef struct {
 	const char* suggestion;
 } ErrorInfo;
 
+/**
+ * @brief Receives a diagnostic instead of it being printed. Fatal errors do
+ * not exit the process while a handler is installed.
+ */
+typedef void (*DiagnosticHandler)(void *userData, ErrorCode code, ErrorLevel level,
+                                  const ErrorContext *context, const char *extraContext);
+
+/**
+ * @brief Error counts and the optional handler of one compilation.
+ */
+typedef struct ErrorState {
+	int errorCount;
+	int warningCount;
+	int fatalCount;
+	DiagnosticHandler handler;      // NULL prints to stdout
+	void *userData;
+	int recoverFatal;               // print fatal errors without exiting (compile server)
+} ErrorState;
+
 extern const ErrorInfo errorDatabase[];
 extern const size_t errorDatabaseCount;
 
@@ -219,4 +240,12 @@ int getFatalCount(void);
 void resetErrorCount(void);
 void repError(ErrorCode code, const char *extraContext);
 
+/**
+ * @brief Makes errors on the calling thread count into (and go to the handler
+ * of) the given state. NULL restores the thread's default state.
+ * @return The previously installed state, to restore afterwards
+ */
+ErrorState *setErrorState(ErrorState *errors);
+ErrorState *getErrorState(void);
+
 #endif
\ No newline at end of file
@@ -662,6 +662,14 @@ const ErrorInfo errorDatabase[] = {
         "unrecoverable syntax error",
         "check for missing semicolons, braces, or invalid syntax nearby"
     },
+    {
+        ERROR_INVALID_STRUCT_ATTRIBUTE,
+        ERROR,
+        "invalid struct attribute",
+        "struct layout attributes are `packed`, `align(N)` and `reorder`",
+        "unknown attribute or bad alignment",
+        "write as `struct Name align(64) { ... };` with N a power of two up to 4096"
+    },
 
     // Logic/Control flow errors (4000s)
     {
@@ -688,6 +696,14 @@ const ErrorInfo errorDatabase[] = {
         "missing main function",
         "add a main function: fn main() -> int { ... }"
     },
+    {
+        ERROR_CIRCULAR_IMPORT,
+        ERROR,
+        "circular import",
+        "modules import each other in a cycle",
+        "import cycle",
+        "move the shared functions into a module both can import"
+    },
     {
         ERROR_INCOMPATIBLE_OPERAND_TYPES,
         ERROR,
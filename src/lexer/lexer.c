@@ -62,12 +62,22 @@ static TokenType lookUpKeyword(const char * s, size_t len) {
 			if (len == 5) {
 				if (memcmp(s, "float", 5) == 0) return TK_FLOAT;
 				if (memcmp(s, "false", 5) == 0) return TK_FALSE;
+				if (memcmp(s, "f32x4", 5) == 0) return TK_F32X4;
+				if (memcmp(s, "f64x2", 5) == 0) return TK_F64X2;
+				if (memcmp(s, "f32x8", 5) == 0) return TK_F32X8;
+				if (memcmp(s, "f64x4", 5) == 0) return TK_F64X4;
 			}
 			break;
 		case 'i':
 			if (len == 3 && memcmp(s, "int", 3) == 0) return TK_INT;
 			if (len == 2 && memcmp(s, "if", 2) == 0) return TK_IF;
 			if(len == 6 && memcmp(s, "import", 6) == 0) return TK_IMPORT;
+			if (len == 2 && s[1] == '8') return TK_I8;
+			if (len == 3 && memcmp(s, "i16", 3) == 0) return TK_I16;
+			if (len == 3 && memcmp(s, "i32", 3) == 0) return TK_I32;
+			if (len == 3 && memcmp(s, "i64", 3) == 0) return TK_I64;
+			if (len == 5 && memcmp(s, "i32x4", 5) == 0) return TK_I32X4;
+			if (len == 5 && memcmp(s, "i32x8", 5) == 0) return TK_I32X8;
 			break;
 		case 'l':
 			if(len == 3 && memcmp(s, "let", 3) == 0) return TK_LET;
@@ -82,6 +92,12 @@ static TokenType lookUpKeyword(const char * s, size_t len) {
 		case 't':
 			if (len == 4 && memcmp(s, "true", 4) == 0) return TK_TRUE;
 			break;
+		case 'u':
+			if (len == 2 && s[1] == '8') return TK_U8;
+			if (len == 3 && memcmp(s, "u16", 3) == 0) return TK_U16;
+			if (len == 3 && memcmp(s, "u32", 3) == 0) return TK_U32;
+			if (len == 3 && memcmp(s, "u64", 3) == 0) return TK_U64;
+			break;
 		case 'v':
 			if (len == 4 && memcmp(s, "void", 4) == 0) return TK_VOID;
 			break;
@@ -35,6 +35,20 @@ typedef enum {
 	TK_FLOAT,
 	TK_BOOL,
 	TK_DOUBLE,
+	TK_I8,
+	TK_I16,
+	TK_I32,
+	TK_I64,
+	TK_U8,
+	TK_U16,
+	TK_U32,
+	TK_U64,
+	TK_F32X4,
+	TK_F64X2,
+	TK_I32X4,
+	TK_F32X8,
+	TK_F64X4,
+	TK_I32X8,
 
 	// Literals
 	TK_LIT,
@@ -3,32 +3,79 @@
 #include <string.h>
 
 #include "modules/build.h"
+#include "modules/server.h"
+#include "modules/watch.h"
+
+#define MAX_INCLUDE_DIRS 64
+#define MAX_LINK_OBJECTS 4096
 
 void printUsage(const char* programName) {
     printf("Orn Lang Compiler\n\n");
     printf("OPTIONS:\n");
     printf("    -o <file>    Write output to <file>\n");
+    printf("    -c           Compile only this module to <name>.o and its interface <name>.orni\n");
+    printf("    -S           Like -c, but write assembly to <name>.s\n");
+    printf("    -MD          With -c/-S, also write a Makefile/Ninja depfile (<name>.d)\n");
+    printf("    -MF <file>   Write the depfile to <file> (implies -MD)\n");
+    printf("    -I <dir>     Also look for imported .orni interfaces in <dir>\n");
+    printf("    <file>.o...  Link objects built with -c into an executable\n");
     printf("    --verbose    Show build steps\n");
     printf("    --ir         Show intermediate representation for all modules\n");
     printf("    --ast        Show AST for all modules\n");
     printf("    -O0          No optimization (default)\n");
-    printf("    -O1          Basic optimization (3 passes)\n");
-    printf("    -O2          Moderate optimization (5 passes)\n");
-    printf("    -O3          Aggressive optimization (10 passes)\n");
+    printf("    -O1          Basic optimization (up to 3 iterations)\n");
+    printf("    -O2          Moderate optimization (up to 5 iterations), hot/cold code layout\n");
+    printf("    -O3          Aggressive optimization (up to 10 iterations)\n");
+    printf("    -fno-<pass>        Disable one optimization pass\n");
+    printf("    -fpass=<list>      Run these comma separated passes instead of the level's pipeline\n");
+    printf("    --print-after=<list>  Print the IR after each run of these passes (or 'all')\n");
+    printf("    --pass-stats       Report runs and changes per optimization pass\n");
+    printf("    -g                 Emit DWARF line tables and CFI (for perf, gdb)\n");
+    printf("    -ffunction-sections  Put each function in its own section, so the linker can drop unused ones\n");
+    printf("    -mavx2             Target AVX2: enables the 256-bit vector types f32x8, f64x4 and i32x8\n");
+    printf("    -fprofile-generate Count basic blocks; the program writes orn.profdata on exit\n");
+    printf("    -fprofile-use=<f>  Lay out branches using the counts in <f>\n");
+    printf("    --profile          Instrument functions; the program writes orn.prof on exit\n");
+    printf("    --emit-asm=<dir>   Keep each module's .s in <dir>, annotated with source lines and IR\n");
+    printf("    --emit-ir=<dir>    Write each module's optimized IR to <dir>/<module>.oir and stop\n");
+    printf("    --from-ir=<dir>    Generate code and link from the .oir files in <dir>\n");
+    printf("    --codegen-stats    Report frame size, stack traffic and instruction mix per function\n");
+    printf("    --list-passes      List optimization passes and per-level pipelines\n");
+    printf("    --time-passes      Report time spent in each compiler phase\n");
+    printf("    --perf-counters    Like --time-passes, plus cycles, IPC and cache/branch misses\n");
+    printf("    --trace=<file>     Write a Chrome trace-event JSON of the build\n");
+    printf("    --watch            Rebuild whenever a module changes, recompiling only what it affects\n");
+    printf("    --server[=<sock>]  Serve compile requests, caching unchanged modules (must come first)\n");
+    printf("    --client[=<sock>]  Send this compilation to a running server (must come first)\n");
+    printf("    --client --stop-server  Shut the server down\n");
     printf("    --help       Show this help message\n\n");
     printf("EXAMPLES:\n");
     printf("    %s program.orn                   Compile to ./program\n", programName);
     printf("    %s --ast program.orn             Show AST for all modules\n", programName);
     printf("    %s -O2 -o myapp program.orn      Optimize and output to myapp\n", programName);
+    printf("    %s --client -O2 program.orn      Same, through the compile server\n", programName);
+    printf("    %s -c -MD math.orn && %s -c -MD program.orn && %s -o myapp program.o math.o\n", programName,
+           programName, programName);
 }
 
-int main(int argc, char* argv[]) {
+/**
+ * @brief One compiler invocation, in this process or for a server request
+ * @param cache Kept across a server's requests, NULL otherwise
+ * @return Exit code
+ */
+static int compileCommand(int argc, char* argv[], BuildCache *cache) {
     const char* inputFile = NULL;
     const char* outputFile = NULL;
-    int verbose = 0;
-    int showAST = 0;
-    int showIR = 0;
-    int optLvl = 0;
+    const char* fromIrDir = NULL;
+    int watch = 0;
+    int compileOnly = 0;
+    const char *objects[MAX_LINK_OBJECTS];
+    int objectCount = 0;
+    const char *includeDirs[MAX_INCLUDE_DIRS];
+    UnitOptions unit = {0};
+    unit.includeDirs = includeDirs;
+    BuildOptions opts = {0};
+    opts.cache = cache;
 
     if (argc < 2) {
         printUsage(argv[0]);
@@ -41,13 +88,137 @@ int main(int argc, char* argv[]) {
             return 0;
         }
         else if (strcmp(argv[i], "--verbose") == 0) {
-            verbose = 1;
+            opts.verbose = 1;
         }
         else if (strcmp(argv[i], "--ast") == 0) {
-            showAST = 1;
+            opts.showAST = 1;
         }
         else if (strcmp(argv[i], "--ir") == 0) {
-            showIR = 1;
+            opts.showIR = 1;
+        }
+        else if (strcmp(argv[i], "--time-passes") == 0) {
+            opts.timePasses = 1;
+        }
+        else if (strcmp(argv[i], "--perf-counters") == 0) {
+            opts.perfCounters = 1;
+        }
+        else if (strcmp(argv[i], "--pass-stats") == 0) {
+            opts.passStats = 1;
+        }
+        else if (strcmp(argv[i], "-g") == 0) {
+            opts.debugInfo = 1;
+        }
+        else if (strcmp(argv[i], "-ffunction-sections") == 0) {
+            opts.functionSections = 1;
+        }
+        else if (strcmp(argv[i], "-mavx2") == 0) {
+            opts.avx2 = 1;
+        }
+        else if (strcmp(argv[i], "-fprofile-generate") == 0) {
+            opts.profileGenerate = 1;
+        }
+        else if (strncmp(argv[i], "-fprofile-use=", 14) == 0) {
+            opts.profileUse = argv[i] + 14;
+            if (!*opts.profileUse) {
+                fprintf(stderr, "Error: -fprofile-use requires a file name\n");
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--profile") == 0) {
+            opts.profile = 1;
+        }
+        else if (strcmp(argv[i], "--watch") == 0) {
+            watch = 1;
+        }
+        else if (strcmp(argv[i], "--codegen-stats") == 0) {
+            opts.codegenStats = 1;
+        }
+        else if (strcmp(argv[i], "--list-passes") == 0) {
+            printf("Optimization passes:\n");
+            printOptPasses(stdout);
+            return 0;
+        }
+        else if (strncmp(argv[i], "-fno-", 5) == 0) {
+            int pass = findOptPass(argv[i] + 5, strlen(argv[i] + 5));
+            if (pass < 0) {
+                fprintf(stderr, "Error: Unknown optimization pass '%s' (see --list-passes)\n", argv[i] + 5);
+                return 1;
+            }
+            opts.passes.disabled |= 1u << pass;
+        }
+        else if (strncmp(argv[i], "-fpass=", 7) == 0) {
+            int count = parseOptPassList(argv[i] + 7, opts.passes.pipeline, OPT_MAX_PIPELINE);
+            if (count <= 0) {
+                if (count == 0) fprintf(stderr, "Error: -fpass requires at least one pass\n");
+                return 1;
+            }
+            opts.passes.pipelineLength = count;
+        }
+        else if (strncmp(argv[i], "--print-after=", 14) == 0) {
+            int passes[OPT_MAX_PIPELINE];
+            int count = parseOptPassList(argv[i] + 14, passes, OPT_MAX_PIPELINE);
+            if (count <= 0) {
+                if (count == 0) fprintf(stderr, "Error: --print-after requires a pass name\n");
+                return 1;
+            }
+            for (int p = 0; p < count; p++) opts.passes.printAfter |= 1u << passes[p];
+        }
+        else if (strncmp(argv[i], "--emit-asm=", 11) == 0) {
+            opts.emitAsmDir = argv[i] + 11;
+            if (!*opts.emitAsmDir) {
+                fprintf(stderr, "Error: --emit-asm requires a directory\n");
+                return 1;
+            }
+        }
+        else if (strncmp(argv[i], "--emit-ir=", 10) == 0) {
+            opts.emitIrDir = argv[i] + 10;
+            if (!*opts.emitIrDir) {
+                fprintf(stderr, "Error: --emit-ir requires a directory\n");
+                return 1;
+            }
+        }
+        else if (strncmp(argv[i], "--from-ir=", 10) == 0) {
+            fromIrDir = argv[i] + 10;
+            if (!*fromIrDir) {
+                fprintf(stderr, "Error: --from-ir requires a directory\n");
+                return 1;
+            }
+        }
+        else if (strncmp(argv[i], "--trace=", 8) == 0) {
+            opts.traceFile = argv[i] + 8;
+            if (!*opts.traceFile) {
+                fprintf(stderr, "Error: --trace requires a file name\n");
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "-c") == 0) {
+            compileOnly = 1;
+        }
+        else if (strcmp(argv[i], "-S") == 0) {
+            unit.assemblyOnly = 1;
+        }
+        else if (strcmp(argv[i], "-MD") == 0) {
+            if (!unit.depFile) unit.depFile = "";
+        }
+        else if (strcmp(argv[i], "-MF") == 0) {
+            if (i + 1 < argc) {
+                unit.depFile = argv[++i];
+            } else {
+                fprintf(stderr, "Error: -MF requires a file name\n");
+                return 1;
+            }
+        }
+        else if (strncmp(argv[i], "-I", 2) == 0) {
+            const char *dir = argv[i][2] ? argv[i] + 2 : i + 1 < argc ? argv[++i] : NULL;
+            if (!dir) {
+                fprintf(stderr, "Error: -I requires a directory\n");
+                return 1;
+            }
+            if (unit.includeDirCount == MAX_INCLUDE_DIRS) {
+                fprintf(stderr, "Error: Too many -I directories (at most %d)\n", MAX_INCLUDE_DIRS);
+                return 1;
+            }
+            includeDirs[unit.includeDirCount++] = dir;
         }
         else if (strcmp(argv[i], "-o") == 0) {
             if (i + 1 < argc) {
@@ -60,12 +231,19 @@ int main(int argc, char* argv[]) {
         else if (strncmp(argv[i], "-O", 2) == 0) {
             char level = argv[i][2];
             if (level >= '0' && level <= '3') {
-                optLvl = level - '0';
+                opts.optLevel = level - '0';
             } else {
                 fprintf(stderr, "Invalid optimization level: %s (use -O0 to -O3)\n", argv[i]);
                 return 1;
             }
         }
+        else if (argv[i][0] != '-' && strlen(argv[i]) > 2 && strcmp(argv[i] + strlen(argv[i]) - 2, ".o") == 0) {
+            if (objectCount == MAX_LINK_OBJECTS) {
+                fprintf(stderr, "Error: Too many object files (at most %d)\n", MAX_LINK_OBJECTS);
+                return 1;
+            }
+            objects[objectCount++] = argv[i];
+        }
         else if (argv[i][0] != '-') {
             inputFile = argv[i];
         }
@@ -75,6 +253,65 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    if (watch && (fromIrDir || cache)) {
+        fprintf(stderr, "Error: --watch rebuilds from sources and cannot run inside the compile server\n");
+        return 1;
+    }
+
+    int unitMode = compileOnly || unit.assemblyOnly;
+    if (unit.depFile && !unitMode) {
+        fprintf(stderr, "Error: -MD and -MF need -c or -S\n");
+        return 1;
+    }
+    if ((unitMode || objectCount > 0) && (watch || fromIrDir || opts.emitIrDir)) {
+        fprintf(stderr, "Error: -c, -S and linking objects cannot be combined with --watch, --from-ir or --emit-ir\n");
+        return 1;
+    }
+
+    if (objectCount > 0) {
+        if (inputFile || unitMode) {
+            fprintf(stderr, "Error: Either compile a module or link object files, not both\n");
+            return 1;
+        }
+        char exeFile[256];
+        if (outputFile) {
+            snprintf(exeFile, sizeof(exeFile), "%s", outputFile);
+        } else {
+            const char *slash = strrchr(objects[0], '/');
+            const char *baseName = slash ? slash + 1 : objects[0];
+            snprintf(exeFile, sizeof(exeFile), "%.*s", (int)strlen(baseName) - 2, baseName);
+        }
+        return linkObjects((char **)objects, objectCount, exeFile, &opts) ? 0 : 1;
+    }
+
+    if (unitMode) {
+        if (compileOnly && unit.assemblyOnly) {
+            fprintf(stderr, "Error: -c and -S cannot be combined\n");
+            return 1;
+        }
+        if (!inputFile) {
+            fprintf(stderr, "Error: No input file specified\n");
+            return 1;
+        }
+        return compileUnit(inputFile, outputFile, &opts, &unit) ? 0 : 1;
+    }
+
+    if (fromIrDir) {
+        if (inputFile || opts.emitIrDir) {
+            fprintf(stderr, "Error: --from-ir takes no source file and cannot be combined with --emit-ir\n");
+            return 1;
+        }
+        char exeFile[256];
+        snprintf(exeFile, sizeof(exeFile), "%s", outputFile ? outputFile : "");
+        if (!buildFromIr(fromIrDir, exeFile, sizeof(exeFile), &opts)) {
+            return 1;
+        }
+        if (!opts.verbose) {
+            printf("Compiled '%s' -> '%s'\n", fromIrDir, exeFile);
+        }
+        return 0;
+    }
+
     if (!inputFile) {
         fprintf(stderr, "Error: No input file specified\n");
         printUsage(argv[0]);
@@ -93,14 +330,66 @@ int main(int argc, char* argv[]) {
         snprintf(exeFile, sizeof(exeFile), "%.*s", (int)baseLen, baseName);
     }
 
+    if (watch) {
+        return watchProject(inputFile, exeFile, &opts) ? 0 : 1;
+    }
+
     // Build project
-    if (!buildProject(inputFile, exeFile, optLvl, verbose, showAST, showIR)) {
+    if (!buildProject(inputFile, exeFile, &opts)) {
         return 1;
     }
 
-    if (!verbose && !showAST && !showIR) {
-        printf("Compiled '%s' -> '%s'\n", inputFile, exeFile);
+    if (!opts.verbose && !opts.showAST && !opts.showIR) {
+        printf("Compiled '%s' -> '%s'\n", inputFile, opts.emitIrDir ? opts.emitIrDir : exeFile);
     }
 
     return 0;
-}
\ No newline at end of file
+}
+
+static int serveRequest(int argc, char **argv, void *cache) {
+    return compileCommand(argc, argv, cache);
+}
+
+/**
+ * @brief Matches --server / --client, optionally followed by =<socket>
+ */
+static int socketFlag(const char *arg, const char *flag, char *socketPath, size_t size) {
+    size_t len = strlen(flag);
+    if (strncmp(arg, flag, len) != 0 || (arg[len] != '\0' && arg[len] != '=')) return 0;
+    if (arg[len] == '=') {
+        snprintf(socketPath, size, "%s", arg + len + 1);
+    }
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    char socketPath[256] = "";
+
+    if (argc >= 2 && socketFlag(argv[1], "--server", socketPath, sizeof(socketPath))) {
+        if (!socketPath[0] && !defaultServerSocket(socketPath, sizeof(socketPath))) {
+            return 1;
+        }
+        BuildCache *cache = createBuildCache();
+        int ok = cache && runServer(socketPath, serveRequest, cache);
+        freeBuildCache(cache);
+        return ok ? 0 : 1;
+    }
+
+    if (argc >= 2 && socketFlag(argv[1], "--client", socketPath, sizeof(socketPath))) {
+        // Drop the flag; the server sees the rest as its own command line
+        argv[1] = argv[0];
+        int code = socketPath[0] || defaultServerSocket(socketPath, sizeof(socketPath))
+            ? runClient(socketPath, argc - 1, argv + 1) : -1;
+        if (code >= 0) {
+            return code;
+        }
+        if (argc == 3 && strcmp(argv[2], "--stop-server") == 0) {
+            fprintf(stderr, "Error: No compile server listening on '%s'\n", socketPath);
+            return 1;
+        }
+        // No server running: compile here instead
+        return compileCommand(argc - 1, argv + 1, NULL);
+    }
+
+    return compileCommand(argc, argv, NULL);
+}
@@ -2,15 +2,30 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <dirent.h>
+#include <unistd.h>
 
 #include "../lexer/lexer.h"
 #include "../codeGeneration/codegen.h"
+#include "../codeGeneration/stringBuffer.h"
 #include "../IR/optimization.h"
+#include "../IR/layout.h"
+#include "../IR/irFile.h"
+
+#define LINK_RESPONSE_THRESHOLD (32 * 1024)      // object list bytes before it moves to a response file
+#define RUNTIME_ARCHIVE "libornrt.a"
+
+static void buildError(ErrorCode code, const char *format, ...);
+static void reportRuntimeNotFound(void);
 
 static char *readFile(const char *fileName){
     FILE *file = fopen(fileName, "r");
     if(!file){
-        fprintf(stderr, "Error: Cannot open file '%s'\n", fileName);
+        buildError(ERROR_OK, "Cannot open file '%s'", fileName);
         return NULL;
     }
 
@@ -20,7 +35,7 @@ static char *readFile(const char *fileName){
 
     char *content = malloc(fileSize + 1);
     if(!content){
-        fprintf(stderr, "Error: Cannot allocate memory for file '%s'\n", fileName);
+        buildError(ERROR_MEMORY_ALLOCATION_FAILED, "Cannot allocate memory for file '%s'", fileName);
         fclose(file);
         return NULL;
     }
@@ -31,6 +46,28 @@ static char *readFile(const char *fileName){
     return content;
 }
 
+char *loadSource(BuildContext *ctx, const char *path) {
+    return ctx->readSource ? ctx->readSource(ctx->readerData, path) : readFile(path);
+}
+
+/**
+ * @brief Driver errors go to stderr, or become diagnostics when an embedder
+ * collects them. ERROR_OK marks a follow-up line embedders do not need.
+ */
+static void buildError(ErrorCode code, const char *format, ...) {
+    char message[1024];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+
+    if (!getErrorState()->handler) {
+        fprintf(stderr, "Error: %s\n", message);
+    } else if (code != ERROR_OK) {
+        repError(code, message);
+    }
+}
+
 static char *extractModuleName(const char *path){
     const char *base = strrchr(path, '/');
     base = base ? base + 1 : path;
@@ -98,20 +135,57 @@ char **extractImports(ASTNode ast, int *count){
     return imports;
 }
 
+/**
+ * @brief "<dir>/<name><ext>", malloc'd
+ */
+static char *joinPath(const char *dir, const char *name, const char *ext) {
+    size_t len = strlen(dir) + 1 + strlen(name) + strlen(ext) + 1;
+    char *path = malloc(len);
+    if (path) {
+        snprintf(path, len, "%s/%s%s", dir, name, ext);
+    }
+    return path;
+}
+
 char *resolveModulePath(const char *basePath, const char *moduleName){
-    size_t len = strlen(basePath) + 1 + strlen(moduleName) + 4 + 1;
-    char *fullPath = malloc(len);
-    if(fullPath){
-        snprintf(fullPath, len, "%s/%s.orn", basePath, moduleName);
+    return joinPath(basePath, moduleName, ".orn");
+}
+
+static void removeModuleObjects(BuildContext *ctx) {
+    for (int i = 0; i < ctx->moduleCount; i++) {
+        if (ctx->modules[i].prebuilt) continue;
+        char *objPath = joinPath(ctx->basePath, ctx->modules[i].name, ".o");
+        if (objPath) remove(objPath);
+        free(objPath);
     }
-    return fullPath;
+}
+
+static unsigned moduleSlot(const char *name, unsigned bucketCount) {
+    return (unsigned)hashString64(0, name) & (bucketCount - 1);
+}
+
+static int growModuleBuckets(BuildContext *ctx) {
+    unsigned count = ctx->moduleBucketCount ? ctx->moduleBucketCount * 2 : 64;
+    unsigned *buckets = calloc(count, sizeof(unsigned));
+    if (!buckets) return 0;
+    for (int i = 0; i < ctx->moduleCount; i++) {
+        unsigned slot = moduleSlot(ctx->modules[i].name, count);
+        while (buckets[slot]) slot = (slot + 1) & (count - 1);
+        buckets[slot] = (unsigned)i + 1;
+    }
+    free(ctx->moduleBuckets);
+    ctx->moduleBuckets = buckets;
+    ctx->moduleBucketCount = count;
+    return 1;
 }
 
 Module *findModule(BuildContext *ctx, const char *name){
-    for(int i=0;i<ctx->moduleCount; ++i){
-        if(strcmp(ctx->modules[i].name, name)==0){
-            return &ctx->modules[i];
-        }
+    if (ctx->moduleBucketCount == 0) return NULL;
+    unsigned slot = moduleSlot(name, ctx->moduleBucketCount);
+    while (ctx->moduleBuckets[slot]) {
+        Module *mod = &ctx->modules[ctx->moduleBuckets[slot] - 1];
+        if (strcmp(mod->name, name) == 0) return mod;
+        slot = (slot + 1) & (ctx->moduleBucketCount - 1);
     }
     return NULL;
 }
@@ -119,6 +193,7 @@ Module *findModule(BuildContext *ctx, const char *name){
 static Module *addModule(BuildContext *ctx, const char *name, const char *path){
     Module *existing = findModule(ctx, name);
     if(existing) return existing;
+    if ((unsigned)(ctx->moduleCount + 1) * 2 > ctx->moduleBucketCount && !growModuleBuckets(ctx)) return NULL;
     if(ctx->moduleCount >= ctx->moduleCapacity){
         int newCap = ctx->moduleCapacity == 0 ? 8 : ctx->moduleCapacity * 2;
         Module *newMods = realloc(ctx->modules, sizeof(Module) * newCap);
@@ -127,70 +202,159 @@ static Module *addModule(BuildContext *ctx, const char *name, const char *path){
         ctx->moduleCapacity = newCap;
     }
 
-    Module *mod = &ctx->modules[ctx->moduleCount++];
+    Module *mod = &ctx->modules[ctx->moduleCount];
     memset(mod, 0, sizeof(Module));
     mod->name = strdup(name);
     mod->path = strdup(path);
+    if (!mod->name || !mod->path) {
+        free(mod->name);
+        free(mod->path);
+        return NULL;
+    }
     mod->imports = NULL;
     mod->importCount = 0;
     mod->importCapacity = 0;
     mod->interface = NULL;
+    mod->cached = NULL;
+
+    unsigned slot = moduleSlot(name, ctx->moduleBucketCount);
+    while (ctx->moduleBuckets[slot]) slot = (slot + 1) & (ctx->moduleBucketCount - 1);
+    ctx->moduleBuckets[slot] = (unsigned)ctx->moduleCount + 1;
+    ctx->moduleCount++;
     return mod;
 }
 
-static int findModulesRec(BuildContext *ctx, const char *path){
-    char *name = extractModuleName(path);
-    if(!name) return 0;
-    if(findModule(ctx, name)){
-        free(name);
+/**
+ * @brief Import names of the module at path: from the cache when the file is
+ * unchanged since the last build, otherwise by lexing and parsing it.
+ * @return 1 on success, 0 once the error has been reported
+ */
+static int discoverImports(BuildContext *ctx, const char *name, const char *path, char ***outImports,
+                           int *outCount, CachedModule **outCached) {
+    *outImports = NULL;
+    *outCount = 0;
+    *outCached = ctx->cache ? cacheLookup(ctx->cache, path) : NULL;
+    if (*outCached) {
+        CachedModule *cached = *outCached;
+        cached->generation = ctx->cache->generation;
+        if (cached->importCount > 0) {
+            *outImports = malloc(cached->importCount * sizeof(char *));
+            if (!*outImports) return 0;
+            for (int i = 0; i < cached->importCount; i++) {
+                (*outImports)[i] = strdup(cached->imports[i]);
+            }
+        }
+        *outCount = cached->importCount;
         return 1;
     }
 
-    char *source = readFile(path);
+    char *source = loadSource(ctx, path);
     if (!source) {
-        fprintf(stderr, "Error: Cannot read module '%s' at '%s'\n", name, path);
-        free(name);
+        buildError(ERROR_FILE_NOT_FOUND, "Cannot read module '%s' at '%s'", name, path);
         return 0;
     }
 
     TokenList *tokens = lex(source, path);
     if (!tokens) {
-        fprintf(stderr, "Error: Failed to lex module '%s'\n", name);
+        buildError(ERROR_OK, "Failed to lex module '%s'", name);
         free(source);
-        free(name);
         return 0;
     }
 
     ASTContext *ast = ASTGenerator(tokens);
     if (!ast || !ast->root) {
-        fprintf(stderr, "Error: Failed to parse module '%s'\n", name);
+        buildError(ERROR_OK, "Failed to parse module '%s'", name);
         freeTokens(tokens);
         free(source);
+        return 0;
+    }
+
+    *outImports = extractImports(ast->root, outCount);
+    if (ctx->cache) {
+        *outCached = cacheStore(ctx->cache, path, source, *outImports, *outCount);
+        if (*outCached) {
+            (*outCached)->generation = ctx->cache->generation;
+        }
+    }
+    freeASTContext(ast);
+    freeTokens(tokens);
+    free(source);
+    return 1;
+}
+
+static int sourceExists(BuildContext *ctx, const char *path) {
+    if (!ctx->readSource) {
+        return access(path, F_OK) == 0;
+    }
+    char *source = ctx->readSource(ctx->readerData, path);
+    free(source);
+    return source != NULL;
+}
+
+/**
+ * @brief Adds name from the standard library: its interface from the runtime
+ * directory, its code already in libornrt.a
+ * @return 0 when the standard library has no such module, -1 once the
+ * missing runtime directory has been reported
+ */
+static int addStdlibModule(BuildContext *ctx, const char *name) {
+    if (!ctx->runtimeDir) {
+        ctx->runtimeDir = findRuntimeDir();
+        if (!ctx->runtimeDir) {
+            reportRuntimeNotFound();
+            return -1;
+        }
+    }
+    char *path = joinPath(ctx->runtimeDir, name, ".orni");
+    ModuleInterface *iface = path && access(path, R_OK) == 0 ? readInterfaceFile(path) : NULL;
+    Module *mod = iface ? addModule(ctx, name, path) : NULL;
+    free(path);
+    if (!mod) {
+        if (iface) freeModuleInterface(iface);
+        return 0;
+    }
+    mod->interface = iface;
+    mod->prebuilt = 1;
+    return 1;
+}
+
+static int findModulesRec(BuildContext *ctx, const char *path){
+    char *name = extractModuleName(path);
+    if(!name) return 0;
+    if(findModule(ctx, name)){
+        free(name);
+        return 1;
+    }
+
+    int importCount;
+    char **imports;
+    CachedModule *cached;
+    if (!discoverImports(ctx, name, path, &imports, &importCount, &cached)) {
         free(name);
         return 0;
     }
 
     Module *mod = addModule(ctx, name, path);
     if(!mod){
-        fprintf(stderr, "Error: Failed to add module '%s'\n", name);
-        freeASTContext(ast);
-        freeTokens(tokens);
-        free(source);
+        buildError(ERROR_MEMORY_ALLOCATION_FAILED, "Failed to add module '%s'", name);
+        for (int i = 0; i < importCount; i++) free(imports[i]);
+        free(imports);
         free(name);
         return 0;
     }
+    mod->cached = cached;
 
-    int importCount;
-    char **imports = extractImports(ast->root, &importCount);
+    // Recursion can grow ctx->modules, so re-derive mod from its index
+    int modIndex = (int)(mod - ctx->modules);
     for(int i = 0; i<importCount; ++i){
+        mod = &ctx->modules[modIndex];
         if(mod->importCount >= mod->importCapacity){
             int newCap = mod->importCapacity == 0 ? 4 : mod->importCapacity * 2;
             char **newImports = realloc(mod->imports, sizeof(char*) * newCap);
             if(!newImports){
-                fprintf(stderr, "Error: Failed to allocate imports for module '%s'\n", name);
-                freeASTContext(ast);
-                freeTokens(tokens);
-                free(source);
+                buildError(ERROR_MEMORY_ALLOCATION_FAILED, "Failed to allocate imports for module '%s'", name);
+                for (int j = i; j < importCount; j++) free(imports[j]);
+                free(imports);
                 free(name);
                 return 0;
             }
@@ -200,14 +364,17 @@ static int findModulesRec(BuildContext *ctx, const char *path){
         }
         mod->imports[mod->importCount++] = imports[i];
 
+        // A name with no source beside the entry may be a standard library module
         char *importPath = resolveModulePath(ctx->basePath, imports[i]);
-        if(!findModulesRec(ctx, importPath)){
-            fprintf(stderr, "Error: Failed to process import '%s' for module '%s'\n", imports[i], name);
+        int prebuilt = 0;
+        if (!findModule(ctx, imports[i]) && !sourceExists(ctx, importPath)) {
+            prebuilt = addStdlibModule(ctx, imports[i]);
+        }
+        if(prebuilt < 0 || (!prebuilt && !findModulesRec(ctx, importPath))){
+            buildError(ERROR_OK, "Failed to process import '%s' for module '%s'", imports[i], name);
             free(importPath);
+            for (int j = i + 1; j < importCount; j++) free(imports[j]);
             free(imports);
-            freeASTContext(ast);
-            freeTokens(tokens);
-            free(source);
             free(name);
             return 0;
         }
@@ -215,9 +382,6 @@ static int findModulesRec(BuildContext *ctx, const char *path){
     }
 
     free(imports);
-    freeASTContext(ast);
-    freeTokens(tokens);
-    free(source);
     free(name);
     return 1;
 }
@@ -226,83 +390,276 @@ int findModules(BuildContext *ctx, const char *entryPath){
     ctx->modules = NULL;
     ctx->moduleCount = 0;
     ctx->moduleCapacity = 0;
+    ctx->moduleBuckets = NULL;
+    ctx->moduleBucketCount = 0;
     ctx->basePath = extractBasePath(entryPath);
     return findModulesRec(ctx, entryPath);
 }
 
+/**
+ * @brief Reports the import cycle among the modules Kahn's algorithm could not
+ * order. Each of them still waits on an import that is also unordered, so
+ * following those imports must come back to a module already on the path.
+ */
+static void reportCycle(BuildContext *ctx, const int *inDegree, const int *edgeStart, const int *edges) {
+    int n = ctx->moduleCount;
+    int *onPath = malloc(n * sizeof(int));     // position on the path + 1, 0 = not on it
+    int *path = malloc((n + 1) * sizeof(int));
+    int start = 0;
+    while (start < n && inDegree[start] == 0) start++;
+    if (!onPath || !path || start == n) {
+        buildError(ERROR_CIRCULAR_IMPORT, "Circular dependency detected");
+        free(onPath);
+        free(path);
+        return;
+    }
+    memset(onPath, 0, n * sizeof(int));
+
+    int length = 0;
+    int curr = start;
+    while (!onPath[curr]) {
+        onPath[curr] = length + 1;
+        path[length++] = curr;
+        int next = -1;
+        for (int e = edgeStart[curr]; e < edgeStart[curr + 1] && next < 0; e++) {
+            if (edges[e] >= 0 && inDegree[edges[e]] > 0) next = edges[e];
+        }
+        curr = next;
+    }
+
+    StringBuffer sb = sbCreate(128);
+    for (int i = onPath[curr] - 1; i < length; i++) {
+        sbAppendf(&sb, "%s -> ", ctx->modules[path[i]].name);
+    }
+    sbAppend(&sb, ctx->modules[curr].name);
+    buildError(ERROR_CIRCULAR_IMPORT, "Circular dependency detected: %s", sb.data ? sb.data : "");
+    sbFree(&sb);
+    free(onPath);
+    free(path);
+}
+
 int *topoSortModules(BuildContext *ctx, int *outCount) {
     int n = ctx->moduleCount;
-    int *inDegree = calloc(n, sizeof(int));
-    int *result = malloc(n * sizeof(int));
-    int *queue = malloc(n * sizeof(int));
-    int qHead = 0, qTail = 0;
-    int resultCount = 0;
-    
-    // Actually: in-degree[i] = number of modules that i depends on
-    // We want modules with no dependencies first
+    *outCount = 0;
+
+    // edges[edgeStart[i]..edgeStart[i + 1]) are the modules i imports, -1 for
+    // names outside the build; dependents holds the same graph reversed
+    int edgeCount = 0;
+    for (int i = 0; i < n; i++) edgeCount += ctx->modules[i].importCount;
+    int *edgeStart = malloc((n + 1) * sizeof(int));
+    int *edges = malloc((edgeCount ? edgeCount : 1) * sizeof(int));
+    int *dependentStart = calloc(n + 2, sizeof(int));
+    int *dependents = malloc((edgeCount ? edgeCount : 1) * sizeof(int));
+    int *inDegree = calloc(n ? n : 1, sizeof(int));
+    int *result = malloc((n ? n : 1) * sizeof(int));
+    if (!edgeStart || !edges || !dependentStart || !dependents || !inDegree || !result) {
+        buildError(ERROR_MEMORY_ALLOCATION_FAILED, "Cannot allocate the module graph");
+        free(edgeStart);
+        free(edges);
+        free(dependentStart);
+        free(dependents);
+        free(inDegree);
+        free(result);
+        return NULL;
+    }
+
+    // in-degree[i] = number of modules i depends on: those compile first
+    int e = 0;
     for (int i = 0; i < n; i++) {
         Module *mod = &ctx->modules[i];
-        inDegree[i] = mod->importCount;
-        
-        // But only count imports that are actual modules we're building
-        inDegree[i] = 0;
+        edgeStart[i] = e;
         for (int j = 0; j < mod->importCount; j++) {
-            if (findModule(ctx, mod->imports[j])) {
+            Module *dep = findModule(ctx, mod->imports[j]);
+            int target = dep ? (int)(dep - ctx->modules) : -1;
+            edges[e++] = target;
+            if (target >= 0) {
                 inDegree[i]++;
+                dependentStart[target + 2]++;
             }
         }
-        
-        if (inDegree[i] == 0) {
-            queue[qTail++] = i;
+    }
+    edgeStart[n] = e;
+
+    // Counting sort by target; dependentStart[t + 1] doubles as t's fill cursor
+    for (int i = 2; i <= n + 1; i++) dependentStart[i] += dependentStart[i - 1];
+    for (int i = 0; i < n; i++) {
+        for (int k = edgeStart[i]; k < edgeStart[i + 1]; k++) {
+            if (edges[k] >= 0) dependents[dependentStart[edges[k] + 1]++] = i;
         }
     }
-    
-    // Process queue
-    while (qHead < qTail) {
-        int curr = queue[qHead++];
-        result[resultCount++] = curr;
-        
-        // For each module that imports this one, decrease its in-degree
-        for (int i = 0; i < n; i++) {
-            Module *mod = &ctx->modules[i];
-            for (int j = 0; j < mod->importCount; j++) {
-                if (strcmp(mod->imports[j], ctx->modules[curr].name) == 0) {
-                    inDegree[i]--;
-                    if (inDegree[i] == 0) {
-                        queue[qTail++] = i;
-                    }
-                }
-            }
+
+    // Kahn's algorithm, with result doubling as the queue
+    int resultCount = 0;
+    for (int i = 0; i < n; i++) {
+        if (inDegree[i] == 0) result[resultCount++] = i;
+    }
+    for (int head = 0; head < resultCount; head++) {
+        int curr = result[head];
+        for (int k = dependentStart[curr]; k < dependentStart[curr + 1]; k++) {
+            if (--inDegree[dependents[k]] == 0) result[resultCount++] = dependents[k];
         }
     }
-    
-    free(inDegree);
-    free(queue);
-    
-    // Check for cycle
+
     if (resultCount != n) {
-        fprintf(stderr, "Error: Circular dependency detected\n");
+        reportCycle(ctx, inDegree, edgeStart, edges);
         free(result);
-        *outCount = 0;
-        return NULL;
+        result = NULL;
+        resultCount = 0;
     }
-    
+    free(edgeStart);
+    free(edges);
+    free(dependentStart);
+    free(dependents);
+    free(inDegree);
+
     *outCount = resultCount;
     return result;
 }
 
-static int compileModule(BuildContext *ctx, Module *mod, int optLevel, 
-                        int verbose, int showAST, int showIR) {
-    if (verbose) {
-        printf("  Compiling %s...\n", mod->name);
+/**
+ * @brief Generates one module's assembly
+ * @param source Module source for listings, NULL when unavailable
+ * @return malloc'd listing, NULL on failure
+ */
+static char *moduleAssembly(BuildContext *ctx, const char *name, IrContext *ir, const char *source,
+                            const char *path, ModuleInterface **imports, int importCount, int layout,
+                            const BuildOptions *opts) {
+    int phase = timerBegin(ctx->timer, "codegen");
+    // Line tables name the source by absolute path so profilers find it from any directory
+    char *sourcePath = opts->debugInfo ? realpath(path, NULL) : NULL;
+    CodegenOptions codegenOpts = {
+        .stats = ctx->codegenStats,
+        .source = source,
+        .sourceName = sourcePath ? sourcePath : path,
+        .annotate = opts->emitAsmDir != NULL,
+        .debugInfo = opts->debugInfo,
+        .profile = opts->profile,
+        .layout = layout,
+        .functionSections = opts->functionSections,
+        .avx2 = opts->avx2
+    };
+    char *assembly = generateAssembly(ir, name, imports, importCount, &codegenOpts);
+    timerEnd(ctx->timer, phase);
+    free(sourcePath);
+    return assembly;
+}
+
+/**
+ * @brief Runs argv[0] from PATH with its stderr joined to stdout. No shell is
+ * involved, so paths reach the tool verbatim whatever characters they hold.
+ * @return 1 when the tool exits with status 0
+ */
+static int runTool(char *const argv[]) {
+    fflush(stdout);
+    fflush(stderr);
+    pid_t pid = fork();
+    if (pid < 0) {
+        fprintf(stderr, "Error: Cannot start %s: %s\n", argv[0], strerror(errno));
+        return 0;
+    }
+    if (pid == 0) {
+        dup2(STDOUT_FILENO, STDERR_FILENO);
+        execvp(argv[0], argv);
+        fprintf(stderr, "Error: Cannot run %s: %s\n", argv[0], strerror(errno));
+        _exit(127);
+    }
+    int status;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) return 0;
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static int assembleFile(BuildContext *ctx, const char *asmPath, const char *objPath) {
+    char *argv[] = {"gcc", "-c", "-o", (char *)objPath, (char *)asmPath, NULL};
+
+    int phase = timerBegin(ctx->timer, "assemble");
+    int ok = runTool(argv);
+    timerEnd(ctx->timer, phase);
+    if (!ok) {
+        fprintf(stderr, "Error: Failed to assemble '%s'\n", asmPath);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Codegen, then assembles the module to <basePath>/<name>.o.
+ * @param source Module source for listings, NULL when unavailable
+ */
+static int emitModuleObject(BuildContext *ctx, const char *name, IrContext *ir, const char *source,
+                            const char *path, ModuleInterface **imports, int importCount, int layout,
+                            const BuildOptions *opts) {
+    char *assembly = moduleAssembly(ctx, name, ir, source, path, imports, importCount, layout, opts);
+    if (!assembly) {
+        return 0;
     }
     
-    // Read source
-    char *source = readFile(mod->path);
-    if (!source) {
-        fprintf(stderr, "Error: Cannot read '%s'\n", mod->path);
+    // Write assembly file
+    char *asmPath = joinPath(opts->emitAsmDir ? opts->emitAsmDir : ctx->basePath, name, ".s");
+    char *objPath = joinPath(ctx->basePath, name, ".o");
+    int ok = asmPath && objPath && writeAssemblyToFile(assembly, asmPath);
+    if (!ok) {
+        fprintf(stderr, "Error: Cannot write assembly file '%s'\n", asmPath ? asmPath : name);
+    }
+    free(assembly);
+    
+    // Assemble to .o
+    ok = ok && assembleFile(ctx, asmPath, objPath);
+    
+    // Cleanup assembly file unless the listing was requested
+    if (asmPath && !opts->emitAsmDir) {
+        remove(asmPath);
+    }
+    free(asmPath);
+    free(objPath);
+    return ok;
+}
+
+/**
+ * @brief Writes <dir>/<module>.oir, recording every function of the imported
+ * modules so codegen can bind calls without their interfaces.
+ */
+static int writeModuleIr(Module *mod, IrContext *ir, ModuleInterface **imports, int importCount,
+                         int isEntry, int layout, const char *dir) {
+    int functionCount = 0;
+    for (int i = 0; i < importCount; i++) functionCount += imports[i]->functionCount;
+
+    IrFileInfo info = {0};
+    info.moduleName = mod->name;
+    info.sourcePath = realpath(mod->path, NULL);
+    info.flags = (isEntry ? IR_FILE_ENTRY : 0) | (layout ? IR_FILE_LAYOUT : 0);
+    info.imports = malloc((functionCount ? functionCount : 1) * sizeof(char *));
+    if (!info.imports) {
+        free(info.sourcePath);
         return 0;
     }
+    for (int i = 0; i < importCount; i++) {
+        for (ExportedFunction *func = imports[i]->functions; func; func = func->next) {
+            size_t len = strlen(imports[i]->moduleName) + strlen(func->name) + 2;
+            char *qualified = malloc(len);
+            if (!qualified) continue;
+            snprintf(qualified, len, "%s.%s", imports[i]->moduleName, func->name);
+            info.imports[info.importCount++] = qualified;
+        }
+    }
+
+    char *irPath = joinPath(dir, mod->name, ".oir");
+    int ok = irPath && writeIrFile(irPath, &info, ir);
+    free(irPath);
+
+    for (int i = 0; i < info.importCount; i++) free(info.imports[i]);
+    free(info.imports);
+    free(info.sourcePath);
+    return ok;
+}
+
+IrContext *lowerModule(BuildContext *ctx, Module *mod, const char *source, const BuildOptions *opts,
+                       int *outLayout) {
+    int verbose = opts->verbose;
+    int showAST = opts->showAST;
+    int showIR = opts->showIR;
+    timerAddSource(ctx->timer, strlen(source));
 
     if (showAST || showIR) {
         printf("\n=== MODULE: %s ===\n", mod->name);
@@ -310,18 +667,20 @@ static int compileModule(BuildContext *ctx, Module *mod, int optLevel,
     }
     
     // Lex
+    int phase = timerBegin(ctx->timer, "lex");
     TokenList *tokens = lex(source, mod->path);
+    timerEnd(ctx->timer, phase);
     if (!tokens) {
-        free(source);
-        return 0;
+        return NULL;
     }
     
     // Parse
+    phase = timerBegin(ctx->timer, "parse");
     ASTContext *ast = ASTGenerator(tokens);
+    timerEnd(ctx->timer, phase);
     if (!ast || !ast->root) {
         freeTokens(tokens);
-        free(source);
-        return 0;
+        return NULL;
     }
 
     if (showAST) {
@@ -331,13 +690,14 @@ static int compileModule(BuildContext *ctx, Module *mod, int optLevel,
     }
     
     // Create type check context
+    phase = timerBegin(ctx->timer, "typecheck");
     TypeCheckContext typeCtx = createTypeCheckContext(source, mod->path);
     if (!typeCtx) {
         freeASTContext(ast);
         freeTokens(tokens);
-        free(source);
-        return 0;
+        return NULL;
     }
+    typeCtx->avx2 = opts->avx2;
     
     // Load imports into symbol table
     for (int i = 0; i < mod->importCount; i++) {
@@ -347,146 +707,490 @@ static int compileModule(BuildContext *ctx, Module *mod, int optLevel,
         }
     }
     // Type check
-    typeCheckAST(ast->root, source, mod->path, typeCtx);
+    // On failure typeCheckAST has already freed typeCtx
+    TypeCheckContext checked = typeCheckAST(ast->root, source, mod->path, typeCtx);
+    timerEnd(ctx->timer, phase);
+    if (!checked) {
+        freeASTContext(ast);
+        freeTokens(tokens);
+        return NULL;
+    }
     
     // Extract exports for dependents
+    phase = timerBegin(ctx->timer, "exports");
     mod->interface = extractExportsWithContext(ast->root, mod->name, typeCtx);
+    timerEnd(ctx->timer, phase);
     
     // Generate IR
+    phase = timerBegin(ctx->timer, "irgen");
     IrContext *ir = generateIr(ast->root, typeCtx);
+    timerEnd(ctx->timer, phase);
+    freeTypeCheckContext(typeCtx);
+    freeASTContext(ast);
+    freeTokens(tokens);
     if (!ir) {
-        freeTypeCheckContext(typeCtx);
-        freeASTContext(ast);
-        freeTokens(tokens);
-        free(source);
-        return 0;
+        return NULL;
+    }
+    if (verbose) {
+        printf("  IR: %d instruction(s), %zu KiB\n", ir->instructionCount, (irMemoryUsage(ir) + 1023) / 1024);
     }
     
+    // Profile-guided: count blocks, or lay out branches by the counts, on the unoptimized IR
+    if (opts->profileGenerate) {
+        instrumentProfile(ir);
+    } else if (ctx->profile) {
+        int matched = applyProfile(ir, mod->name, ctx->profile);
+        int swapped = layoutProfiledBranches(ir);
+        if (verbose) {
+            printf("  Profile: %d function(s) matched, %d branch(es) reordered\n", matched, swapped);
+        }
+    }
+
     // Optimize
-    if (optLevel > 0) {
-        optimizeIR(ir, optLevel);
+    if (opts->optLevel > 0 || opts->passes.pipelineLength > 0) {
+        phase = timerBegin(ctx->timer, "optimize");
+        optimizeIR(ir, opts->optLevel, &opts->passes, &ctx->optStats, ctx->timer);
+        timerEnd(ctx->timer, phase);
+    }
+
+    // Code layout: function order by call affinity, cold blocks out of line.
+    // Cold blocks are left in place under -g: their CFI would need a second FDE.
+    int layout = opts->optLevel >= 2 || ctx->profile;
+    if (layout) {
+        int ordered = orderFunctions(ir);
+        int cold = opts->debugInfo ? 0 : splitColdCode(ir);
+        if (verbose) {
+            printf("  Layout: %d function(s) ordered, %d cold range(s) split\n", ordered, cold);
+        }
     }
 
+    // Codegen walks one array in list order, without the optimizer's tombstones
+    compactIr(ir);
+
     if (showIR) {
         printf("\n--- IR: %s ---\n", mod->name);
         printIR(ir);
         printf("\n");
     }
 
-    // Build array of imported interfaces for codegen
-    ModuleInterface **imports = NULL;
-    int importCount = 0;
+    *outLayout = layout;
+    return ir;
+}
 
-    if (mod->importCount > 0) {
-        imports = malloc(mod->importCount * sizeof(ModuleInterface*));
-        if (imports) {
-            for (int i = 0; i < mod->importCount; i++) {
-                Module *imported = findModule(ctx, mod->imports[i]);
-                if (imported && imported->interface) {
-                    imports[importCount++] = imported->interface;
-                }
+ModuleInterface **moduleImports(BuildContext *ctx, Module *mod, int *outCount) {
+    *outCount = 0;
+    if (mod->importCount == 0) {
+        return NULL;
+    }
+    ModuleInterface **imports = malloc(mod->importCount * sizeof(ModuleInterface*));
+    if (imports) {
+        for (int i = 0; i < mod->importCount; i++) {
+            Module *imported = findModule(ctx, mod->imports[i]);
+            if (imported && imported->interface) {
+                imports[(*outCount)++] = imported->interface;
             }
         }
     }
-    
-    // Generate assembly
-    char *assembly = generateAssembly(ir, mod->name, imports, importCount);
-    free(imports);
+    return imports;
+}
 
-    if (!assembly) {
-        freeIrContext(ir);
-        freeTypeCheckContext(typeCtx);
-        freeASTContext(ast);
-        freeTokens(tokens);
-        free(source);
+/**
+ * @brief What a module's object depends on: its source, the options that
+ * change codegen and the interfaces of the modules it imports
+ */
+static uint64_t objectKey(BuildContext *ctx, const Module *mod, uint64_t sourceHash, const BuildOptions *opts) {
+    uint64_t key = hashString64(sourceHash, mod->name);
+    int options[] = {opts->optLevel, opts->debugInfo, opts->profile, opts->profileGenerate,
+                     (int)opts->passes.disabled, opts->passes.pipelineLength, opts->functionSections,
+                     opts->avx2};
+    key = hashBytes(key, options, sizeof(options));
+    key = hashBytes(key, opts->passes.pipeline, opts->passes.pipelineLength * sizeof(opts->passes.pipeline[0]));
+    for (int i = 0; i < mod->importCount; i++) {
+        Module *imported = findModule(ctx, mod->imports[i]);
+        uint64_t iface = hashModuleInterface(imported ? imported->interface : NULL);
+        key = hashBytes(key, &iface, sizeof(iface));
+    }
+    return key;
+}
+
+/**
+ * @brief Reuses the cached object when nothing it depends on changed
+ */
+static int reuseCachedObject(BuildContext *ctx, Module *mod, const BuildOptions *opts) {
+    CachedModule *cached = mod->cached;
+    if (!ctx->cache || !cached || !cached->object ||
+        cached->objectKey != objectKey(ctx, mod, cached->sourceHash, opts)) {
         return 0;
     }
-    
-    // Write assembly file
-    char asmPath[512];
-    snprintf(asmPath, sizeof(asmPath), "%s/%s.s", ctx->basePath, mod->name);
-    printf("%s", assembly);
-    if (!writeAssemblyToFile(assembly, asmPath)) {
-        free(assembly);
-        freeIrContext(ir);
-        freeTypeCheckContext(typeCtx);
-        freeASTContext(ast);
-        freeTokens(tokens);
-        free(source);
+    char *objPath = joinPath(ctx->basePath, mod->name, ".o");
+    int written = objPath && cacheWriteObject(cached, objPath);
+    free(objPath);
+    if (!written) {
         return 0;
     }
+    mod->interface = copyModuleInterface(cached->interface);
+    ctx->cache->hits++;
+    if (opts->verbose) {
+        printf("  Reused %s\n", mod->name);
+    }
+    return 1;
+}
+
+static int compileModule(BuildContext *ctx, Module *mod, const BuildOptions *opts) {
+    if (mod->prebuilt) {
+        return 1;
+    }
+    timerSetModule(ctx->timer, mod->name);
+    if (reuseCachedObject(ctx, mod, opts)) {
+        return 1;
+    }
+
+    if (opts->verbose) {
+        printf("  Compiling %s...\n", mod->name);
+    }
     
-    // Assemble to .o
-    char objPath[512];
-    char cmd[2048];
-    snprintf(objPath, sizeof(objPath), "%s/%s.o", ctx->basePath, mod->name);
-    snprintf(cmd, sizeof(cmd), "gcc -c -o %s %s 2>&1", objPath, asmPath);
-    
-    int result = system(cmd);
-    if (result != 0) {
-        fprintf(stderr, "Error: Failed to assemble '%s'\n", asmPath);
-        free(assembly);
-        freeIrContext(ir);
-        freeTypeCheckContext(typeCtx);
-        freeASTContext(ast);
-        freeTokens(tokens);
+    // Read source
+    char *source = loadSource(ctx, mod->path);
+    if (!source) {
+        buildError(ERROR_FILE_NOT_FOUND, "Cannot read '%s'", mod->path);
+        return 0;
+    }
+
+    int layout;
+    IrContext *ir = lowerModule(ctx, mod, source, opts, &layout);
+    if (!ir) {
         free(source);
         return 0;
     }
-    
-    // Cleanup assembly file
-    remove(asmPath);
-    
+
+    // Build array of imported interfaces for codegen
+    int importCount;
+    ModuleInterface **imports = moduleImports(ctx, mod, &importCount);
+
+    // --emit-ir stops here; --from-ir resumes at emitModuleObject
+    int ok;
+    if (opts->emitIrDir) {
+        ok = writeModuleIr(mod, ir, imports, importCount, mod == &ctx->modules[0], layout, opts->emitIrDir);
+    } else {
+        ok = emitModuleObject(ctx, mod->name, ir, source, mod->path, imports, importCount, layout, opts);
+    }
+    free(imports);
+
+    // Keep the object unless the file changed since discovery hashed it
+    uint64_t sourceHash = hashBytes(0, source, strlen(source));
+    if (ok && ctx->cache && mod->cached && !opts->emitIrDir && sourceHash == mod->cached->sourceHash) {
+        char *objPath = joinPath(ctx->basePath, mod->name, ".o");
+        if (objPath) {
+            cacheStoreObject(mod->cached, objectKey(ctx, mod, sourceHash, opts), objPath, mod->interface);
+        }
+        free(objPath);
+    }
+    if (ctx->cache) {
+        ctx->cache->misses++;
+    }
+
     // Cleanup
-    free(assembly);
     freeIrContext(ir);
-    freeTypeCheckContext(typeCtx);
-    freeASTContext(ast);
-    freeTokens(tokens);
     free(source);
     
-    return 1;
+    return ok;
+}
+
+static const char *const runtimeCandidates[] = {"lib/orn", "../lib/orn"};
+
+/**
+ * @brief Directory of the running executable, malloc'd; NULL when unknown
+ */
+static char *executableDir(void) {
+    char exe[4096];
+    ssize_t len = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+    if (len <= 0) return NULL;
+    exe[len] = '\0';
+    return extractBasePath(exe);
+}
+
+char *findRuntimeDir(void) {
+    const char *env = getenv("ORN_LIBDIR");
+    if (env && *env) {
+        return strdup(env);
+    }
+    char *exeDir = executableDir();
+    if (!exeDir) return NULL;
+
+    for (size_t i = 0; i < sizeof(runtimeCandidates) / sizeof(runtimeCandidates[0]); i++) {
+        char *dir = joinPath(exeDir, runtimeCandidates[i], "");
+        char *archive = dir ? joinPath(dir, RUNTIME_ARCHIVE, "") : NULL;
+        int found = archive && access(archive, R_OK) == 0;
+        free(archive);
+        if (found) {
+            free(exeDir);
+            return dir;
+        }
+        free(dir);
+    }
+    free(exeDir);
+    return NULL;
+}
+
+/**
+ * @brief Reports that findRuntimeDir came back empty, naming where it looked
+ */
+static void reportRuntimeNotFound(void) {
+    char *exeDir = executableDir();
+    if (!exeDir) {
+        buildError(ERROR_FILE_NOT_FOUND, "Cannot find the Orn runtime: the executable's directory is unknown "
+                   "and ORN_LIBDIR is unset");
+        return;
+    }
+    buildError(ERROR_FILE_NOT_FOUND, "Cannot find the Orn runtime: no %s in %s/%s or %s/%s, and ORN_LIBDIR is unset",
+               RUNTIME_ARCHIVE, exeDir, runtimeCandidates[0], exeDir, runtimeCandidates[1]);
+    free(exeDir);
+}
+
+/**
+ * @brief Path of libornrt.a, malloc'd; NULL once the error has been reported
+ */
+static char *runtimeArchive(BuildContext *ctx) {
+    if (!ctx->runtimeDir) {
+        ctx->runtimeDir = findRuntimeDir();
+        if (!ctx->runtimeDir) {
+            reportRuntimeNotFound();
+            return NULL;
+        }
+    }
+    return joinPath(ctx->runtimeDir, RUNTIME_ARCHIVE, "");
+}
+
+/**
+ * @brief Hash of everything the executable is linked from, 0 when some
+ * module has no cached object to identify it by
+ */
+static uint64_t linkKey(BuildContext *ctx, const char *outputPath) {
+    uint64_t key = hashString64(0, outputPath);
+    for (int i = 0; i < ctx->moduleCount; i++) {
+        const CachedModule *cached = ctx->modules[i].cached;
+        if (ctx->modules[i].prebuilt) continue;
+        if (!cached || !cached->object) return 0;
+        key = hashBytes(key, &cached->objectKey, sizeof(cached->objectKey));
+    }
+    char *archive = runtimeArchive(ctx);
+    struct stat st;
+    int found = archive && stat(archive, &st) == 0;
+    free(archive);
+    if (!found) return 0;
+    long long runtime[] = {(long long)st.st_mtim.tv_sec, (long long)st.st_mtim.tv_nsec, (long long)st.st_size};
+    return hashBytes(key, runtime, sizeof(runtime));
+}
+
+/**
+ * @brief Writes the object list to a temporary gcc response file (@file)
+ * @return malloc'd path, NULL on failure
+ */
+static char *writeResponseFile(char **objects, int count) {
+    char *path = strdup("/tmp/orn-link-XXXXXX");
+    int fd = path ? mkstemp(path) : -1;
+    FILE *out = fd >= 0 ? fdopen(fd, "w") : NULL;
+    if (!out) {
+        if (fd >= 0) {
+            close(fd);
+            remove(path);
+        }
+        fprintf(stderr, "Error: Cannot create a linker response file\n");
+        free(path);
+        return NULL;
+    }
+    for (int i = 0; i < count; i++) {
+        for (const char *c = objects[i]; *c; c++) {
+            if (*c == ' ' || *c == '\t' || *c == '\n' || *c == '\\' || *c == '\'' || *c == '"') fputc('\\', out);
+            fputc(*c, out);
+        }
+        fputc('\n', out);
+    }
+    if (fclose(out) != 0) {
+        remove(path);
+        free(path);
+        return NULL;
+    }
+    return path;
+}
+
+/**
+ * @brief Links objects with libornrt.a into outputPath. --gc-sections drops
+ * the runtime and standard library functions nothing calls. Long object lists
+ * go through a response file, the kernel caps the size of a command line.
+ */
+static int runLinker(BuildContext *ctx, char **objects, int count, const char *outputPath) {
+    char *archive = runtimeArchive(ctx);
+    if (!archive) return 0;
+    size_t listLength = 0;
+    for (int i = 0; i < count; i++) listLength += strlen(objects[i]) + 1;
+    char *responseFile = NULL;
+    char *responseArg = NULL;
+    if (listLength > LINK_RESPONSE_THRESHOLD) {
+        responseFile = writeResponseFile(objects, count);
+        responseArg = responseFile ? malloc(strlen(responseFile) + 2) : NULL;
+        if (!responseArg) {
+            if (responseFile) remove(responseFile);
+            free(responseFile);
+            free(archive);
+            return 0;
+        }
+        sprintf(responseArg, "@%s", responseFile);
+    }
+
+    // _start is in the archive: nothing references it, so ask for it
+    char *fixed[] = {"gcc", "-no-pie", "-nostdlib", "-Wl,--gc-sections", "-u", "_start", "-o", (char *)outputPath};
+    int fixedCount = (int)(sizeof(fixed) / sizeof(fixed[0]));
+    int objectArgs = responseArg ? 1 : count;
+    char **argv = malloc(sizeof(char *) * (size_t)(fixedCount + objectArgs + 2));
+    int ok = argv != NULL;
+    if (ok) {
+        int argc = 0;
+        for (int i = 0; i < fixedCount; i++) argv[argc++] = fixed[i];
+        if (responseArg) {
+            argv[argc++] = responseArg;
+        } else {
+            for (int i = 0; i < count; i++) argv[argc++] = objects[i];
+        }
+        argv[argc++] = archive;
+        argv[argc] = NULL;
+
+        timerSetModule(ctx->timer, NULL);
+        int phase = timerBegin(ctx->timer, "link");
+        ok = runTool(argv);
+        timerEnd(ctx->timer, phase);
+    }
+    free(argv);
+    free(archive);
+    free(responseArg);
+    if (responseFile) {
+        remove(responseFile);
+        free(responseFile);
+    }
+    return ok;
 }
 
 static int linkModules(BuildContext *ctx, const char *outputPath, int verbose) {
+    uint64_t key = ctx->cache ? linkKey(ctx, outputPath) : 0;
+    if (key && cacheLinkIsCurrent(ctx->cache, outputPath, key)) {
+        if (verbose) {
+            printf("  %s is up to date\n", outputPath);
+        }
+        removeModuleObjects(ctx);
+        return 1;
+    }
+
     if (verbose) {
         printf("  Linking...\n");
     }
-    char cmd[4096];
-    int pos = snprintf(cmd, sizeof(cmd), "gcc -no-pie -nostdlib -o %s", outputPath);
-    
-    for (int i = 0; i < ctx->moduleCount; i++) {
-        pos += snprintf(cmd + pos, sizeof(cmd) - pos, " %s/%s.o", 
-                        ctx->basePath, ctx->modules[i].name);
+    char **objects = malloc((ctx->moduleCount ? ctx->moduleCount : 1) * sizeof(char *));
+    int objectCount = 0, missing = objects == NULL;
+    for (int i = 0; objects && i < ctx->moduleCount; i++) {
+        if (ctx->modules[i].prebuilt) continue;
+        char *objPath = joinPath(ctx->basePath, ctx->modules[i].name, ".o");
+        if (!objPath) {
+            missing = 1;
+            break;
+        }
+        objects[objectCount++] = objPath;
     }
-    
-    pos += snprintf(cmd + pos, sizeof(cmd) - pos, " ./runtime.s 2>&1");
-    
-    int result = system(cmd);
+    int linked = !missing && runLinker(ctx, objects, objectCount, outputPath);
+    for (int i = 0; i < objectCount; i++) free(objects[i]);
+    free(objects);
     
     // Cleanup .o files
-    for (int i = 0; i < ctx->moduleCount; i++) {
-        char objPath[512];
-        snprintf(objPath, sizeof(objPath), "%s/%s.o", ctx->basePath, ctx->modules[i].name);
-        remove(objPath);
+    removeModuleObjects(ctx);
+    
+    if (linked && key) {
+        cacheStoreLink(ctx->cache, outputPath, key);
+    }
+    return linked;
+}
+
+/**
+ * @brief Prints the requested reports and frees the context.
+ * @return 0 when the trace file could not be written
+ */
+static int finishBuild(BuildContext *ctx, const BuildOptions *opts) {
+    int ok = 1;
+    if (opts->passStats) {
+        printOptStats(stderr, &ctx->optStats);
+    }
+    if (ctx->codegenStats) {
+        printCodegenStats(ctx->codegenStats, stderr);
+    }
+    if (opts->timePasses || opts->perfCounters) {
+        printTimeReport(ctx->timer, stderr);
+    }
+    if (opts->traceFile && !writeTraceFile(ctx->timer, opts->traceFile)) {
+        ok = 0;
     }
     
-    return result == 0;
+    freeBuildContext(ctx);
+    return ok;
 }
 
-int buildProject(const char *entryPath, const char *outputPath, int optLevel, 
-                 int verbose, int showAST, int showIR) {
+/**
+ * @brief Whether a build may reuse cached objects: not when it must show or
+ * write per-module output, or when a profile file (not tracked) drives it
+ */
+static int cacheableBuild(const BuildOptions *opts) {
+    return opts->cache && !opts->showAST && !opts->showIR && !opts->emitAsmDir && !opts->emitIrDir &&
+           !opts->profileUse && !opts->passStats && !opts->codegenStats && !opts->passes.printAfter;
+}
+
+int buildProject(const char *entryPath, const char *outputPath, const BuildOptions *opts) {
     BuildContext ctx = {0};
+    int verbose = opts->verbose;
+    int showAST = opts->showAST;
+    int showIR = opts->showIR;
+
+    if (cacheableBuild(opts)) {
+        ctx.cache = opts->cache;
+        ctx.cache->hits = 0;
+        ctx.cache->misses = 0;
+        ctx.cache->generation++;
+    }
+
+    if (opts->timePasses || opts->perfCounters || opts->traceFile) {
+        ctx.timer = createBuildTimer();
+    }
+    if (opts->perfCounters) {
+        timerEnablePerfCounters(ctx.timer);
+    }
+    if (opts->codegenStats) {
+        ctx.codegenStats = createCodegenStats();
+    }
+    if (opts->profileUse) {
+        ctx.profile = readProfileData(opts->profileUse);
+        if (!ctx.profile) {
+            freeBuildContext(&ctx);
+            return 0;
+        }
+    }
+    if (opts->emitAsmDir && mkdir(opts->emitAsmDir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Error: Cannot create assembly directory '%s'\n", opts->emitAsmDir);
+        freeBuildContext(&ctx);
+        return 0;
+    }
+    if (opts->emitIrDir && mkdir(opts->emitIrDir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Error: Cannot create IR directory '%s'\n", opts->emitIrDir);
+        freeBuildContext(&ctx);
+        return 0;
+    }
     
     if (verbose || showAST || showIR) {
         printf("=== BUILD ===\n");
         printf("Entry: %s\n", entryPath);
-        printf("Optimization: -O%d\n", optLevel);
+        printf("Optimization: -O%d\n", opts->optLevel);
     }
     
     // 1. Discover all modules
     if (verbose) printf("Discovering modules...\n");
-    if (!findModules(&ctx, entryPath)) {
+    int phase = timerBegin(ctx.timer, "discovery");
+    int found = findModules(&ctx, entryPath);
+    timerEnd(ctx.timer, phase);
+    if (!found) {
         freeBuildContext(&ctx);
         return 0;
     }
@@ -518,8 +1222,8 @@ int buildProject(const char *entryPath, const char *outputPath, int optLevel,
     if (verbose) printf("Compiling...\n");
     for (int i = 0; i < sortedCount; i++) {
         Module *mod = &ctx.modules[sorted[i]];
-        if (!compileModule(&ctx, mod, optLevel, verbose, showAST, showIR)) {
-            fprintf(stderr, "Error: Failed to compile module '%s'\n", mod->name);
+        if (!compileModule(&ctx, mod, opts)) {
+            buildError(ERROR_OK, "Failed to compile module '%s'", mod->name);
             free(sorted);
             freeBuildContext(&ctx);
             return 0;
@@ -529,22 +1233,457 @@ int buildProject(const char *entryPath, const char *outputPath, int optLevel,
     free(sorted);
     
     // 4. Link
+    if (opts->emitIrDir) {
+        if (verbose) printf("Wrote IR for %d module(s) to %s\n", ctx.moduleCount, opts->emitIrDir);
+    } else {
+        if (verbose) printf("Linking...\n");
+        if (!linkModules(&ctx, outputPath, verbose)) {
+            fprintf(stderr, "Error: Linking failed\n");
+            freeBuildContext(&ctx);
+            return 0;
+        }
+    }
+    
+    if (verbose && ctx.cache) {
+        printf("Cache: %d module(s) reused, %d compiled\n", ctx.cache->hits, ctx.cache->misses);
+    }
+    if (verbose || showAST || showIR) {
+        printf("\n=== BUILD SUCCESSFUL ===\n");
+        printf("Output: %s\n", opts->emitIrDir ? opts->emitIrDir : outputPath);
+    }
+
+    return finishBuild(&ctx, opts);
+}
+
+/**
+ * @brief Rebuilds the interfaces codegen binds calls with from the
+ * "module.function" list stored in an IR file.
+ */
+static ModuleInterface **interfacesFromIr(const IrFileInfo *info, int *outCount) {
+    *outCount = 0;
+    ModuleInterface **ifaces = calloc(info->importCount ? info->importCount : 1, sizeof(ModuleInterface *));
+    if (!ifaces) return NULL;
+
+    for (int i = 0; i < info->importCount; i++) {
+        const char *qualified = info->imports[i];
+        const char *dot = strchr(qualified, '.');
+        if (!dot) continue;
+        size_t moduleLen = (size_t)(dot - qualified);
+
+        ModuleInterface *iface = NULL;
+        for (int j = 0; j < *outCount; j++) {
+            if (strlen(ifaces[j]->moduleName) == moduleLen &&
+                memcmp(ifaces[j]->moduleName, qualified, moduleLen) == 0) {
+                iface = ifaces[j];
+                break;
+            }
+        }
+        if (!iface) {
+            iface = calloc(1, sizeof(ModuleInterface));
+            if (!iface) continue;
+            iface->moduleName = strndup(qualified, moduleLen);
+            ifaces[(*outCount)++] = iface;
+        }
+
+        ExportedFunction *func = calloc(1, sizeof(ExportedFunction));
+        if (!func) continue;
+        func->name = strdup(dot + 1);
+        func->next = iface->functions;
+        iface->functions = func;
+        iface->functionCount++;
+    }
+    return ifaces;
+}
+
+static int compareStrings(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+/**
+ * @brief Lists the .oir files of a directory, sorted so builds are reproducible.
+ */
+static char **listIrFiles(const char *dir, int *outCount) {
+    *outCount = 0;
+    DIR *d = opendir(dir);
+    if (!d) {
+        fprintf(stderr, "Error: Cannot open IR directory '%s'\n", dir);
+        return NULL;
+    }
+    int capacity = 8;
+    char **files = malloc(capacity * sizeof(char *));
+    struct dirent *entry;
+    while (files && (entry = readdir(d)) != NULL) {
+        size_t len = strlen(entry->d_name);
+        if (len <= 4 || strcmp(entry->d_name + len - 4, ".oir") != 0) continue;
+        if (*outCount == capacity) {
+            char **grown = realloc(files, capacity * 2 * sizeof(char *));
+            if (!grown) break;
+            files = grown;
+            capacity *= 2;
+        }
+        files[(*outCount)++] = strdup(entry->d_name);
+    }
+    closedir(d);
+    if (files) qsort(files, *outCount, sizeof(char *), compareStrings);
+    return files;
+}
+
+int buildFromIr(const char *irDir, char *outputPath, size_t outputSize, const BuildOptions *opts) {
+    BuildContext ctx = {0};
+    int verbose = opts->verbose;
+
+    if (opts->timePasses || opts->perfCounters || opts->traceFile) {
+        ctx.timer = createBuildTimer();
+    }
+    if (opts->perfCounters) {
+        timerEnablePerfCounters(ctx.timer);
+    }
+    if (opts->codegenStats) {
+        ctx.codegenStats = createCodegenStats();
+    }
+    if (opts->emitAsmDir && mkdir(opts->emitAsmDir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Error: Cannot create assembly directory '%s'\n", opts->emitAsmDir);
+        freeBuildContext(&ctx);
+        return 0;
+    }
+    ctx.basePath = strdup(irDir);
+
+    int fileCount;
+    char **files = listIrFiles(irDir, &fileCount);
+    if (!files || fileCount == 0) {
+        if (files) fprintf(stderr, "Error: No .oir files in '%s'\n", irDir);
+        free(files);
+        freeBuildContext(&ctx);
+        return 0;
+    }
+
+    if (verbose) printf("=== BUILD FROM IR ===\nCompiling %d module(s) from %s...\n", fileCount, irDir);
+    int ok = 1, entries = 0;
+    for (int i = 0; i < fileCount && ok; i++) {
+        char *irPath = joinPath(irDir, files[i], "");
+        IrFileInfo info;
+        IrContext *ir = irPath ? readIrFile(irPath, &info) : NULL;
+        free(irPath);
+        if (!ir) {
+            ok = 0;
+            break;
+        }
+        if (findModule(&ctx, info.moduleName)) {
+            fprintf(stderr, "Error: Module '%s' appears twice in '%s'\n", info.moduleName, irDir);
+            ok = 0;
+        } else if (info.flags & IR_FILE_ENTRY) {
+            if (entries++ == 0 && !outputPath[0]) snprintf(outputPath, outputSize, "%s", info.moduleName);
+        }
+        if (ok) {
+            timerSetModule(ctx.timer, info.moduleName);
+            if (verbose) printf("  Compiling %s...\n", info.moduleName);
+            addModule(&ctx, info.moduleName, info.sourcePath);
+
+            // The source only feeds --emit-asm listings; IR carries everything else
+            char *source = opts->emitAsmDir && access(info.sourcePath, R_OK) == 0 ? readFile(info.sourcePath) : NULL;
+            int importCount;
+            ModuleInterface **imports = interfacesFromIr(&info, &importCount);
+            ok = imports && emitModuleObject(&ctx, info.moduleName, ir, source, info.sourcePath, imports,
+                                             importCount, (info.flags & IR_FILE_LAYOUT) != 0, opts);
+            for (int j = 0; j < importCount; j++) freeModuleInterface(imports[j]);
+            free(imports);
+            free(source);
+        }
+        if (!ok) fprintf(stderr, "Error: Failed to compile module '%s'\n", info.moduleName);
+        freeIrContext(ir);
+        freeIrFileInfo(&info);
+    }
+    for (int i = 0; i < fileCount; i++) free(files[i]);
+    free(files);
+
+    if (ok && entries != 1) {
+        fprintf(stderr, "Error: '%s' must hold exactly one entry module, found %d\n", irDir, entries);
+        ok = 0;
+    }
+    if (!ok) {
+        // Objects of the modules that did compile
+        removeModuleObjects(&ctx);
+        freeBuildContext(&ctx);
+        return 0;
+    }
+
     if (verbose) printf("Linking...\n");
     if (!linkModules(&ctx, outputPath, verbose)) {
         fprintf(stderr, "Error: Linking failed\n");
         freeBuildContext(&ctx);
         return 0;
     }
-    
-    if (verbose || showAST || showIR) {
+    if (verbose) {
         printf("\n=== BUILD SUCCESSFUL ===\n");
         printf("Output: %s\n", outputPath);
     }
-    
-    freeBuildContext(&ctx);
+    return finishBuild(&ctx, opts);
+}
+
+/**
+ * @brief Locates <name>.orni for an import: next to the output, then in each
+ * -I directory, next to the source and last in the standard library
+ * @return malloc'd path, NULL when there is none
+ */
+static char *findInterfaceFile(BuildContext *ctx, const char *name, const char *outDir, const UnitOptions *unit) {
+    if (!ctx->runtimeDir) {
+        ctx->runtimeDir = findRuntimeDir();
+    }
+    int dirCount = unit->includeDirCount + 3;
+    for (int i = 0; i < dirCount; i++) {
+        const char *dir = i == 0                        ? outDir
+                          : i <= unit->includeDirCount ? unit->includeDirs[i - 1]
+                          : i == dirCount - 2          ? ctx->basePath
+                                                       : ctx->runtimeDir;
+        if (!dir) continue;
+        char *path = joinPath(dir, name, ".orni");
+        if (path && access(path, R_OK) == 0) {
+            return path;
+        }
+        free(path);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Writes a path to a depfile, escaped the way make and ninja read it
+ */
+static void writeDepPath(FILE *out, const char *path) {
+    for (const char *c = path; *c; c++) {
+        if (*c == ' ' || *c == '#') fputc('\\', out);
+        if (*c == '$') fputc('$', out);
+        fputc(*c, out);
+    }
+}
+
+static int writeDepFile(const char *depPath, const char *target, const char *sourcePath, char **deps,
+                        int depCount) {
+    FILE *out = fopen(depPath, "w");
+    if (!out) {
+        fprintf(stderr, "Error: Cannot write dependency file '%s'\n", depPath);
+        return 0;
+    }
+    writeDepPath(out, target);
+    fputs(": ", out);
+    writeDepPath(out, sourcePath);
+    for (int i = 0; i < depCount; i++) {
+        if (!deps[i]) continue;     // repeated import
+        fputs(" \\\n  ", out);
+        writeDepPath(out, deps[i]);
+    }
+    fputc('\n', out);
+    return fclose(out) == 0;
+}
+
+/**
+ * @brief path with ext in place of its extension, malloc'd
+ * @param baseName Drop the directory too
+ */
+static char *replaceExtension(const char *path, const char *ext, int baseName) {
+    const char *slash = strrchr(path, '/');
+    const char *base = slash ? slash + 1 : path;
+    const char *dot = strrchr(base, '.');
+    const char *start = baseName ? base : path;
+    size_t stemLen = dot && dot > base ? (size_t)(dot - start) : strlen(start);
+    StringBuffer sb = sbCreate(stemLen + strlen(ext) + 1);
+    sbAppendf(&sb, "%.*s%s", (int)stemLen, start, ext);
+    return sb.data;
+}
+
+/**
+ * @brief Registers the module's imports from their .orni files
+ * @param deps Receives the interface paths, for the depfile
+ */
+static int loadUnitImports(BuildContext *ctx, const char *outDir, const UnitOptions *unit, char **deps) {
+    // addModule may move ctx->modules: the unit stays at index 0
+    for (int i = 0; i < ctx->modules[0].importCount; i++) {
+        const char *name = ctx->modules[0].imports[i];
+        if (strcmp(name, ctx->modules[0].name) == 0) {
+            buildError(ERROR_CIRCULAR_IMPORT, "Module '%s' imports itself", name);
+            return 0;
+        }
+        if (findModule(ctx, name)) continue;
+
+        char *ifacePath = findInterfaceFile(ctx, name, outDir, unit);
+        if (!ifacePath) {
+            buildError(ERROR_FILE_NOT_FOUND, "No interface '%s.orni' for import '%s' of '%s' (compile it with -c first)",
+                       name, name, ctx->modules[0].name);
+            return 0;
+        }
+        ModuleInterface *iface = readInterfaceFile(ifacePath);
+        if (iface && strcmp(iface->moduleName, name) != 0) {
+            fprintf(stderr, "Error: '%s' holds the interface of module '%s', not '%s'\n", ifacePath,
+                    iface->moduleName, name);
+            freeModuleInterface(iface);
+            iface = NULL;
+        }
+        Module *dep = iface ? addModule(ctx, name, ifacePath) : NULL;
+        if (!dep) {
+            if (iface) freeModuleInterface(iface);
+            free(ifacePath);
+            return 0;
+        }
+        dep->interface = iface;
+        deps[i] = ifacePath;
+    }
     return 1;
 }
 
+int compileUnit(const char *sourcePath, const char *outputPath, const BuildOptions *opts,
+                const UnitOptions *unit) {
+    BuildContext ctx = {0};
+    int verbose = opts->verbose;
+
+    if (opts->timePasses || opts->perfCounters || opts->traceFile) {
+        ctx.timer = createBuildTimer();
+    }
+    if (opts->perfCounters) {
+        timerEnablePerfCounters(ctx.timer);
+    }
+    if (opts->codegenStats) {
+        ctx.codegenStats = createCodegenStats();
+    }
+    if (opts->profileUse) {
+        ctx.profile = readProfileData(opts->profileUse);
+        if (!ctx.profile) {
+            freeBuildContext(&ctx);
+            return 0;
+        }
+    }
+    if (opts->emitAsmDir && mkdir(opts->emitAsmDir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Error: Cannot create assembly directory '%s'\n", opts->emitAsmDir);
+        freeBuildContext(&ctx);
+        return 0;
+    }
+    ctx.basePath = extractBasePath(sourcePath);
+
+    // Default: the source's base name in the working directory
+    char *outPath = outputPath ? strdup(outputPath)
+                               : replaceExtension(sourcePath, unit->assemblyOnly ? ".s" : ".o", 1);
+    char *outDir = outPath ? extractBasePath(outPath) : NULL;
+
+    // 1. The module and the names it imports
+    char *name = extractModuleName(sourcePath);
+    int importCount = 0;
+    char **imports = NULL;
+    CachedModule *cached;
+    Module *mod = NULL;
+    if (name && outDir && discoverImports(&ctx, name, sourcePath, &imports, &importCount, &cached)) {
+        mod = addModule(&ctx, name, sourcePath);
+    }
+    free(name);
+    if (!mod) {
+        for (int i = 0; i < importCount; i++) free(imports[i]);
+        free(imports);
+        free(outPath);
+        free(outDir);
+        freeBuildContext(&ctx);
+        return 0;
+    }
+    mod->imports = imports;
+    mod->importCount = importCount;
+    mod->importCapacity = importCount;
+    if (verbose) {
+        printf("=== COMPILE ===\nSource: %s\nOutput: %s\n", sourcePath, outPath);
+    }
+
+    // 2. What the imports export, from the interfaces their own -c wrote
+    char **deps = calloc(importCount ? importCount : 1, sizeof(char *));
+    int ok = deps && loadUnitImports(&ctx, outDir, unit, deps);
+    mod = &ctx.modules[0];
+
+    // 3. Lower and generate code
+    char *source = ok ? loadSource(&ctx, sourcePath) : NULL;
+    IrContext *ir = NULL;
+    char *assembly = NULL;
+    int layout = 0;
+    if (source) {
+        timerSetModule(ctx.timer, mod->name);
+        ir = lowerModule(&ctx, mod, source, opts, &layout);
+    }
+    if (ir && mod->interface) {
+        int count;
+        ModuleInterface **ifaces = moduleImports(&ctx, mod, &count);
+        assembly = moduleAssembly(&ctx, mod->name, ir, source, sourcePath, ifaces, count, layout, opts);
+        free(ifaces);
+    }
+    ok = assembly != NULL;
+
+    // 4. Write the .s, or assemble the .o
+    if (ok && unit->assemblyOnly) {
+        ok = writeAssemblyToFile(assembly, outPath);
+        if (!ok) fprintf(stderr, "Error: Cannot write assembly file '%s'\n", outPath);
+    } else if (ok) {
+        StringBuffer asmPath = sbCreate(64);
+        if (opts->emitAsmDir) {
+            sbAppendf(&asmPath, "%s/%s.s", opts->emitAsmDir, mod->name);
+        } else {
+            sbAppendf(&asmPath, "%s.s", outPath);
+        }
+        ok = asmPath.data && writeAssemblyToFile(assembly, asmPath.data);
+        if (!ok) fprintf(stderr, "Error: Cannot write assembly file '%s.s'\n", outPath);
+        ok = ok && assembleFile(&ctx, asmPath.data, outPath);
+        if (asmPath.data && !opts->emitAsmDir) {
+            remove(asmPath.data);
+        }
+        sbFree(&asmPath);
+    }
+
+    // 5. The interface dependents compile against, and the depfile
+    if (ok) {
+        char *ifacePath = joinPath(outDir, mod->name, ".orni");
+        ok = ifacePath && writeInterfaceFile(ifacePath, mod->interface);
+        free(ifacePath);
+    }
+    if (ok && unit->depFile) {
+        char *depPath = *unit->depFile ? strdup(unit->depFile) : replaceExtension(outPath, ".d", 0);
+        ok = depPath && writeDepFile(depPath, outPath, sourcePath, deps, importCount);
+        free(depPath);
+    }
+    if (!ok) {
+        buildError(ERROR_OK, "Failed to compile module '%s'", mod->name);
+    } else if (verbose) {
+        printf("\n=== COMPILE SUCCESSFUL ===\n");
+    }
+
+    for (int i = 0; deps && i < importCount; i++) free(deps[i]);
+    free(deps);
+    free(assembly);
+    if (ir) freeIrContext(ir);
+    free(source);
+    free(outPath);
+    free(outDir);
+    int finished = finishBuild(&ctx, opts);
+    return ok && finished;
+}
+
+int linkObjects(char **objects, int count, const char *outputPath, const BuildOptions *opts) {
+    BuildContext ctx = {0};
+    if (opts->timePasses || opts->perfCounters || opts->traceFile) {
+        ctx.timer = createBuildTimer();
+    }
+    if (opts->perfCounters) {
+        timerEnablePerfCounters(ctx.timer);
+    }
+
+    int ok = 1;
+    for (int i = 0; i < count; i++) {
+        if (access(objects[i], R_OK) != 0) {
+            fprintf(stderr, "Error: Cannot read object file '%s'\n", objects[i]);
+            ok = 0;
+        }
+    }
+    if (ok && opts->verbose) {
+        printf("Linking %d object(s) -> %s\n", count, outputPath);
+    }
+    if (ok && !runLinker(&ctx, objects, count, outputPath)) {
+        fprintf(stderr, "Error: Linking failed\n");
+        ok = 0;
+    }
+    int finished = finishBuild(&ctx, opts);
+    return ok && finished;
+}
+
 void freeBuildContext(BuildContext *ctx) {
     for (int i = 0; i < ctx->moduleCount; i++) {
         Module *mod = &ctx->modules[i];
@@ -559,5 +1698,10 @@ void freeBuildContext(BuildContext *ctx) {
         }
     }
     free(ctx->modules);
+    free(ctx->moduleBuckets);
     free(ctx->basePath);
+    free(ctx->runtimeDir);
+    freeBuildTimer(ctx->timer);
+    freeCodegenStats(ctx->codegenStats);
+    freeProfileData(ctx->profile);
 }
\ No newline at end of file
@@ -2,6 +2,11 @@
 #define BUILD_H
 
 #include "interface.h"
+#include "cache.h"
+#include "timing.h"
+#include "../IR/optimization.h"
+#include "../IR/profile.h"
+#include "../codeGeneration/codegenStats.h"
 
 typedef struct Module {
     char *name;
@@ -10,13 +15,53 @@ typedef struct Module {
     int importCount;
     int importCapacity;
     ModuleInterface *interface;
+    CachedModule *cached;       // BuildCache entry, NULL when not caching
+    int prebuilt;               // standard library: interface from its .orni, code from libornrt.a
 } Module;
 
+typedef struct BuildOptions {
+    int optLevel;
+    int verbose;
+    int showAST;
+    int showIR;
+    int timePasses;
+    int perfCounters;
+    const char *traceFile;
+    OptOptions passes;
+    int passStats;
+    int codegenStats;
+    int debugInfo;
+    int functionSections;       // -ffunction-sections: one section per function
+    int avx2;                   // -mavx2: 256-bit vectors and SSE4.1/AVX2 instructions
+    int profile;
+    int profileGenerate;
+    const char *profileUse;     // -fprofile-use file, NULL without PGO
+    const char *emitAsmDir;     // keep annotated .s files here, NULL to discard them
+    const char *emitIrDir;      // write each module's optimized IR here and stop before codegen
+    BuildCache *cache;          // kept across builds by --server and --watch, NULL otherwise
+} BuildOptions;
+
+/**
+ * @brief Returns the malloc'd, NUL terminated contents of a module, or NULL
+ * when it does not exist. Lets embedders compile from memory.
+ */
+typedef char *(*SourceReader)(void *userData, const char *path);
+
 typedef struct BuildContext {
     Module *modules;
     int moduleCount;
     int moduleCapacity;
+    unsigned *moduleBuckets;    // name -> index + 1, open addressing, 0 = empty
+    unsigned moduleBucketCount;
     char *basePath;
+    BuildTimer *timer;
+    OptStats optStats;
+    CodegenStats *codegenStats;
+    ProfileData *profile;
+    SourceReader readSource;    // NULL reads the filesystem
+    void *readerData;
+    BuildCache *cache;          // opts->cache when this build's outputs may come from it
+    char *runtimeDir;           // located on first use, see findRuntimeDir
 } BuildContext;
 
 char **extractImports(ASTNode ast, int *count);
@@ -38,10 +83,69 @@ int findModules(BuildContext *ctx, const char *entryPath);
  */
 int *topoSortModules(BuildContext *ctx, int *outCount);
 
+/**
+ * @brief Reads a module through ctx->readSource, or from disk without one
+ */
+char *loadSource(BuildContext *ctx, const char *path);
+
+/**
+ * @brief Lex, parse, type check and lower one module to optimized, laid out IR.
+ * Fills mod->interface for the modules compiled after it.
+ * @param outLayout Set when the IR went through the code layout pass
+ * @return The IR, NULL once the errors have been reported
+ */
+IrContext *lowerModule(BuildContext *ctx, Module *mod, const char *source, const BuildOptions *opts,
+                       int *outLayout);
+
+/**
+ * @brief Interfaces of the already compiled modules mod imports, for codegen
+ * @return malloc'd array, NULL when there are none
+ */
+ModuleInterface **moduleImports(BuildContext *ctx, Module *mod, int *outCount);
+
 /**
  * @brief Build entire project from entry file
  */
-int buildProject(const char *entryPath, const char *outputPath, int optLevel, int verbose,int showAST, int showIR);
+int buildProject(const char *entryPath, const char *outputPath, const BuildOptions *opts);
+
+/**
+ * @brief Codegen and link the .oir files of a directory written by --emit-ir
+ * @param outputPath Executable name; when empty it is set to the entry module's name
+ */
+int buildFromIr(const char *irDir, char *outputPath, size_t outputSize, const BuildOptions *opts);
+
+/**
+ * @brief Per-module (-c / -S) compilation
+ */
+typedef struct UnitOptions {
+    int assemblyOnly;           // -S: write assembly instead of an object
+    const char *depFile;        // -MD: "" for <output>.d, or the -MF path; NULL for none
+    const char **includeDirs;   // -I: where to look for imported .orni interfaces
+    int includeDirCount;
+} UnitOptions;
+
+/**
+ * @brief Compiles one module to an object (or assembly) and writes its
+ * <module>.orni interface next to the output. Imports are not compiled: their
+ * interfaces must already exist beside the output, in an include dir or
+ * beside the source.
+ * @param outputPath NULL for <source base name>.o (or .s) in the working directory
+ */
+int compileUnit(const char *sourcePath, const char *outputPath, const BuildOptions *opts,
+                const UnitOptions *unit);
+
+/**
+ * @brief Links objects built with compileUnit and the runtime into an executable
+ */
+int linkObjects(char **objects, int count, const char *outputPath, const BuildOptions *opts);
+
+/**
+ * @brief Directory of libornrt.a and the standard library's .orni files:
+ * $ORN_LIBDIR, else lib/orn beside the orn executable (build tree), else
+ * ../lib/orn (installed)
+ * @return malloc'd path, NULL when none of them holds the archive
+ */
+char *findRuntimeDir(void);
 
 /**
  * @brief Find module by name
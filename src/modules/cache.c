@@ -0,0 +1,239 @@
+#include "cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define FNV_OFFSET 14695981039346656037ull
+#define FNV_PRIME 1099511628211ull
+
+BuildCache *createBuildCache(void) {
+    return calloc(1, sizeof(BuildCache));
+}
+
+static void clearObject(CachedModule *entry) {
+    free(entry->object);
+    entry->object = NULL;
+    entry->objectSize = 0;
+    entry->objectKey = 0;
+    freeModuleInterface(entry->interface);
+    entry->interface = NULL;
+    entry->interfaceHash = 0;
+}
+
+static void clearImports(CachedModule *entry) {
+    for (int i = 0; i < entry->importCount; i++) free(entry->imports[i]);
+    free(entry->imports);
+    entry->imports = NULL;
+    entry->importCount = 0;
+}
+
+void freeBuildCache(BuildCache *cache) {
+    if (!cache) return;
+    CachedModule *entry = cache->modules;
+    while (entry) {
+        CachedModule *next = entry->next;
+        clearObject(entry);
+        clearImports(entry);
+        free(entry->path);
+        free(entry);
+        entry = next;
+    }
+    CachedLink *link = cache->links;
+    while (link) {
+        CachedLink *next = link->next;
+        free(link->outputPath);
+        free(link);
+        link = next;
+    }
+    free(cache);
+}
+
+uint64_t hashBytes(uint64_t hash, const void *data, size_t len) {
+    const unsigned char *bytes = data;
+    if (hash == 0) hash = FNV_OFFSET;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+uint64_t hashString64(uint64_t hash, const char *str) {
+    // Include the terminator so "ab","c" and "a","bc" differ
+    return str ? hashBytes(hash, str, strlen(str) + 1) : hashBytes(hash, "", 1);
+}
+
+uint64_t hashModuleInterface(const ModuleInterface *iface) {
+    uint64_t hash = hashString64(0, iface ? iface->moduleName : NULL);
+    if (!iface) return hash;
+    for (const ExportedFunction *func = iface->functions; func; func = func->next) {
+        hash = hashString64(hash, func->name);
+        hash = hashString64(hash, func->signature);
+        hash = hashString64(hash, func->returnType);
+    }
+    for (const ExportedStruct *es = iface->structs; es; es = es->next) {
+        hash = hashString64(hash, es->name);
+        hash = hashBytes(hash, &es->size, sizeof(es->size));
+        hash = hashBytes(hash, &es->alignment, sizeof(es->alignment));
+        for (const ExportedField *field = es->fields; field; field = field->next) {
+            hash = hashString64(hash, field->name);
+            hash = hashString64(hash, field->type);
+            hash = hashBytes(hash, &field->offset, sizeof(field->offset));
+            hash = hashBytes(hash, &field->pointerLevel, sizeof(field->pointerLevel));
+        }
+    }
+    return hash;
+}
+
+static int statFile(const char *path, long long *mtimeNs, long long *size) {
+    struct stat st;
+    if (stat(path, &st) != 0) return 0;
+    *mtimeNs = (long long)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+    *size = (long long)st.st_size;
+    return 1;
+}
+
+static char *readWholeFile(const char *path, size_t *outSize) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char *data = size >= 0 ? malloc((size_t)size + 1) : NULL;
+    if (data && fread(data, 1, (size_t)size, file) != (size_t)size) {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+    if (data) {
+        data[size] = '\0';
+        *outSize = (size_t)size;
+    }
+    return data;
+}
+
+static CachedModule *findEntry(BuildCache *cache, const char *realPath) {
+    for (CachedModule *entry = cache->modules; entry; entry = entry->next) {
+        if (strcmp(entry->path, realPath) == 0) return entry;
+    }
+    return NULL;
+}
+
+CachedModule *cacheLookup(BuildCache *cache, const char *path) {
+    char *realPath = realpath(path, NULL);
+    if (!realPath) return NULL;
+    CachedModule *entry = findEntry(cache, realPath);
+    free(realPath);
+    if (!entry) return NULL;
+
+    long long mtimeNs, size;
+    if (!statFile(entry->path, &mtimeNs, &size)) return NULL;
+    if (mtimeNs == entry->mtimeNs && size == entry->size) return entry;
+    if (size != entry->size) return NULL;
+
+    // Touched but maybe not edited: compare contents
+    size_t length;
+    char *source = readWholeFile(entry->path, &length);
+    if (!source) return NULL;
+    uint64_t hash = hashBytes(0, source, length);
+    free(source);
+    if (hash != entry->sourceHash) return NULL;
+    entry->mtimeNs = mtimeNs;
+    return entry;
+}
+
+CachedModule *cacheStore(BuildCache *cache, const char *path, const char *source, char **imports,
+                         int importCount) {
+    char *realPath = realpath(path, NULL);
+    if (!realPath) return NULL;
+    CachedModule *entry = findEntry(cache, realPath);
+    if (entry) {
+        free(realPath);
+    } else {
+        entry = calloc(1, sizeof(CachedModule));
+        if (!entry) {
+            free(realPath);
+            return NULL;
+        }
+        entry->path = realPath;
+        entry->next = cache->modules;
+        cache->modules = entry;
+    }
+
+    // Stat before hashing: an edit racing with us then only causes a needless rebuild
+    statFile(entry->path, &entry->mtimeNs, &entry->size);
+    uint64_t hash = hashBytes(0, source, strlen(source));
+    if (hash != entry->sourceHash) {
+        clearObject(entry);
+    }
+    entry->sourceHash = hash;
+
+    clearImports(entry);
+    if (imports && importCount > 0) {
+        entry->imports = malloc(importCount * sizeof(char *));
+        for (int i = 0; entry->imports && i < importCount; i++) {
+            entry->imports[entry->importCount++] = strdup(imports[i]);
+        }
+    }
+    return entry;
+}
+
+int cacheStoreObject(CachedModule *entry, uint64_t objectKey, const char *objectPath,
+                     const ModuleInterface *interface) {
+    clearObject(entry);
+    size_t size;
+    char *object = readWholeFile(objectPath, &size);
+    if (!object) return 0;
+    entry->object = (unsigned char *)object;
+    entry->objectSize = size;
+    entry->objectKey = objectKey;
+    entry->interface = copyModuleInterface(interface);
+    entry->interfaceHash = hashModuleInterface(interface);
+    return 1;
+}
+
+int cacheWriteObject(const CachedModule *entry, const char *objectPath) {
+    FILE *out = fopen(objectPath, "wb");
+    if (!out) return 0;
+    int ok = fwrite(entry->object, 1, entry->objectSize, out) == entry->objectSize;
+    if (fclose(out) != 0) ok = 0;
+    return ok;
+}
+
+static CachedLink *findLink(BuildCache *cache, const char *outputPath) {
+    for (CachedLink *link = cache->links; link; link = link->next) {
+        if (strcmp(link->outputPath, outputPath) == 0) return link;
+    }
+    return NULL;
+}
+
+int cacheLinkIsCurrent(BuildCache *cache, const char *outputPath, uint64_t key) {
+    char *realPath = realpath(outputPath, NULL);
+    if (!realPath) return 0;
+    CachedLink *link = findLink(cache, realPath);
+    free(realPath);
+
+    long long mtimeNs, size;
+    return link && link->key == key && statFile(link->outputPath, &mtimeNs, &size) &&
+           mtimeNs == link->mtimeNs && size == link->size;
+}
+
+void cacheStoreLink(BuildCache *cache, const char *outputPath, uint64_t key) {
+    char *realPath = realpath(outputPath, NULL);
+    if (!realPath) return;
+    CachedLink *link = findLink(cache, realPath);
+    if (link) {
+        free(realPath);
+    } else {
+        link = calloc(1, sizeof(CachedLink));
+        if (!link) {
+            free(realPath);
+            return;
+        }
+        link->outputPath = realPath;
+        link->next = cache->links;
+        cache->links = link;
+    }
+    link->key = key;
+    statFile(link->outputPath, &link->mtimeNs, &link->size);
+}
@@ -0,0 +1,87 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "interface.h"
+
+/**
+ * @brief What the compile server remembers about one source file. The entry is
+ * trusted while mtime and size match, and revalidated by hash when they do not.
+ */
+typedef struct CachedModule {
+    char *path;                     // realpath, the lookup key
+    long long mtimeNs;
+    long long size;
+    uint64_t sourceHash;
+    char **imports;                 // module names found by discovery
+    int importCount;
+    uint64_t objectKey;             // source, options and imported interfaces the object was built from
+    unsigned char *object;          // the assembled .o, NULL until compiled once
+    size_t objectSize;
+    ModuleInterface *interface;
+    uint64_t interfaceHash;
+    int generation;                 // last build that discovered this module
+    struct CachedModule *next;
+} CachedModule;
+
+typedef struct CachedLink {
+    char *outputPath;
+    uint64_t key;                   // the objects and runtime it was linked from
+    long long mtimeNs;
+    long long size;
+    struct CachedLink *next;
+} CachedLink;
+
+/**
+ * @brief Modules and executables kept across builds by orn --server and --watch
+ */
+typedef struct BuildCache {
+    CachedModule *modules;
+    CachedLink *links;
+    int hits;                       // objects reused by the last build
+    int misses;
+    int generation;                 // builds run with this cache
+} BuildCache;
+
+BuildCache *createBuildCache(void);
+void freeBuildCache(BuildCache *cache);
+
+uint64_t hashBytes(uint64_t hash, const void *data, size_t len);
+uint64_t hashString64(uint64_t hash, const char *str);
+uint64_t hashModuleInterface(const ModuleInterface *iface);
+
+/**
+ * @brief Entry for path if the file is unchanged since it was cached. A changed
+ * mtime with identical contents refreshes the entry instead of dropping it.
+ * @return NULL when uncached, changed or unreadable
+ */
+CachedModule *cacheLookup(BuildCache *cache, const char *path);
+
+/**
+ * @brief Records (or replaces) path's entry from freshly read contents,
+ * dropping the object and interface of a previous version
+ * @param imports Copied; NULL when the module failed to parse
+ */
+CachedModule *cacheStore(BuildCache *cache, const char *path, const char *source, char **imports,
+                         int importCount);
+
+/**
+ * @brief Keeps the object file and interface a build just produced for entry
+ */
+int cacheStoreObject(CachedModule *entry, uint64_t objectKey, const char *objectPath,
+                     const ModuleInterface *interface);
+
+/**
+ * @brief Writes a cached object back to disk for the linker
+ */
+int cacheWriteObject(const CachedModule *entry, const char *objectPath);
+
+/**
+ * @brief Whether outputPath is still the executable last linked from key
+ */
+int cacheLinkIsCurrent(BuildCache *cache, const char *outputPath, uint64_t key);
+void cacheStoreLink(BuildCache *cache, const char *outputPath, uint64_t key);
+
+#endif //CACHE_H
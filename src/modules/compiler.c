@@ -0,0 +1,169 @@
+#include "compiler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../codeGeneration/codegen.h"
+
+char *readMemoryFile(void *files, const char *path) {
+    for (const MemoryFile *file = files; file && file->path; file++) {
+        if (strcmp(file->path, path) == 0) {
+            return strdup(file->contents);
+        }
+    }
+    return NULL;
+}
+
+Compiler *createCompiler(const CompilerOptions *opts) {
+    Compiler *compiler = calloc(1, sizeof(Compiler));
+    if (compiler && opts) {
+        compiler->options = *opts;
+    }
+    return compiler;
+}
+
+void freeCompiler(Compiler *compiler) {
+    free(compiler);
+}
+
+/**
+ * @brief DiagnosticHandler appending to the CompileResult being built
+ */
+static void collectDiagnostic(void *userData, ErrorCode code, ErrorLevel level, const ErrorContext *context,
+                              const char *extraContext) {
+    CompileResult *result = userData;
+    if (result->diagnosticCount >= result->diagnosticCapacity) {
+        int newCap = result->diagnosticCapacity ? result->diagnosticCapacity * 2 : 8;
+        Diagnostic *grown = realloc(result->diagnostics, newCap * sizeof(Diagnostic));
+        if (!grown) return;
+        result->diagnostics = grown;
+        result->diagnosticCapacity = newCap;
+    }
+
+    const char *message = getErrorInfo(code)->message;
+    size_t len = strlen(message) + (extraContext ? strlen(extraContext) + 3 : 0) + 1;
+    char *text = malloc(len);
+    if (!text) return;
+    if (extraContext) {
+        snprintf(text, len, "%s (%s)", message, extraContext);
+    } else {
+        snprintf(text, len, "%s", message);
+    }
+
+    Diagnostic *diag = &result->diagnostics[result->diagnosticCount++];
+    diag->code = code;
+    diag->level = level;
+    diag->message = text;
+    diag->file = context && context->file ? strdup(context->file) : NULL;
+    diag->line = context ? context->line : 0;
+    diag->column = context ? context->column : 0;
+}
+
+/**
+ * @brief lowerModule plus codegen into a string, the library's compileModule
+ */
+static int compileToAssembly(BuildContext *ctx, Module *mod, const BuildOptions *opts, int annotate,
+                             ModuleArtifact *out) {
+    char *source = loadSource(ctx, mod->path);
+    if (!source) {
+        repError(ERROR_FILE_NOT_FOUND, mod->path);
+        return 0;
+    }
+
+    int layout;
+    IrContext *ir = lowerModule(ctx, mod, source, opts, &layout);
+    if (!ir) {
+        free(source);
+        return 0;
+    }
+
+    int importCount;
+    ModuleInterface **imports = moduleImports(ctx, mod, &importCount);
+    CodegenOptions codegenOpts = {
+        .source = source,
+        .sourceName = mod->path,
+        .annotate = annotate,
+        .debugInfo = opts->debugInfo,
+        .layout = layout,
+        .avx2 = opts->avx2
+    };
+    out->name = strdup(mod->name);
+    out->assembly = generateAssembly(ir, mod->name, imports, importCount, &codegenOpts);
+    if (!out->assembly) {
+        repError(ERROR_INTERNAL_CODE_GENERATOR_ERROR, mod->name);
+    }
+    free(imports);
+    freeIrContext(ir);
+    free(source);
+    return out->name && out->assembly;
+}
+
+CompileResult *compileProgram(const Compiler *compiler, const char *entryPath) {
+    CompileResult *result = calloc(1, sizeof(CompileResult));
+    if (!result) return NULL;
+    result->entryModule = -1;
+
+    // Errors reported on this thread land in result until the compilation ends
+    ErrorState errors = {0};
+    errors.handler = collectDiagnostic;
+    errors.userData = result;
+    ErrorState *previous = setErrorState(&errors);
+
+    const CompilerOptions *options = &compiler->options;
+    BuildOptions opts = {0};
+    opts.optLevel = options->optLevel;
+    opts.passes = options->passes;
+    opts.debugInfo = options->debugInfo;
+    opts.avx2 = options->avx2;
+
+    BuildContext ctx = {0};
+    ctx.readSource = options->readSource;
+    ctx.readerData = options->readerData;
+
+    int ok = findModules(&ctx, entryPath);
+    int sortedCount = 0;
+    int *sorted = ok ? topoSortModules(&ctx, &sortedCount) : NULL;
+    if (sorted) {
+        result->modules = calloc(sortedCount ? sortedCount : 1, sizeof(ModuleArtifact));
+    }
+    ok = sorted && result->modules;
+
+    for (int i = 0; ok && i < sortedCount; i++) {
+        Module *mod = &ctx.modules[sorted[i]];
+        if (mod->prebuilt) {
+            continue;           // already in libornrt.a
+        }
+        ok = compileToAssembly(&ctx, mod, &opts, options->annotate, &result->modules[result->moduleCount++]);
+        // findModules puts the entry file first; prebuilt modules take no slot
+        if (sorted[i] == 0) {
+            result->entryModule = result->moduleCount - 1;
+        }
+    }
+
+    free(sorted);
+    freeBuildContext(&ctx);
+    setErrorState(previous);
+
+    result->errorCount = errors.errorCount + errors.fatalCount;
+    result->warningCount = errors.warningCount;
+    result->success = ok && result->errorCount == 0;
+    if (!result->success) {
+        result->entryModule = -1;
+    }
+    return result;
+}
+
+void freeCompileResult(CompileResult *result) {
+    if (!result) return;
+    for (int i = 0; i < result->diagnosticCount; i++) {
+        free(result->diagnostics[i].message);
+        free(result->diagnostics[i].file);
+    }
+    free(result->diagnostics);
+    for (int i = 0; i < result->moduleCount; i++) {
+        free(result->modules[i].name);
+        free(result->modules[i].assembly);
+    }
+    free(result->modules);
+    free(result);
+}
@@ -0,0 +1,79 @@
+#ifndef COMPILER_H
+#define COMPILER_H
+
+#include "build.h"
+
+/**
+ * @brief Options of an embedded compiler. All zero is -O0 reading the real filesystem.
+ */
+typedef struct CompilerOptions {
+    int optLevel;
+    OptOptions passes;
+    int debugInfo;              // .file/.loc line tables and CFI
+    int annotate;               // source lines and IR as comments in the assembly
+    int avx2;                   // AVX2 target: 256-bit vector types
+    SourceReader readSource;    // virtual filesystem, NULL reads the real one
+    void *readerData;
+} CompilerOptions;
+
+/**
+ * @brief A compiler for embedders: no output on stdout/stderr and no exit(),
+ * all state lives in the Compiler and the CompileResult. It is read-only after
+ * creation, so any number of threads may call compileProgram on it at once.
+ */
+typedef struct Compiler {
+    CompilerOptions options;
+} Compiler;
+
+typedef struct Diagnostic {
+    ErrorCode code;
+    ErrorLevel level;
+    char *message;              // "mismatched types (extra context)"
+    char *file;                 // NULL when not tied to a source location
+    size_t line;
+    size_t column;
+} Diagnostic;
+
+typedef struct ModuleArtifact {
+    char *name;
+    char *assembly;             // GNU as input; link all modules with libornrt.a
+} ModuleArtifact;
+
+typedef struct CompileResult {
+    int success;
+    Diagnostic *diagnostics;
+    int diagnosticCount;
+    int diagnosticCapacity;
+    int errorCount;
+    int warningCount;
+    ModuleArtifact *modules;    // compilation order, dependencies first
+    int moduleCount;
+    int entryModule;            // index of the module holding the top-level code, -1 on failure
+} CompileResult;
+
+/**
+ * @brief In-memory file for readMemoryFile
+ */
+typedef struct MemoryFile {
+    const char *path;
+    const char *contents;
+} MemoryFile;
+
+/**
+ * @brief SourceReader over an array of MemoryFile ended by a NULL path
+ */
+char *readMemoryFile(void *files, const char *path);
+
+Compiler *createCompiler(const CompilerOptions *opts);
+
+/**
+ * @brief Compiles the program rooted at entryPath (imports resolve next to
+ * it) to one assembly listing per module.
+ * @return The artifacts and diagnostics, NULL only when out of memory
+ */
+CompileResult *compileProgram(const Compiler *compiler, const char *entryPath);
+
+void freeCompileResult(CompileResult *result);
+void freeCompiler(Compiler *compiler);
+
+#endif //COMPILER_H
@@ -4,6 +4,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "../codeGeneration/stringBuffer.h"
+
+#define ORNI_VERSION 3
+
 const char *dataTypeToString(DataType type) {
     switch (type) {
     case TYPE_INT:
@@ -20,6 +24,32 @@ const char *dataTypeToString(DataType type) {
         return "void";
     case TYPE_POINTER:
         return "ptr";
+    case TYPE_I8:
+        return "i8";
+    case TYPE_I16:
+        return "i16";
+    case TYPE_I64:
+        return "i64";
+    case TYPE_U8:
+        return "u8";
+    case TYPE_U16:
+        return "u16";
+    case TYPE_U32:
+        return "u32";
+    case TYPE_U64:
+        return "u64";
+    case TYPE_F32X4:
+        return "f32x4";
+    case TYPE_F64X2:
+        return "f64x2";
+    case TYPE_I32X4:
+        return "i32x4";
+    case TYPE_F32X8:
+        return "f32x8";
+    case TYPE_F64X4:
+        return "f64x4";
+    case TYPE_I32X8:
+        return "i32x8";
     default:
         return "unknown";
     }
@@ -34,6 +64,20 @@ DataType stringToDataType(const char *str) {
     if (strcmp(str, "bool") == 0) return TYPE_BOOL;
     if (strcmp(str, "void") == 0) return TYPE_VOID;
     if (strcmp(str, "ptr") == 0) return TYPE_POINTER;
+    if (strcmp(str, "i8") == 0) return TYPE_I8;
+    if (strcmp(str, "i16") == 0) return TYPE_I16;
+    if (strcmp(str, "i32") == 0) return TYPE_INT;
+    if (strcmp(str, "i64") == 0) return TYPE_I64;
+    if (strcmp(str, "u8") == 0) return TYPE_U8;
+    if (strcmp(str, "u16") == 0) return TYPE_U16;
+    if (strcmp(str, "u32") == 0) return TYPE_U32;
+    if (strcmp(str, "u64") == 0) return TYPE_U64;
+    if (strcmp(str, "f32x4") == 0) return TYPE_F32X4;
+    if (strcmp(str, "f64x2") == 0) return TYPE_F64X2;
+    if (strcmp(str, "i32x4") == 0) return TYPE_I32X4;
+    if (strcmp(str, "f32x8") == 0) return TYPE_F32X8;
+    if (strcmp(str, "f64x4") == 0) return TYPE_F64X4;
+    if (strcmp(str, "i32x8") == 0) return TYPE_I32X8;
     if (str[0] == '*') return TYPE_POINTER;
     return TYPE_STRUCT;
 }
@@ -119,6 +163,7 @@ static ExportedStruct *createExportedStruct(ASTNode structNode, TypeCheckContext
 
     es->name = strndup(structNode->start, structNode->length);
     es->size = structSym->structType->size;
+    es->alignment = structSym->structType->alignment;
     es->fieldCount = structSym->structType->fieldCount;
     es->fields = NULL;
     es->next = NULL;
@@ -161,6 +206,7 @@ static StructType createStructTypeFromExport(ExportedStruct *es) {
     st->nameStart = nameCopy;
     st->nameLength = strlen(es->name);
     st->size = es->size;
+    st->alignment = es->alignment;
     st->fieldCount = es->fieldCount;
     st->fields = NULL;
 
@@ -352,6 +398,26 @@ int addImportsToSymbolTable(SymbolTable table, ModuleInterface *iface) {
     return 1;
 }
 
+static void freeExportedFields(ExportedField *field) {
+    while (field) {
+        ExportedField *next = field->next;
+        free(field->name);
+        free(field->type);
+        free(field);
+        field = next;
+    }
+}
+
+static void freeExportedStructs(ExportedStruct *es) {
+    while (es) {
+        ExportedStruct *next = es->next;
+        free(es->name);
+        freeExportedFields(es->fields);
+        free(es);
+        es = next;
+    }
+}
+
 void freeModuleInterface(ModuleInterface *iface) {
     if (!iface) return;
 
@@ -366,26 +432,188 @@ void freeModuleInterface(ModuleInterface *iface) {
         free(func);
         func = next;
     }
+    freeExportedStructs(iface->structs);
 
     free(iface);
 }
 
-static void freeExportedFields(ExportedField *field) {
-    while (field) {
-        ExportedField *next = field->next;
-        free(field->name);
-        free(field->type);
-        free(field);
-        field = next;
+ModuleInterface *copyModuleInterface(const ModuleInterface *iface) {
+    if (!iface) return NULL;
+    ModuleInterface *copy = calloc(1, sizeof(ModuleInterface));
+    if (!copy) return NULL;
+    copy->moduleName = strdup(iface->moduleName);
+    copy->functionCount = iface->functionCount;
+    copy->structCount = iface->structCount;
+
+    ExportedFunction **lastFunc = &copy->functions;
+    for (const ExportedFunction *func = iface->functions; func; func = func->next) {
+        ExportedFunction *ef = calloc(1, sizeof(ExportedFunction));
+        if (!ef) break;
+        ef->name = strdup(func->name);
+        ef->signature = func->signature ? strdup(func->signature) : NULL;
+        ef->returnType = func->returnType ? strdup(func->returnType) : NULL;
+        *lastFunc = ef;
+        lastFunc = &ef->next;
     }
+
+    ExportedStruct **lastStruct = &copy->structs;
+    for (const ExportedStruct *es = iface->structs; es; es = es->next) {
+        ExportedStruct *cs = calloc(1, sizeof(ExportedStruct));
+        if (!cs) break;
+        cs->name = strdup(es->name);
+        cs->fieldCount = es->fieldCount;
+        cs->size = es->size;
+        cs->alignment = es->alignment;
+        ExportedField **lastField = &cs->fields;
+        for (const ExportedField *field = es->fields; field; field = field->next) {
+            ExportedField *cf = calloc(1, sizeof(ExportedField));
+            if (!cf) break;
+            *cf = *field;
+            cf->name = strdup(field->name);
+            cf->type = strdup(field->type);
+            cf->next = NULL;
+            *lastField = cf;
+            lastField = &cf->next;
+        }
+        *lastStruct = cs;
+        lastStruct = &cs->next;
+    }
+    return copy;
 }
 
-static void freeExportedStructs(ExportedStruct *es) {
-    while (es) {
-        ExportedStruct *next = es->next;
-        free(es->name);
-        freeExportedFields(es->fields);
-        free(es);
-        es = next;
+static char *formatInterface(const ModuleInterface *iface) {
+    StringBuffer sb = sbCreate(256);
+    sbAppendf(&sb, "orni %d\nmodule %s\n", ORNI_VERSION, iface->moduleName);
+    for (const ExportedFunction *func = iface->functions; func; func = func->next) {
+        sbAppendf(&sb, "fn\t%s\t%s\t%s\n", func->name, func->returnType ? func->returnType : "void",
+                  func->signature ? func->signature : "");
+    }
+    for (const ExportedStruct *es = iface->structs; es; es = es->next) {
+        sbAppendf(&sb, "struct\t%s\t%d\t%d\n", es->name, es->size, es->alignment);
+        for (const ExportedField *field = es->fields; field; field = field->next) {
+            sbAppendf(&sb, "field\t%s\t%s\t%d\t%d\n", field->name, field->type, field->offset, field->pointerLevel);
+        }
+    }
+    return sb.data;
+}
+
+static char *readTextFile(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char *text = size >= 0 ? malloc((size_t)size + 1) : NULL;
+    if (text) {
+        text[fread(text, 1, (size_t)size, file)] = '\0';
+    }
+    fclose(file);
+    return text;
+}
+
+int writeInterfaceFile(const char *path, const ModuleInterface *iface) {
+    char *text = formatInterface(iface);
+    if (!text) return 0;
+
+    // Same interface, same file: build systems that restat outputs skip the dependents
+    char *existing = readTextFile(path);
+    int same = existing && strcmp(existing, text) == 0;
+    free(existing);
+
+    int ok = 1;
+    if (!same) {
+        FILE *out = fopen(path, "w");
+        ok = out && fputs(text, out) >= 0;
+        if (out && fclose(out) != 0) ok = 0;
+        if (!ok) fprintf(stderr, "Error: Cannot write interface file '%s'\n", path);
+    }
+    free(text);
+    return ok;
+}
+
+/**
+ * @brief Splits line at tabs, in place
+ * @return Number of fields
+ */
+static int splitFields(char *line, char **fields, int max) {
+    int count = 0;
+    while (count < max) {
+        fields[count++] = line;
+        char *tab = strchr(line, '\t');
+        if (!tab) break;
+        *tab = '\0';
+        line = tab + 1;
     }
-}
\ No newline at end of file
+    return count;
+}
+
+ModuleInterface *readInterfaceFile(const char *path) {
+    char *text = readTextFile(path);
+    if (!text) return NULL;
+
+    ModuleInterface *iface = calloc(1, sizeof(ModuleInterface));
+    ExportedFunction **lastFunc = iface ? &iface->functions : NULL;
+    ExportedStruct **lastStruct = iface ? &iface->structs : NULL;
+    ExportedStruct *currentStruct = NULL;
+    ExportedField **lastField = NULL;
+    int ok = iface != NULL;
+    int version = 0;
+
+    char *save = NULL;
+    for (char *line = strtok_r(text, "\n", &save); ok && line; line = strtok_r(NULL, "\n", &save)) {
+        char *fields[5] = {0};
+        int count = splitFields(line, fields, 5);
+        if (!version) {
+            ok = sscanf(fields[0], "orni %d", &version) == 1 && version == ORNI_VERSION;
+        } else if (strncmp(fields[0], "module ", 7) == 0 && !iface->moduleName) {
+            iface->moduleName = strdup(fields[0] + 7);
+        } else if (strcmp(fields[0], "fn") == 0 && count == 4) {
+            ExportedFunction *ef = calloc(1, sizeof(ExportedFunction));
+            ok = ef != NULL;
+            if (ok) {
+                ef->name = strdup(fields[1]);
+                ef->returnType = strdup(fields[2]);
+                ef->signature = strdup(fields[3]);
+                *lastFunc = ef;
+                lastFunc = &ef->next;
+                iface->functionCount++;
+            }
+        } else if (strcmp(fields[0], "struct") == 0 && count == 4) {
+            ExportedStruct *es = calloc(1, sizeof(ExportedStruct));
+            ok = es != NULL;
+            if (ok) {
+                es->name = strdup(fields[1]);
+                es->size = atoi(fields[2]);
+                es->alignment = atoi(fields[3]);
+                *lastStruct = es;
+                lastStruct = &es->next;
+                currentStruct = es;
+                lastField = &es->fields;
+                iface->structCount++;
+            }
+        } else if (strcmp(fields[0], "field") == 0 && count == 5 && currentStruct) {
+            ExportedField *ef = calloc(1, sizeof(ExportedField));
+            ok = ef != NULL;
+            if (ok) {
+                ef->name = strdup(fields[1]);
+                ef->type = strdup(fields[2]);
+                ef->offset = atoi(fields[3]);
+                ef->pointerLevel = atoi(fields[4]);
+                ef->isPointer = ef->pointerLevel > 0;
+                *lastField = ef;
+                lastField = &ef->next;
+                currentStruct->fieldCount++;
+            }
+        } else {
+            ok = 0;
+        }
+    }
+    free(text);
+
+    if (!ok || !iface->moduleName) {
+        fprintf(stderr, "Error: '%s' is not a valid Orn interface file\n", path);
+        freeModuleInterface(iface);
+        return NULL;
+    }
+    return iface;
+}
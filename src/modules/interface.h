@@ -26,6 +26,7 @@ typedef struct ExportedStruct {
     ExportedField *fields;
     int fieldCount;
     int size;
+    int alignment;
     struct ExportedStruct *next;
 } ExportedStruct;
 
@@ -50,6 +51,23 @@ int addImportsToSymbolTable(SymbolTable table, ModuleInterface *iface);
  */
 void freeModuleInterface(ModuleInterface *iface);
 
+/**
+ * @brief Deep copy, for interfaces that outlive their build (compile server cache)
+ */
+ModuleInterface *copyModuleInterface(const ModuleInterface *iface);
+
+/**
+ * @brief Writes iface as a .orni file for separate compilation. The file is
+ * left untouched when it already holds the same interface.
+ */
+int writeInterfaceFile(const char *path, const ModuleInterface *iface);
+
+/**
+ * @brief Reads a .orni file written by writeInterfaceFile
+ * @return NULL when missing or malformed
+ */
+ModuleInterface *readInterfaceFile(const char *path);
+
 /**
  * @brief Convert DataType to string for .orni output
  */
@@ -0,0 +1,110 @@
+#define _GNU_SOURCE
+#include "perfCounters.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+
+static const struct {
+    uint32_t type;
+    uint64_t config;
+    const char *name;
+} counterConfigs[PERF_COUNTER_COUNT] = {
+    [PERF_CYCLES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, "cycles"},
+    [PERF_INSTRUCTIONS] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, "instructions"},
+    [PERF_BRANCH_MISSES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, "branch-misses"},
+    [PERF_LLC_MISSES] = {PERF_TYPE_HW_CACHE,
+                         PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+                         "LLC-load-misses"},
+};
+
+static int openCounter(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // count the gcc children spawned for assemble/link too
+    attr.inherit = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+PerfCounters *openPerfCounters(void) {
+    PerfCounters *perf = malloc(sizeof(PerfCounters));
+    if (!perf) return NULL;
+    perf->openCount = 0;
+
+    int lastErr = 0;
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        perf->fds[i] = openCounter(counterConfigs[i].type, counterConfigs[i].config);
+        if (perf->fds[i] >= 0) {
+            perf->openCount++;
+        } else {
+            lastErr = errno;
+        }
+    }
+
+    if (perf->openCount == 0) {
+        fprintf(stderr, "Warning: hardware counters unavailable (%s), reporting time only\n",
+                strerror(lastErr));
+        free(perf);
+        return NULL;
+    }
+
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        if (perf->fds[i] < 0) {
+            fprintf(stderr, "Warning: perf counter '%s' unavailable\n", counterConfigs[i].name);
+        }
+    }
+    return perf;
+}
+
+void readPerfCounters(PerfCounters *perf, uint64_t values[PERF_COUNTER_COUNT]) {
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        uint64_t buf[3] = {0, 0, 0};
+        values[i] = 0;
+        if (!perf || perf->fds[i] < 0) continue;
+        if (read(perf->fds[i], buf, sizeof(buf)) != (ssize_t)sizeof(buf)) continue;
+        // buf = {value, time enabled, time running}; scale when multiplexed
+        if (buf[2] && buf[2] < buf[1]) {
+            values[i] = (uint64_t)((double)buf[0] * buf[1] / buf[2]);
+        } else {
+            values[i] = buf[0];
+        }
+    }
+}
+
+#else
+
+PerfCounters *openPerfCounters(void) {
+    fprintf(stderr, "Warning: hardware counters need Linux perf_event_open, reporting time only\n");
+    return NULL;
+}
+
+void readPerfCounters(PerfCounters *perf, uint64_t values[PERF_COUNTER_COUNT]) {
+    (void)perf;
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) values[i] = 0;
+}
+
+#endif
+
+void closePerfCounters(PerfCounters *perf) {
+    if (!perf) return;
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        if (perf->fds[i] >= 0) close(perf->fds[i]);
+    }
+    free(perf);
+}
+
+int perfCounterAvailable(PerfCounters *perf, PerfCounterKind kind) {
+    return perf && perf->fds[kind] >= 0;
+}
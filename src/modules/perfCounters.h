@@ -0,0 +1,38 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdint.h>
+
+typedef enum {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_BRANCH_MISSES,
+    PERF_LLC_MISSES,
+    PERF_COUNTER_COUNT
+} PerfCounterKind;
+
+/**
+ * @brief Hardware counters opened with perf_event_open for this process and
+ * its children (gcc). A counter whose fd is -1 could not be opened and
+ * reads as 0.
+ */
+typedef struct PerfCounters {
+    int fds[PERF_COUNTER_COUNT];
+    int openCount;
+} PerfCounters;
+
+/**
+ * @brief Open every counter the kernel allows.
+ * @return NULL when none are available; the reason is printed to stderr
+ */
+PerfCounters *openPerfCounters(void);
+void closePerfCounters(PerfCounters *perf);
+
+/**
+ * @brief Snapshot current counter values (scaled for multiplexing)
+ */
+void readPerfCounters(PerfCounters *perf, uint64_t values[PERF_COUNTER_COUNT]);
+
+int perfCounterAvailable(PerfCounters *perf, PerfCounterKind kind);
+
+#endif //PERF_COUNTERS_H
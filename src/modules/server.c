@@ -0,0 +1,341 @@
+#define _GNU_SOURCE
+#include "server.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "../errorHandling/errorHandling.h"
+
+#define SERVER_MAX_ARGS 1024
+#define SERVER_MAX_STRING (1u << 20)
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void onStopSignal(int sig) {
+    (void)sig;
+    stopRequested = 1;
+}
+
+int defaultServerSocket(char *buffer, size_t size) {
+    const char *runtimeDir = getenv("XDG_RUNTIME_DIR");
+    if (runtimeDir && *runtimeDir) {
+        if ((size_t)snprintf(buffer, size, "%s/orn.sock", runtimeDir) >= size) {
+            fprintf(stderr, "Error: XDG_RUNTIME_DIR '%s' is too long for a socket path\n", runtimeDir);
+            return 0;
+        }
+        return 1;
+    }
+
+    // /tmp is shared: the socket goes in a directory only this user can enter
+    char dir[64];
+    snprintf(dir, sizeof(dir), "/tmp/orn-%u", (unsigned)getuid());
+    if (mkdir(dir, 0700) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Error: Cannot create '%s': %s\n", dir, strerror(errno));
+        return 0;
+    }
+    struct stat st;
+    if (lstat(dir, &st) != 0 || !S_ISDIR(st.st_mode) || st.st_uid != getuid() || (st.st_mode & 077) != 0) {
+        fprintf(stderr, "Error: '%s' is not a private directory owned by you, refusing to use it\n", dir);
+        return 0;
+    }
+    snprintf(buffer, size, "%s/server.sock", dir);
+    return 1;
+}
+
+/**
+ * @brief Whether the process at the other end of a connected socket runs as this user
+ */
+static int peerIsSelf(int fd) {
+    struct ucred cred;
+    socklen_t len = sizeof(cred);
+    return getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) == 0 && cred.uid == getuid();
+}
+
+static int sendAll(int fd, const void *data, size_t len) {
+    const char *bytes = data;
+    while (len > 0) {
+        ssize_t sent = send(fd, bytes, len, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return 0;
+        bytes += sent;
+        len -= (size_t)sent;
+    }
+    return 1;
+}
+
+static int recvAll(int fd, void *data, size_t len) {
+    char *bytes = data;
+    while (len > 0) {
+        ssize_t got = recv(fd, bytes, len, 0);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return 0;
+        bytes += got;
+        len -= (size_t)got;
+    }
+    return 1;
+}
+
+// Both ends run on the same machine, so integers go in host byte order
+static int sendU32(int fd, uint32_t value) {
+    return sendAll(fd, &value, sizeof(value));
+}
+
+static int recvU32(int fd, uint32_t *value) {
+    return recvAll(fd, value, sizeof(*value));
+}
+
+static int sendBlob(int fd, const char *data, size_t len) {
+    return sendU32(fd, (uint32_t)len) && sendAll(fd, data, len);
+}
+
+static char *recvBlob(int fd, uint32_t limit, uint32_t *outLen) {
+    uint32_t len;
+    if (!recvU32(fd, &len) || len > limit) return NULL;
+    char *data = malloc((size_t)len + 1);
+    if (!data) return NULL;
+    if (!recvAll(fd, data, len)) {
+        free(data);
+        return NULL;
+    }
+    data[len] = '\0';
+    if (outLen) *outLen = len;
+    return data;
+}
+
+static int connectTo(const char *socketPath) {
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    if (strlen(socketPath) >= sizeof(addr.sun_path)) return -1;
+    strcpy(addr.sun_path, socketPath);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int listenOn(const char *socketPath) {
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    if (strlen(socketPath) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Error: Socket path '%s' is too long\n", socketPath);
+        return -1;
+    }
+    strcpy(addr.sun_path, socketPath);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot create socket: %s\n", strerror(errno));
+        return -1;
+    }
+    int bound = bind(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0;
+    if (!bound && errno == EADDRINUSE) {
+        // A socket file left behind by a server that died is safe to replace
+        int live = connectTo(socketPath);
+        if (live >= 0) {
+            int own = peerIsSelf(live);
+            close(live);
+            close(fd);
+            fprintf(stderr, own ? "Error: A server is already listening on '%s'\n"
+                                : "Error: Another user's server is listening on '%s'\n", socketPath);
+            return -1;
+        }
+        unlink(socketPath);
+        bound = bind(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0;
+    }
+    // Only this user may connect; peers are checked on accept as well
+    if (!bound || chmod(socketPath, 0600) != 0 || listen(fd, 16) != 0) {
+        fprintf(stderr, "Error: Cannot listen on '%s': %s\n", socketPath, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+typedef struct Capture {
+    FILE *out;
+    FILE *err;
+    int savedOut;
+    int savedErr;
+} Capture;
+
+/**
+ * @brief Points stdout/stderr (and so the assembler and linker the build
+ * runs) at temporary files
+ */
+static int captureBegin(Capture *capture) {
+    fflush(stdout);
+    fflush(stderr);
+    capture->out = tmpfile();
+    capture->err = tmpfile();
+    if (!capture->out || !capture->err) {
+        if (capture->out) fclose(capture->out);
+        if (capture->err) fclose(capture->err);
+        return 0;
+    }
+    capture->savedOut = dup(STDOUT_FILENO);
+    capture->savedErr = dup(STDERR_FILENO);
+    dup2(fileno(capture->out), STDOUT_FILENO);
+    dup2(fileno(capture->err), STDERR_FILENO);
+    return 1;
+}
+
+static char *readCaptured(FILE *file, size_t *outLen) {
+    fseek(file, 0, SEEK_END);
+    long len = ftell(file);
+    rewind(file);
+    char *data = malloc(len > 0 ? (size_t)len : 1);
+    *outLen = data && len > 0 ? fread(data, 1, (size_t)len, file) : 0;
+    fclose(file);
+    return data;
+}
+
+static void captureEnd(Capture *capture) {
+    fflush(stdout);
+    fflush(stderr);
+    dup2(capture->savedOut, STDOUT_FILENO);
+    dup2(capture->savedErr, STDERR_FILENO);
+    close(capture->savedOut);
+    close(capture->savedErr);
+}
+
+/**
+ * @brief Reads one request, runs it and replies
+ * @return 0 when the client asked the server to stop
+ */
+static int serveConnection(int fd, ServerRequestHandler handler, void *userData) {
+    uint32_t argc;
+    if (!recvU32(fd, &argc) || argc < 2 || argc > SERVER_MAX_ARGS) return 1;
+    char **args = calloc(argc, sizeof(char *));
+    if (!args) return 1;
+    int received = 1;
+    for (uint32_t i = 0; i < argc && received; i++) {
+        args[i] = recvBlob(fd, SERVER_MAX_STRING, NULL);
+        received = args[i] != NULL;
+    }
+
+    int keepRunning = 1;
+    if (received) {
+        // args[0] is the client's working directory, the rest its command line
+        char **argv = args + 1;
+        int argCount = (int)argc - 1;
+        int code = 1;
+        char *out = NULL, *err = NULL;
+        size_t outLen = 0, errLen = 0;
+
+        if (argCount == 2 && strcmp(argv[1], "--stop-server") == 0) {
+            keepRunning = 0;
+            code = 0;
+        } else if (chdir(args[0]) != 0) {
+            char message[512];
+            errLen = (size_t)snprintf(message, sizeof(message), "Error: Server cannot enter '%s'\n", args[0]);
+            err = strdup(message);
+        } else {
+            Capture capture;
+            if (captureBegin(&capture)) {
+                // Fresh counts per request, and a fatal error must not take the server down
+                ErrorState errors = {0};
+                errors.recoverFatal = 1;
+                ErrorState *previous = setErrorState(&errors);
+                code = handler(argCount, argv, userData);
+                setErrorState(previous);
+                captureEnd(&capture);
+                out = readCaptured(capture.out, &outLen);
+                err = readCaptured(capture.err, &errLen);
+            }
+        }
+        if (sendU32(fd, (uint32_t)code) && sendBlob(fd, out ? out : "", out ? outLen : 0)) {
+            sendBlob(fd, err ? err : "", err ? errLen : 0);
+        }
+        free(out);
+        free(err);
+    }
+
+    for (uint32_t i = 0; i < argc; i++) free(args[i]);
+    free(args);
+    return keepRunning;
+}
+
+int runServer(const char *socketPath, ServerRequestHandler handler, void *userData) {
+    int listener = listenOn(socketPath);
+    if (listener < 0) return 0;
+
+    // No SA_RESTART: accept() must return so the loop sees the flag
+    struct sigaction action = {0};
+    action.sa_handler = onStopSignal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    printf("Orn compile server listening on %s\n", socketPath);
+    fflush(stdout);
+
+    int running = 1;
+    while (running && !stopRequested) {
+        int client = accept(listener, NULL, NULL);
+        if (client < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "Error: accept failed: %s\n", strerror(errno));
+            break;
+        }
+        if (!peerIsSelf(client)) {
+            fprintf(stderr, "Error: Rejected a connection from another user\n");
+            close(client);
+            continue;
+        }
+        running = serveConnection(client, handler, userData);
+        close(client);
+    }
+
+    close(listener);
+    unlink(socketPath);
+    return 1;
+}
+
+int runClient(const char *socketPath, int argc, char **argv) {
+    int fd = connectTo(socketPath);
+    if (fd < 0) return -1;
+    if (!peerIsSelf(fd)) {
+        close(fd);
+        fprintf(stderr, "Error: The compile server at '%s' runs as another user, not sending it the build\n",
+                socketPath);
+        return 1;
+    }
+
+    char *cwd = getcwd(NULL, 0);
+    int ok = cwd && sendU32(fd, (uint32_t)argc + 1) && sendBlob(fd, cwd, strlen(cwd));
+    free(cwd);
+    for (int i = 0; ok && i < argc; i++) {
+        ok = sendBlob(fd, argv[i], strlen(argv[i]));
+    }
+
+    uint32_t code = 1;
+    uint32_t outLen = 0, errLen = 0;
+    char *out = NULL, *err = NULL;
+    ok = ok && recvU32(fd, &code) && (out = recvBlob(fd, UINT32_MAX - 1, &outLen)) &&
+         (err = recvBlob(fd, UINT32_MAX - 1, &errLen));
+    close(fd);
+    if (!ok) {
+        fprintf(stderr, "Error: Lost connection to the compile server at '%s'\n", socketPath);
+        free(out);
+        free(err);
+        return 1;
+    }
+
+    fwrite(out, 1, outLen, stdout);
+    fwrite(err, 1, errLen, stderr);
+    free(out);
+    free(err);
+    return (int)code;
+}
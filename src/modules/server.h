@@ -0,0 +1,36 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stddef.h>
+
+/**
+ * @brief Runs one compiler invocation inside the server, from the client's
+ * working directory. argv[0] is the program name.
+ * @return The exit code the client exits with
+ */
+typedef int (*ServerRequestHandler)(int argc, char **argv, void *userData);
+
+/**
+ * @brief The socket --server and --client use by default: $XDG_RUNTIME_DIR/orn.sock,
+ * else /tmp/orn-<uid>/server.sock in a directory created 0700 and checked to be
+ * this user's alone
+ * @return 0 after reporting that the directory is unsafe or cannot be created
+ */
+int defaultServerSocket(char *buffer, size_t size);
+
+/**
+ * @brief Serves compile requests on a Unix domain socket, one at a time, until
+ * SIGINT/SIGTERM or a client sends --stop-server. Whatever a request prints on
+ * stdout and stderr is sent back to its client.
+ * @return 1 after a clean shutdown, 0 when the socket could not be set up
+ */
+int runServer(const char *socketPath, ServerRequestHandler handler, void *userData);
+
+/**
+ * @brief Sends argv and the working directory to the server and replays its output
+ * @return The request's exit code, -1 when no server listens on socketPath; a
+ * server running as another user is refused and never sees the request
+ */
+int runClient(const char *socketPath, int argc, char **argv);
+
+#endif //SERVER_H
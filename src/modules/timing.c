@@ -0,0 +1,277 @@
+#define _POSIX_C_SOURCE 199309L
+#include "timing.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define PROJECT_NAME "<project>"
+
+typedef struct {
+    const char *phase;
+    int depth;
+    int calls;
+    uint64_t totalNs;
+    uint64_t counters[PERF_COUNTER_COUNT];
+} PhaseRow;
+
+static uint64_t nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int sameModule(const char *a, const char *b) {
+    if (!a || !b) return a == b;
+    return strcmp(a, b) == 0;
+}
+
+BuildTimer *createBuildTimer(void) {
+    BuildTimer *timer = calloc(1, sizeof(BuildTimer));
+    if (!timer) return NULL;
+    timer->originNs = nowNs();
+    return timer;
+}
+
+void freeBuildTimer(BuildTimer *timer) {
+    if (!timer) return;
+    closePerfCounters(timer->perf);
+    free(timer->samples);
+    free(timer->sources);
+    free(timer);
+}
+
+void timerSetModule(BuildTimer *timer, const char *module) {
+    if (timer) timer->module = module;
+}
+
+int timerEnablePerfCounters(BuildTimer *timer) {
+    if (!timer) return 0;
+    if (!timer->perf) timer->perf = openPerfCounters();
+    return timer->perf != NULL;
+}
+
+void timerAddSource(BuildTimer *timer, size_t bytes) {
+    if (!timer) return;
+    if (timer->sourceCount >= timer->sourceCapacity) {
+        int newCap = timer->sourceCapacity ? timer->sourceCapacity * 2 : 8;
+        SourceSize *grown = realloc(timer->sources, newCap * sizeof(SourceSize));
+        if (!grown) return;
+        timer->sources = grown;
+        timer->sourceCapacity = newCap;
+    }
+    timer->sources[timer->sourceCount++] = (SourceSize){timer->module, bytes};
+}
+
+/**
+ * @brief Source bytes of one module, or of all modules when module is NULL
+ */
+static size_t sourceBytes(BuildTimer *timer, const char *module) {
+    size_t total = 0;
+    for (int i = 0; i < timer->sourceCount; i++) {
+        if (!module || sameModule(timer->sources[i].module, module)) {
+            total += timer->sources[i].bytes;
+        }
+    }
+    return total;
+}
+
+int timerBegin(BuildTimer *timer, const char *phase) {
+    if (!timer) return -1;
+
+    if (timer->sampleCount >= timer->sampleCapacity) {
+        int newCap = timer->sampleCapacity ? timer->sampleCapacity * 2 : 64;
+        PhaseSample *grown = realloc(timer->samples, newCap * sizeof(PhaseSample));
+        if (!grown) return -1;
+        timer->samples = grown;
+        timer->sampleCapacity = newCap;
+    }
+
+    PhaseSample *sample = &timer->samples[timer->sampleCount];
+    sample->module = timer->module;
+    sample->phase = phase;
+    sample->depth = timer->depth++;
+    sample->durationNs = 0;
+    if (timer->perf) readPerfCounters(timer->perf, sample->counters);
+    sample->startNs = nowNs();
+    return timer->sampleCount++;
+}
+
+void timerEnd(BuildTimer *timer, int sample) {
+    if (!timer || sample < 0 || sample >= timer->sampleCount) return;
+    PhaseSample *s = &timer->samples[sample];
+    s->durationNs = nowNs() - s->startNs;
+    if (timer->perf) {
+        uint64_t now[PERF_COUNTER_COUNT];
+        readPerfCounters(timer->perf, now);
+        for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+            // multiplex scaling can make a later estimate smaller
+            s->counters[i] = now[i] > s->counters[i] ? now[i] - s->counters[i] : 0;
+        }
+    }
+    timer->depth = s->depth;
+}
+
+/**
+ * @brief Sum samples of one module by (phase, depth), keeping first-seen order.
+ * allModules merges every module into one table.
+ */
+static int collectRows(BuildTimer *timer, const char *module, int allModules, PhaseRow *rows) {
+    int rowCount = 0;
+    for (int i = 0; i < timer->sampleCount; i++) {
+        PhaseSample *s = &timer->samples[i];
+        if (!allModules && !sameModule(s->module, module)) continue;
+
+        int r = 0;
+        while (r < rowCount && !(rows[r].depth == s->depth && strcmp(rows[r].phase, s->phase) == 0)) {
+            r++;
+        }
+        if (r == rowCount) {
+            rows[rowCount++] = (PhaseRow){s->phase, s->depth, 0, 0, {0}};
+        }
+        rows[r].calls++;
+        rows[r].totalNs += s->durationNs;
+        for (int c = 0; c < PERF_COUNTER_COUNT; c++) rows[r].counters[c] += s->counters[c];
+    }
+    return rowCount;
+}
+
+static void printCount(FILE *out, PerfCounters *perf, PerfCounterKind kind, uint64_t value) {
+    if (perfCounterAvailable(perf, kind)) {
+        fprintf(out, " %12llu", (unsigned long long)value);
+    } else {
+        fprintf(out, " %12s", "-");
+    }
+}
+
+/**
+ * @brief Per-phase rows; with counters, adds IPC and misses per KB of source
+ */
+static void printRows(FILE *out, BuildTimer *timer, PhaseRow *rows, int rowCount, uint64_t wallNs,
+                      size_t bytes) {
+    PerfCounters *perf = timer->perf;
+    fprintf(out, "  %-28s %6s %12s %7s", "Phase", "Calls", "Time (ms)", "%");
+    if (perf) {
+        fprintf(out, " %12s %12s %12s %12s %6s %9s %9s", "Cycles", "Instrs", "BrMisses",
+                "LLCMisses", "IPC", "BrMiss/KB", "LLC/KB");
+    }
+    fprintf(out, "\n");
+
+    double kb = bytes / 1024.0;
+    for (int r = 0; r < rowCount; r++) {
+        PhaseRow *row = &rows[r];
+        double ms = row->totalNs / 1e6;
+        double pct = wallNs ? 100.0 * row->totalNs / wallNs : 0.0;
+        fprintf(out, "  %*s%-*s %6d %12.3f %6.1f%%", row->depth * 2, "", 28 - row->depth * 2,
+                row->phase, row->calls, ms, pct);
+
+        if (perf) {
+            for (int c = 0; c < PERF_COUNTER_COUNT; c++) printCount(out, perf, c, row->counters[c]);
+
+            uint64_t cycles = row->counters[PERF_CYCLES];
+            if (cycles && perfCounterAvailable(perf, PERF_INSTRUCTIONS)) {
+                fprintf(out, " %6.2f", (double)row->counters[PERF_INSTRUCTIONS] / cycles);
+            } else {
+                fprintf(out, " %6s", "-");
+            }
+            if (kb > 0 && perfCounterAvailable(perf, PERF_BRANCH_MISSES)) {
+                fprintf(out, " %9.1f", row->counters[PERF_BRANCH_MISSES] / kb);
+            } else {
+                fprintf(out, " %9s", "-");
+            }
+            if (kb > 0 && perfCounterAvailable(perf, PERF_LLC_MISSES)) {
+                fprintf(out, " %9.1f", row->counters[PERF_LLC_MISSES] / kb);
+            } else {
+                fprintf(out, " %9s", "-");
+            }
+        }
+        fprintf(out, "\n");
+    }
+}
+
+void printTimeReport(BuildTimer *timer, FILE *out) {
+    if (!timer) return;
+    uint64_t wallNs = nowNs() - timer->originNs;
+
+    PhaseRow *rows = malloc((timer->sampleCount + 1) * sizeof(PhaseRow));
+    const char **seen = malloc((timer->sampleCount + 1) * sizeof(char *));
+    if (!rows || !seen) {
+        free(rows);
+        free(seen);
+        return;
+    }
+
+    fprintf(out, "\n=== TIME REPORT ===\n");
+
+    // One table per module in order of first appearance, project-level phases included
+    int seenCount = 0;
+    int moduleCount = 0;
+    for (int i = 0; i < timer->sampleCount; i++) {
+        const char *module = timer->samples[i].module;
+        int known = 0;
+        for (int j = 0; j < seenCount && !known; j++) known = sameModule(seen[j], module);
+        if (known) continue;
+        seen[seenCount++] = module;
+        if (module) moduleCount++;
+
+        int rowCount = collectRows(timer, module, 0, rows);
+        uint64_t moduleNs = 0;
+        for (int r = 0; r < rowCount; r++) {
+            if (rows[r].depth == 0) moduleNs += rows[r].totalNs;
+        }
+        fprintf(out, "\nModule: %s (%.3f ms)\n", module ? module : PROJECT_NAME, moduleNs / 1e6);
+        printRows(out, timer, rows, rowCount, wallNs, sourceBytes(timer, module));
+    }
+
+    int rowCount = collectRows(timer, NULL, 1, rows);
+    fprintf(out, "\nTotal (%d module(s))\n", moduleCount);
+    printRows(out, timer, rows, rowCount, wallNs, sourceBytes(timer, NULL));
+    fprintf(out, "\nWall time: %.3f ms\n", wallNs / 1e6);
+
+    free(seen);
+    free(rows);
+}
+
+static void writeJsonString(FILE *out, const char *str) {
+    fputc('"', out);
+    for (const char *p = str; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            fputc('\\', out);
+            fputc(*p, out);
+        } else if ((unsigned char)*p < 0x20) {
+            fprintf(out, "\\u%04x", (unsigned char)*p);
+        } else {
+            fputc(*p, out);
+        }
+    }
+    fputc('"', out);
+}
+
+int writeTraceFile(BuildTimer *timer, const char *path) {
+    if (!timer) return 0;
+    FILE *out = fopen(path, "w");
+    if (!out) {
+        fprintf(stderr, "Error: Cannot write trace file '%s'\n", path);
+        return 0;
+    }
+
+    // Complete ("X") events; timestamps are microseconds since build start
+    fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (int i = 0; i < timer->sampleCount; i++) {
+        PhaseSample *s = &timer->samples[i];
+        const char *module = s->module ? s->module : PROJECT_NAME;
+        fprintf(out, "  {\"name\":");
+        writeJsonString(out, s->phase);
+        fprintf(out, ",\"cat\":");
+        writeJsonString(out, module);
+        fprintf(out, ",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f,"
+                     "\"args\":{\"module\":",
+                (s->startNs - timer->originNs) / 1e3, s->durationNs / 1e3);
+        writeJsonString(out, module);
+        fprintf(out, "}}%s\n", i + 1 < timer->sampleCount ? "," : "");
+    }
+    fprintf(out, "]}\n");
+
+    int ok = !ferror(out);
+    fclose(out);
+    return ok;
+}
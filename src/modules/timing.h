@@ -0,0 +1,77 @@
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "perfCounters.h"
+
+/**
+ * @brief One timed region. Phases nest, so depth records how many regions
+ * were open when this one began (0 = top-level phase, 1 = optimizer pass).
+ */
+typedef struct PhaseSample {
+    const char *module;
+    const char *phase;
+    int depth;
+    uint64_t startNs;
+    uint64_t durationNs;
+    uint64_t counters[PERF_COUNTER_COUNT];
+} PhaseSample;
+
+typedef struct SourceSize {
+    const char *module;
+    size_t bytes;
+} SourceSize;
+
+typedef struct BuildTimer {
+    PhaseSample *samples;
+    int sampleCount;
+    int sampleCapacity;
+    int depth;
+    const char *module;
+    uint64_t originNs;
+    PerfCounters *perf;
+    SourceSize *sources;
+    int sourceCount;
+    int sourceCapacity;
+} BuildTimer;
+
+BuildTimer *createBuildTimer(void);
+void freeBuildTimer(BuildTimer *timer);
+
+/**
+ * @brief Module that subsequent samples are attributed to (NULL = project)
+ */
+void timerSetModule(BuildTimer *timer, const char *module);
+
+/**
+ * @brief Also sample hardware counters in every region
+ * @return 0 when no counter could be opened (timing keeps working)
+ */
+int timerEnablePerfCounters(BuildTimer *timer);
+
+/**
+ * @brief Record source size of the current module, for misses per KB
+ */
+void timerAddSource(BuildTimer *timer, size_t bytes);
+
+/**
+ * @brief Open a timed region. Safe to call with a NULL timer.
+ * @return Sample handle to pass to timerEnd, or -1 when not timing
+ */
+int timerBegin(BuildTimer *timer, const char *phase);
+void timerEnd(BuildTimer *timer, int sample);
+
+/**
+ * @brief Print per-module and total phase tables
+ */
+void printTimeReport(BuildTimer *timer, FILE *out);
+
+/**
+ * @brief Write samples as Chrome trace-event JSON
+ */
+int writeTraceFile(BuildTimer *timer, const char *path);
+
+#endif //TIMING_H
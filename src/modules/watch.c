@@ -0,0 +1,159 @@
+#include "watch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+#define WATCH_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE)
+#define WATCH_SETTLE_MS 50      // editors save in several writes; wait for them to finish
+
+typedef struct WatchedDir {
+    int wd;
+    char *path;
+} WatchedDir;
+
+typedef struct WatchSet {
+    int fd;
+    WatchedDir *dirs;
+    int count;
+    int capacity;
+} WatchSet;
+
+static double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static const char *watchedPath(const WatchSet *set, int wd) {
+    for (int i = 0; i < set->count; i++) {
+        if (set->dirs[i].wd == wd) return set->dirs[i].path;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Watches the directory holding file. Directories rather than files, so
+ * that saves which replace the file (write to temp, rename) are seen too.
+ */
+static void watchDirectoryOf(WatchSet *set, const char *file) {
+    const char *slash = strrchr(file, '/');
+    char *relative = slash ? strndup(file, slash == file ? 1 : (size_t)(slash - file)) : strdup(".");
+    // Absolute, to compare event paths with the cache's realpaths
+    char *dir = relative ? realpath(relative, NULL) : NULL;
+    free(relative);
+    if (!dir) return;
+
+    // inotify hands back the same descriptor for a directory it already watches
+    int wd = inotify_add_watch(set->fd, dir, WATCH_EVENTS);
+    if (wd < 0 || watchedPath(set, wd)) {
+        free(dir);
+        return;
+    }
+    if (set->count >= set->capacity) {
+        int newCap = set->capacity ? set->capacity * 2 : 4;
+        WatchedDir *grown = realloc(set->dirs, newCap * sizeof(WatchedDir));
+        if (!grown) {
+            free(dir);
+            return;
+        }
+        set->dirs = grown;
+        set->capacity = newCap;
+    }
+    set->dirs[set->count].wd = wd;
+    set->dirs[set->count].path = dir;
+    set->count++;
+}
+
+/**
+ * @brief Whether a change to dir/name calls for a rebuild: it is one of the
+ * last build's modules, or any module file while the build is broken (the
+ * fix may be creating a missing import).
+ */
+static int isModuleChange(const BuildCache *cache, const char *dir, const char *name, int lastOk) {
+    size_t len = strlen(name);
+    if (len < 4 || strcmp(name + len - 4, ".orn") != 0) return 0;
+    if (!lastOk) return 1;
+
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s", strcmp(dir, "/") == 0 ? "" : dir, name);
+    for (const CachedModule *entry = cache->modules; entry; entry = entry->next) {
+        if (entry->generation == cache->generation && strcmp(entry->path, path) == 0) return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Reads pending events, printing the module changes among them
+ * @return Number of module changes
+ */
+static int readChanges(WatchSet *set, const BuildCache *cache, int lastOk) {
+    char buffer[8192] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t len = read(set->fd, buffer, sizeof(buffer));
+    int changes = 0;
+    for (char *at = buffer; len > 0 && at < buffer + len;) {
+        const struct inotify_event *event = (const struct inotify_event *)at;
+        const char *dir = watchedPath(set, event->wd);
+        if (event->len > 0 && dir && isModuleChange(cache, dir, event->name, lastOk)) {
+            printf("[watch] %s/%s changed\n", dir, event->name);
+            changes++;
+        }
+        at += sizeof(struct inotify_event) + event->len;
+    }
+    return changes;
+}
+
+static int rebuild(const char *entryPath, const char *outputPath, const BuildOptions *opts, WatchSet *set,
+                   int first) {
+    double start = nowMs();
+    int ok = buildProject(entryPath, outputPath, opts);
+    double elapsed = nowMs() - start;
+
+    BuildCache *cache = opts->cache;
+    if (ok) {
+        printf("[watch] %s '%s' in %.1f ms: %d module(s) reused, %d compiled\n", first ? "built" : "rebuilt",
+               outputPath, elapsed, cache->hits, cache->misses);
+    } else {
+        printf("[watch] build failed after %.1f ms\n", elapsed);
+    }
+
+    // Imports may have changed: watch wherever this build's modules live
+    watchDirectoryOf(set, entryPath);
+    for (const CachedModule *entry = cache->modules; entry; entry = entry->next) {
+        if (entry->generation == cache->generation) watchDirectoryOf(set, entry->path);
+    }
+    fflush(stdout);
+    return ok;
+}
+
+int watchProject(const char *entryPath, const char *outputPath, const BuildOptions *opts) {
+    WatchSet set = {0};
+    set.fd = inotify_init1(IN_CLOEXEC);
+    if (set.fd < 0) {
+        fprintf(stderr, "Error: Cannot start watching: inotify unavailable\n");
+        return 0;
+    }
+    BuildOptions watchOpts = *opts;
+    watchOpts.cache = createBuildCache();
+    if (!watchOpts.cache) {
+        close(set.fd);
+        return 0;
+    }
+
+    int ok = rebuild(entryPath, outputPath, &watchOpts, &set, 1);
+    printf("[watch] watching for changes, Ctrl-C to stop\n");
+    fflush(stdout);
+
+    for (;;) {
+        if (readChanges(&set, watchOpts.cache, ok) == 0) continue;
+
+        struct pollfd pfd = {set.fd, POLLIN, 0};
+        while (poll(&pfd, 1, WATCH_SETTLE_MS) > 0) {
+            readChanges(&set, watchOpts.cache, ok);
+        }
+        ok = rebuild(entryPath, outputPath, &watchOpts, &set, 0);
+    }
+}
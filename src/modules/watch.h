@@ -0,0 +1,14 @@
+#ifndef WATCH_H
+#define WATCH_H
+
+#include "build.h"
+
+/**
+ * @brief Builds, then rebuilds whenever a module of the last build changes on
+ * disk, until interrupted. Rebuilds go through a BuildCache: only edited
+ * modules and dependents whose imported interfaces changed are recompiled.
+ * @return 0 when the watch could not be set up; otherwise it does not return
+ */
+int watchProject(const char *entryPath, const char *outputPath, const BuildOptions *opts);
+
+#endif //WATCH_H
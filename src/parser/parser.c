@@ -89,8 +89,8 @@ ASTNode parseType(TokenList* list, size_t* pos) {
  * @brief Create error context by extracting source line on-demand
  */
 ErrorContext *createErrorContextFromParser(TokenList *list, size_t * pos) {
-    static ErrorContext context;
-    static char *lastSourceLine = NULL;  // Static to persist between calls
+    static _Thread_local ErrorContext context;
+    static _Thread_local char *lastSourceLine = NULL;  // Persists between calls, one per compiling thread
 
     if (!list || *pos >= list->count) return NULL;
 	size_t tempPos = list->tokens[*pos].type != TK_SEMI ? *pos-1 : *pos;
@@ -765,6 +765,20 @@ NodeTypes getTypeNodeFromToken(TokenType type) {
 		case TK_BOOL: return REF_BOOL;
 		case TK_VOID: return REF_VOID;
 		case TK_DOUBLE: return REF_DOUBLE;
+		case TK_I8: return REF_I8;
+		case TK_I16: return REF_I16;
+		case TK_I32: return REF_INT;
+		case TK_I64: return REF_I64;
+		case TK_U8: return REF_U8;
+		case TK_U16: return REF_U16;
+		case TK_U32: return REF_U32;
+		case TK_U64: return REF_U64;
+		case TK_F32X4: return REF_F32X4;
+		case TK_F64X2: return REF_F64X2;
+		case TK_I32X4: return REF_I32X4;
+		case TK_F32X8: return REF_F32X8;
+		case TK_F64X4: return REF_F64X4;
+		case TK_I32X8: return REF_I32X8;
 		case TK_LIT: return REF_CUSTOM;
 		default: return null_NODE; 
 	}
@@ -793,6 +807,47 @@ ASTNode parseStructField(TokenList * list, size_t* pos) {
 	return fieldNode;
 }
 
+/**
+ * @brief Parses one layout attribute after a struct's name: `packed`, `reorder` or `align(N)`
+ * @details N must be a power of two up to 4096 and becomes the attribute's LITERAL child.
+ */
+ASTNode parseStructAttribute(TokenList *list, size_t *pos) {
+	Token *name = &list->tokens[*pos];
+	int isAlign = name->length == 5 && memcmp(name->start, "align", 5) == 0;
+	if (!isAlign && !(name->length == 6 && memcmp(name->start, "packed", 6) == 0) &&
+		!(name->length == 7 && memcmp(name->start, "reorder", 7) == 0)) {
+		reportError(ERROR_INVALID_STRUCT_ATTRIBUTE, createErrorContextFromParser(list, pos), "Unknown struct attribute");
+		return NULL;
+	}
+	ASTNode attribute;
+	CREATE_NODE_OR_FAIL(attribute, name, STRUCT_ATTRIBUTE, list, pos);
+	ADVANCE_TOKEN(list, pos);
+	if (!isAlign) return attribute;
+
+	if (*pos >= list->count || list->tokens[*pos].type != TK_LPAREN) {
+		reportError(ERROR_INVALID_STRUCT_ATTRIBUTE, createErrorContextFromParser(list, pos), "Expected '(' after align");
+		freeAST(attribute);
+		return NULL;
+	}
+	ADVANCE_TOKEN(list, pos);
+	Token *value = &list->tokens[*pos];
+	long alignment = value->type == TK_NUM ? strtol(value->start, NULL, 10) : 0;
+	if (alignment <= 0 || alignment > 4096 || (alignment & (alignment - 1)) != 0) {
+		reportError(ERROR_INVALID_STRUCT_ATTRIBUTE, createErrorContextFromParser(list, pos), "Alignment must be a power of two up to 4096");
+		freeAST(attribute);
+		return NULL;
+	}
+	PARSE_OR_CLEANUP(attribute->children, createNode(value, LITERAL, list, pos), attribute);
+	ADVANCE_TOKEN(list, pos);
+	if (*pos >= list->count || list->tokens[*pos].type != TK_RPAREN) {
+		reportError(ERROR_INVALID_STRUCT_ATTRIBUTE, createErrorContextFromParser(list, pos), "Expected ')' after alignment");
+		freeAST(attribute);
+		return NULL;
+	}
+	ADVANCE_TOKEN(list, pos);
+	return attribute;
+}
+
 ASTNode parseStruct(TokenList *list, size_t *pos) {
 	EXPECT_TOKEN(list, pos, TK_STRUCT, ERROR_EXPECTED_STRUCT, "expected struct");
 	ADVANCE_TOKEN(list, pos);
@@ -804,9 +859,19 @@ ASTNode parseStruct(TokenList *list, size_t *pos) {
 	ASTNode structNode;
 	CREATE_NODE_OR_FAIL(structNode, name, STRUCT_DEFINITION, list, pos);
 	ADVANCE_TOKEN(list, pos);
+	// Layout attributes hang as brothers of the field list
+	ASTNode attributes = NULL, lastAttribute = NULL;
+	while (*pos < list->count && list->tokens[*pos].type == TK_LIT) {
+		ASTNode attribute;
+		PARSE_OR_CLEANUP(attribute, parseStructAttribute(list, pos), structNode, attributes);
+		if (!attributes) attributes = attribute;
+		else lastAttribute->brothers = attribute;
+		lastAttribute = attribute;
+	}
 	EXPECT_AND_ADVANCE(list, pos, TK_LBRACE, ERROR_EXPECTED_OPENING_BRACE, "Expected '{'");
 	ASTNode fieldList;
 	CREATE_NODE_OR_FAIL(fieldList, NULL, STRUCT_FIELD_LIST, list, pos);
+	fieldList->brothers = attributes;
 	ASTNode last = NULL;
 	while (list->tokens[*pos].type != TK_RBRACE) {
 		ASTNode field;
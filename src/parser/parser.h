@@ -91,6 +91,19 @@ typedef enum {
     REF_BOOL,
     REF_VOID,
     REF_DOUBLE,
+    REF_I8,
+    REF_I16,
+    REF_I64,
+    REF_U8,
+    REF_U16,
+    REF_U32,
+    REF_U64,
+    REF_F32X4,
+    REF_F64X2,
+    REF_I32X4,
+    REF_F32X8,
+    REF_F64X4,
+    REF_I32X8,
     REF_CUSTOM,
     POINTER,
     MEMADDRS,
@@ -187,6 +200,7 @@ typedef enum {
     STRUCT_DEFINITION,
     STRUCT_FIELD_LIST,
     STRUCT_FIELD,
+    STRUCT_ATTRIBUTE,
     MEMBER_ACCESS,
 } NodeTypes;
 
@@ -256,6 +270,7 @@ static const NodeTypeMap nodeTypeMapping[] = {
     {STRUCT_DEFINITION, "STRUCT_DEFINITION"},
     {STRUCT_FIELD_LIST, "STRUCT_FIELD_LIST"},
     {STRUCT_FIELD, "STRUCT_FIELD"},
+    {STRUCT_ATTRIBUTE, "STRUCT_ATTRIBUTE"},
     {STRUCT_VARIABLE_DEFINITION, "STRUCT_VAR_DEF"},
     {MEMBER_ACCESS, "MEMBER_ACCESS"},
     {REF_INT, "TYPE_INT"},
@@ -264,6 +279,19 @@ static const NodeTypeMap nodeTypeMapping[] = {
     {REF_BOOL, "TYPE_BOOL"},
     {REF_VOID, "TYPE_VOID"},
     {REF_DOUBLE, "TYPE_DOUBLE"},
+    {REF_I8, "TYPE_I8"},
+    {REF_I16, "TYPE_I16"},
+    {REF_I64, "TYPE_I64"},
+    {REF_U8, "TYPE_U8"},
+    {REF_U16, "TYPE_U16"},
+    {REF_U32, "TYPE_U32"},
+    {REF_U64, "TYPE_U64"},
+    {REF_F32X4, "TYPE_F32X4"},
+    {REF_F64X2, "TYPE_F64X2"},
+    {REF_I32X4, "TYPE_I32X4"},
+    {REF_F32X8, "TYPE_F32X8"},
+    {REF_F64X4, "TYPE_F64X4"},
+    {REF_I32X8, "TYPE_I32X8"},
     {REF_CUSTOM, "TYPE_CUSTOM"},
     {CAST_EXPRESSION, "CAST_EXPRESSION"},
     {ARRAY_VARIABLE_DEFINITION, "ARRAY_VAR_DEF"},
@@ -448,6 +476,7 @@ ASTNode parseDeclaration(TokenList* list, size_t* pos);
 ASTNode parseExpressionStatement(TokenList* list, size_t* pos);
 ASTNode parseStruct(TokenList* list, size_t* pos);
 ASTNode parseStructField(TokenList* list, size_t* pos);
+ASTNode parseStructAttribute(TokenList* list, size_t* pos);
 NodeTypes getTypeNodeFromToken(TokenType type);
 ASTNode parseArrayDec(TokenList *list, size_t *pos, Token *varName);
 ASTNode parseArrLit(TokenList *list, size_t *pos);
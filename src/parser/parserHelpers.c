@@ -33,6 +33,20 @@ NodeTypes getDecType(TokenType type) {
 		case TK_DOUBLE: return REF_DOUBLE;
 		case TK_BOOL: return REF_BOOL;
 		case TK_STRING: return REF_STRING;
+		case TK_I8: return REF_I8;
+		case TK_I16: return REF_I16;
+		case TK_I32: return REF_INT;
+		case TK_I64: return REF_I64;
+		case TK_U8: return REF_U8;
+		case TK_U16: return REF_U16;
+		case TK_U32: return REF_U32;
+		case TK_U64: return REF_U64;
+		case TK_F32X4: return REF_F32X4;
+		case TK_F64X2: return REF_F64X2;
+		case TK_I32X4: return REF_I32X4;
+		case TK_F32X8: return REF_F32X8;
+		case TK_F64X4: return REF_F64X4;
+		case TK_I32X8: return REF_I32X8;
 		default: return null_NODE;
 	}
 }
@@ -222,6 +236,7 @@ int isTypeToken(TokenType type) {
             type == TK_FLOAT ||
             type == TK_BOOL ||
 			type == TK_DOUBLE ||
+			(type >= TK_I8 && type <= TK_I32X8) ||
 			type == TK_LIT ||
             type == TK_VOID);
 }
@@ -0,0 +1,247 @@
+# Heap builtins: alloc_mem, free_mem and the arena_* region allocator, x86_64 AT&T
+#
+# Every block starts with a 16 byte header, the pointer handed out follows it
+# and is 16 byte aligned. Header word 0 is the block size including the header:
+# up to ALLOC_MAX_SMALL it is a power of two size class, served from a
+# per-class free list refilled ALLOC_CHUNK bytes at a time; above it the block
+# is its own mapping and goes back to the kernel on free. Header word 1 links
+# free blocks of a class.
+.globl alloc_mem
+.globl free_mem
+.globl arena_create
+.globl arena_alloc
+.globl arena_reset
+.globl arena_destroy
+
+.set SYS_MMAP, 9
+.set SYS_MUNMAP, 11
+.set PROT_RW, 3
+.set MAP_PRIVATE_ANON, 0x22
+.set PAGE_MASK, 4095
+.set ALLOC_HEADER, 16
+.set ALLOC_MIN_SHIFT, 5             # smallest class: 32 byte blocks
+.set ALLOC_MAX_SMALL, 4096          # largest class, 8 classes in all
+.set ALLOC_CLASSES, 8
+.set ALLOC_CHUNK, 65536
+.set ARENA_HEADER, 32               # bump, limit, extra chunk list, first mapping length
+.set ARENA_CHUNK_HEADER, 16         # next chunk, mapping length
+
+.section .text.alloc_map, "ax", @progbits
+# Anonymous read/write mapping of %rsi bytes; address in %rax, 0 on failure
+alloc_map:
+    movq $SYS_MMAP, %rax
+    xorq %rdi, %rdi
+    movq $PROT_RW, %rdx
+    movq $MAP_PRIVATE_ANON, %r10
+    movq $-1, %r8
+    xorq %r9, %r9
+    syscall
+    cmpq $-4096, %rax
+    jbe alloc_map_done
+    xorq %rax, %rax
+alloc_map_done:
+    ret
+
+.section .text.alloc_mem, "ax", @progbits
+# alloc(size: int) -> pointer; null when size is negative or memory runs out
+alloc_mem:
+    movslq %edi, %rdi
+    testq %rdi, %rdi
+    js alloc_fail
+    leaq ALLOC_HEADER(%rdi), %rsi
+    cmpq $ALLOC_MAX_SMALL, %rsi
+    ja alloc_large
+
+    # class = bsr((total - 1) | 31) - 4, block size = 32 << class
+    decq %rsi
+    orq $31, %rsi
+    bsrq %rsi, %rcx
+    subq $(ALLOC_MIN_SHIFT - 1), %rcx
+    leaq alloc_free_lists(%rip), %r8
+    movq (%r8, %rcx, 8), %rax
+    testq %rax, %rax
+    jz alloc_refill
+alloc_pop:
+    movq 8(%rax), %rdx
+    movq %rdx, (%r8, %rcx, 8)
+    addq $ALLOC_HEADER, %rax
+    ret
+
+alloc_refill:
+    # Carve a fresh chunk into blocks of this class and push them all
+    pushq %rcx
+    movq $ALLOC_CHUNK, %rsi
+    call alloc_map
+    popq %rcx
+    testq %rax, %rax
+    jz alloc_fail
+    leaq alloc_free_lists(%rip), %r8
+    movq $(1 << ALLOC_MIN_SHIFT), %rdx
+    shlq %cl, %rdx
+    leaq ALLOC_CHUNK(%rax), %r9
+    xorq %r10, %r10
+alloc_carve:
+    subq %rdx, %r9
+    movq %rdx, (%r9)
+    movq %r10, 8(%r9)
+    movq %r9, %r10
+    cmpq %rax, %r9
+    ja alloc_carve
+    jmp alloc_pop
+
+alloc_large:
+    addq $PAGE_MASK, %rsi
+    andq $~PAGE_MASK, %rsi
+    pushq %rsi
+    call alloc_map
+    popq %rsi
+    testq %rax, %rax
+    jz alloc_fail
+    movq %rsi, (%rax)
+    addq $ALLOC_HEADER, %rax
+    ret
+
+alloc_fail:
+    xorq %rax, %rax
+    ret
+
+.section .text.free_mem, "ax", @progbits
+# free(ptr: pointer); null is ignored
+free_mem:
+    testq %rdi, %rdi
+    jz free_done
+    subq $ALLOC_HEADER, %rdi
+    movq (%rdi), %rsi
+    cmpq $ALLOC_MAX_SMALL, %rsi
+    ja free_large
+    bsrq %rsi, %rcx
+    subq $ALLOC_MIN_SHIFT, %rcx
+    leaq alloc_free_lists(%rip), %r8
+    movq (%r8, %rcx, 8), %rdx
+    movq %rdx, 8(%rdi)
+    movq %rdi, (%r8, %rcx, 8)
+free_done:
+    ret
+free_large:
+    movq $SYS_MUNMAP, %rax
+    syscall
+    ret
+
+.section .text.arena_create, "ax", @progbits
+# arenaCreate(capacity: int) -> pointer; the arena grows past capacity when needed
+arena_create:
+    movslq %edi, %rsi
+    testq %rsi, %rsi
+    jns arena_create_size
+    xorq %rsi, %rsi
+arena_create_size:
+    addq $(ARENA_HEADER + PAGE_MASK), %rsi
+    andq $~PAGE_MASK, %rsi
+    pushq %rsi
+    call alloc_map
+    popq %rsi
+    testq %rax, %rax
+    jz arena_create_done
+    leaq ARENA_HEADER(%rax), %rdx
+    movq %rdx, (%rax)
+    leaq (%rax, %rsi), %rdx
+    movq %rdx, 8(%rax)
+    movq $0, 16(%rax)
+    movq %rsi, 24(%rax)
+arena_create_done:
+    ret
+
+.section .text.arena_alloc, "ax", @progbits
+# arenaAlloc(arena: pointer, size: int) -> pointer, 16 byte aligned
+arena_alloc:
+    testq %rdi, %rdi
+    jz arena_alloc_fail
+    movslq %esi, %rsi
+    testq %rsi, %rsi
+    js arena_alloc_fail
+    addq $15, %rsi
+    andq $~15, %rsi
+    movq (%rdi), %rax
+    leaq (%rax, %rsi), %rdx
+    cmpq 8(%rdi), %rdx
+    ja arena_alloc_grow
+    movq %rdx, (%rdi)
+    ret
+
+arena_alloc_grow:
+    # New chunk of max(first mapping, size + chunk header), linked for reset
+    pushq %rdi
+    pushq %rsi
+    leaq (ARENA_CHUNK_HEADER + PAGE_MASK)(%rsi), %rsi
+    andq $~PAGE_MASK, %rsi
+    cmpq 24(%rdi), %rsi
+    jae arena_alloc_map
+    movq 24(%rdi), %rsi
+arena_alloc_map:
+    pushq %rsi
+    call alloc_map
+    popq %rdx
+    popq %rsi
+    popq %rdi
+    testq %rax, %rax
+    jz arena_alloc_fail
+    movq 16(%rdi), %rcx
+    movq %rcx, (%rax)
+    movq %rdx, 8(%rax)
+    movq %rax, 16(%rdi)
+    leaq (%rax, %rdx), %rcx
+    movq %rcx, 8(%rdi)
+    addq $ARENA_CHUNK_HEADER, %rax
+    leaq (%rax, %rsi), %rcx
+    movq %rcx, (%rdi)
+    ret
+
+arena_alloc_fail:
+    xorq %rax, %rax
+    ret
+
+.section .text.arena_reset, "ax", @progbits
+# arenaReset(arena: pointer): unmaps grown chunks, everything allocated is released
+arena_reset:
+    testq %rdi, %rdi
+    jz arena_reset_done
+    pushq %rbx
+    movq %rdi, %rbx
+arena_reset_chunk:
+    movq 16(%rbx), %rdi
+    testq %rdi, %rdi
+    jz arena_reset_rewind
+    movq (%rdi), %rax
+    movq %rax, 16(%rbx)
+    movq 8(%rdi), %rsi
+    movq $SYS_MUNMAP, %rax
+    syscall
+    jmp arena_reset_chunk
+arena_reset_rewind:
+    leaq ARENA_HEADER(%rbx), %rax
+    movq %rax, (%rbx)
+    movq 24(%rbx), %rax
+    addq %rbx, %rax
+    movq %rax, 8(%rbx)
+    popq %rbx
+arena_reset_done:
+    ret
+
+.section .text.arena_destroy, "ax", @progbits
+# arenaDestroy(arena: pointer): returns the arena and all its chunks to the kernel
+arena_destroy:
+    testq %rdi, %rdi
+    jz arena_destroy_done
+    pushq %rdi
+    call arena_reset
+    popq %rdi
+    movq 24(%rdi), %rsi
+    movq $SYS_MUNMAP, %rax
+    syscall
+arena_destroy_done:
+    ret
+
+.section .bss
+.align 8
+alloc_free_lists:
+    .zero 8 * ALLOC_CLASSES
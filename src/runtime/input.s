@@ -0,0 +1,138 @@
+# stdin builtins: read_int, read_str
+.globl read_int
+.globl read_str
+
+.section .text.input_getc, "ax", @progbits
+# Next stdin byte in %eax, -1 at EOF. Input is buffered so consecutive
+# reads do not drop data that arrived in the same read(2)
+input_getc:
+    movq input_pos(%rip), %rax
+    cmpq input_len(%rip), %rax
+    jb input_getc_ready
+
+    pushq %rcx
+    pushq %rdx
+    pushq %rsi
+    pushq %rdi
+    pushq %r11
+    movq $0, %rax
+    movq $0, %rdi
+    leaq input_buffer(%rip), %rsi
+    movq $4096, %rdx
+    syscall
+    popq %r11
+    popq %rdi
+    popq %rsi
+    popq %rdx
+    popq %rcx
+
+    movq $0, input_pos(%rip)
+    testq %rax, %rax
+    jg input_getc_filled
+    movq $0, input_len(%rip)
+    movl $-1, %eax
+    ret
+
+input_getc_filled:
+    movq %rax, input_len(%rip)
+    xorq %rax, %rax
+
+input_getc_ready:
+    leaq input_buffer(%rip), %r10
+    movzbl (%r10, %rax), %eax
+    incq input_pos(%rip)
+    ret
+
+.section .text.read_int, "ax", @progbits
+read_int:
+    pushq %rbp
+    movq %rsp, %rbp
+    xorq %r8, %r8
+    xorq %r9, %r9
+
+read_int_skip_ws:
+    call input_getc
+    cmpl $-1, %eax
+    je read_int_done
+    cmpl $' ', %eax
+    je read_int_skip_ws
+    cmpl $'\t', %eax
+    je read_int_skip_ws
+    cmpl $'\n', %eax
+    je read_int_skip_ws
+    cmpl $'\r', %eax
+    je read_int_skip_ws
+
+    cmpl $'-', %eax
+    jne read_int_parse
+    movq $1, %r9
+    call input_getc
+
+read_int_parse:
+    cmpl $'0', %eax
+    jl read_int_done
+    cmpl $'9', %eax
+    jg read_int_done
+
+    imulq $10, %r8
+    subl $'0', %eax
+    addq %rax, %r8
+    call input_getc
+    jmp read_int_parse
+
+read_int_done:
+    movq %r8, %rax
+    testq %r9, %r9
+    jz read_int_return
+    negq %rax
+
+read_int_return:
+    popq %rbp
+    ret
+
+# Reads one line (without the newline) into string_buffer
+
+.section .text.read_str, "ax", @progbits
+# Reads one line (without the newline) into string_buffer
+read_str:
+    pushq %rbp
+    movq %rsp, %rbp
+    xorq %r8, %r8
+
+read_str_loop:
+    call input_getc
+    cmpl $-1, %eax
+    je read_str_end
+    cmpl $'\n', %eax
+    je read_str_end
+    cmpq $255, %r8
+    jae read_str_loop
+    leaq string_buffer(%rip), %r9
+    movb %al, (%r9, %r8)
+    incq %r8
+    jmp read_str_loop
+
+read_str_end:
+    leaq string_buffer(%rip), %r9
+    testq %r8, %r8
+    jz read_str_done
+    cmpb $'\r', -1(%r9, %r8)
+    jne read_str_done
+    decq %r8
+
+read_str_done:
+    movb $0, (%r9, %r8)
+    movq %r9, %rax
+    popq %rbp
+    ret
+
+.bss
+.align 8
+string_buffer:
+    .space 256
+input_pos:
+    .quad 0
+input_len:
+    .quad 0
+input_buffer:
+    .space 4096
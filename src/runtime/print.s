@@ -0,0 +1,120 @@
+# print builtins for strings, ints of every width and bools, x86_64 AT&T
+.globl print_str_z
+.globl print_int
+.globl print_bool
+.globl print_newline
+.globl print_long
+.globl print_ulong
+.globl __orn_print_long
+
+.section .text.print_str_z, "ax", @progbits
+print_str_z:
+    pushq %rbp
+    movq %rsp, %rbp
+    pushq %rdi
+    xorq %rcx, %rcx
+strlen_loop:
+    movb (%rdi, %rcx), %al
+    testb %al, %al
+    jz strlen_done
+    incq %rcx
+    jmp strlen_loop
+strlen_done:
+    movq $1, %rax
+    movq $1, %rdi
+    popq %rsi
+    movq %rcx, %rdx
+    syscall
+    popq %rbp
+    ret
+
+# Orn ints are 32 bit, widen before sharing the 64 bit printer
+.section .text.print_int, "ax", @progbits
+print_int:
+    movslq %edi, %rdi
+
+print_long:
+__orn_print_long:
+    pushq %rbp
+    movq %rsp, %rbp
+    subq $32, %rsp
+    movq %rdi, %rax
+    leaq 31(%rsp), %rdi
+    movb $0, (%rdi)
+    movq $10, %rcx
+    testq %rax, %rax
+    jns positive
+    negq %rax
+    pushq %rax
+    movq $1, %r8
+    popq %rax
+    jmp convert
+positive:
+    xorq %r8, %r8
+convert:
+    decq %rdi
+    xorq %rdx, %rdx
+    divq %rcx
+    addb $'0', %dl
+    movb %dl, (%rdi)
+    testq %rax, %rax
+    jnz convert
+
+    testq %r8, %r8
+    jz print_number
+    decq %rdi
+    movb $'-', (%rdi)
+print_number:
+    call print_str_z
+    addq $32, %rsp
+    popq %rbp
+    ret
+
+# u64 shares the digit loop, skipping the sign
+print_ulong:
+    pushq %rbp
+    movq %rsp, %rbp
+    subq $32, %rsp
+    movq %rdi, %rax
+    leaq 31(%rsp), %rdi
+    movb $0, (%rdi)
+    movq $10, %rcx
+    xorq %r8, %r8
+    jmp convert
+
+.section .text.print_bool, "ax", @progbits
+print_bool:
+    pushq %rbp
+    movq %rsp, %rbp
+
+    testq %rdi, %rdi
+    jz print_false
+
+    leaq true_str(%rip), %rdi
+    call print_str_z
+    jmp bool_done
+
+print_false:
+    leaq false_str(%rip), %rdi
+    call print_str_z
+
+bool_done:
+    popq %rbp
+    ret
+
+.section .text.print_newline, "ax", @progbits
+print_newline:
+    movq $1, %rax
+    movq $1, %rdi
+    lea newline(%rip), %rsi
+    movq $1, %rdx
+    syscall
+    ret
+
+.section .rodata
+newline:
+    .asciz "\n"
+true_str:
+    .asciz "true"
+false_str:
+    .asciz "false"
@@ -0,0 +1,207 @@
+# print builtins for floats and doubles: integer part, '.', six decimals
+.globl print_float
+.globl print_double
+
+.section .text.print_float, "ax", @progbits
+print_float:
+    pushq %rbp
+    movq %rsp, %rbp
+    subq $16, %rsp
+    
+    # Convert single precision to double precision
+    cvtss2sd %xmm0, %xmm0
+    
+    # Save original value
+    movsd %xmm0, -8(%rbp)
+    
+    # Check if negative
+    xorpd %xmm1, %xmm1
+    ucomisd %xmm1, %xmm0
+    jae float_positive
+    
+    # Print minus and make positive
+    leaq minus_str(%rip), %rdi
+    call print_str_z
+    movsd -8(%rbp), %xmm0
+    movsd neg_mask(%rip), %xmm1
+    andpd %xmm1, %xmm0
+    movsd %xmm0, -8(%rbp)
+    
+float_positive:
+    # Round to 6 decimals like printf("%f") before splitting the parts
+    movsd -8(%rbp), %xmm0
+    addsd round_half(%rip), %xmm0
+    movsd %xmm0, -8(%rbp)
+
+    # Print integer part
+    cvttsd2si %xmm0, %rdi
+    call __orn_print_long
+    
+    # Print decimal point
+    leaq dot_str(%rip), %rdi
+    call print_str_z
+    
+    # Calculate fractional part
+    movsd -8(%rbp), %xmm0
+    cvttsd2si %xmm0, %rax
+    cvtsi2sd %rax, %xmm1
+    subsd %xmm1, %xmm0
+
+    # Values past the int64 range (and NaN) have no usable fraction
+    xorpd %xmm1, %xmm1
+    ucomisd %xmm1, %xmm0
+    jp float_no_frac
+    jb float_no_frac
+    ucomisd one_double(%rip), %xmm0
+    jb float_frac
+float_no_frac:
+    xorpd %xmm0, %xmm0
+float_frac:
+    
+    # Multiply by 1000000 for 6 decimal places
+    movsd float_scale(%rip), %xmm2
+    mulsd %xmm2, %xmm0
+    cvttsd2si %xmm0, %rdi
+    
+    # Print with leading zeros if needed
+    subq $32, %rsp
+    movq %rdi, %rax
+    leaq 31(%rsp), %rdi
+    movb $0, (%rdi)
+    movq $10, %rcx
+    movq $6, %r9
+    
+float_convert:
+    decq %rdi
+    xorq %rdx, %rdx
+    divq %rcx
+    addb $'0', %dl
+    movb %dl, (%rdi)
+    decq %r9
+    testq %rax, %rax
+    jnz float_convert
+    
+    # Add leading zeros
+float_pad:
+    testq %r9, %r9
+    jz float_print
+    decq %rdi
+    movb $'0', (%rdi)
+    decq %r9
+    jmp float_pad
+    
+float_print:
+    call print_str_z
+    addq $32, %rsp
+    addq $16, %rsp
+    popq %rbp
+    ret
+
+.section .text.print_double, "ax", @progbits
+print_double:
+    pushq %rbp
+    movq %rsp, %rbp
+    subq $16, %rsp
+    
+    # Save original value
+    movsd %xmm0, -8(%rbp)
+    
+    # Check if negative
+    xorpd %xmm1, %xmm1
+    ucomisd %xmm1, %xmm0
+    jae double_positive
+    
+    # Print minus and make positive
+    leaq minus_str(%rip), %rdi
+    call print_str_z
+    movsd -8(%rbp), %xmm0
+    movsd neg_mask(%rip), %xmm1
+    andpd %xmm1, %xmm0
+    movsd %xmm0, -8(%rbp)
+    
+double_positive:
+    # Round to 6 decimals like printf("%f") before splitting the parts
+    movsd -8(%rbp), %xmm0
+    addsd round_half(%rip), %xmm0
+    movsd %xmm0, -8(%rbp)
+
+    # Print integer part
+    cvttsd2si %xmm0, %rdi
+    call __orn_print_long
+    
+    # Print decimal point
+    leaq dot_str(%rip), %rdi
+    call print_str_z
+    
+    # Calculate fractional part
+    movsd -8(%rbp), %xmm0
+    cvttsd2si %xmm0, %rax
+    cvtsi2sd %rax, %xmm1
+    subsd %xmm1, %xmm0
+
+    # Values past the int64 range (and NaN) have no usable fraction
+    xorpd %xmm1, %xmm1
+    ucomisd %xmm1, %xmm0
+    jp double_no_frac
+    jb double_no_frac
+    ucomisd one_double(%rip), %xmm0
+    jb double_frac
+double_no_frac:
+    xorpd %xmm0, %xmm0
+double_frac:
+    
+    # Multiply by 1000000 for 6 decimal places
+    movsd float_scale(%rip), %xmm2
+    mulsd %xmm2, %xmm0
+    cvttsd2si %xmm0, %rdi
+    
+    # Print with leading zeros if needed
+    subq $32, %rsp
+    movq %rdi, %rax
+    leaq 31(%rsp), %rdi
+    movb $0, (%rdi)
+    movq $10, %rcx
+    movq $6, %r9
+    
+double_convert:
+    decq %rdi
+    xorq %rdx, %rdx
+    divq %rcx
+    addb $'0', %dl
+    movb %dl, (%rdi)
+    decq %r9
+    testq %rax, %rax
+    jnz double_convert
+    
+    # Add leading zeros
+double_pad:
+    testq %r9, %r9
+    jz double_print
+    decq %rdi
+    movb $'0', (%rdi)
+    decq %r9
+    jmp double_pad
+    
+double_print:
+    call print_str_z
+    addq $32, %rsp
+    addq $16, %rsp
+    popq %rbp
+    ret
+
+.section .rodata
+minus_str:
+    .asciz "-"
+dot_str:
+    .asciz "."
+
+.align 16
+float_scale:
+    .double 1000000.0
+round_half:
+    .double 0.0000005
+one_double:
+    .double 1.0
+neg_mask:
+    .quad 0x7FFFFFFFFFFFFFFF
+    .quad 0x7FFFFFFFFFFFFFFF
@@ -0,0 +1,459 @@
+# --profile and -fprofile-generate runtime: rdtsc hooks and the orn.prof / orn.profdata writers.
+# Linked when a program calls the hooks or references __orn_pgo_report.
+.globl __orn_prof_enter
+.globl __orn_prof_exit
+.globl __orn_prof_report
+.globl __orn_pgo_report
+.weak __start_orn_prof
+.weak __stop_orn_prof
+.weak __start_orn_pgo
+.weak __stop_orn_pgo
+
+# --profile: every instrumented function owns a 48 byte record in section
+# orn_prof: name, calls, inclusive cycles, self cycles, active depth, printed
+.set PROF_RECORD, 48
+.set PROF_MAX_DEPTH, 4096
+# -fprofile-generate: section orn_pgo holds name, checksum, block count, counters[count]
+# caller-callee edge table: caller record (0 = _start), callee record, calls, cycles, printed
+.set PROF_EDGE, 40
+.set PROF_EDGES, 4096
+
+.section .text.__orn_prof_enter, "ax", @progbits
+# Profiling hooks, called after the prologue and before the epilogue of
+# instrumented functions. The record comes in %r11; every other register
+# (arguments on entry, return value on exit) is preserved.
+__orn_prof_enter:
+    pushq %rax
+    pushq %rdx
+    pushq %rcx
+    rdtsc
+    shlq $32, %rdx
+    orq %rdx, %rax
+    incq 8(%r11)
+    incq 32(%r11)
+    movq prof_depth(%rip), %rcx
+    incq prof_depth(%rip)
+    cmpq $PROF_MAX_DEPTH, %rcx
+    jae prof_enter_done
+    shlq $5, %rcx
+    leaq prof_stack(%rip), %rdx
+    addq %rcx, %rdx
+    movq %r11, (%rdx)
+    movq %rax, 8(%rdx)
+    movq $0, 16(%rdx)
+prof_enter_done:
+    popq %rcx
+    popq %rdx
+    popq %rax
+    ret
+
+.section .text.__orn_prof_exit, "ax", @progbits
+__orn_prof_exit:
+    pushq %rax
+    pushq %rdx
+    pushq %rcx
+    pushq %rsi
+    pushq %rdi
+    pushq %r8
+    rdtsc
+    shlq $32, %rdx
+    orq %rdx, %rax
+    decq 32(%r11)
+    movq prof_depth(%rip), %rcx
+    testq %rcx, %rcx
+    jz prof_exit_done
+    decq %rcx
+    movq %rcx, prof_depth(%rip)
+    cmpq $PROF_MAX_DEPTH, %rcx
+    jae prof_exit_done
+
+    # %rsi = shadow stack frame: record, entry tsc, cycles spent in callees
+    shlq $5, %rcx
+    leaq prof_stack(%rip), %rsi
+    addq %rcx, %rsi
+    subq 8(%rsi), %rax
+    # recursive activations are already covered by the outermost one
+    cmpq $0, 32(%r11)
+    jne prof_exit_self
+    addq %rax, 16(%r11)
+prof_exit_self:
+    movq %rax, %rdx
+    subq 16(%rsi), %rdx
+    addq %rdx, 24(%r11)
+    xorq %rdi, %rdi
+    testq %rcx, %rcx
+    jz prof_exit_edge
+    addq %rax, -16(%rsi)
+    movq -32(%rsi), %rdi
+
+prof_exit_edge:
+    movq %rdi, %rdx
+    shrq $4, %rdx
+    movq %r11, %rcx
+    shrq $4, %rcx
+    imulq $31, %rcx
+    xorq %rcx, %rdx
+    andq $PROF_EDGES-1, %rdx
+    movq $PROF_EDGES, %r8
+prof_exit_probe:
+    imulq $PROF_EDGE, %rdx, %rcx
+    leaq prof_edges(%rip), %rsi
+    addq %rcx, %rsi
+    movq 8(%rsi), %rcx
+    testq %rcx, %rcx
+    jz prof_exit_new_edge
+    cmpq %r11, %rcx
+    jne prof_exit_next
+    cmpq %rdi, (%rsi)
+    je prof_exit_count
+prof_exit_next:
+    incq %rdx
+    andq $PROF_EDGES-1, %rdx
+    decq %r8
+    jnz prof_exit_probe
+    jmp prof_exit_done
+prof_exit_new_edge:
+    movq %rdi, (%rsi)
+    movq %r11, 8(%rsi)
+prof_exit_count:
+    incq 16(%rsi)
+    # like the records, a recursive edge only takes the outermost activation's cycles
+    cmpq $0, 32(%r11)
+    jne prof_exit_done
+    addq %rax, 24(%rsi)
+
+prof_exit_done:
+    popq %r8
+    popq %rdi
+    popq %rsi
+    popq %rcx
+    popq %rdx
+    popq %rax
+    ret
+
+.section .text.__orn_prof_report, "ax", @progbits
+# Writes the flat profile (by self cycles) and the call graph (by cycles) to orn.prof
+__orn_prof_report:
+    pushq %rbx
+    pushq %r12
+    pushq %r13
+    pushq %r14
+    pushq %r15
+    leaq prof_file(%rip), %rdi
+    call prof_open
+    testq %rax, %rax
+    js prof_report_done
+
+    # %r15 = total self cycles, for the percentage column
+    xorq %r15, %r15
+    movq $__start_orn_prof, %r12
+prof_total_loop:
+    cmpq $__stop_orn_prof, %r12
+    jae prof_total_done
+    addq 24(%r12), %r15
+    addq $PROF_RECORD, %r12
+    jmp prof_total_loop
+prof_total_done:
+    testq %r15, %r15
+    jnz prof_flat_start
+    movq $1, %r15
+prof_flat_start:
+    leaq prof_flat_header(%rip), %rsi
+    call prof_puts
+
+prof_flat_next:
+    movq $__start_orn_prof, %r12
+    xorq %r13, %r13
+prof_flat_scan:
+    cmpq $__stop_orn_prof, %r12
+    jae prof_flat_picked
+    cmpq $0, 40(%r12)
+    jne prof_flat_skip
+    cmpq $0, 8(%r12)
+    je prof_flat_skip
+    testq %r13, %r13
+    jz prof_flat_take
+    movq 24(%r12), %rax
+    cmpq 24(%r13), %rax
+    jbe prof_flat_skip
+prof_flat_take:
+    movq %r12, %r13
+prof_flat_skip:
+    addq $PROF_RECORD, %r12
+    jmp prof_flat_scan
+
+prof_flat_picked:
+    testq %r13, %r13
+    jz prof_graph_start
+    movq $1, 40(%r13)
+    movq 24(%r13), %rax
+    movq $1000, %rcx
+    mulq %rcx
+    divq %r15
+    xorq %rdx, %rdx
+    movq $10, %rcx
+    divq %rcx
+    movq %rdx, %rbx
+    movq $6, %rcx
+    call prof_putnum
+    leaq prof_dot(%rip), %rsi
+    call prof_puts
+    movq %rbx, %rax
+    movq $1, %rcx
+    call prof_putnum
+    movq 8(%r13), %rax
+    movq $14, %rcx
+    call prof_putnum
+    movq 24(%r13), %rax
+    movq $18, %rcx
+    call prof_putnum
+    movq 16(%r13), %rax
+    movq $18, %rcx
+    call prof_putnum
+    leaq prof_gap(%rip), %rsi
+    call prof_puts
+    movq (%r13), %rsi
+    call prof_puts
+    leaq prof_newline(%rip), %rsi
+    call prof_puts
+    jmp prof_flat_next
+
+prof_graph_start:
+    leaq prof_graph_header(%rip), %rsi
+    call prof_puts
+prof_graph_next:
+    leaq prof_edges(%rip), %r12
+    movq $PROF_EDGES, %r14
+    xorq %r13, %r13
+prof_graph_scan:
+    cmpq $0, 8(%r12)
+    je prof_graph_skip
+    cmpq $0, 32(%r12)
+    jne prof_graph_skip
+    testq %r13, %r13
+    jz prof_graph_take
+    movq 24(%r12), %rax
+    cmpq 24(%r13), %rax
+    jbe prof_graph_skip
+prof_graph_take:
+    movq %r12, %r13
+prof_graph_skip:
+    addq $PROF_EDGE, %r12
+    decq %r14
+    jnz prof_graph_scan
+
+    testq %r13, %r13
+    jz prof_report_close
+    movq $1, 32(%r13)
+    movq 16(%r13), %rax
+    movq $14, %rcx
+    call prof_putnum
+    movq 24(%r13), %rax
+    movq $18, %rcx
+    call prof_putnum
+    leaq prof_gap(%rip), %rsi
+    call prof_puts
+    leaq prof_root_name(%rip), %rsi
+    movq (%r13), %rax
+    testq %rax, %rax
+    jz prof_graph_caller
+    movq (%rax), %rsi
+prof_graph_caller:
+    call prof_puts
+    leaq prof_arrow(%rip), %rsi
+    call prof_puts
+    movq 8(%r13), %rax
+    movq (%rax), %rsi
+    call prof_puts
+    leaq prof_newline(%rip), %rsi
+    call prof_puts
+    jmp prof_graph_next
+
+prof_report_close:
+    call prof_close
+prof_report_done:
+    popq %r15
+    popq %r14
+    popq %r13
+    popq %r12
+    popq %rbx
+    ret
+
+.section .text.__orn_pgo_report, "ax", @progbits
+# Writes one line per function to orn.profdata: name checksum blocks counts...
+__orn_pgo_report:
+    pushq %rbx
+    pushq %r12
+    leaq pgo_file(%rip), %rdi
+    call prof_open
+    testq %rax, %rax
+    js pgo_write_done
+    leaq pgo_header(%rip), %rsi
+    call prof_puts
+    movq $__start_orn_pgo, %r12
+pgo_write_function:
+    cmpq $__stop_orn_pgo, %r12
+    jae pgo_write_close
+    movq (%r12), %rsi
+    call prof_puts
+    leaq pgo_space(%rip), %rsi
+    call prof_puts
+    movq 8(%r12), %rax
+    xorq %rcx, %rcx
+    call prof_putnum
+    leaq pgo_space(%rip), %rsi
+    call prof_puts
+    movq 16(%r12), %rax
+    xorq %rcx, %rcx
+    call prof_putnum
+    xorq %rbx, %rbx
+pgo_write_block:
+    cmpq 16(%r12), %rbx
+    jae pgo_write_next
+    leaq pgo_space(%rip), %rsi
+    call prof_puts
+    movq 24(%r12, %rbx, 8), %rax
+    xorq %rcx, %rcx
+    call prof_putnum
+    incq %rbx
+    jmp pgo_write_block
+pgo_write_next:
+    leaq prof_newline(%rip), %rsi
+    call prof_puts
+    movq 16(%r12), %rax
+    leaq 24(%r12, %rax, 8), %r12
+    jmp pgo_write_function
+pgo_write_close:
+    call prof_close
+pgo_write_done:
+    popq %r12
+    popq %rbx
+    ret
+
+.section .text.prof_open, "ax", @progbits
+# Creates/truncates the file named at %rdi as the report output; fd in %rax
+prof_open:
+    movq $2, %rax
+    movq $0x241, %rsi
+    movq $420, %rdx
+    syscall
+    movq %rax, prof_fd(%rip)
+    movq $0, prof_len(%rip)
+    ret
+
+.section .text.prof_close, "ax", @progbits
+prof_close:
+    call prof_flush
+    movq $3, %rax
+    movq prof_fd(%rip), %rdi
+    syscall
+    ret
+
+.section .text.prof_puts, "ax", @progbits
+# Appends the string at %rsi to the report buffer
+prof_puts:
+    movq prof_len(%rip), %rdx
+    leaq prof_buf(%rip), %rcx
+prof_puts_loop:
+    movb (%rsi), %al
+    testb %al, %al
+    jz prof_puts_done
+    movb %al, (%rcx, %rdx)
+    incq %rsi
+    incq %rdx
+    cmpq $4096, %rdx
+    jb prof_puts_loop
+    movq %rdx, prof_len(%rip)
+    pushq %rsi
+    call prof_flush
+    popq %rsi
+    xorq %rdx, %rdx
+    leaq prof_buf(%rip), %rcx
+    jmp prof_puts_loop
+prof_puts_done:
+    movq %rdx, prof_len(%rip)
+    ret
+
+.section .text.prof_putnum, "ax", @progbits
+# Appends %rax as an unsigned decimal, right aligned in %rcx columns
+prof_putnum:
+    pushq %rbx
+    subq $32, %rsp
+    leaq 31(%rsp), %rsi
+    movb $0, (%rsi)
+    movq $10, %rbx
+    movq %rcx, %r8
+prof_putnum_digit:
+    decq %rsi
+    xorq %rdx, %rdx
+    divq %rbx
+    addb $'0', %dl
+    movb %dl, (%rsi)
+    decq %r8
+    testq %rax, %rax
+    jnz prof_putnum_digit
+prof_putnum_pad:
+    testq %r8, %r8
+    jle prof_putnum_out
+    decq %rsi
+    movb $' ', (%rsi)
+    decq %r8
+    jmp prof_putnum_pad
+prof_putnum_out:
+    call prof_puts
+    addq $32, %rsp
+    popq %rbx
+    ret
+
+.section .text.prof_flush, "ax", @progbits
+prof_flush:
+    movq $1, %rax
+    movq prof_fd(%rip), %rdi
+    leaq prof_buf(%rip), %rsi
+    movq prof_len(%rip), %rdx
+    syscall
+    movq $0, prof_len(%rip)
+    ret
+
+.section .text.__orn_prof_enter, "ax", @progbits
+
+.section .rodata
+prof_newline:
+    .asciz "\n"
+prof_dot:
+    .asciz "."
+prof_file:
+    .asciz "orn.prof"
+prof_flat_header:
+    .ascii "Flat profile (cycles measured with rdtsc)\n\n"
+    .asciz "  % self         calls       self cycles  inclusive cycles  function\n"
+prof_graph_header:
+    .ascii "\nCall graph\n\n"
+    .asciz "         calls            cycles  caller -> callee\n"
+prof_gap:
+    .asciz "  "
+prof_arrow:
+    .asciz " -> "
+prof_root_name:
+    .asciz "<start>"
+pgo_file:
+    .asciz "orn.profdata"
+pgo_header:
+    .asciz "# orn profile v1: function checksum blocks counts...\n"
+pgo_space:
+    .asciz " "
+
+.bss
+.align 8
+prof_depth:
+    .quad 0
+prof_fd:
+    .quad 0
+prof_len:
+    .quad 0
+prof_stack:
+    .space 32 * PROF_MAX_DEPTH
+prof_edges:
+    .space PROF_EDGE * PROF_EDGES
+prof_buf:
+    .space 4096
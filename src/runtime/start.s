@@ -0,0 +1,32 @@
+# Program entry and exit, x86_64 AT&T
+# Each function lives in its own .text.<name> section so --gc-sections can drop what a program does not use
+.globl _start
+.globl exit_program
+# Defined by profile.s, which is only linked when the program was instrumented
+.weak __orn_prof_report
+.weak __orn_pgo_report
+.weak __start_orn_prof
+.weak __start_orn_pgo
+
+.section .text._start, "ax", @progbits
+_start:
+    call main
+    movq $0, %rdi
+    call exit_program
+
+.section .text.exit_program, "ax", @progbits
+exit_program:
+    pushq %rdi
+    movq $__start_orn_prof, %rax
+    testq %rax, %rax
+    jz exit_no_prof
+    call __orn_prof_report
+exit_no_prof:
+    movq $__start_orn_pgo, %rax
+    testq %rax, %rax
+    jz exit_now
+    call __orn_pgo_report
+exit_now:
+    popq %rdi
+    movq $60, %rax
+    syscall
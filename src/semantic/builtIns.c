@@ -9,36 +9,53 @@
 #include <stdlib.h>
 #include <string.h>
 
-static BuiltInFunction builtInFunctions[] = {
+// Parameter lists are shared, read-only tables so concurrent compilations never race on them
+static DataType intParam[] = {TYPE_INT};
+static DataType stringParam[] = {TYPE_STRING};
+static DataType floatParam[] = {TYPE_FLOAT};
+static DataType boolParam[] = {TYPE_BOOL};
+static DataType doubleParam[] = {TYPE_DOUBLE};
+static DataType pointerParam[] = {TYPE_POINTER};
+static DataType arenaAllocParams[] = {TYPE_POINTER, TYPE_INT};
+static char *messageParam[] = {"message"};
+static char *valueParam[] = {"value"};
+static char *codeParam[] = {"code"};
+static char *sizeParam[] = {"size"};
+static char *ptrParam[] = {"ptr"};
+static char *capacityParam[] = {"capacity"};
+static char *arenaParam[] = {"arena"};
+static char *arenaAllocNames[] = {"arena", "size"};
+
+static const BuiltInFunction builtInFunctions[] = {
     {
         .name = "print",
         .returnType = TYPE_VOID,
-        .paramTypes = NULL,
-        .paramNames = NULL,
+        .paramTypes = intParam,
+        .paramNames = messageParam,
         .paramCount = 1,
         .id = BUILTIN_PRINT_INT
     },
     {
         .name = "print",
         .returnType = TYPE_VOID,
-        .paramTypes = NULL,
-        .paramNames = NULL,
+        .paramTypes = stringParam,
+        .paramNames = valueParam,
         .paramCount = 1,
         .id = BUILTIN_PRINT_STRING
     },
     {
         .name = "print",
         .returnType = TYPE_VOID,
-        .paramTypes = NULL,
-        .paramNames = NULL,
+        .paramTypes = floatParam,
+        .paramNames = valueParam,
         .paramCount = 1,
         .id = BUILTIN_PRINT_FLOAT
     },
     {
         .name = "print",
         .returnType = TYPE_VOID,
-        .paramTypes = NULL,
-        .paramNames = NULL,
+        .paramTypes = boolParam,
+        .paramNames = valueParam,
         .paramCount = 1,
         .id = BUILTIN_PRINT_BOOL
     },
@@ -61,53 +78,90 @@ static BuiltInFunction builtInFunctions[] = {
     {
         .name = "print",
         .returnType = TYPE_VOID,
-        .paramTypes = NULL,
-        .paramNames = NULL,
+        .paramTypes = doubleParam,
+        .paramNames = valueParam,
         .paramCount = 1,
         .id = BUILTIN_PRINT_DOUBLE
     },
+    {
+        .name = "exit",
+        .returnType = TYPE_VOID,
+        .paramTypes = intParam,
+        .paramNames = codeParam,
+        .paramCount = 1,
+        .id = BUILTIN_EXIT
+    },
+    {
+        .name = "alloc",
+        .returnType = TYPE_POINTER,
+        .paramTypes = intParam,
+        .paramNames = sizeParam,
+        .paramCount = 1,
+        .id = BUILTIN_ALLOC
+    },
+    {
+        .name = "free",
+        .returnType = TYPE_VOID,
+        .paramTypes = pointerParam,
+        .paramNames = ptrParam,
+        .paramCount = 1,
+        .id = BUILTIN_FREE
+    },
+    {
+        .name = "arenaCreate",
+        .returnType = TYPE_POINTER,
+        .paramTypes = intParam,
+        .paramNames = capacityParam,
+        .paramCount = 1,
+        .id = BUILTIN_ARENA_CREATE
+    },
+    {
+        .name = "arenaAlloc",
+        .returnType = TYPE_POINTER,
+        .paramTypes = arenaAllocParams,
+        .paramNames = arenaAllocNames,
+        .paramCount = 2,
+        .id = BUILTIN_ARENA_ALLOC
+    },
+    {
+        .name = "arenaReset",
+        .returnType = TYPE_VOID,
+        .paramTypes = pointerParam,
+        .paramNames = arenaParam,
+        .paramCount = 1,
+        .id = BUILTIN_ARENA_RESET
+    },
+    {
+        .name = "arenaDestroy",
+        .returnType = TYPE_VOID,
+        .paramTypes = pointerParam,
+        .paramNames = arenaParam,
+        .paramCount = 1,
+        .id = BUILTIN_ARENA_DESTROY
+    },
 };
 
-static int builtInFnCount = sizeof(builtInFunctions) / sizeof(BuiltInFunction);
-static int builtInsInit = 0;
-
-static void initBuiltInsParams() {
-    if (builtInsInit) return;
-    builtInFunctions[0].paramTypes = malloc(sizeof(DataType));
-    builtInFunctions[0].paramTypes[0] = TYPE_INT;
-    builtInFunctions[0].paramNames = malloc(sizeof(char *));
-    builtInFunctions[0].paramNames[0] = strdup("message");
-
-    builtInFunctions[1].paramTypes = malloc(sizeof(DataType));
-    builtInFunctions[1].paramTypes[0] = TYPE_STRING;
-    builtInFunctions[1].paramNames = malloc(sizeof(char *));
-    builtInFunctions[1].paramNames[0] = strdup("value");
-
-    builtInFunctions[2].paramTypes = malloc(sizeof(DataType));
-    builtInFunctions[2].paramTypes[0] = TYPE_FLOAT;
-    builtInFunctions[2].paramNames = malloc(sizeof(char *));
-    builtInFunctions[2].paramNames[0] = strdup("value");
-
-    builtInFunctions[3].paramTypes = malloc(sizeof(DataType));
-    builtInFunctions[3].paramTypes[0] = TYPE_BOOL;
-    builtInFunctions[3].paramNames = malloc(sizeof(char *));
-    builtInFunctions[3].paramNames[0] = strdup("value");
-
-    // read() -> int (no parameters, reads from stdin)
-    builtInFunctions[4].paramTypes = NULL;
-    builtInFunctions[4].paramNames = NULL;
-
-    // scan() -> string
-    builtInFunctions[5].paramTypes = NULL;
-    builtInFunctions[5].paramNames = NULL;
-
-    builtInFunctions[6].paramTypes = malloc(sizeof(DataType));
-    builtInFunctions[6].paramTypes[0] = TYPE_DOUBLE;
-    builtInFunctions[6].paramNames = malloc(sizeof(char *));
-    builtInFunctions[6].paramNames[0] = strdup("value");
-
-    builtInsInit = 1;
-}
+static const int builtInFnCount = sizeof(builtInFunctions) / sizeof(BuiltInFunction);
+
+static const VectorIntrinsic vectorIntrinsics[] = {
+    {"loadF32x4", VEC_INTRINSIC_LOAD, TYPE_F32X4},
+    {"loadF64x2", VEC_INTRINSIC_LOAD, TYPE_F64X2},
+    {"loadI32x4", VEC_INTRINSIC_LOAD, TYPE_I32X4},
+    {"loadF32x8", VEC_INTRINSIC_LOAD, TYPE_F32X8},
+    {"loadF64x4", VEC_INTRINSIC_LOAD, TYPE_F64X4},
+    {"loadI32x8", VEC_INTRINSIC_LOAD, TYPE_I32X8},
+    {"splatF32x4", VEC_INTRINSIC_SPLAT, TYPE_F32X4},
+    {"splatF64x2", VEC_INTRINSIC_SPLAT, TYPE_F64X2},
+    {"splatI32x4", VEC_INTRINSIC_SPLAT, TYPE_I32X4},
+    {"splatF32x8", VEC_INTRINSIC_SPLAT, TYPE_F32X8},
+    {"splatF64x4", VEC_INTRINSIC_SPLAT, TYPE_F64X4},
+    {"splatI32x8", VEC_INTRINSIC_SPLAT, TYPE_I32X8},
+    {"store", VEC_INTRINSIC_STORE, TYPE_UNKNOWN},
+    {"shuffle", VEC_INTRINSIC_SHUFFLE, TYPE_UNKNOWN},
+    {"reduceAdd", VEC_INTRINSIC_REDUCE_ADD, TYPE_UNKNOWN},
+    {"reduceMin", VEC_INTRINSIC_REDUCE_MIN, TYPE_UNKNOWN},
+    {"reduceMax", VEC_INTRINSIC_REDUCE_MAX, TYPE_UNKNOWN},
+};
 
 static FunctionParameter createParameterList(char **names, DataType *types, int count) {
     if (count == 0) return NULL;
@@ -136,10 +190,8 @@ static FunctionParameter createParameterList(char **names, DataType *types, int
 void initBuiltIns(SymbolTable globTable) {
     if (globTable == NULL) return;
 
-    initBuiltInsParams();
-
     for (int i = 0; i < builtInFnCount; i++) {
-        BuiltInFunction *builtin = &builtInFunctions[i];
+        const BuiltInFunction *builtin = &builtInFunctions[i];
 
         FunctionParameter params = createParameterList(
             builtin->paramNames,
@@ -161,7 +213,7 @@ BuiltInId resolveOverload(const char *nameStart, size_t nameLength, DataType arg
     if (nameStart == NULL || nameLength == 0) return BUILTIN_UNKNOWN;
 
     for (int i = 0; i < builtInFnCount; i++) {
-        BuiltInFunction *builtin = &builtInFunctions[i];
+        const BuiltInFunction *builtin = &builtInFunctions[i];
 
         size_t builtinNameLen = strlen(builtin->name);
         if (nameLength != builtinNameLen ||
@@ -194,3 +246,15 @@ int isBuiltinFunction(const char *nameStart, size_t nameLength) {
     }
     return 0;
 }
+
+const VectorIntrinsic *findVectorIntrinsic(const char *nameStart, size_t nameLength) {
+    if (nameStart == NULL || nameLength == 0) return NULL;
+
+    for (size_t i = 0; i < sizeof(vectorIntrinsics) / sizeof(vectorIntrinsics[0]); i++) {
+        if (strlen(vectorIntrinsics[i].name) == nameLength &&
+            memcmp(nameStart, vectorIntrinsics[i].name, nameLength) == 0) {
+            return &vectorIntrinsics[i];
+        }
+    }
+    return NULL;
+}
@@ -15,6 +15,12 @@ typedef enum {
   BUILTIN_EXIT,
   BUILTIN_READ_INT,
   BUILTIN_READ_STRING,
+  BUILTIN_ALLOC,
+  BUILTIN_FREE,
+  BUILTIN_ARENA_CREATE,
+  BUILTIN_ARENA_ALLOC,
+  BUILTIN_ARENA_RESET,
+  BUILTIN_ARENA_DESTROY,
   BUILTIN_UNKNOWN
 } BuiltInId;
 
@@ -27,9 +33,34 @@ typedef struct BuiltInFunction {
   BuiltInId id;
 } BuiltInFunction;
 
+typedef enum {
+  VEC_INTRINSIC_LOAD,         // loadF32x4(src, index): lanes src[index] .. src[index + lanes - 1]
+  VEC_INTRINSIC_SPLAT,        // splatF32x4(x): x in every lane
+  VEC_INTRINSIC_STORE,        // store(dst, index, v)
+  VEC_INTRINSIC_SHUFFLE,      // shuffle(v, lane, ...): one constant source lane per result lane
+  VEC_INTRINSIC_REDUCE_ADD,   // reduceAdd(v) and friends fold the lanes into a scalar
+  VEC_INTRINSIC_REDUCE_MIN,
+  VEC_INTRINSIC_REDUCE_MAX
+} VectorIntrinsicKind;
+
+/**
+ * @brief Vector intrinsics are checked by the type checker and lowered to
+ * vector IR in place, they are never called. Loads and splats name the
+ * vector type they build, the others take it from their vector argument.
+ */
+typedef struct VectorIntrinsic {
+  char *name;
+  VectorIntrinsicKind kind;
+  DataType vectorType;        // TYPE_UNKNOWN when it comes from the arguments
+} VectorIntrinsic;
+
 void initBuiltIns(SymbolTable globalTable);
 BuiltInId resolveOverload(const char *nameStart, size_t nameLength, DataType arg[], int argCount);
 int isBuiltinFunction(const char *nameStart, size_t nameLength);
+/**
+ * @brief The vector intrinsic called nameStart, NULL when there is none.
+ */
+const VectorIntrinsic *findVectorIntrinsic(const char *nameStart, size_t nameLength);
 Symbol findMatchingBuiltinFunction(SymbolTable table, const char *nameStart, size_t nameLength,
                                    DataType argTypes[], int argCount);
 
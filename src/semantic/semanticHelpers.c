@@ -108,7 +108,7 @@ int validateArrayAccessNode(ASTNode arrayAccess, TypeCheckContext context) {
     Symbol arraySym = lookupSymbolOrError(context, baseNode);
     if (!arraySym) return 0;
     
-    if (!arraySym->isArray && !arraySym->isPointer) {
+    if (!arraySym->isArray && !arraySym->isPointer && !isVectorType(arraySym->type)) {
         reportErrorWithText(ERROR_INVALID_OPERATION_FOR_TYPE, baseNode, context,
                           "Array subscript requires array or pointer type");
         return 0;
@@ -124,7 +124,7 @@ int validateArrayAccessNode(ASTNode arrayAccess, TypeCheckContext context) {
         return 0;
     }
     
-    if (indexType != TYPE_INT) {
+    if (!isIntegerType(indexType)) {
         REPORT_ERROR(ERROR_ARRAY_INDEX_NOT_INTEGER, indexNode, context,
                     "Array index must be integer type");
         return 0;
@@ -35,7 +35,7 @@ Symbol addFunctionSymbol(SymbolTable symbolTable, const char *nameStart, size_t
     Symbol exists = lookupSymbol(symbolTable, nameStart, nameLength);
     if (exists != NULL) return NULL;
 
-    Symbol newSymbol = malloc(sizeof(struct Symbol));
+    Symbol newSymbol = calloc(1, sizeof(struct Symbol));
     if (newSymbol == NULL) return NULL;
 
     newSymbol->nameStart = nameStart;
@@ -49,6 +49,7 @@ Symbol addFunctionSymbol(SymbolTable symbolTable, const char *nameStart, size_t
     newSymbol->parameters = parameters;
     newSymbol->paramCount = paramCount;
     newSymbol->functionScope = NULL;
+    newSymbol->returnedVar = NULL;
 
     newSymbol->next = symbolTable->symbols;
     symbolTable->symbols = newSymbol;
@@ -204,7 +205,7 @@ Symbol addSymbol(SymbolTable table, const char *nameStart, size_t nameLength,
     Symbol existing = lookupSymbolCurrentOnly(table, nameStart, nameLength);
     if (existing != NULL) return NULL;
 
-    Symbol newSymbol = malloc(sizeof(struct Symbol));
+    Symbol newSymbol = calloc(1, sizeof(struct Symbol));
     if (newSymbol == NULL) return NULL;
 
     newSymbol->nameStart = nameStart;
@@ -247,6 +248,32 @@ DataType getDataTypeFromNode(NodeTypes nodeType) {
             return TYPE_BOOL;
         case REF_DOUBLE:
             return TYPE_DOUBLE;
+        case REF_I8:
+            return TYPE_I8;
+        case REF_I16:
+            return TYPE_I16;
+        case REF_I64:
+            return TYPE_I64;
+        case REF_U8:
+            return TYPE_U8;
+        case REF_U16:
+            return TYPE_U16;
+        case REF_U32:
+            return TYPE_U32;
+        case REF_U64:
+            return TYPE_U64;
+        case REF_F32X4:
+            return TYPE_F32X4;
+        case REF_F64X2:
+            return TYPE_F64X2;
+        case REF_I32X4:
+            return TYPE_I32X4;
+        case REF_F32X8:
+            return TYPE_F32X8;
+        case REF_F64X4:
+            return TYPE_F64X4;
+        case REF_I32X8:
+            return TYPE_I32X8;
         // now works bcs structs are the only user custom types
         case REF_CUSTOM:
             return TYPE_STRUCT;
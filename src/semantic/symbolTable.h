@@ -47,6 +47,19 @@ typedef enum {
     TYPE_STRUCT,
     TYPE_POINTER,
     TYPE_NULL,
+    TYPE_I8,
+    TYPE_I16,
+    TYPE_I64,
+    TYPE_U8,
+    TYPE_U16,
+    TYPE_U32,
+    TYPE_U64,
+    TYPE_F32X4,
+    TYPE_F64X2,
+    TYPE_I32X4,
+    TYPE_F32X8,
+    TYPE_F64X4,
+    TYPE_I32X8,
     TYPE_UNKNOWN
 } DataType;
 
@@ -75,8 +88,9 @@ typedef struct StructField {
 typedef struct StructType {
     const char * nameStart;
     size_t nameLength;
-    StructField fields;
+    StructField fields;     // declaration order; offsets may follow another order
     size_t size;
+    size_t alignment;
     int fieldCount;
 } *StructType;
 
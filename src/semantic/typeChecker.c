@@ -21,6 +21,12 @@ typedef enum {
   STACK_SIZE_BOOL = 1,     
   STACK_SIZE_STRING = 8,   
   STACK_SIZE_DOUBLE = 8, 
+  STACK_SIZE_I8 = 1,
+  STACK_SIZE_I16 = 2,
+  STACK_SIZE_I64 = 8,
+  STACK_SIZE_POINTER = 8,
+  STACK_SIZE_VEC128 = 16,
+  STACK_SIZE_VEC256 = 32,
   ALIGNMENT = 16
 } StackSize;
 
@@ -32,6 +38,20 @@ StackSize getStackSize(DataType type) {
         case TYPE_STRING: return STACK_SIZE_STRING;
         case TYPE_STRUCT: return STACK_SIZE_STRING;
         case TYPE_DOUBLE: return STACK_SIZE_DOUBLE;
+        case TYPE_POINTER: return STACK_SIZE_POINTER;
+        case TYPE_I8:
+        case TYPE_U8: return STACK_SIZE_I8;
+        case TYPE_I16:
+        case TYPE_U16: return STACK_SIZE_I16;
+        case TYPE_U32: return STACK_SIZE_INT;
+        case TYPE_I64:
+        case TYPE_U64: return STACK_SIZE_I64;
+        case TYPE_F32X4:
+        case TYPE_F64X2:
+        case TYPE_I32X4: return STACK_SIZE_VEC128;
+        case TYPE_F32X8:
+        case TYPE_F64X4:
+        case TYPE_I32X8: return STACK_SIZE_VEC256;
         default: return STACK_SIZE_INT;
     }
 }
@@ -66,6 +86,7 @@ TypeCheckContext createTypeCheckContext(const char *sourceCode, const char *file
     context->currentFunction = NULL;
     context->sourceFile = sourceCode;
     context->filename = filename;
+    context->avx2 = 0;
     context->blockScopesHead = NULL;
     context->blockScopesTail = NULL;
 
@@ -103,8 +124,8 @@ void freeTypeCheckContext(TypeCheckContext context) {
  * @brief Checks if two data types are compatible for assignment operations.
  *
  * Implements the type compatibility rules for the language. Supports
- * identity compatibility (same types) and limited implicit conversions.
- * The only implicit conversion allowed is int to float.
+ * identity compatibility (same types) and limited implicit conversions
+ * between integer types and from integers to floating point.
  *
  * @param target Target type for assignment
  * @param source Source type being assigned
@@ -112,7 +133,8 @@ void freeTypeCheckContext(TypeCheckContext context) {
  *
  * Compatibility rules:
  * - Same types are always compatible
- * - int can be assigned to float (implicit conversion)
+ * - Integer types convert to each other, wrapping like C
+ * - Integers can be assigned to float and double (implicit conversion)
  * - All other type combinations are incompatible
  */
 CompatResult areCompatible(DataType target, DataType source) {
@@ -121,6 +143,7 @@ CompatResult areCompatible(DataType target, DataType source) {
     }
     
     if (target == source) return COMPAT_OK;
+    if (isIntegerType(target) && isIntegerType(source)) return COMPAT_OK;
 
     if (source == TYPE_NULL && target == TYPE_POINTER) return COMPAT_OK;
     if (target == TYPE_NULL && source == TYPE_POINTER) return COMPAT_OK;
@@ -134,10 +157,10 @@ CompatResult areCompatible(DataType target, DataType source) {
             return COMPAT_ERROR;
         case TYPE_FLOAT: {
             if(source == TYPE_DOUBLE) return COMPAT_WARNING;
-            return source == TYPE_INT ? COMPAT_OK : COMPAT_ERROR;
+            return isIntegerType(source) ? COMPAT_OK : COMPAT_ERROR;
         }
         case TYPE_DOUBLE: 
-            return source == TYPE_INT || source == TYPE_FLOAT ? COMPAT_OK : COMPAT_ERROR;
+            return isIntegerType(source) || source == TYPE_FLOAT ? COMPAT_OK : COMPAT_ERROR;
         default: 
             return COMPAT_ERROR;
     }
@@ -145,16 +168,100 @@ CompatResult areCompatible(DataType target, DataType source) {
 
 int isPrecisionLossCast(DataType source, DataType target) {
     if (source == TYPE_DOUBLE && target == TYPE_FLOAT) return 1;
-    if ((source == TYPE_FLOAT || source == TYPE_DOUBLE) && target == TYPE_INT) return 1;
-    if (source == TYPE_INT && target == TYPE_BOOL) return 1;
+    if ((source == TYPE_FLOAT || source == TYPE_DOUBLE) && isIntegerType(target)) return 1;
+    if (isIntegerType(source) && target == TYPE_BOOL) return 1;
     return 0;
 }
 
+int isIntegerType(DataType type) {
+    return type == TYPE_INT || (type >= TYPE_I8 && type <= TYPE_U64);
+}
+
+int isUnsignedType(DataType type) {
+    return type >= TYPE_U8 && type <= TYPE_U64;
+}
+
 int isNumType(DataType type) {
-    return type == TYPE_INT || type == TYPE_FLOAT || type == TYPE_DOUBLE;
+    return isIntegerType(type) || type == TYPE_FLOAT || type == TYPE_DOUBLE;
+}
+
+/**
+ * @brief Common type of two integer operands, as in C: types narrower than
+ * int become int, then the wider type wins and unsigned wins a tie.
+ */
+DataType promoteIntegerTypes(DataType left, DataType right) {
+    if (getStackSize(left) < STACK_SIZE_INT) left = TYPE_INT;
+    if (getStackSize(right) < STACK_SIZE_INT) right = TYPE_INT;
+    if (getStackSize(left) != getStackSize(right)) {
+        return getStackSize(left) > getStackSize(right) ? left : right;
+    }
+    return isUnsignedType(right) ? right : left;
+}
+
+int isVectorType(DataType type) {
+    return type >= TYPE_F32X4 && type <= TYPE_I32X8;
+}
+
+DataType vectorElementType(DataType type) {
+    switch (type) {
+        case TYPE_F32X4:
+        case TYPE_F32X8: return TYPE_FLOAT;
+        case TYPE_F64X2:
+        case TYPE_F64X4: return TYPE_DOUBLE;
+        case TYPE_I32X4:
+        case TYPE_I32X8: return TYPE_INT;
+        default: return TYPE_UNKNOWN;
+    }
+}
+
+int vectorLaneCount(DataType type) {
+    return isVectorType(type) ? getStackSize(type) / getStackSize(vectorElementType(type)) : 0;
+}
+
+/**
+ * @brief v[i] on a vector variable: an integer lane index, range checked
+ * when it is a literal. Yields the element type.
+ */
+static DataType validateLaneAccess(Symbol vector, ASTNode indexNode, TypeCheckContext context) {
+    if (!isIntegerType(getExpressionType(indexNode, context))) {
+        REPORT_ERROR(ERROR_ARRAY_INDEX_NOT_INTEGER, indexNode, context, "Lane index must be integer type");
+        return TYPE_UNKNOWN;
+    }
+    int lanes = vectorLaneCount(vector->type);
+    if (indexNode->nodeType == LITERAL) {
+        int lane = parseInt(indexNode->start, indexNode->length);
+        if (lane < 0 || lane >= lanes) {
+            char msg[100];
+            snprintf(msg, sizeof(msg), "Lane %d out of bounds [0, %d)", lane, lanes);
+            REPORT_ERROR(ERROR_ARRAY_INDEX_OUT_OF_BOUNDS, indexNode, context, msg);
+            return TYPE_UNKNOWN;
+        }
+    }
+    return vectorElementType(vector->type);
+}
+
+/**
+ * @brief Element-wise operators a vector type supports: + - * on all of them,
+ * / on floating point vectors and & | ^ on integer vectors. Compound
+ * assignments count as their operator.
+ */
+static int vectorSupportsOp(DataType type, NodeTypes op) {
+    switch (op) {
+        case ADD_OP: case SUB_OP: case MUL_OP:
+        case COMPOUND_ADD_ASSIGN: case COMPOUND_SUB_ASSIGN: case COMPOUND_MUL_ASSIGN:
+            return 1;
+        case DIV_OP: case COMPOUND_DIV_ASSIGN:
+            return vectorElementType(type) != TYPE_INT;
+        case BITWISE_AND: case BITWISE_OR: case BITWISE_XOR:
+        case COMPOUND_AND_ASSIGN: case COMPOUND_OR_ASSIGN: case COMPOUND_XOR_ASSIGN:
+            return vectorElementType(type) == TYPE_INT;
+        default:
+            return 0;
+    }
 }
 
 CompatResult isCastAllowed(DataType target, DataType source) {
+    if (isVectorType(target) || isVectorType(source)) return COMPAT_ERROR;
     CompatResult baseComp = areCompatible(target, source);
     if (baseComp != COMPAT_ERROR) {
         return baseComp;
@@ -182,11 +289,14 @@ CompatResult isCastAllowed(DataType target, DataType source) {
  * @return Result type of the operation or TYPE_UNKNOWN for invalid operations
  *
  * Type promotion rules:
- * - Arithmetic: float + int = float, int + int = int
+ * - Arithmetic: float + int = float, integers follow promoteIntegerTypes
  * - Comparison: operands must be compatible, result is bool
  * - Logical: operands must be bool, result is bool
  */
 DataType getOperationResultType(DataType left, DataType right, NodeTypes op) {
+    if (isVectorType(left) || isVectorType(right)) {
+        return left == right && vectorSupportsOp(left, op) ? left : TYPE_UNKNOWN;
+    }
     switch (op) {
         case ADD_OP:
         case SUB_OP:
@@ -195,7 +305,7 @@ DataType getOperationResultType(DataType left, DataType right, NodeTypes op) {
         case MOD_OP:
             if (left == TYPE_DOUBLE || right == TYPE_DOUBLE) return TYPE_DOUBLE;
             if (left == TYPE_FLOAT || right == TYPE_FLOAT) return TYPE_FLOAT;
-            if (left == TYPE_INT && right == TYPE_INT) return TYPE_INT;
+            if (isIntegerType(left) && isIntegerType(right)) return promoteIntegerTypes(left, right);
             return TYPE_UNKNOWN;
         case EQUAL_OP:
         case NOT_EQUAL_OP:
@@ -283,6 +393,123 @@ DataType validateMemberAccess(ASTNode node, TypeCheckContext context) {
     return resolved.type;
 }
 
+/**
+ * @brief Source or destination of a vector load/store: an array or a single
+ * level pointer variable of the vector's element type. A literal index into
+ * an array must leave room for every lane.
+ */
+static int validateVectorMemory(ASTNode base, ASTNode index, DataType vectorType, TypeCheckContext context) {
+    if (base->nodeType != VARIABLE) {
+        REPORT_ERROR(ERROR_INVALID_OPERATION_FOR_TYPE, base, context,
+                    "Vector loads and stores need an array or pointer variable");
+        return 0;
+    }
+    Symbol sym = lookupSymbolOrError(context, base);
+    if (!sym) return 0;
+
+    DataType element = vectorElementType(vectorType);
+    int isArray = sym->isArray && !sym->isPointer && sym->type == element;
+    int isPointer = sym->isPointer && sym->pointerLvl == 1 && sym->baseType == element;
+    if (!isArray && !isPointer) {
+        char msg[100];
+        snprintf(msg, sizeof(msg), "%s lanes need a %s array or *%s", getTypeName(vectorType),
+                 getTypeName(element), getTypeName(element));
+        REPORT_ERROR(ERROR_INVALID_OPERATION_FOR_TYPE, base, context, msg);
+        return 0;
+    }
+    if (!isIntegerType(getExpressionType(index, context))) {
+        REPORT_ERROR(ERROR_ARRAY_INDEX_NOT_INTEGER, index, context, "Vector load/store index must be integer type");
+        return 0;
+    }
+    if (isArray && index->nodeType == LITERAL) {
+        int first = parseInt(index->start, index->length);
+        if (first < 0 || first + vectorLaneCount(vectorType) > sym->staticSize) {
+            char msg[100];
+            snprintf(msg, sizeof(msg), "Lanes [%d, %d) out of bounds [0, %d)", first,
+                     first + vectorLaneCount(vectorType), sym->staticSize);
+            REPORT_ERROR(ERROR_ARRAY_INDEX_OUT_OF_BOUNDS, index, context, msg);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Checks a vector intrinsic call.
+ * @return The call's type, TYPE_VOID for store, TYPE_UNKNOWN after an error
+ */
+static DataType validateVectorIntrinsic(ASTNode node, const VectorIntrinsic *intrinsic, TypeCheckContext context) {
+    ASTNode args[9] = {NULL};
+    int argCount = 0;
+    for (ASTNode arg = node->children ? node->children->children : NULL; arg; arg = arg->brothers) {
+        if (argCount < 9) args[argCount] = arg;
+        argCount++;
+    }
+
+    int expected;
+    switch (intrinsic->kind) {
+        case VEC_INTRINSIC_LOAD: expected = 2; break;
+        case VEC_INTRINSIC_STORE: expected = 3; break;
+        default: expected = 1; break;
+    }
+    DataType vectorType = intrinsic->vectorType;
+    if (getStackSize(vectorType) == STACK_SIZE_VEC256 && !context->avx2) {
+        REPORT_ERROR(ERROR_INVALID_OPERATION_FOR_TYPE, node, context, "256-bit vector types require -mavx2");
+        return TYPE_UNKNOWN;
+    }
+    if (intrinsic->kind == VEC_INTRINSIC_STORE || intrinsic->kind == VEC_INTRINSIC_SHUFFLE ||
+        intrinsic->kind >= VEC_INTRINSIC_REDUCE_ADD) {
+        ASTNode vectorArg = args[intrinsic->kind == VEC_INTRINSIC_STORE ? 2 : 0];
+        vectorType = vectorArg ? getExpressionType(vectorArg, context) : TYPE_UNKNOWN;
+        if (vectorArg && !isVectorType(vectorType)) {
+            if (vectorType != TYPE_UNKNOWN) {
+                REPORT_ERROR(ERROR_INVALID_OPERATION_FOR_TYPE, vectorArg, context, "Expected a vector argument");
+            }
+            return TYPE_UNKNOWN;
+        }
+        if (intrinsic->kind == VEC_INTRINSIC_SHUFFLE) expected = 1 + vectorLaneCount(vectorType);
+    }
+    if (argCount != expected) {
+        char msg[100];
+        snprintf(msg, sizeof(msg), "%s expects %d arguments", intrinsic->name, expected);
+        REPORT_ERROR(ERROR_FUNCTION_ARG_COUNT_MISMATCH, node, context, msg);
+        return TYPE_UNKNOWN;
+    }
+
+    switch (intrinsic->kind) {
+        case VEC_INTRINSIC_LOAD:
+            return validateVectorMemory(args[0], args[1], vectorType, context) ? vectorType : TYPE_UNKNOWN;
+        case VEC_INTRINSIC_STORE:
+            return validateVectorMemory(args[0], args[1], vectorType, context) ? TYPE_VOID : TYPE_UNKNOWN;
+        case VEC_INTRINSIC_SPLAT: {
+            DataType scalar = getExpressionType(args[0], context);
+            if (scalar == TYPE_UNKNOWN) return TYPE_UNKNOWN;
+            if (areCompatible(vectorElementType(vectorType), scalar) == COMPAT_ERROR) {
+                REPORT_ERROR(variableErrorCompatibleHandling(vectorElementType(vectorType), scalar), args[0], context,
+                            "Splat value does not fit the lane type");
+                return TYPE_UNKNOWN;
+            }
+            return vectorType;
+        }
+        case VEC_INTRINSIC_SHUFFLE:
+            for (int i = 1; i < argCount; i++) {
+                int lane = args[i]->nodeType == LITERAL && args[i]->children &&
+                           args[i]->children->nodeType == REF_INT
+                    ? parseInt(args[i]->start, args[i]->length) : -1;
+                if (lane < 0 || lane >= vectorLaneCount(vectorType)) {
+                    char msg[100];
+                    snprintf(msg, sizeof(msg), "Shuffle lanes must be integer literals in [0, %d)",
+                             vectorLaneCount(vectorType));
+                    REPORT_ERROR(ERROR_INVALID_OPERATION_FOR_TYPE, args[i], context, msg);
+                    return TYPE_UNKNOWN;
+                }
+            }
+            return vectorType;
+        default:
+            return vectorElementType(vectorType);
+    }
+}
+
 /**
  * @brief Infers the data type of an expression AST node.
  *
@@ -309,7 +536,11 @@ DataType getExpressionType(ASTNode node, TypeCheckContext context) {
             }
             switch(node->children->nodeType){
             case REF_INT:
-                return TYPE_INT;
+                switch (intLiteralRank(node->start, node->length)) {
+                    case 0: return TYPE_INT;
+                    case 1: return TYPE_I64;
+                    default: return TYPE_U64;
+                }
             case REF_FLOAT:
                 return TYPE_FLOAT;
             case REF_BOOL:
@@ -428,6 +659,9 @@ DataType getExpressionType(ASTNode node, TypeCheckContext context) {
                 return TYPE_UNKNOWN;
             }
 
+            if (isVectorType(sym->type) && !sym->isArray && !sym->isPointer) {
+                return validateLaneAccess(sym, indexNode, context);
+            }
             if (!sym->isArray) {
                 REPORT_ERROR(ERROR_INVALID_OPERATION_FOR_TYPE, node, context,
                             "Subscript on non-array type");
@@ -435,7 +669,7 @@ DataType getExpressionType(ASTNode node, TypeCheckContext context) {
             }
 
             DataType indexType = getExpressionType(indexNode, context);
-            if (indexType != TYPE_INT) {
+            if (!isIntegerType(indexType)) {
                 REPORT_ERROR(ERROR_ARRAY_INDEX_NOT_INTEGER, indexNode, context,
                             "Array index must be integer type");
                 return TYPE_UNKNOWN;
@@ -499,10 +733,25 @@ DataType getExpressionType(ASTNode node, TypeCheckContext context) {
             return TYPE_DOUBLE;
         case REF_STRING:
             return TYPE_STRING;
+        case REF_I8:
+        case REF_I16:
+        case REF_I64:
+        case REF_U8:
+        case REF_U16:
+        case REF_U32:
+        case REF_U64:
+        case REF_F32X4:
+        case REF_F64X2:
+        case REF_I32X4:
+        case REF_F32X8:
+        case REF_F64X4:
+        case REF_I32X8:
+            return getDataTypeFromNode(node->nodeType);
         case UNARY_MINUS_OP:
         case UNARY_PLUS_OP: {
             DataType opType = getExpressionType(node->children, context);
-            if (opType == TYPE_INT || opType == TYPE_FLOAT || opType == TYPE_DOUBLE) {
+            if (isIntegerType(opType)) return promoteIntegerTypes(opType, opType);
+            if (opType == TYPE_FLOAT || opType == TYPE_DOUBLE) {
                 return opType;
             }
             REPORT_ERROR(ERROR_INVALID_UNARY_OPERAND, node, context, "Arithmetic unary operators require numeric operands");
@@ -519,7 +768,7 @@ DataType getExpressionType(ASTNode node, TypeCheckContext context) {
         case POST_INCREMENT:
         case POST_DECREMENT: {
             DataType operandType = getExpressionType(node->children, context);
-            if (operandType == TYPE_INT || operandType == TYPE_FLOAT) {
+            if (isIntegerType(operandType) || operandType == TYPE_FLOAT) {
                 return operandType;
             }
             REPORT_ERROR(ERROR_INVALID_UNARY_OPERAND, node, context, "Increment/decrement operators require numeric operands");
@@ -538,13 +787,23 @@ DataType getExpressionType(ASTNode node, TypeCheckContext context) {
             DataType leftType = getExpressionType(node->children, context);
             DataType rightType = getExpressionType(node->children->brothers, context);
 
-            if (leftType != TYPE_INT || rightType != TYPE_INT) {
+            if (isVectorType(leftType) || isVectorType(rightType)) {
+                if (leftType == rightType && vectorSupportsOp(leftType, node->nodeType)) return leftType;
+                REPORT_ERROR(ERROR_INCOMPATIBLE_BINARY_OPERANDS, node, context,
+                            "Bitwise operators need two integer vectors of the same type");
+                return TYPE_UNKNOWN;
+            }
+            if (!isIntegerType(leftType) || !isIntegerType(rightType)) {
                 REPORT_ERROR(ERROR_INCOMPATIBLE_BINARY_OPERANDS, node, context,
                             "Bitwise operators require integer operands");
                 return TYPE_UNKNOWN;
             }
 
-            return TYPE_INT;
+            // Shifts keep the type of the value being shifted
+            if (node->nodeType == BITWISE_LSHIFT || node->nodeType == BITWISE_RSHIFT) {
+                return promoteIntegerTypes(leftType, leftType);
+            }
+            return promoteIntegerTypes(leftType, rightType);
         }
         case ADD_OP:
         case SUB_OP:
@@ -572,11 +831,21 @@ DataType getExpressionType(ASTNode node, TypeCheckContext context) {
             }
             return resultType;
         }
-        case CAST_EXPRESSION:
+        case CAST_EXPRESSION: {
             if(!node->children || !node->children->brothers) return TYPE_UNKNOWN;
             ASTNode targetTypeNode = node->children->brothers;
-            return getDataTypeFromNode(targetTypeNode->nodeType);
+            DataType targetType = getDataTypeFromNode(targetTypeNode->nodeType);
+            if (isVectorType(targetType) || isVectorType(getExpressionType(node->children, context))) {
+                REPORT_ERROR(ERROR_FORBIDDEN_CAST, node, context, "Vectors cannot be cast");
+                return TYPE_UNKNOWN;
+            }
+            return targetType;
+        }
         case FUNCTION_CALL: {
+            const VectorIntrinsic *intrinsic = findVectorIntrinsic(node->start, node->length);
+            if (intrinsic) return validateVectorIntrinsic(node, intrinsic, context);
+            // Nested calls are only reached through here, check their arguments too
+            if (!validateFunctionCall(node, context)) return TYPE_UNKNOWN;
             Symbol funcSymbol = lookupSymbol(context->current, node->start, node->length);
             if (funcSymbol != NULL && funcSymbol->symbolType == SYMBOL_FUNCTION) {
                 return funcSymbol->type;
@@ -603,6 +872,7 @@ DataType getExpressionType(ASTNode node, TypeCheckContext context) {
             DataType falseType = getExpressionType(falseExpr, context);
 
             if (trueType == falseType) return trueType;
+            if (isIntegerType(trueType) && isIntegerType(falseType)) return promoteIntegerTypes(trueType, falseType);
 
             // Type promotion for numbers
             if ((trueType == TYPE_DOUBLE || falseType == TYPE_DOUBLE)) return TYPE_DOUBLE;
@@ -627,6 +897,10 @@ int validateFunctionCall(ASTNode node, TypeCheckContext context) {
         return 0;
     }
 
+    const VectorIntrinsic *intrinsic = findVectorIntrinsic(node->start, node->length);
+    if (intrinsic) {
+        return validateVectorIntrinsic(node, intrinsic, context) != TYPE_UNKNOWN;
+    }
     if (isBuiltinFunction(node->start, node->length)) {
         return validateBuiltinFunctionCall(node, context);
     }
@@ -752,6 +1026,9 @@ int validateUserDefinedFunctionCall(ASTNode node, TypeCheckContext context) {
  *       only be called after compatibility checking has failed.
  */
 ErrorCode variableErrorCompatibleHandling(DataType varType, DataType initType) {
+    // Sized integers share the int diagnostics
+    if (isIntegerType(varType)) varType = TYPE_INT;
+    if (isIntegerType(initType)) initType = TYPE_INT;
     switch (varType) {
         case TYPE_INT: {
             switch (initType) {
@@ -811,6 +1088,19 @@ const char* getTypeName(DataType type) {
         case TYPE_POINTER: return "pointer";
         case TYPE_STRUCT: return "struct";
         case TYPE_NULL: return "null";
+        case TYPE_I8: return "i8";
+        case TYPE_I16: return "i16";
+        case TYPE_I64: return "i64";
+        case TYPE_U8: return "u8";
+        case TYPE_U16: return "u16";
+        case TYPE_U32: return "u32";
+        case TYPE_U64: return "u64";
+        case TYPE_F32X4: return "f32x4";
+        case TYPE_F64X2: return "f64x2";
+        case TYPE_I32X4: return "i32x4";
+        case TYPE_F32X8: return "f32x8";
+        case TYPE_F64X4: return "f64x4";
+        case TYPE_I32X8: return "i32x8";
         default: return "unknown";
     }
 }
@@ -867,6 +1157,13 @@ int validateVariableDeclaration(ASTNode node, TypeCheckContext context, int isCo
             REPORT_ERROR(ERROR_UNDEFINED_SYMBOL, typeref, context, "Undefined struct type in variable declaration");
             return 0;
         }
+    }else if(isVectorType(varType) && (pointerLevel > 0 || isArr)){
+        REPORT_ERROR(ERROR_INVALID_OPERATION_FOR_TYPE, node, context,
+                    "Vectors cannot be array elements or pointees, use scalar arrays with the vector loads and stores");
+        return 0;
+    }else if(getStackSize(varType) == STACK_SIZE_VEC256 && !context->avx2){
+        REPORT_ERROR(ERROR_INVALID_OPERATION_FOR_TYPE, node, context, "256-bit vector types require -mavx2");
+        return 0;
     }
     
     // Check for redeclaration
@@ -939,7 +1236,7 @@ int validateVariableDeclaration(ASTNode node, TypeCheckContext context, int isCo
     }
     
     ASTNode initNode = isArr ? node->children->brothers->brothers : node->children->brothers;
-    if (node->children && node->children->brothers) {
+    if (initNode) {
         int isMemRef = (initNode->children && initNode->children->nodeType == MEMADDRS);
         
         // Validate address-of operator if used
@@ -1109,6 +1406,11 @@ int validateAssignment(ASTNode node, TypeCheckContext context) {
         REPORT_ERROR(ERROR_TYPE_MISMATCH_DOUBLE_TO_FLOAT, node, context, 
                     "Type mismatch in assignment");
     }
+    if (isVectorType(leftType) && node->nodeType != ASSIGNMENT && !vectorSupportsOp(leftType, node->nodeType)) {
+        REPORT_ERROR(ERROR_INVALID_OPERATION_FOR_TYPE, node, context,
+                    "Operator not supported on this vector type");
+        return 0;
+    }
     
     // Handle address-of with const tracking
     if (left->nodeType == VARIABLE && right->nodeType == MEMADDRS) {
@@ -1266,11 +1568,24 @@ int validateFunctionDef(ASTNode node, TypeCheckContext context) {
     int paramCount = 0;
     FunctionParameter param = parameters;
     while (param != NULL) {
+        if (isVectorType(param->type)) {
+            REPORT_ERROR(ERROR_INVALID_OPERATION_FOR_TYPE, node, context,
+                        "Vector types cannot cross function boundaries, pass a scalar array instead");
+            freeParamList(parameters);
+            return 0;
+        }
         paramCount++;
         param = param->next;
     }
+    if (isVectorType(returnType)) {
+        REPORT_ERROR(ERROR_INVALID_OPERATION_FOR_TYPE, node, context,
+                    "Vector types cannot cross function boundaries, pass a scalar array instead");
+        freeParamList(parameters);
+        return 0;
+    }
 
-    Symbol funcSymbol = addFunctionSymbolFromNode(context->current, node, returnType, parameters, paramCount);
+    Symbol funcSymbol = findVectorIntrinsic(node->start, node->length) ? NULL
+        : addFunctionSymbolFromNode(context->current, node, returnType, parameters, paramCount);
     if (funcSymbol == NULL) {
         char * tempText = extractText(node->start, node->length);
         REPORT_ERROR(ERROR_VARIABLE_REDECLARED, node, context, tempText);
@@ -1427,7 +1742,6 @@ int validateReturnStatement(ASTNode node, TypeCheckContext context) {
     }
 
     funcSym->returnedVar = lookupSymbol(context->current, node->children->start, node->children->length);
-    printf("return type is %s, expected %s\n", getTypeName(returnType), getTypeName(expectedType));
 
     return 1;
 }
@@ -1507,6 +1821,48 @@ static size_t alignTo(size_t offset, size_t alignment) {
     return (offset + alignment - 1) & ~(alignment - 1);
 }
 
+static int isStructAttribute(ASTNode attribute, const char *name) {
+    size_t len = strlen(name);
+    return attribute->length == len && memcmp(attribute->start, name, len) == 0;
+}
+
+/**
+ * @brief Assigns field offsets, size and alignment following the struct's attributes
+ * @details Fields are placed in declaration order at their natural alignment. `reorder`
+ * places them by decreasing size instead, which leaves padding only at the end; `packed`
+ * drops all padding; `align(N)` raises the struct's alignment (and so its size) to N.
+ * The field list itself stays in declaration order.
+ */
+static void layoutStruct(StructType structType, ASTNode attributes) {
+    int packed = 0, reorder = 0;
+    size_t alignment = 1;
+    for (ASTNode attribute = attributes; attribute; attribute = attribute->brothers) {
+        if (attribute->nodeType != STRUCT_ATTRIBUTE) continue;
+        if (isStructAttribute(attribute, "packed")) packed = 1;
+        else if (isStructAttribute(attribute, "reorder")) reorder = 1;
+        else if (attribute->children) alignment = strtoul(attribute->children->start, NULL, 10);
+    }
+
+    size_t offset = 0;
+    size_t naturalAlignment = 1;
+    // reorder makes one pass per size class, largest first; otherwise a single pass takes all
+    for (size_t pass = reorder && !packed ? STACK_SIZE_POINTER : 0; ; pass /= 2) {
+        for (StructField field = structType->fields; field; field = field->next) {
+            size_t fieldSize = getStackSize(field->type);
+            if (pass && fieldSize != pass) continue;
+            size_t fieldAlignment = packed ? 1 : fieldSize;
+            offset = alignTo(offset, fieldAlignment);
+            field->offset = offset;
+            offset += fieldSize;
+            if (fieldAlignment > naturalAlignment) naturalAlignment = fieldAlignment;
+        }
+        if (pass <= 1) break;
+    }
+    if (naturalAlignment > alignment) alignment = naturalAlignment;
+    structType->alignment = alignment;
+    structType->size = alignTo(offset, alignment);
+}
+
 StructType createStructType(ASTNode node, TypeCheckContext context) {
     if (!node || node->nodeType != STRUCT_DEFINITION) return NULL;
     StructType structType = malloc(sizeof(struct StructType));
@@ -1519,6 +1875,7 @@ StructType createStructType(ASTNode node, TypeCheckContext context) {
     structType->fields = NULL;
     structType->fieldCount = 0;
     structType->size = 0;
+    structType->alignment = 1;
 
     ASTNode fieldList = node->children;
     if (fieldList && fieldList->nodeType == STRUCT_FIELD_LIST) {
@@ -1551,20 +1908,21 @@ StructType createStructType(ASTNode node, TypeCheckContext context) {
                     }
                     structField->structType = structSymbol->structType;
                 }
+                if (isVectorType(type)) {
+                    REPORT_ERROR(ERROR_INVALID_OPERATION_FOR_TYPE, field, context,
+                                "Vectors cannot be struct fields, use scalar arrays with the vector loads and stores");
+                    free(structField);
+                    free(structType);
+                    return NULL;
+                }
                 structField->isPointer = (pointerLevel > 0);
                 structField->pointerLevel = pointerLevel;
                 if (pointerLevel > 0) {
                     structField->type = TYPE_POINTER;
                 }
+                structField->offset = 0;
                 structField->next = NULL;
 
-                size_t fieldSize = getStackSize(structField->type);
-                size_t alignment = getStackSize(structField->type);
-                structType->size = alignTo(structType->size, alignment);
-                structField->offset = structType->size;
-
-                structType->size += fieldSize;
-
                 StructField check = structType->fields;
                 while (check) {
                     if (check->nameLength == structField->nameLength && memcmp(check->nameStart, structField->nameStart, check->nameLength) == 0) {
@@ -1584,14 +1942,7 @@ StructType createStructType(ASTNode node, TypeCheckContext context) {
             }
             field = field->brothers;
         }
-        size_t maxAlignment = 1;
-        StructField f = structType->fields;
-        while (f) {
-            size_t align = getStackSize(f->type);
-            if (align > maxAlignment) maxAlignment = align;
-            f = f->next;
-        }
-        structType->size = alignTo(structType->size, maxAlignment);
+        layoutStruct(structType, fieldList->brothers);
     }
     return structType;
 }
@@ -1783,6 +2134,11 @@ int typeCheckNode(ASTNode node, TypeCheckContext context) {
             success = validateVariableUsage(node, context);
             break;
 
+        case MEMBER_ACCESS:
+            // The field child is not a variable, resolve the whole chain instead
+            success = validateMemberAccess(node, context) != TYPE_UNKNOWN;
+            break;
+
         case ADD_OP:
         case SUB_OP:
         case MUL_OP:
@@ -24,6 +24,7 @@ typedef struct TypeCheckContext {
     Symbol currentFunction;
     const char *sourceFile;
     const char *filename;
+    int avx2;                        // 256-bit vector types allowed
 
     // Block scope tracking for IR generation
     BlockScopeNode blockScopesHead;  // Queue head (for dequeue during IR)
@@ -39,6 +40,13 @@ typedef enum {
 TypeCheckContext createTypeCheckContext(const char *sourceCode, const char *filename);
 void freeTypeCheckContext(TypeCheckContext context);
 CompatResult areCompatible(DataType target, DataType source);
+int isIntegerType(DataType type);
+int isUnsignedType(DataType type);
+DataType promoteIntegerTypes(DataType left, DataType right);
+int isVectorType(DataType type);
+DataType vectorElementType(DataType type);
+int vectorLaneCount(DataType type);
+const char* getTypeName(DataType type);
 DataType getOperationResultType(DataType left, DataType right, NodeTypes op);
 DataType getExpressionType(ASTNode node, TypeCheckContext context);
 ErrorCode variableErrorCompatibleHandling(DataType varType, DataType initType);